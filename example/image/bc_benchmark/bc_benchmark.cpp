@@ -0,0 +1,103 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/core/core.hpp>
+#include <mango/image/image.hpp>
+
+using namespace mango;
+using namespace mango::image;
+
+struct Test
+{
+    u32 compression;
+    int channels;
+    const char* name;
+};
+
+const Test tests [] =
+{
+    { TextureCompression::BC1_UNORM, 3, "BC1" },
+    { TextureCompression::BC2_UNORM, 4, "BC2" },
+    { TextureCompression::BC3_UNORM, 4, "BC3" },
+    { TextureCompression::BC4_UNORM, 1, "BC4" },
+    { TextureCompression::BC5_UNORM, 2, "BC5" },
+};
+
+double psnr(const Surface& a, const Surface& b, int channels)
+{
+    double sum = 0.0;
+
+    for (int y = 0; y < a.height; ++y)
+    {
+        const u8* s = a.address(0, y);
+        const u8* d = b.address(0, y);
+
+        for (int x = 0; x < a.width; ++x)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                double delta = double(s[x * 4 + c]) - double(d[x * 4 + c]);
+                sum += delta * delta;
+            }
+        }
+    }
+
+    double mse = sum / (double(a.width) * a.height * channels);
+    if (mse == 0.0)
+    {
+        return 99.0;
+    }
+
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+void profile(const Surface& surface, int iterations)
+{
+    const TextureCompression::Quality qualities [] =
+    {
+        TextureCompression::Quality::FAST,
+        TextureCompression::Quality::NORMAL,
+        TextureCompression::Quality::BEST,
+    };
+
+    const char* quality_names [] = { "fast", "normal", "best" };
+
+    for (const Test& test : tests)
+    {
+        TextureCompression info(test.compression);
+        Buffer buffer(info.getBlockBytes(surface.width, surface.height));
+
+        for (int q = 0; q < 3; ++q)
+        {
+            u64 time0 = Time::us();
+
+            for (int i = 0; i < iterations; ++i)
+            {
+                info.compress(buffer, surface, qualities[q]);
+            }
+
+            u64 time1 = Time::us();
+
+            Bitmap decoded(surface.width, surface.height, surface.format);
+            info.decompress(decoded, buffer);
+
+            double pixels = double(surface.width) * surface.height * iterations;
+            double mpix = pixels / std::max(u64(1), time1 - time0);
+
+            printf("  %s %-7s %8.1f Mpix/s  %6.2f dB\n", test.name, quality_names[q],
+                mpix, psnr(surface, decoded, test.channels));
+        }
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const char* filename = argc > 1 ? argv[1] : "conquer.jpg";
+    int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1;
+
+    Bitmap bitmap(filename, Format(32, Format::UNORM, Format::RGBA, 8, 8, 8, 8));
+    printf("Image: %d x %d\n", bitmap.width, bitmap.height);
+
+    profile(bitmap, iterations);
+}
@@ -19,6 +19,33 @@ void print(const Buffer& buffer, u64 time0, u64 time1)
         u32(x / (delta * MB)));
 }
 
+// hexadecimal test vector to bytes
+std::vector<u8> hex(const char* text)
+{
+    std::vector<u8> data;
+
+    for (size_t i = 0; text[i] && text[i + 1]; i += 2)
+    {
+        char temp[3] = { text[i], text[i + 1], 0 };
+        data.push_back(u8(std::strtoul(temp, nullptr, 16)));
+    }
+
+    return data;
+}
+
+// bytes 0, 1, 2, .. 255, 0, 1, ..
+std::vector<u8> sequence(size_t size)
+{
+    std::vector<u8> data(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        data[i] = u8(i);
+    }
+
+    return data;
+}
+
 void test_fips()
 {
     // FIPS 197, Appendix B input
@@ -54,6 +81,263 @@ void test_fips()
     }
 }
 
+struct GCMVector
+{
+    const char* name;
+    const char* key;
+    const char* iv;
+    const char* associated;
+    std::vector<u8> plaintext;
+    const char* ciphertext;
+    const char* tag;
+};
+
+bool test_gcm(const GCMVector& vector)
+{
+    std::vector<u8> key = hex(vector.key);
+    std::vector<u8> iv = hex(vector.iv);
+    std::vector<u8> associated = hex(vector.associated);
+    std::vector<u8> ciphertext = hex(vector.ciphertext);
+    std::vector<u8> tag = hex(vector.tag);
+
+    const std::vector<u8>& plaintext = vector.plaintext;
+    const size_t length = plaintext.size();
+
+    AES aes(key.data(), int(key.size() * 8));
+
+    std::vector<u8> result(length);
+    u8 result_tag[16];
+
+    aes.gcm_encrypt(Memory(result.data(), length), ConstMemory(plaintext.data(), length),
+        ConstMemory(associated.data(), associated.size()), ConstMemory(iv.data(), iv.size()), Memory(result_tag, 16));
+
+    bool status = result == ciphertext && !memcmp(result_tag, tag.data(), 16);
+
+    auto decrypt = [&] (std::vector<u8>& output)
+    {
+        return aes.gcm_decrypt(Memory(output.data(), length), ConstMemory(ciphertext.data(), length),
+            ConstMemory(associated.data(), associated.size()), ConstMemory(iv.data(), iv.size()), ConstMemory(tag.data(), 16));
+    };
+
+    std::vector<u8> decrypted(length);
+    status &= decrypt(decrypted);
+    status &= decrypted == plaintext;
+
+    // modified message must be rejected and the output cleared
+    ciphertext[length / 2] ^= 1;
+    status &= !decrypt(decrypted);
+    status &= decrypted == std::vector<u8>(length, 0);
+
+    // modified associated data must be rejected
+    ciphertext[length / 2] ^= 1;
+    associated[0] ^= 1;
+    status &= !decrypt(decrypted);
+
+    printLine("  {}: {}", vector.name, status ? "OK" : "FAILED");
+    return status;
+}
+
+void test_gcm()
+{
+    printLine("GCM:");
+
+    const std::vector<u8> plaintext = hex(
+        "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+        "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+
+    const GCMVector vectors [] =
+    {
+        // The Galois/Counter Mode of Operation (GCM), Test Case 4
+        {
+            "96 bit iv",
+            "feffe9928665731c6d6a8f9467308308",
+            "cafebabefacedbaddecaf888",
+            "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+            plaintext,
+            "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+            "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+            "5bc94fbc3221a5db94fae95ae7121a47"
+        },
+
+        // The Galois/Counter Mode of Operation (GCM), Test Case 5
+        {
+            "64 bit iv",
+            "feffe9928665731c6d6a8f9467308308",
+            "cafebabefacedbad",
+            "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+            plaintext,
+            "61353b4c2806934a777ff51fa22a4755699b2a714fcdc6f83766e5f97b6c7423"
+            "73806900e49f24b22b097544d4896b424989b5e1ebac0f07c23f4598",
+            "3612d2e79e3b0785561be14aaca2fccb"
+        },
+
+        // AES-256, 480 bit iv, 300 bytes of sequence(); computed with OpenSSL
+        {
+            "long message",
+            "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+            "9313225df88406e5a55909c5aff5269aa6a7a9538534f7da1e4c303d2a318a72"
+            "8c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39",
+            "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+            sequence(300),
+            "ce98fcf007387f1a8688a0d76d8e8868ce3223b02fbeb1032543c0097d4911fe"
+            "f60fdfe11bd210bcf059be1cff36c4ff4820a75bbf6cb8bb279883ee5f482b78"
+            "eb5239639d111ca57c208f1b095b07061ac05ed9d2e49498817dc4e328f59351"
+            "52904993ebaf98fc85b75459e9c25124a8f2cd804410f68d3bc512ba9d5a183f"
+            "dcc6f2a52bece0616eeb62e2310c8b45f1f717437932e53843f3ce398ef0fda6"
+            "94a7e47ce1878057fa8e83aa132a05df126b80da6be92997aa34177d973627c0"
+            "8c210ec307e17315b858828f58f586dc7eeb2bacfae7e070f0e091ad519663d8"
+            "2189b84c03bd64dc29ee29b51210af05cf3f7ca7ed910537a895158830050062"
+            "f6ce5115b5f34e91eddb93c2989e06930fbc8420bba9390dd01c4779955000d8"
+            "24dcdced861a0dd36bf981dc",
+            "b77b66941310267841b66f70e3781b4b"
+        },
+    };
+
+    bool status = true;
+
+    for (const GCMVector& vector : vectors)
+    {
+        status &= test_gcm(vector);
+    }
+
+    printLine("GCM: {}", status ? "OK" : "FAILED");
+}
+
+struct XTSVector
+{
+    const char* name;
+    const char* key; // key1 || key2
+    u64 sector;
+    size_t length;
+    const char* ciphertext;
+};
+
+bool test_xts(const XTSVector& vector)
+{
+    std::vector<u8> key = hex(vector.key);
+    std::vector<u8> ciphertext = hex(vector.ciphertext);
+    std::vector<u8> plaintext = sequence(vector.length);
+
+    const int bits = int(key.size() * 4);
+
+    AES aes(key.data(), bits);
+    AES tweak(key.data() + key.size() / 2, bits);
+
+    std::vector<u8> result(vector.length);
+    aes.xts_encrypt(result.data(), plaintext.data(), vector.length, tweak, vector.sector);
+
+    bool status = result == ciphertext;
+
+    aes.xts_decrypt(result.data(), ciphertext.data(), vector.length, tweak, vector.sector);
+    status &= result == plaintext;
+
+    printLine("  {}: {}", vector.name, status ? "OK" : "FAILED");
+    return status;
+}
+
+void test_xts()
+{
+    printLine("XTS:");
+
+    // the plaintext is sequence(length) in every vector
+    const XTSVector vectors [] =
+    {
+        // IEEE 1619, Vector 4
+        {
+            "vector 4",
+            "27182818284590452353602874713526"
+            "31415926535897932384626433832795",
+            0, 512,
+            "27a7479befa1d476489f308cd4cfa6e2a96e4bbe3208ff25287dd3819616e89c"
+            "c78cf7f5e543445f8333d8fa7f56000005279fa5d8b5e4ad40e736ddb4d35412"
+            "328063fd2aab53e5ea1e0a9f332500a5df9487d07a5c92cc512c8866c7e860ce"
+            "93fdf166a24912b422976146ae20ce846bb7dc9ba94a767aaef20c0d61ad0265"
+            "5ea92dc4c4e41a8952c651d33174be51a10c421110e6d81588ede82103a252d8"
+            "a750e8768defffed9122810aaeb99f9172af82b604dc4b8e51bcb08235a6f434"
+            "1332e4ca60482a4ba1a03b3e65008fc5da76b70bf1690db4eae29c5f1badd03c"
+            "5ccf2a55d705ddcd86d449511ceb7ec30bf12b1fa35b913f9f747a8afd1b130e"
+            "94bff94effd01a91735ca1726acd0b197c4e5b03393697e126826fb6bbde8ecc"
+            "1e08298516e2c9ed03ff3c1b7860f6de76d4cecd94c8119855ef5297ca67e9f3"
+            "e7ff72b1e99785ca0a7e7720c5b36dc6d72cac9574c8cbbc2f801e23e56fd344"
+            "b07f22154beba0f08ce8891e643ed995c94d9a69c9f1b5f499027a78572aeebd"
+            "74d20cc39881c213ee770b1010e4bea718846977ae119f7a023ab58cca0ad752"
+            "afe656bb3c17256a9f6e9bf19fdd5a38fc82bbe872c5539edb609ef4f79c203e"
+            "bb140f2e583cb2ad15b4aa5b655016a8449277dbd477ef2c8d6c017db738b18d"
+            "eb4a427d1923ce3ff262735779a418f20a282df920147beabe421ee5319d0568"
+        },
+
+        // IEEE 1619, Vector 10
+        {
+            "vector 10",
+            "2718281828459045235360287471352662497757247093699959574966967627"
+            "3141592653589793238462643383279502884197169399375105820974944592",
+            0xff, 512,
+            "1c3b3a102f770386e4836c99e370cf9bea00803f5e482357a4ae12d414a3e63b"
+            "5d31e276f8fe4a8d66b317f9ac683f44680a86ac35adfc3345befecb4bb188fd"
+            "5776926c49a3095eb108fd1098baec70aaa66999a72a82f27d848b21d4a741b0"
+            "c5cd4d5fff9dac89aeba122961d03a757123e9870f8acf1000020887891429ca"
+            "2a3e7a7d7df7b10355165c8b9a6d0a7de8b062c4500dc4cd120c0f7418dae3d0"
+            "b5781c34803fa75421c790dfe1de1834f280d7667b327f6c8cd7557e12ac3a0f"
+            "93ec05c52e0493ef31a12d3d9260f79a289d6a379bc70c50841473d1a8cc81ec"
+            "583e9645e07b8d9670655ba5bbcfecc6dc3966380ad8fecb17b6ba02469a020a"
+            "84e18e8f84252070c13e9f1f289be54fbc481457778f616015e1327a02b140f1"
+            "505eb309326d68378f8374595c849d84f4c333ec4423885143cb47bd71c5edae"
+            "9be69a2ffeceb1bec9de244fbe15992b11b77c040f12bd8f6a975a44a0f90c29"
+            "a9abc3d4d893927284c58754cce294529f8614dcd2aba991925fedc4ae74ffac"
+            "6e333b93eb4aff0479da9a410e4450e0dd7ae4c6e2910900575da401fc07059f"
+            "645e8b7e9bfdef33943054ff84011493c27b3429eaedb4ed5376441a77ed4385"
+            "1ad77f16f541dfd269d50d6a5f14fb0aab1cbb4c1550be97f7ab4066193c4caa"
+            "773dad38014bd2092fa755c824bb5e54c4f36ffda9fcea70b9c6e693e148c151"
+        },
+
+        // IEEE 1619, Vector 15 (ciphertext stealing)
+        {
+            "vector 15",
+            "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0"
+            "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+            0x123456789a, 17,
+            "6c1625db4671522d3d7599601de7ca09ed"
+        },
+
+        // IEEE 1619, Vector 17 (ciphertext stealing)
+        {
+            "vector 17",
+            "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0"
+            "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+            0x123456789a, 19,
+            "e5df1351c0544ba1350b3363cd8ef4beedbf9d"
+        },
+
+        // keys of Vector 10, ciphertext stealing after 20 blocks; computed with OpenSSL
+        {
+            "long data unit",
+            "2718281828459045235360287471352662497757247093699959574966967627"
+            "3141592653589793238462643383279502884197169399375105820974944592",
+            0x123456789a, 333,
+            "50ea7b0e72da7912892bcd0c7496baa4b346523120af299dac5b9960aed521fb"
+            "369169dcb0c7d652a3af8bd85e97b61c48a1dbefdee6b7bf1698d451d676d346"
+            "bb26b05b6d6794e3c1544329529bc80a6c2d623b878b2c17459ddb669134caba"
+            "4ef4202484f0b6afe707523fd5afc25d636f852f2be988192a28f4ccb2c16bc3"
+            "7924c841dc59e72dadeef07ee20305346002c50d8405cd62fe3c209525850f7a"
+            "52b58a875c69e782d418d492dcf1adf34bd636c8ab740171c9a8bf74ab00556f"
+            "9fe32040211f5e715e86ff986231e29f87d8f1194763559ab28596120bbe6ab7"
+            "cd298768a73de1a71bb66dbee8ffa853ac90585ea1d36f79eeefea7f1c190cad"
+            "9446b9ab1428b6a8fc2801b9cd6105235d1371cd929c25db2886ab4f7048e21b"
+            "5b39521e82361c20c14f09d58a29e9f9c9736527894e72b2e7150fc66e23f59f"
+            "9206c63bfa2f20b597a9ad4abb"
+        },
+    };
+
+    bool status = true;
+
+    for (const XTSVector& vector : vectors)
+    {
+        status &= test_xts(vector);
+    }
+
+    printLine("XTS: {}\n", status ? "OK" : "FAILED");
+}
+
 void test_aes(int bits)
 {
     const u8 key[] =
@@ -107,11 +391,105 @@ void test_aes(int bits)
     }
 }
 
+void test_modes(int bits)
+{
+    const u8 key[] =
+    {
+        0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x9 , 0xcf, 0x4f, 0x3c,
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+    };
+
+    AES aes(key, bits);
+    AES tweak(key + 16, 128);
+
+    constexpr u64 size = 128 * MB;
+    constexpr u64 sector = 4096;
+
+    Buffer buffer(size);
+    Buffer output(size);
+    Buffer temp(size);
+
+    for (u64 i = 0; i < size; ++i)
+    {
+        buffer[i] = u8(i);
+    }
+
+    const u8 iv[12] = { 0 };
+    u8 tag[16];
+
+    bool status = true;
+
+    // GCM
+
+    u64 time0 = Time::us();
+
+    for (int i = 0; i < N; ++i)
+    {
+        aes.gcm_encrypt(Memory(temp, size), ConstMemory(buffer, size), ConstMemory(), ConstMemory(iv, 12), Memory(tag, 16));
+    }
+
+    u64 time1 = Time::us();
+
+    for (int i = 0; i < N; ++i)
+    {
+        status &= aes.gcm_decrypt(Memory(output, size), ConstMemory(temp, size), ConstMemory(), ConstMemory(iv, 12), ConstMemory(tag, 16));
+    }
+
+    u64 time2 = Time::us();
+
+    printf("gcm%d encrypt: ", bits);
+    print(buffer, time0, time1);
+
+    printf("gcm%d decrypt: ", bits);
+    print(buffer, time1, time2);
+
+    status &= !memcmp(output, buffer, size);
+
+    // XTS with 4 KB sectors
+
+    time0 = Time::us();
+
+    for (int i = 0; i < N; ++i)
+    {
+        for (u64 offset = 0; offset < size; offset += sector)
+        {
+            aes.xts_encrypt(temp + offset, buffer + offset, sector, tweak, offset / sector);
+        }
+    }
+
+    time1 = Time::us();
+
+    for (int i = 0; i < N; ++i)
+    {
+        for (u64 offset = 0; offset < size; offset += sector)
+        {
+            aes.xts_decrypt(output + offset, temp + offset, sector, tweak, offset / sector);
+        }
+    }
+
+    time2 = Time::us();
+
+    printf("xts%d encrypt: ", bits);
+    print(buffer, time0, time1);
+
+    printf("xts%d decrypt: ", bits);
+    print(buffer, time1, time2);
+
+    status &= !memcmp(output, buffer, size);
+
+    printf("GCM/XTS%d: %s\n\n", bits, status ? "PASSED" : "FAILED");
+}
+
 int main()
 {
     printLine(getPlatformInfo());
     test_fips();
+    test_gcm();
+    test_xts();
     test_aes(128);
     test_aes(192);
     test_aes(256);
+    test_modes(128);
+    test_modes(192);
+    test_modes(256);
 }
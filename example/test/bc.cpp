@@ -0,0 +1,200 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/mango.hpp>
+
+using namespace mango;
+using namespace mango::image;
+
+// ----------------------------------------------------------------------
+// helpers
+// ----------------------------------------------------------------------
+
+void print_status(bool status)
+{
+    printLine("  status: {}\n", status ? "OK" : "FAILED");
+}
+
+double psnr(const Surface& a, const Surface& b, int channels)
+{
+    double sum = 0.0;
+
+    for (int y = 0; y < a.height; ++y)
+    {
+        const u8* s = a.address(0, y);
+        const u8* d = b.address(0, y);
+
+        for (int x = 0; x < a.width; ++x)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                double delta = double(s[x * 4 + c]) - double(d[x * 4 + c]);
+                sum += delta * delta;
+            }
+        }
+    }
+
+    double mse = sum / (double(a.width) * a.height * channels);
+    if (mse == 0.0)
+    {
+        return 99.0;
+    }
+
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+// ----------------------------------------------------------------------
+// tests
+// ----------------------------------------------------------------------
+
+void test_color(u32 compression, const char* name, int channels, double threshold)
+{
+    printLine("{}: color roundtrip", name);
+
+    // smooth gradients with a bit of detail; the size is not a multiple of the block size
+    const int width = 61;
+    const int height = 47;
+
+    Bitmap source(width, height, Format(32, Format::UNORM, Format::RGBA, 8, 8, 8, 8));
+
+    for (int y = 0; y < height; ++y)
+    {
+        u8* scan = source.address(0, y);
+
+        for (int x = 0; x < width; ++x)
+        {
+            scan[x * 4 + 0] = u8(x * 255 / (width - 1));
+            scan[x * 4 + 1] = u8(y * 255 / (height - 1));
+            scan[x * 4 + 2] = u8(128 + 64 * std::sin(x * 0.2f + y * 0.1f));
+            scan[x * 4 + 3] = channels > 3 ? u8((x + y) * 255 / (width + height - 2)) : 255;
+        }
+    }
+
+    TextureCompression info(compression);
+    Buffer buffer(info.getBlockBytes(width, height));
+
+    bool status = true;
+
+    const TextureCompression::Quality qualities [] =
+    {
+        TextureCompression::Quality::FAST,
+        TextureCompression::Quality::NORMAL,
+        TextureCompression::Quality::BEST,
+    };
+
+    for (auto quality : qualities)
+    {
+        auto result = info.compress(buffer, source, quality);
+        if (!result)
+        {
+            printLine(Print::Error, "  compress: {}", result.info);
+            status = false;
+            continue;
+        }
+
+        Bitmap decoded(width, height, source.format);
+        info.decompress(decoded, buffer);
+
+        double db = psnr(source, decoded, channels);
+        printLine("  quality: {}, psnr: {:.2f} dB", int(quality), db);
+
+        status = status && db >= threshold;
+    }
+
+    print_status(status);
+}
+
+void test_channel(u32 compression, const char* name, int channels, bool snorm)
+{
+    printLine("{}: channel roundtrip", name);
+
+    // ramps that run well past the representable range and constant out-of-range blocks;
+    // the decoded values must be the input clamped to [0, 1] or [-1, 1]
+    const int width = 64;
+    const int height = 32;
+
+    Bitmap source(width, height, Format(128, Format::FLOAT32, Format::RGBA, 32, 32, 32, 32));
+
+    const float constants [] = { 1.5f, -1.5f, 4.0f, -4.0f };
+
+    for (int y = 0; y < height; ++y)
+    {
+        float* scan = source.address<float>(0, y);
+
+        for (int x = 0; x < width; ++x)
+        {
+            float r = (x / float(width - 1)) * 4.0f - 2.0f;
+            float g = (y / float(height - 1)) * 4.0f - 2.0f;
+
+            if (y < 4)
+            {
+                // first row of blocks is constant
+                r = constants[(x / 4) % 4];
+                g = constants[(x / 4 + 1) % 4];
+            }
+
+            scan[x * 4 + 0] = r;
+            scan[x * 4 + 1] = g;
+            scan[x * 4 + 2] = 0.0f;
+            scan[x * 4 + 3] = 1.0f;
+        }
+    }
+
+    TextureCompression info(compression);
+    Buffer buffer(info.getBlockBytes(width, height));
+
+    auto result = info.compress(buffer, source, TextureCompression::Quality::NORMAL);
+    if (!result)
+    {
+        printLine(Print::Error, "  compress: {}", result.info);
+        print_status(false);
+        return;
+    }
+
+    Bitmap decoded(width, height, source.format);
+    info.decompress(decoded, buffer);
+
+    const float lo = snorm ? -1.0f : 0.0f;
+    const float hi = 1.0f;
+
+    float maxError = 0.0f;
+    float maxConstantError = 0.0f;
+
+    for (int y = 0; y < height; ++y)
+    {
+        const float* s = source.address<float>(0, y);
+        const float* d = decoded.address<float>(0, y);
+
+        for (int x = 0; x < width; ++x)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                float expected = std::clamp(s[x * 4 + c], lo, hi);
+                float error = std::abs(d[x * 4 + c] - expected);
+
+                maxError = std::max(maxError, error);
+                if (y < 4)
+                {
+                    maxConstantError = std::max(maxConstantError, error);
+                }
+            }
+        }
+    }
+
+    printLine("  max error: {:.4f}, constant blocks: {:.4f}", maxError, maxConstantError);
+
+    bool status = maxError <= 0.05f && maxConstantError <= 1.0f / 127.0f;
+    print_status(status);
+}
+
+int main()
+{
+    test_color(TextureCompression::BC1_UNORM, "BC1", 3, 30.0);
+    test_color(TextureCompression::BC2_UNORM, "BC2", 4, 30.0);
+    test_color(TextureCompression::BC3_UNORM, "BC3", 4, 30.0);
+    test_channel(TextureCompression::BC4_UNORM, "BC4_UNORM", 1, false);
+    test_channel(TextureCompression::BC4_SNORM, "BC4_SNORM", 1, true);
+    test_channel(TextureCompression::BC5_UNORM, "BC5_UNORM", 2, false);
+    test_channel(TextureCompression::BC5_SNORM, "BC5_SNORM", 2, true);
+}
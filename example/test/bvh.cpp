@@ -0,0 +1,230 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/core/core.hpp>
+#include <mango/import3d/bvh.hpp>
+
+using namespace mango;
+using namespace mango::math;
+using namespace mango::import3d;
+
+// ----------------------------------------------------------------------------
+// scene
+// ----------------------------------------------------------------------------
+
+IndexedMesh createTerrain(int size)
+{
+    Mesh mesh;
+
+    mesh.flags = Vertex::Position;
+
+    auto vertex = [&] (int x, int z)
+    {
+        float s = 200.0f / size;
+        float fx = x * s - 100.0f;
+        float fz = z * s - 100.0f;
+        float fy = std::sin(fx * 0.1f) * std::cos(fz * 0.13f) * 8.0f + std::sin(fx * 0.7f + fz * 0.5f);
+
+        Vertex v;
+        v.position = float32x3(fx, fy, fz);
+        return v;
+    };
+
+    for (int z = 0; z < size; ++z)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            Vertex v0 = vertex(x + 0, z + 0);
+            Vertex v1 = vertex(x + 1, z + 0);
+            Vertex v2 = vertex(x + 0, z + 1);
+            Vertex v3 = vertex(x + 1, z + 1);
+
+            mesh.triangles.push_back({ v0, v1, v2 });
+            mesh.triangles.push_back({ v2, v1, v3 });
+        }
+    }
+
+    return IndexedMesh(mesh, 0);
+}
+
+struct Camera
+{
+    float32x3 origin;
+    float32x3 corner;
+    float32x3 dx;
+    float32x3 dy;
+
+    Camera(const float32x3& origin, const float32x3& target, int width, int height)
+        : origin(origin)
+    {
+        float32x3 forward = normalize(target - origin);
+        float32x3 right = normalize(cross(float32x3(0.0f, 1.0f, 0.0f), forward));
+        float32x3 up = cross(forward, right);
+
+        float aspect = float(width) / float(height);
+        dx = right * (2.0f * aspect / width);
+        dy = up * (-2.0f / height);
+        corner = forward * 1.5f - right * aspect + up;
+    }
+
+    Ray ray(int x, int y) const
+    {
+        return Ray(origin, normalize(corner + dx * (x + 0.5f) + dy * (y + 0.5f)));
+    }
+};
+
+// ----------------------------------------------------------------------------
+// test
+// ----------------------------------------------------------------------------
+
+template <int Width>
+void test(const char* name, const IndexedMesh& mesh, const Camera& camera, int width, int height)
+{
+    using Hit = typename BVH<Width>::Hit;
+
+    u64 time0 = Time::us();
+
+    BVH<Width> bvh(mesh);
+
+    u64 time1 = Time::us();
+
+    printLine("{}: {} primitives, {} nodes", name, bvh.getPrimitiveCount(), bvh.getNodeCount());
+    printLine("  build:    {:8.1f} ms", (time1 - time0) / 1000.0);
+
+    const size_t count = size_t(width) * height;
+
+    std::vector<Hit> hits0(count);
+    std::vector<Hit> hits1(count);
+    std::vector<Hit> hits2(count);
+
+    // single ray
+    time0 = Time::us();
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            bvh.intersect(hits0[y * width + x], camera.ray(x, y));
+        }
+    }
+
+    time1 = Time::us();
+
+    // 4x2 packets
+    auto packets = [&] (std::vector<Hit>& hits, int y0, int y1)
+    {
+        for (int y = y0; y < y1; y += 2)
+        {
+            for (int x = 0; x < width; x += 4)
+            {
+                Ray rays[8];
+                Hit temp[8];
+
+                for (int i = 0; i < 8; ++i)
+                {
+                    rays[i] = camera.ray(x + (i & 3), y + (i >> 2));
+                }
+
+                bvh.intersect(temp, RayPacket(rays, 8));
+
+                for (int i = 0; i < 8; ++i)
+                {
+                    hits[(y + (i >> 2)) * width + x + (i & 3)] = temp[i];
+                }
+            }
+        }
+    };
+
+    packets(hits1, 0, height);
+
+    u64 time2 = Time::us();
+
+    // packets with the ThreadPool
+    ConcurrentQueue q;
+
+    for (int y = 0; y < height; y += 16)
+    {
+        q.enqueue([&, y]
+        {
+            packets(hits2, y, std::min(y + 16, height));
+        });
+    }
+
+    q.wait();
+
+    u64 time3 = Time::us();
+
+    auto mrays = [=] (u64 time)
+    {
+        return double(count) / std::max(time, u64(1));
+    };
+
+    printLine("  single:   {:8.1f} ms, {:6.2f} Mrays/s", (time1 - time0) / 1000.0, mrays(time1 - time0));
+    printLine("  packet:   {:8.1f} ms, {:6.2f} Mrays/s", (time2 - time1) / 1000.0, mrays(time2 - time1));
+    printLine("  threads:  {:8.1f} ms, {:6.2f} Mrays/s", (time3 - time2) / 1000.0, mrays(time3 - time2));
+
+    // compare the traversals; the triangle tests are not bit exact between
+    // the scalar and SIMD code so rays grazing an edge can disagree
+    auto equal = [] (const Hit& a, const Hit& b)
+    {
+        if (a.primitive == 0xffffffff || b.primitive == 0xffffffff)
+            return a.primitive == b.primitive;
+        return std::abs(a.t0 - b.t0) <= 0.001f * a.t0;
+    };
+
+    size_t hitCount = 0;
+    size_t mismatch = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        hitCount += hits0[i].primitive != 0xffffffff;
+        mismatch += !equal(hits0[i], hits1[i]) || !equal(hits1[i], hits2[i]);
+    }
+
+    // brute force reference for a subset of the rays
+    std::vector<math::Triangle> triangles;
+    const float32x3* positions = mesh.getPositions();
+
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        triangles.emplace_back(positions[mesh.indices[i + 0]],
+                               positions[mesh.indices[i + 1]],
+                               positions[mesh.indices[i + 2]]);
+    }
+
+    for (size_t i = 0; i < count; i += count / 97)
+    {
+        Ray ray = camera.ray(int(i % width), int(i / width));
+        Hit reference;
+
+        for (size_t j = 0; j < triangles.size(); ++j)
+        {
+            IntersectBarycentricTwosided is;
+            if (is.intersect(ray, triangles[j]) && is.t0 > 0.0f && is.t0 < reference.t0)
+            {
+                reference.t0 = is.t0;
+                reference.primitive = u32(j);
+            }
+        }
+
+        mismatch += !equal(reference, hits0[i]);
+    }
+
+    printLine("  hits: {} / {}, mismatch: {}", hitCount, count, mismatch);
+    printLine("  status: {}\n", mismatch <= count / 10000 ? "OK" : "FAILED");
+}
+
+int main()
+{
+    printLine(getPlatformInfo());
+
+    const int width = 512;
+    const int height = 512;
+
+    IndexedMesh mesh = createTerrain(400);
+    Camera camera(float32x3(0.0f, 60.0f, -150.0f), float32x3(0.0f, 0.0f, 0.0f), width, height);
+
+    test<4>("BVH4", mesh, camera, width, height);
+    test<8>("BVH8", mesh, camera, width, height);
+}
@@ -59,8 +59,75 @@ void compression_example(size_t size)
     printLine("status: {}", status);
 }
 
+void parallel_compression_example(size_t size)
+{
+    Buffer buffer(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        buffer[i] = ((i + 2) * 0x123456) & 0xff;
+    }
+
+    // the output is a standard zstd stream with one frame per chunk
+    Compressor compressor = getCompressor(Compressor::ZSTD);
+
+    u64 time0 = Time::us();
+
+    Buffer compressed(parallel::bound(compressor, size));
+    CompressionStatus result = parallel::compress(compressor, compressed, buffer, 6);
+
+    u64 time1 = Time::us();
+
+    Buffer output(size);
+    parallel::decompress(compressor, output, Memory(compressed, result.size));
+
+    u64 time2 = Time::us();
+
+    float rate0 = size / float(time1 - time0);
+    float rate1 = size / float(time2 - time1);
+
+    bool correct = std::memcmp(buffer, output, size) == 0;
+    const char* status = correct ? "PASSED" : "FAILED";
+
+    printLine("parallel compressed {} bytes to {} bytes in {} us ({:.1f} MB/s).", size, result.size, time1 - time0, rate0);
+    printLine("parallel decompressed {} bytes to {} bytes in {} us ({:.1f} MB/s).", result.size, size, time2 - time1, rate1);
+    printLine("status: {}", status);
+}
+
+void streaming_example(size_t size)
+{
+    Buffer buffer(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        buffer[i] = ((i + 2) * 0x123456) & 0xff;
+    }
+
+    Buffer compressed(deflate_gzip::bound(size));
+    size_t bytes = deflate_gzip::compress(compressed, buffer, 6);
+
+    u64 time0 = Time::us();
+
+    // the decompressed size does not have to be known; the data is
+    // decompressed through fixed size buffers into the output stream
+    ConstMemoryStream input(Memory(compressed, bytes));
+    MemoryStream output;
+
+    CompressionStatus result = decompress(output, input, Compressor::DEFLATE_GZIP);
+
+    u64 time1 = Time::us();
+
+    bool correct = result && result.size == size && std::memcmp(buffer, output.data(), size) == 0;
+    const char* status = correct ? "PASSED" : "FAILED";
+
+    printLine("streaming decompressed {} bytes to {} bytes in {} us.", bytes, result.size, time1 - time0);
+    printLine("status: {}", status);
+}
+
 int main(int argc, const char* argv[])
 {
     const size_t size = 1024 * 1024;
     compression_example(size);
+    parallel_compression_example(size * 32);
+    streaming_example(size * 4);
 }
@@ -0,0 +1,281 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/mango.hpp>
+
+using namespace mango;
+using namespace mango::image;
+
+// ----------------------------------------------------------------------
+// helpers
+// ----------------------------------------------------------------------
+
+const Format format(128, Format::FLOAT32, Format::RGBA, 32, 32, 32, 32);
+
+void print_status(bool status)
+{
+    printLine("  status: {}\n", status ? "OK" : "FAILED");
+}
+
+// half-float exact values so that only the decoder color conversion differs from the source
+Bitmap createImage(int width, int height)
+{
+    Bitmap bitmap(width, height, format);
+
+    for (int y = 0; y < height; ++y)
+    {
+        float* scan = bitmap.address<float>(0, y);
+
+        for (int x = 0; x < width; ++x)
+        {
+            scan[x * 4 + 0] = float(x) / 64.0f;
+            scan[x * 4 + 1] = float(y) / 64.0f;
+            scan[x * 4 + 2] = float((x * 7 + y * 3) % 32) / 32.0f;
+            scan[x * 4 + 3] = float((x + y) % 2);
+        }
+    }
+
+    return bitmap;
+}
+
+// largest difference between the decoded image and the source read at (x0, y0);
+// the decoder delivers the linear color channels in sRGB
+float compare(const Surface& source, const Surface& decoded, int x0 = 0, int y0 = 0)
+{
+    float error = 0.0f;
+
+    for (int y = 0; y < decoded.height; ++y)
+    {
+        const float* s = source.address<float>(x0, y0 + y);
+        const float* d = decoded.address<float>(0, y);
+
+        for (int x = 0; x < decoded.width; ++x)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                float expected = c < 3 ? math::linear_to_srgb(s[x * 4 + c]) : s[x * 4 + c];
+                error = std::max(error, std::abs(expected - d[x * 4 + c]));
+            }
+        }
+    }
+
+    return error;
+}
+
+// ----------------------------------------------------------------------
+// tests
+// ----------------------------------------------------------------------
+
+void test_method(const Surface& source, int method, const char* name, int tile)
+{
+    printLine("method: {}, tile: {}", name, tile);
+
+    ImageEncodeOptions options;
+    options.method = method;
+    options.tile = tile;
+
+    MemoryStream stream;
+
+    ImageEncodeStatus encodeStatus = source.save(stream, ".exr", options);
+    if (!encodeStatus)
+    {
+        printLine(Print::Error, "  encode: {}", encodeStatus.info);
+        print_status(false);
+        return;
+    }
+
+    ImageDecoder decoder(stream, ".exr");
+    ImageHeader header = decoder.header();
+
+    Bitmap decoded(source.width, source.height, format);
+    ImageDecodeStatus decodeStatus = decoder.decode(decoded, ImageDecodeOptions(), 0, 0, 0);
+    if (!decodeStatus)
+    {
+        printLine(Print::Error, "  decode: {}", decodeStatus.info);
+    }
+
+    float error = compare(source, decoded);
+    printLine("  size: {} bytes, max error: {}", stream.size(), error);
+
+    // all methods are lossless; the error comes from storing the sRGB values as half-floats
+    bool status = decodeStatus && header.width == source.width && header.height == source.height && error < 0.001f;
+    print_status(status);
+}
+
+void test_invalid_method(const Surface& source, int method)
+{
+    printLine("method: {} (invalid)", method);
+
+    ImageEncodeOptions options;
+    options.method = method;
+
+    MemoryStream stream;
+
+    ImageEncodeStatus status = source.save(stream, ".exr", options);
+    printLine("  error: {}", status.info);
+
+    print_status(!status && stream.size() == 0);
+}
+
+void test_region(const Surface& source, int method, const char* name, int tile, int x, int y, int width, int height)
+{
+    printLine("region: ({}, {}) {} x {}, method: {}, tile: {}", x, y, width, height, name, tile);
+
+    ImageEncodeOptions encodeOptions;
+    encodeOptions.method = method;
+    encodeOptions.tile = tile;
+
+    MemoryStream stream;
+
+    ImageEncodeStatus encodeStatus = source.save(stream, ".exr", encodeOptions);
+    if (!encodeStatus)
+    {
+        printLine(Print::Error, "  encode: {}", encodeStatus.info);
+        print_status(false);
+        return;
+    }
+
+    ImageDecoder decoder(stream, ".exr");
+
+    // the region is clipped to the image
+    int x1 = std::min(source.width, x + width);
+    int y1 = std::min(source.height, y + height);
+
+    bool status = true;
+
+    for (bool multithread : { false, true })
+    {
+        ImageDecodeOptions options;
+        options.region.x = x;
+        options.region.y = y;
+        options.region.width = width;
+        options.region.height = height;
+        options.multithread = multithread;
+
+        Bitmap decoded(x1 - x, y1 - y, format);
+        ImageDecodeStatus decodeStatus = decoder.decode(decoded, options, 0, 0, 0);
+        if (!decodeStatus)
+        {
+            printLine(Print::Error, "  decode: {}", decodeStatus.info);
+            status = false;
+            continue;
+        }
+
+        float error = compare(source, decoded, x, y);
+        printLine("  multithread: {}, max error: {}", multithread, error);
+
+        status = status && error < 0.001f;
+    }
+
+    print_status(status);
+}
+
+void test_invalid_region(const Surface& source, int tile)
+{
+    printLine("region: outside the image, tile: {}", tile);
+
+    ImageEncodeOptions encodeOptions;
+    encodeOptions.tile = tile;
+
+    MemoryStream stream;
+    source.save(stream, ".exr", encodeOptions);
+
+    ImageDecoder decoder(stream, ".exr");
+
+    ImageDecodeOptions options;
+    options.region.x = source.width;
+    options.region.y = 0;
+    options.region.width = 8;
+    options.region.height = 8;
+
+    Bitmap decoded(8, 8, format);
+    ImageDecodeStatus status = decoder.decode(decoded, options, 0, 0, 0);
+    printLine("  error: {}", status.info);
+
+    print_status(!status);
+}
+
+void test_cubemap(const std::string& filename)
+{
+    printLine("cubemap: {}", filename);
+
+    // 8 x 8 faces with a complete mipmap chain; the 1 x 3 and 1 x 1 levels of the
+    // vertically stacked cross have less than one row per face and are not exposed
+    filesystem::File file(filename);
+    ImageDecoder decoder(file, ".exr");
+    ImageHeader header = decoder.header();
+
+    printLine("  {} x {}, levels: {}, faces: {}", header.width, header.height, header.levels, header.faces);
+
+    bool status = header.success &&
+                  header.width == 8 &&
+                  header.height == 8 &&
+                  header.levels == 4 &&
+                  header.faces == 6;
+
+    for (int level = 0; level < header.levels; ++level)
+    {
+        int size = std::max(1, header.width >> level);
+
+        // red and green store the level, blue varies across the faces
+        const float expected = math::linear_to_srgb(level * 0.125f);
+
+        for (int face = 0; face < header.faces; ++face)
+        {
+            Bitmap decoded(size, size, format);
+            ImageDecodeStatus decodeStatus = decoder.decode(decoded, ImageDecodeOptions(), level, 0, face);
+            if (!decodeStatus)
+            {
+                printLine(Print::Error, "  level: {}, face: {}: {}", level, face, decodeStatus.info);
+                status = false;
+                continue;
+            }
+
+            const float* pixel = decoded.address<float>(size - 1, size - 1);
+            float error = std::max(std::abs(pixel[0] - expected), std::abs(pixel[1] - expected));
+            status = status && error < 0.001f && pixel[3] == 1.0f;
+        }
+    }
+
+    print_status(status);
+}
+
+int main()
+{
+    Bitmap bitmap = createImage(67, 45);
+
+    struct Method
+    {
+        int method;
+        const char* name;
+    };
+
+    const Method methods [] =
+    {
+        { EXR_COMPRESSION_NONE, "none" },
+        { EXR_COMPRESSION_RLE, "rle" },
+        { EXR_COMPRESSION_ZIPS, "zips" },
+        { EXR_COMPRESSION_ZIP, "zip" },
+        { EXR_COMPRESSION_PIZ, "piz" },
+    };
+
+    for (const Method& method : methods)
+    {
+        test_method(bitmap, method.method, method.name, 0);
+        test_method(bitmap, method.method, method.name, 16);
+    }
+
+    test_invalid_method(bitmap, 5);
+    test_invalid_method(bitmap, 0x103);
+
+    // regions which start and end inside tiles, cross the partial edge tiles and cover a single pixel
+    test_region(bitmap, EXR_COMPRESSION_ZIP, "zip", 16, 5, 7, 37, 23);
+    test_region(bitmap, EXR_COMPRESSION_PIZ, "piz", 16, 5, 7, 37, 23);
+    test_region(bitmap, EXR_COMPRESSION_RLE, "rle", 8, 13, 3, 1, 40);
+    test_region(bitmap, EXR_COMPRESSION_ZIP, "zip", 16, 50, 30, 40, 40);
+    test_region(bitmap, EXR_COMPRESSION_NONE, "none", 16, 33, 17, 1, 1);
+    test_invalid_region(bitmap, 16);
+
+    test_cubemap("data/cubemap.exr");
+}
@@ -0,0 +1,266 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/mango.hpp>
+#include <random>
+
+using namespace mango;
+using namespace mango::math;
+
+// ----------------------------------------------------------------------
+// helpers
+// ----------------------------------------------------------------------
+
+namespace
+{
+
+    std::mt19937 mt(0x12345678);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+    float32x3 random_point()
+    {
+        return float32x3(dist(mt), dist(mt), dist(mt));
+    }
+
+    void print_time(const char* name, u64 time0, u64 time1)
+    {
+        printLine("  {:<22} {:7} us", name, time1 - time0);
+    }
+
+    void print_status(bool status)
+    {
+        printLine("  status: {}\n", status ? "OK" : "FAILED");
+    }
+
+} // namespace
+
+// ----------------------------------------------------------------------
+// tests
+// ----------------------------------------------------------------------
+
+void test_transform(size_t count)
+{
+    printLine("transform: {} points", count);
+
+    const Matrix4x4 m = Matrix4x4::rotateXYZ(0.1f, 0.2f, 0.3f) * Matrix4x4::translate(1.0f, 2.0f, 3.0f);
+
+    std::vector<float32x3> points(count);
+    PointArray array;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        points[i] = random_point();
+        array.push_back(points[i]);
+    }
+
+    std::vector<float32x3> result0(count);
+    PointArray result1;
+
+    u64 time0 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        result0[i] = points[i] * m;
+    }
+
+    u64 time1 = Time::us();
+
+    transformPoints(result1, array, m);
+
+    u64 time2 = Time::us();
+
+    print_time("scalar:", time0, time1);
+    print_time("transformPoints:", time1, time2);
+
+    bool status = result1.size() == count;
+
+    for (size_t i = 0; i < count && status; ++i)
+    {
+        status = length(result0[i] - result1[i]) < 0.001f;
+    }
+
+    print_status(status);
+}
+
+void test_cull(size_t count)
+{
+    printLine("cull: {} boxes and spheres", count);
+
+    const Matrix4x4 view = Matrix4x4::rotateY(0.5f) * Matrix4x4::translate(0.0f, 0.0f, -10.0f);
+    const FrustumPlanes frustum(view * Matrix4x4::perspectiveGL(1.2f, 0.9f, 0.5f, 150.0f));
+
+    std::vector<Box> boxes(count);
+    std::vector<Sphere> spheres(count);
+    BoxArray boxArray;
+    SphereArray sphereArray;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        float32x3 point = random_point();
+
+        boxes[i] = Box(point, size(mt));
+        spheres[i] = Sphere(point, size(mt));
+        boxArray.push_back(boxes[i]);
+        sphereArray.push_back(spheres[i]);
+    }
+
+    std::vector<u32> visible0;
+    std::vector<u32> visible1(count);
+
+    u64 time0 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (frustum.intersect(boxes[i]))
+        {
+            visible0.push_back(u32(i));
+        }
+    }
+
+    u64 time1 = Time::us();
+
+    visible1.resize(cull(visible1.data(), frustum, boxArray));
+
+    u64 time2 = Time::us();
+
+    print_time("scalar boxes:", time0, time1);
+    print_time("cull boxes:", time1, time2);
+
+    bool status = visible0 == visible1;
+    printLine("  visible: {}", visible1.size());
+
+    visible0.clear();
+    visible1.resize(count);
+
+    time0 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (frustum.intersect(spheres[i]))
+        {
+            visible0.push_back(u32(i));
+        }
+    }
+
+    time1 = Time::us();
+
+    visible1.resize(cull(visible1.data(), frustum, sphereArray));
+
+    time2 = Time::us();
+
+    print_time("scalar spheres:", time0, time1);
+    print_time("cull spheres:", time1, time2);
+
+    status &= visible0 == visible1;
+    printLine("  visible: {}", visible1.size());
+
+    print_status(status);
+}
+
+void test_ray(size_t count)
+{
+    printLine("ray: {} boxes", count);
+
+    std::vector<Box> boxes(count);
+    BoxArray boxArray;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        boxes[i] = Box(random_point(), size(mt) * 4.0f);
+        boxArray.push_back(boxes[i]);
+    }
+
+    std::vector<Ray> rays;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        rays.emplace_back(random_point(), normalize(random_point()));
+    }
+
+    // every ray appends its hits to the same buffer
+    std::vector<u32> hits0;
+    std::vector<u32> hits1(count * rays.size());
+    std::vector<float> distance(count * rays.size());
+
+    u64 time0 = Time::us();
+
+    for (const Ray& ray : rays)
+    {
+        FastRay fast(ray);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            IntersectRange is;
+            if (is.intersect(fast, boxes[i]))
+            {
+                hits0.push_back(u32(i));
+            }
+        }
+    }
+
+    u64 time1 = Time::us();
+
+    size_t total = 0;
+
+    for (const Ray& ray : rays)
+    {
+        size_t n = intersect(hits1.data() + total, distance.data() + total, FastRay(ray), boxArray);
+        total += n;
+    }
+
+    hits1.resize(total);
+
+    u64 time2 = Time::us();
+
+    // the same rays as one packet against every box
+    RayPacket packet(rays.data(), rays.size());
+    std::vector<u32> hits2[8];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        float32x8 t;
+        u32 mask = intersect(t, packet, boxes[i]);
+
+        for (int j = 0; j < 8; ++j)
+        {
+            if (mask & (1 << j))
+            {
+                hits2[j].push_back(u32(i));
+            }
+        }
+    }
+
+    u64 time3 = Time::us();
+
+    print_time("scalar:", time0, time1);
+    print_time("intersect boxes:", time1, time2);
+    print_time("intersect packet:", time2, time3);
+
+    std::vector<u32> hits3;
+
+    for (auto& hits : hits2)
+    {
+        hits3.insert(hits3.end(), hits.begin(), hits.end());
+    }
+
+    bool status = hits0 == hits1 && hits0 == hits3;
+    printLine("  hits: {}", hits1.size());
+
+    // an empty packet does not read the rays and never intersects
+    RayPacket empty(nullptr, 0);
+    float32x8 t;
+    status &= empty.mask == 0 && intersect(t, empty, boxes[0]) == 0;
+
+    print_status(status);
+}
+
+int main()
+{
+    printLine(getPlatformInfo());
+
+    test_transform(1000000);
+    test_cull(1000000);
+    test_ray(1000000);
+}
@@ -85,6 +85,196 @@ void validate(Buffer& message5)
     check(mango::sha2(message5), { 0x486cc817, 0xb95d853d, 0x3c357ff2, 0x83b204c0, 0x144bd255, 0xe73fe2de, 0xb1389493, 0xb257e3c0 });
 
     printf("\n");
+    printf("BLAKE3 test vectors:\n");
+    printf("\n");
+
+    check(mango::blake3(memory0), { 0x6437b3ac, 0x38465133, 0xffb63b75, 0x273a8db5, 0x48c55846, 0x5d79db03, 0xfd359c6c, 0xd5bd9d85 });
+    check(mango::blake3(memory1), { 0xaf1349b9, 0xf5f9a1a6, 0xa0404dea, 0x36dcc949, 0x9bcb25c9, 0xadc112b7, 0xcc9a93ca, 0xe41f3262 });
+    check(mango::blake3(memory2), { 0xc19012cc, 0x2aaf0dc3, 0xd8e5c45a, 0x1b79114d, 0x2df42abb, 0x2a410bf5, 0x4be09e89, 0x1af06ff8 });
+
+    printf("\n");
+    printf("HMAC-SHA1 / PBKDF2-HMAC-SHA1 test vectors:\n");
+    printf("\n");
+
+    const u8 key [] = "Jefe";
+    const u8 data [] = "what do ya want for nothing?";
+    const u8 password [] = "password";
+    const u8 salt [] = "salt";
+
+    check(mango::hmac_sha1(ConstMemory(key, 4), ConstMemory(data, 28)), { 0xeffcdf6a, 0xe5eb2fa2, 0xd27416d5, 0xf184df9c, 0x259a7c79 });
+
+    SHA1 derived;
+    pbkdf2_sha1(Memory(reinterpret_cast<u8*>(derived.data), 20), ConstMemory(password, 8), ConstMemory(salt, 4), 2);
+    check(derived, { 0xea6c014d, 0xc72d6f8c, 0xcd1ed92a, 0xce1d41f0, 0xd8de8957 });
+
+    pbkdf2_sha1(Memory(reinterpret_cast<u8*>(derived.data), 20), ConstMemory(password, 8), ConstMemory(salt, 4), 4096);
+    check(derived, { 0x4b007901, 0xb765489a, 0xbead49d9, 0x26f721d0, 0x65a429c1 });
+
+    printf("\n");
+}
+
+void validate_blake3()
+{
+    printf("BLAKE3 official test vectors (input: i %% 251):\n");
+    printf("\n");
+
+    // lengths which end one byte into a chunk, span several chunk pairs and
+    // need more than one level of parent nodes in the tree
+    struct Vector
+    {
+        size_t size;
+        BLAKE3 hash;
+    };
+
+    const Vector vectors [] =
+    {
+        { 1025, { 0xd00278ae, 0x47eb27b3, 0x4faecf67, 0xb4fe263f, 0x82d54129, 0x16c1ffd9, 0x7c8cb7fb, 0x814b8444 } },
+        { 2049, { 0x5f4d72f4, 0x0d7a5f82, 0xb15ca2b2, 0xe44b1de3, 0xc2ef86c4, 0x26c95c1a, 0xf0b68795, 0x22563030 } },
+        { 31744, { 0x62b6960e, 0x1a44bcc1, 0xeb1a611a, 0x8d6235b6, 0xb4b78f32, 0xe7abc4fb, 0x4c6cdcce, 0x94895c47 } },
+        { 102400, { 0xbc3e3d41, 0xa1146b06, 0x9abffad3, 0xc0d44860, 0xcf664390, 0xafce4d96, 0x61f7902e, 0x7943e085 } },
+    };
+
+    for (const Vector& vector : vectors)
+    {
+        Buffer buffer(vector.size);
+
+        for (size_t i = 0; i < vector.size; ++i)
+        {
+            buffer[i] = u8(i % 251);
+        }
+
+        BLAKE3 hash = mango::blake3(buffer);
+        check(hash, vector.hash);
+
+        // incremental hashing must agree with the one-shot hash for any split
+        const size_t pieces [] = { 1, 64, 1023, 1024, 1025, 4096 };
+
+        bool incremental = true;
+
+        for (size_t piece : pieces)
+        {
+            BLAKE3Context context;
+
+            for (size_t offset = 0; offset < vector.size; offset += piece)
+            {
+                context.update(ConstMemory(buffer.data() + offset, std::min(piece, vector.size - offset)));
+            }
+
+            incremental = incremental && context.final() == hash;
+        }
+
+        printf("  %6zu bytes, incremental: %s\n", vector.size, incremental ? "OK" : "FAILED");
+    }
+
+    printf("\n");
+}
+
+void validate_incremental(const Buffer& buffer)
+{
+    printf("Incremental hashing:\n");
+    printf("\n");
+
+    MD5Context md5;
+    SHA1Context sha1;
+    SHA2Context sha2;
+    XXHash64Context xxhash64;
+    XX3Hash128Context xx3hash128;
+    BLAKE3Context blake3;
+    CRC32Context crc32;
+
+    // feed the data in pieces which do not align with the 64 byte blocks
+    const size_t size = 16 * MB;
+    const size_t pieces[] = { 1, 63, 64, 65, 1000, 4093, 70000 };
+
+    for (size_t offset = 0, i = 0; offset < size; ++i)
+    {
+        size_t bytes = std::min(pieces[i % 7], size - offset);
+        ConstMemory memory(buffer.data() + offset, bytes);
+
+        md5.update(memory);
+        sha1.update(memory);
+        sha2.update(memory);
+        xxhash64.update(memory);
+        xx3hash128.update(memory);
+        blake3.update(memory);
+        crc32.update(memory);
+
+        offset += bytes;
+    }
+
+    ConstMemory memory(buffer.data(), size);
+
+    printf("  md5:        %s\n", md5.final() == mango::md5(memory) ? "OK" : "FAILED");
+    printf("  sha1:       %s\n", sha1.final() == mango::sha1(memory) ? "OK" : "FAILED");
+    printf("  sha2:       %s\n", sha2.final() == mango::sha2(memory) ? "OK" : "FAILED");
+    printf("  xxhash64:   %s\n", xxhash64.final() == mango::xxhash64(0, memory) ? "OK" : "FAILED");
+    printf("  xx3hash128: %s\n", xx3hash128.final() == mango::xx3hash128(0, memory) ? "OK" : "FAILED");
+    printf("  blake3:     %s\n", blake3.final() == mango::blake3(memory) ? "OK" : "FAILED");
+    printf("  crc32:      %s\n", crc32.final() == mango::crc32(0, memory) ? "OK" : "FAILED");
+    printf("\n");
+}
+
+void test_multibuffer(const Buffer& buffer)
+{
+    printf("Multi-buffer hashing (65536 messages):\n");
+    printf("\n");
+
+    // small messages of varying length
+    std::vector<ConstMemory> messages;
+
+    size_t offset = 0;
+    for (size_t i = 0; i < 65536; ++i)
+    {
+        size_t size = (i * 97) % 2000;
+        messages.emplace_back(buffer.data() + offset, size);
+        offset += size;
+    }
+
+    const size_t count = messages.size();
+
+    std::vector<MD5> md5(count);
+    std::vector<SHA1> sha1(count);
+    std::vector<SHA2> sha2(count);
+
+    u64 time0 = Time::us();
+    mango::md5(md5.data(), messages.data(), count);
+    u64 time1 = Time::us();
+    mango::sha1(sha1.data(), messages.data(), count);
+    u64 time2 = Time::us();
+    mango::sha2(sha2.data(), messages.data(), count);
+    u64 time3 = Time::us();
+
+    bool md5_success = true;
+    bool sha1_success = true;
+    bool sha2_success = true;
+
+    u64 md5_time = 0;
+    u64 sha1_time = 0;
+    u64 sha2_time = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        u64 time4 = Time::us();
+        MD5 a = mango::md5(messages[i]);
+        u64 time5 = Time::us();
+        SHA1 b = mango::sha1(messages[i]);
+        u64 time6 = Time::us();
+        SHA2 c = mango::sha2(messages[i]);
+        u64 time7 = Time::us();
+
+        md5_time += time5 - time4;
+        sha1_time += time6 - time5;
+        sha2_time += time7 - time6;
+
+        md5_success &= md5[i] == a;
+        sha1_success &= sha1[i] == b;
+        sha2_success &= sha2[i] == c;
+    }
+
+    printf("  md5:   %6d us (single: %6d us) %s\n", int(time1 - time0), int(md5_time), md5_success ? "" : "FAILED");
+    printf("  sha1:  %6d us (single: %6d us) %s\n", int(time2 - time1), int(sha1_time), sha1_success ? "" : "FAILED");
+    printf("  sha2:  %6d us (single: %6d us) %s\n", int(time3 - time2), int(sha2_time), sha2_success ? "" : "FAILED");
+    printf("\n");
 }
 
 void print(const Buffer& buffer, const char* name, u64 time0, u64 time1, u32 value, u32 correct)
@@ -169,6 +359,16 @@ void test_xx3hash128(const Buffer& buffer)
     print(buffer, "xx3hash128: ", time0, time1, u32(v[0]), 0x8d332372);
 }
 
+void test_blake3(const Buffer& buffer)
+{
+    u64 time0 = Time::us();
+
+    mango::BLAKE3 v = mango::blake3(buffer);
+    u64 time1 = Time::us();
+
+    print(buffer, "blake3:     ", time0, time1, v[0], 0xd5e4dbf3);
+}
+
 int main()
 {
     constexpr u64 size = 256 * MB;
@@ -182,6 +382,9 @@ int main()
 
     printf("%s\n", getPlatformInfo().c_str());
     validate(buffer);
+    validate_blake3();
+    validate_incremental(buffer);
+    test_multibuffer(buffer);
 
     test_md5(buffer);
     test_sha1(buffer);
@@ -190,4 +393,5 @@ int main()
     test_xxhash64(buffer);
     test_xx3hash64(buffer);
     test_xx3hash128(buffer);
+    test_blake3(buffer);
 }
@@ -0,0 +1,434 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <random>
+#include <mango/core/core.hpp>
+#include <mango/import3d/mesh.hpp>
+
+using namespace mango;
+using namespace mango::math;
+using namespace mango::import3d;
+
+// ----------------------------------------------------------------------------
+// helpers
+// ----------------------------------------------------------------------------
+
+IndexedMesh createTorus(int segments, int sides)
+{
+    Mesh mesh;
+
+    mesh.flags = Vertex::Position;
+
+    auto vertex = [&] (int i, int j)
+    {
+        float u = float(i % segments) / segments * 2.0f * pi;
+        float v = float(j % sides) / sides * 2.0f * pi;
+        float r = 1.0f + 0.05f * std::sin(u * 5.0f) * std::cos(v * 3.0f);
+
+        Vertex vertex;
+        vertex.position = float32x3((4.0f + r * std::cos(v)) * std::cos(u),
+                                    r * std::sin(v),
+                                    (4.0f + r * std::cos(v)) * std::sin(u));
+        return vertex;
+    };
+
+    for (int i = 0; i < segments; ++i)
+    {
+        for (int j = 0; j < sides; ++j)
+        {
+            Vertex v0 = vertex(i + 0, j + 0);
+            Vertex v1 = vertex(i + 1, j + 0);
+            Vertex v2 = vertex(i + 0, j + 1);
+            Vertex v3 = vertex(i + 1, j + 1);
+
+            mesh.triangles.push_back({ v0, v2, v1 });
+            mesh.triangles.push_back({ v2, v3, v1 });
+        }
+    }
+
+    // the positions are welded into a closed mesh
+    return IndexedMesh(mesh, 0);
+}
+
+float distance(const float32x3& point, const float32x3& p0, const float32x3& p1, const float32x3& p2)
+{
+    float32x3 n = normalize(cross(p1 - p0, p2 - p0));
+    float32x3 q = point - n * dot(point - p0, n);
+
+    // the projection is inside when it is on the same side of every edge
+    float32x3 c0 = cross(p1 - p0, q - p0);
+    float32x3 c1 = cross(p2 - p1, q - p1);
+    float32x3 c2 = cross(p0 - p2, q - p2);
+
+    if (dot(c0, n) >= 0.0f && dot(c1, n) >= 0.0f && dot(c2, n) >= 0.0f)
+    {
+        return std::abs(dot(point - p0, n));
+    }
+
+    float d0 = LineSegment(p0, p1).distance(point);
+    float d1 = LineSegment(p1, p2).distance(point);
+    float d2 = LineSegment(p2, p0).distance(point);
+    return std::min(d0, std::min(d1, d2));
+}
+
+void print_status(bool status)
+{
+    printLine("  status: {}\n", status ? "OK" : "FAILED");
+}
+
+// average cache miss ratio: transformed vertices per triangle with a FIFO cache
+float computeACMR(const std::vector<u32>& indices, size_t vertexCount, u32 cacheSize)
+{
+    std::vector<u32> timestamp(vertexCount, 0);
+    u32 time = cacheSize + 1;
+    size_t misses = 0;
+
+    for (u32 index : indices)
+    {
+        if (time - timestamp[index] > cacheSize)
+        {
+            timestamp[index] = time++;
+            ++misses;
+        }
+    }
+
+    return float(misses) / float(indices.size() / 3);
+}
+
+// sorted triangles with the smallest index rotated first to keep the winding
+std::vector<u64> sortTriangles(const std::vector<u32>& indices)
+{
+    std::vector<u64> triangles;
+
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        u32 a = indices[i + 0];
+        u32 b = indices[i + 1];
+        u32 c = indices[i + 2];
+
+        while (a > b || a > c)
+        {
+            u32 temp = a;
+            a = b;
+            b = c;
+            c = temp;
+        }
+
+        triangles.push_back((u64(a) << 42) | (u64(b) << 21) | c);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// ----------------------------------------------------------------------------
+// tests
+// ----------------------------------------------------------------------------
+
+void test_meshlets(const IndexedMesh& mesh, u32 maxVertices, u32 maxTriangles)
+{
+    printLine("meshlets: {} vertices, {} triangles", maxVertices, maxTriangles);
+
+    u64 time0 = Time::us();
+
+    MeshletMesh result = createMeshlets(mesh, maxVertices, maxTriangles);
+
+    u64 time1 = Time::us();
+
+    printLine("  time: {} us, meshlets: {}", time1 - time0, result.meshlets.size());
+
+    const float32x3* positions = mesh.getPositions();
+
+    // every triangle must be found in exactly one meshlet
+    std::vector<u32> output;
+
+    bool status = true;
+
+    for (const Meshlet& meshlet : result.meshlets)
+    {
+        status &= meshlet.vertexCount <= maxVertices;
+        status &= meshlet.triangleCount <= maxTriangles;
+        status &= meshlet.vertexOffset + meshlet.vertexCount <= result.vertices.size();
+        status &= meshlet.triangleOffset + meshlet.triangleCount * 3 <= result.triangles.size();
+
+        if (!status)
+        {
+            break;
+        }
+
+        const u32* vertices = result.vertices.data() + meshlet.vertexOffset;
+        const u8* triangles = result.triangles.data() + meshlet.triangleOffset;
+
+        for (u32 i = 0; i < meshlet.triangleCount * 3u; i += 3)
+        {
+            u8 a = triangles[i + 0];
+            u8 b = triangles[i + 1];
+            u8 c = triangles[i + 2];
+
+            status &= a < meshlet.vertexCount && b < meshlet.vertexCount && c < meshlet.vertexCount;
+
+            if (status)
+            {
+                output.push_back(vertices[a]);
+                output.push_back(vertices[b]);
+                output.push_back(vertices[c]);
+
+                // the bounding sphere contains the triangles
+                for (u8 index : { a, b, c })
+                {
+                    status &= length(positions[vertices[index]] - meshlet.center) <= meshlet.radius * 1.001f + 1e-5f;
+                }
+            }
+        }
+    }
+
+    status &= sortTriangles(mesh.indices) == sortTriangles(output);
+
+    print_status(status);
+}
+
+void test_lods(const IndexedMesh& mesh, int levels, float ratio, float targetError)
+{
+    printLine("lods: {} levels, ratio: {}, error: {}", levels, ratio, targetError);
+
+    u64 time0 = Time::us();
+
+    std::vector<MeshLOD> lods = createLODs(mesh, levels, ratio, targetError);
+
+    u64 time1 = Time::us();
+
+    printLine("  time: {} us", time1 - time0);
+
+    const float32x3* positions = mesh.getPositions();
+    const size_t vertexCount = mesh.getVertexCount();
+    const float extent = length(mesh.boundingBox.size());
+
+    // the levels stop when the error limit prevents any further reduction
+    bool status = !lods.empty() && lods.size() <= size_t(levels);
+
+    size_t previous = mesh.indices.size() / 3;
+    float previousError = 0.0f;
+
+    for (const MeshLOD& lod : lods)
+    {
+        const size_t triangles = lod.indices.size() / 3;
+        const size_t target = size_t(previous * ratio);
+
+        // distance of the original vertices to the simplified surface
+        float maxDistance = 0.0f;
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            float d = std::numeric_limits<float>::max();
+
+            for (size_t j = 0; j < lod.indices.size(); j += 3)
+            {
+                d = std::min(d, distance(positions[i],
+                                         positions[lod.indices[j + 0]],
+                                         positions[lod.indices[j + 1]],
+                                         positions[lod.indices[j + 2]]));
+            }
+
+            maxDistance = std::max(maxDistance, d);
+        }
+
+        printLine("  triangles: {:6} (target: {:6}), error: {:.4f}, distance: {:.4f}",
+            triangles, target, lod.error, maxDistance / extent);
+
+        status &= lod.indices.size() % 3 == 0;
+        status &= lod.primitives.size() == mesh.primitives.size();
+
+        for (u32 index : lod.indices)
+        {
+            status &= index < vertexCount;
+        }
+
+        // the level is reduced to the target unless the error limit is reached first
+        status &= triangles < previous;
+        status &= triangles <= target || lod.error > targetError * 0.5f;
+
+        // the error is within the limit and grows with the level
+        status &= lod.error <= targetError && lod.error >= previousError;
+
+        // the quadric error measures the distance to the planes of the original
+        // triangles, which only estimates the distance to the surface
+        status &= maxDistance <= targetError * 4.0f * extent;
+
+        previous = triangles;
+        previousError = lod.error;
+    }
+
+    print_status(status);
+}
+
+void test_vertexCache(int width, int height, bool shuffle)
+{
+    printLine("vertex cache: {} x {} grid, {}", width, height, shuffle ? "shuffled" : "row order");
+
+    const u32 cacheSize = 16;
+    const size_t vertexCount = size_t(width + 1) * (height + 1);
+
+    std::vector<u32> indices;
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            u32 v0 = u32(y * (width + 1) + x);
+            u32 v1 = v0 + 1;
+            u32 v2 = v0 + width + 1;
+            u32 v3 = v2 + 1;
+
+            indices.insert(indices.end(), { v0, v2, v1, v2, v3, v1 });
+        }
+    }
+
+    if (shuffle)
+    {
+        std::mt19937 mt(0x12345678);
+
+        for (size_t i = indices.size() / 3 - 1; i > 0; --i)
+        {
+            size_t j = mt() % (i + 1);
+            std::swap_ranges(indices.begin() + i * 3, indices.begin() + i * 3 + 3, indices.begin() + j * 3);
+        }
+    }
+
+    std::vector<u32> result = indices;
+
+    u64 time0 = Time::us();
+
+    optimizeVertexCache(result.data(), result.size(), vertexCount, cacheSize);
+
+    u64 time1 = Time::us();
+
+    float before = computeACMR(indices, vertexCount, cacheSize);
+    float after = computeACMR(result, vertexCount, cacheSize);
+
+    printLine("  time: {} us, ACMR: {:.3f} -> {:.3f}", time1 - time0, before, after);
+
+    // the output triangles are a permutation of the input triangles
+    bool status = sortTriangles(indices) == sortTriangles(result);
+
+    // a regular grid needs at least 0.5 vertices per triangle; tipsify gets
+    // well below the one vertex per triangle of the row order
+    status &= after < before && after >= 0.5f && after < 0.8f;
+
+    print_status(status);
+}
+
+void test_meshopt()
+{
+    printLine("meshopt: decode known streams");
+
+    bool status = true;
+
+    // triangle codec stream from the meshoptimizer test suite
+    const u8 triangleData[] =
+    {
+        0xe0, 0xf0, 0x10, 0xfe, 0xff, 0xf0, 0x0c, 0xff, 0x02, 0x02, 0x02, 0x00, 0x76, 0x87, 0x56, 0x67,
+        0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00,
+    };
+
+    const u32 triangleExpected[] = { 0, 1, 2, 2, 1, 3, 4, 6, 5, 7, 8, 9 };
+
+    // index sequence codec stream from the meshoptimizer test suite
+    const u8 sequenceData[] =
+    {
+        0xd1, 0x00, 0x04, 0xcd, 0x01, 0x04, 0x07, 0x98, 0x1f, 0x00, 0x00, 0x00, 0x00,
+    };
+
+    const u32 sequenceExpected[] = { 0, 1, 51, 2, 49, 1000 };
+
+    // vertex codec stream; 16 vertices of four u16 with zero, 2, 4 and 8 bit groups
+    const u8 vertexData[] =
+    {
+        0xa0, 0x02, 0x06, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x03, 0x00, 0x01, 0x05, 0x09,
+        0x0d, 0x11, 0x15, 0x19, 0x1d, 0x21, 0x25, 0x29, 0x2d, 0x31, 0x35, 0x39, 0x00, 0x00, 0x00, 0x01,
+        0x2a, 0xaa, 0xaa, 0xaa, 0x01, 0x2a, 0xaa, 0xaa, 0xaa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x64, 0x00, 0xe8, 0x03, 0x07, 0x00, 0x00, 0x00,
+    };
+
+    u16 vertexExpected[16][4];
+
+    for (int i = 0; i < 16; ++i)
+    {
+        vertexExpected[i][0] = u16(100 + i * 3);
+        vertexExpected[i][1] = u16(1000 - i * i);
+        vertexExpected[i][2] = 7;
+        vertexExpected[i][3] = u16(i * 257);
+    }
+
+    try
+    {
+        u32 triangles32[12];
+        u16 triangles16[12];
+        decodeMeshoptTriangles(triangles32, 12, 4, ConstMemory(triangleData, sizeof(triangleData)));
+        decodeMeshoptTriangles(triangles16, 12, 2, ConstMemory(triangleData, sizeof(triangleData)));
+
+        u32 sequence[6];
+        decodeMeshoptIndices(sequence, 6, 4, ConstMemory(sequenceData, sizeof(sequenceData)));
+
+        u16 vertices[16][4];
+        decodeMeshoptVertices(vertices, 16, 8, ConstMemory(vertexData, sizeof(vertexData)));
+
+        for (int i = 0; i < 12; ++i)
+        {
+            status &= triangles32[i] == triangleExpected[i];
+            status &= triangles16[i] == triangleExpected[i];
+        }
+
+        status &= !std::memcmp(sequence, sequenceExpected, sizeof(sequence));
+        status &= !std::memcmp(vertices, vertexExpected, sizeof(vertices));
+    }
+    catch (const Exception& e)
+    {
+        printLine("  {}", e.what());
+        status = false;
+    }
+
+    // truncated streams are rejected
+    for (size_t size : { size_t(4), sizeof(triangleData) - 2 })
+    {
+        try
+        {
+            u32 triangles[12];
+            decodeMeshoptTriangles(triangles, 12, 4, ConstMemory(triangleData, size));
+            status = false;
+        }
+        catch (const Exception&)
+        {
+        }
+    }
+
+    try
+    {
+        u16 vertices[16][4];
+        decodeMeshoptVertices(vertices, 16, 8, ConstMemory(vertexData, sizeof(vertexData) - 40));
+        status = false;
+    }
+    catch (const Exception&)
+    {
+    }
+
+    print_status(status);
+}
+
+int main()
+{
+    printLine(getPlatformInfo());
+
+    IndexedMesh mesh = createTorus(96, 48);
+
+    printLine("torus: {} vertices, {} triangles\n", mesh.getVertexCount(), mesh.indices.size() / 3);
+
+    test_meshlets(mesh, 64, 124);
+    test_meshlets(mesh, 128, 255);
+    test_lods(mesh, 4, 0.5f, 0.05f);
+    test_lods(mesh, 6, 0.25f, 0.01f);
+    test_vertexCache(200, 200, false);
+    test_vertexCache(200, 200, true);
+    test_meshopt();
+}
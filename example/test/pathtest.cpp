@@ -404,6 +404,73 @@ void test32()
     print(path3, "data/fake/random.snitch/");
 }
 
+// WinZip AES encrypted container (password: "secret")
+
+void test33()
+{
+    Path path("data/aes.zip/", "secret");
+    print(path, "data/aes.zip/");
+
+    // AES-128, AES-256 and AES-192 with deflate; stored and empty entries
+    File file1(path, "aes128.txt");
+    print(file1, "data/aes.zip/aes128.txt", 0xb514d8bb);
+
+    File file2(path, "aes256.txt");
+    print(file2, "data/aes.zip/aes256.txt", 0xe8c774eb);
+
+    File file3(path, "stored.bin");
+    print(file3, "data/aes.zip/stored.bin", 0xf37a2443);
+
+    File file4(path, "folder/aes192.txt");
+    print(file4, "data/aes.zip/folder/aes192.txt", 0x1c50cf1e);
+
+    File file5(path, "empty.txt");
+    print(file5, "data/aes.zip/empty.txt", 0x00000000);
+}
+
+void test34()
+{
+    // incorrect password and corrupted data must be rejected
+
+    auto expect_failure = [] (const char* name, auto func)
+    {
+        bool status = false;
+
+        try
+        {
+            func();
+        }
+        catch (const Exception& e)
+        {
+            printf("    %s\n", e.what());
+            status = true;
+        }
+
+        g_count_failed += !status;
+        printf("[exception]   %s [%s]\n", name, status ? "PASSED" : "FAILED");
+    };
+
+    expect_failure("incorrect password", []
+    {
+        Path path("data/aes.zip/", "wrong");
+        File entry(path, "aes256.txt");
+    });
+
+    File file("data/aes.zip");
+
+    // flip one bit in the encrypted data of aes128.txt; the password is still correct
+    Buffer buffer(file);
+    buffer[100] ^= 1;
+
+    expect_failure("authentication code", [&]
+    {
+        Path path(buffer, ".zip", "secret");
+        File entry(path, "aes128.txt");
+    });
+
+    printf("\n");
+}
+
 // -----------------------------------------------------------------------------------
 // main()
 // -----------------------------------------------------------------------------------
@@ -450,6 +517,8 @@ int main(int argc, char *argv[])
     MAKE_TEST(30);
     MAKE_TEST(31);
     MAKE_TEST(32);
+    MAKE_TEST(33);
+    MAKE_TEST(34);
 
     printLine();
     if (g_count_failed)
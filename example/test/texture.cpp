@@ -0,0 +1,159 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/mango.hpp>
+
+using namespace mango;
+using namespace mango::image;
+
+// ----------------------------------------------------------------------
+// helpers
+// ----------------------------------------------------------------------
+
+void print_status(bool status)
+{
+    printLine("  status: {}\n", status ? "OK" : "FAILED");
+}
+
+double psnr(const Surface& a, const Surface& b, int channels)
+{
+    double sum = 0.0;
+
+    for (int y = 0; y < a.height; ++y)
+    {
+        const u8* s = a.address(0, y);
+        const u8* d = b.address(0, y);
+
+        for (int x = 0; x < a.width; ++x)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                double delta = double(s[x * 4 + c]) - double(d[x * 4 + c]);
+                sum += delta * delta;
+            }
+        }
+    }
+
+    double mse = sum / (double(a.width) * a.height * channels);
+    if (mse == 0.0)
+    {
+        return 99.0;
+    }
+
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+Bitmap createImage(int width, int height)
+{
+    Bitmap bitmap(width, height, Format(32, Format::UNORM, Format::RGBA, 8, 8, 8, 8));
+
+    for (int y = 0; y < height; ++y)
+    {
+        u8* scan = bitmap.address(0, y);
+
+        for (int x = 0; x < width; ++x)
+        {
+            scan[x * 4 + 0] = u8(x * 255 / (width - 1));
+            scan[x * 4 + 1] = u8(y * 255 / (height - 1));
+            scan[x * 4 + 2] = u8(128 + 64 * std::sin(x * 0.2f + y * 0.1f));
+            scan[x * 4 + 3] = u8((x + y) * 255 / (width + height - 2));
+        }
+    }
+
+    return bitmap;
+}
+
+// ----------------------------------------------------------------------
+// tests
+// ----------------------------------------------------------------------
+
+void test_roundtrip(const Surface& source, const char* extension, u32 compression, int channels,
+                    bool supercompress, double threshold)
+{
+    printLine("{}: compression: {:#x}, supercompress: {}", extension, compression, supercompress);
+
+    ImageEncodeOptions options;
+    options.texture = compression;
+    options.supercompress = supercompress;
+    options.levels = 0;
+
+    MemoryStream stream;
+
+    ImageEncodeStatus encodeStatus = source.save(stream, extension, options);
+    if (!encodeStatus)
+    {
+        printLine(Print::Error, "  encode: {}", encodeStatus.info);
+        print_status(false);
+        return;
+    }
+
+    ImageDecoder decoder(stream, extension);
+    ImageHeader header = decoder.header();
+
+    // complete mipmap chain down to 1x1
+    int levels = 1;
+    for (int size = std::max(source.width, source.height); size > 1; size >>= 1)
+    {
+        ++levels;
+    }
+
+    bool status = header.success &&
+                  header.width == source.width &&
+                  header.height == source.height &&
+                  header.levels == levels &&
+                  header.compression == compression;
+
+    Bitmap decoded(source.width, source.height, source.format);
+    ImageDecodeStatus decodeStatus = decoder.decode(decoded, ImageDecodeOptions(), 0, 0, 0);
+    if (!decodeStatus)
+    {
+        printLine(Print::Error, "  decode: {}", decodeStatus.info);
+        status = false;
+    }
+
+    double db = psnr(source, decoded, channels);
+    printLine("  size: {} bytes, levels: {}, psnr: {:.2f} dB", stream.size(), header.levels, db);
+
+    status = status && db >= threshold;
+    print_status(status);
+}
+
+void test_unsupported(const Surface& source, const char* extension, u32 compression)
+{
+    printLine("{}: unsupported compression: {:#x}", extension, compression);
+
+    ImageEncodeOptions options;
+    options.texture = compression;
+
+    MemoryStream stream;
+
+    ImageEncodeStatus status = source.save(stream, extension, options);
+    printLine("  error: {}", status.info);
+
+    // the encoder must report the failure and not write a partial file
+    print_status(!status && !status.info.empty() && stream.size() == 0);
+}
+
+int main()
+{
+    Bitmap bitmap = createImage(61, 47);
+
+    for (const char* extension : { ".dds", ".ktx2" })
+    {
+        test_roundtrip(bitmap, extension, TextureCompression::NONE, 4, false, 99.0);
+        test_roundtrip(bitmap, extension, TextureCompression::BC1_UNORM, 3, false, 30.0);
+        test_roundtrip(bitmap, extension, TextureCompression::BC3_UNORM, 4, false, 30.0);
+        test_roundtrip(bitmap, extension, TextureCompression::BC5_UNORM, 2, false, 30.0);
+        test_roundtrip(bitmap, extension, TextureCompression::BC7_UNORM, 4, false, 30.0);
+    }
+
+    // zstd supercompression is specific to the KTX2 container
+    test_roundtrip(bitmap, ".ktx2", TextureCompression::NONE, 4, true, 99.0);
+    test_roundtrip(bitmap, ".ktx2", TextureCompression::BC3_UNORM, 4, true, 30.0);
+
+    // no encoder for ETC2; ETC1 can be encoded but has no DXGI format
+    test_unsupported(bitmap, ".dds", TextureCompression::ETC2_RGB);
+    test_unsupported(bitmap, ".dds", TextureCompression::ETC1_RGB);
+    test_unsupported(bitmap, ".ktx2", TextureCompression::ETC2_RGB);
+}
@@ -0,0 +1,150 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <unordered_map>
+#include <mango/core/core.hpp>
+#include <mango/import3d/mesh.hpp>
+
+using namespace mango;
+using namespace mango::import3d;
+
+// ----------------------------------------------------------------------------
+// reference: std::unordered_map
+// ----------------------------------------------------------------------------
+
+struct VertexEqual
+{
+    bool operator () (const Vertex& a, const Vertex& b) const
+    {
+        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+struct VertexHash
+{
+    std::size_t operator () (const Vertex& v) const
+    {
+        u32 temp[3];
+        std::memcpy(temp, v.position.data(), 12);
+        return (temp[0] ^ temp[1]) | (temp[2] << 16);
+    }
+};
+
+size_t weld_map(u32* remap, const Vertex* vertices, size_t count)
+{
+    std::unordered_map<Vertex, u32, VertexHash, VertexEqual> unique;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto it = unique.find(vertices[i]);
+        if (it != unique.end())
+        {
+            remap[i] = it->second;
+        }
+        else
+        {
+            u32 index = u32(unique.size());
+            unique[vertices[i]] = index;
+            remap[i] = index;
+        }
+    }
+
+    return unique.size();
+}
+
+// ----------------------------------------------------------------------------
+// test
+// ----------------------------------------------------------------------------
+
+Mesh createGrid(int width, int height, float jitter)
+{
+    Mesh mesh;
+
+    mesh.flags = Vertex::Position | Vertex::Normal | Vertex::Texcoord;
+
+    u32 seed = 0x12345678;
+
+    auto vertex = [&] (int x, int y)
+    {
+        Vertex v;
+
+        seed = seed * 1664525 + 1013904223;
+        float noise = (float(seed >> 8) / float(1 << 24) - 0.5f) * jitter;
+
+        v.position = float32x3(float(x) + noise, float(y), 0.0f);
+        v.normal = float32x3(0.0f, 0.0f, 1.0f);
+        v.texcoord = float32x2(float(x) / width, float(y) / height);
+
+        return v;
+    };
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            Vertex v0 = vertex(x + 0, y + 0);
+            Vertex v1 = vertex(x + 1, y + 0);
+            Vertex v2 = vertex(x + 0, y + 1);
+            Vertex v3 = vertex(x + 1, y + 1);
+
+            mesh.triangles.push_back({ v0, v1, v2 });
+            mesh.triangles.push_back({ v2, v1, v3 });
+        }
+    }
+
+    return mesh;
+}
+
+void test(int width, int height)
+{
+    Mesh mesh = createGrid(width, height, 0.0f);
+
+    const size_t count = mesh.triangles.size() * 3;
+    const Vertex* vertices = mesh.triangles[0].vertex;
+
+    std::vector<u32> remap0(count);
+    std::vector<u32> remap1(count);
+
+    u64 time0 = Time::us();
+
+    size_t unique0 = weld_map(remap0.data(), vertices, count);
+
+    u64 time1 = Time::us();
+
+    size_t unique1 = weldVertices(remap1.data(), vertices, count, sizeof(Vertex));
+
+    u64 time2 = Time::us();
+
+    bool status = unique0 == unique1 && remap0 == remap1;
+    status &= unique1 == size_t((width + 1) * (height + 1));
+
+    printLine("triangles: {}, vertices: {}, unique: {}", mesh.triangles.size(), count, unique1);
+    printLine("  unordered_map: {:7} us", time1 - time0);
+    printLine("  weldVertices:  {:7} us", time2 - time1);
+
+    // the jitter is smaller than the epsilon
+
+    mesh = createGrid(width, height, 0.0001f);
+
+    u64 time3 = Time::us();
+
+    size_t unique2 = weldVertices(remap1.data(), reinterpret_cast<const float*>(mesh.triangles[0].vertex),
+                                  count, sizeof(Vertex), 0.01f);
+
+    u64 time4 = Time::us();
+
+    printLine("  epsilon:       {:7} us", time4 - time3);
+
+    status &= unique1 == unique2;
+    printLine("  status: {}\n", status ? "OK" : "FAILED");
+}
+
+int main()
+{
+    printLine(getPlatformInfo());
+
+    test(100, 100);
+    test(300, 300);
+    test(1000, 1000);
+}
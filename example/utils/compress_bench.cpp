@@ -0,0 +1,499 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <algorithm>
+#include <atomic>
+#include <mango/mango.hpp>
+
+using namespace mango;
+using namespace mango::filesystem;
+
+/*
+    Compression benchmark over a corpus folder.
+
+    Every registered Compressor is run at the selected levels over all files in the corpus.
+    Each file is compressed as an individual object. The single threaded pass measures the
+    throughput of the compressor; the multithreaded pass processes the files concurrently in
+    the ThreadPool. The "/parallel" rows split each file into chunks with parallel::compress().
+    The results are printed and optionally written as CSV and JSON.
+*/
+
+namespace
+{
+
+    constexpr u64 MB = 1 << 20;
+
+    struct Options
+    {
+        std::vector<std::string> methods;
+        std::vector<int> levels { 1, 6, 10 };
+        std::string csv;
+        std::string json;
+        bool multithread = true;
+    };
+
+    struct Corpus
+    {
+        std::vector<std::unique_ptr<File>> files;
+        u64 bytes = 0;
+    };
+
+    struct Result
+    {
+        std::string method;
+        int level;
+        u64 uncompressed = 0;
+        u64 compressed = 0;
+        double compress_st = 0; // MB/s
+        double decompress_st = 0;
+        double compress_mt = 0;
+        double decompress_mt = 0;
+        bool verified = true;
+
+        double ratio() const
+        {
+            return compressed ? double(uncompressed) / double(compressed) : 0.0;
+        }
+    };
+
+    double throughput(u64 bytes, u64 us)
+    {
+        return bytes / double(MB) / (std::max(u64(1), us) / 1000000.0);
+    }
+
+    void enumerate(const Path& path, Corpus& corpus)
+    {
+        for (auto& node : path)
+        {
+            if (node.isContainer())
+            {
+                continue;
+            }
+
+            if (node.isDirectory())
+            {
+                enumerate(Path(path, node.name), corpus);
+            }
+            else if (node.size > 0)
+            {
+                corpus.files.emplace_back(std::make_unique<File>(path, node.name));
+                corpus.bytes += node.size;
+            }
+        }
+    }
+
+    std::vector<std::string> split(const std::string& text)
+    {
+        std::vector<std::string> result;
+
+        size_t start = 0;
+        while (start <= text.length())
+        {
+            size_t end = text.find(',', start);
+            if (end == std::string::npos)
+            {
+                end = text.length();
+            }
+
+            if (end > start)
+            {
+                result.push_back(text.substr(start, end - start));
+            }
+
+            start = end + 1;
+        }
+
+        return result;
+    }
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------
+// benchmark
+// ------------------------------------------------------------------------------------------
+
+Result benchmark(const Compressor& compressor, int level, const Corpus& corpus, bool multithread)
+{
+    Result result;
+
+    result.method = compressor.name;
+    result.level = level;
+    result.uncompressed = corpus.bytes;
+
+    const size_t count = corpus.files.size();
+
+    std::vector<std::unique_ptr<Buffer>> compressed(count);
+    std::vector<size_t> compressed_size(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t bound = compressor.bound(corpus.files[i]->size());
+        compressed[i] = std::make_unique<Buffer>(bound);
+    }
+
+    // single threaded
+
+    u64 time0 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        CompressionStatus status = compressor.compress(*compressed[i], *corpus.files[i], level);
+        compressed_size[i] = status.size;
+        result.verified &= status.success;
+    }
+
+    u64 time1 = Time::us();
+
+    Buffer output(corpus.files.empty() ? 0 : std::max_element(corpus.files.begin(), corpus.files.end(),
+        [] (const std::unique_ptr<File>& a, const std::unique_ptr<File>& b)
+        {
+            return a->size() < b->size();
+        })->get()->size());
+
+    u64 decompress_time = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const File& file = *corpus.files[i];
+        Memory dest(output.data(), size_t(file.size()));
+
+        u64 time2 = Time::us();
+        CompressionStatus status = compressor.decompress(dest, ConstMemory(*compressed[i], compressed_size[i]));
+        decompress_time += Time::us() - time2;
+
+        // verify outside of the timing
+        result.verified &= status.success && !std::memcmp(dest.address, file.data(), dest.size);
+        result.compressed += compressed_size[i];
+    }
+
+    result.compress_st = throughput(corpus.bytes, time1 - time0);
+    result.decompress_st = throughput(corpus.bytes, decompress_time);
+
+    if (!multithread)
+    {
+        return result;
+    }
+
+    // multithreaded: the files are processed concurrently
+
+    std::atomic<bool> verified { true };
+    std::vector<std::unique_ptr<Buffer>> decompressed(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        decompressed[i] = std::make_unique<Buffer>(size_t(corpus.files[i]->size()));
+    }
+
+    time0 = Time::us();
+
+    ConcurrentQueue q;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        q.enqueue([&, i]
+        {
+            CompressionStatus status = compressor.compress(*compressed[i], *corpus.files[i], level);
+            compressed_size[i] = status.size;
+            if (!status)
+            {
+                verified = false;
+            }
+        });
+    }
+
+    q.wait();
+
+    time1 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        q.enqueue([&, i]
+        {
+            CompressionStatus status = compressor.decompress(*decompressed[i], ConstMemory(*compressed[i], compressed_size[i]));
+            if (!status)
+            {
+                verified = false;
+            }
+        });
+    }
+
+    q.wait();
+
+    u64 time2 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const File& file = *corpus.files[i];
+        if (std::memcmp(decompressed[i]->data(), file.data(), size_t(file.size())))
+        {
+            verified = false;
+        }
+    }
+
+    result.compress_mt = throughput(corpus.bytes, time1 - time0);
+    result.decompress_mt = throughput(corpus.bytes, time2 - time1);
+    result.verified &= verified;
+
+    return result;
+}
+
+// parallel::compress splits every file into chunks which are processed in the ThreadPool;
+// the files are processed one after another so the throughput is reported in the MT columns
+Result benchmark_parallel(const Compressor& compressor, int level, const Corpus& corpus)
+{
+    Result result;
+
+    result.method = compressor.name + "/parallel";
+    result.level = level;
+    result.uncompressed = corpus.bytes;
+
+    const size_t count = corpus.files.size();
+
+    std::vector<std::unique_ptr<Buffer>> compressed(count);
+    std::vector<size_t> compressed_size(count);
+    std::vector<std::unique_ptr<Buffer>> decompressed(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t size = size_t(corpus.files[i]->size());
+        compressed[i] = std::make_unique<Buffer>(parallel::bound(compressor, size));
+        decompressed[i] = std::make_unique<Buffer>(size);
+    }
+
+    u64 time0 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        CompressionStatus status = parallel::compress(compressor, *compressed[i], *corpus.files[i], level);
+        compressed_size[i] = status.size;
+        result.verified &= status.success;
+    }
+
+    u64 time1 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        CompressionStatus status = parallel::decompress(compressor, *decompressed[i], ConstMemory(*compressed[i], compressed_size[i]));
+        result.verified &= status.success;
+    }
+
+    u64 time2 = Time::us();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const File& file = *corpus.files[i];
+        result.verified &= !std::memcmp(decompressed[i]->data(), file.data(), size_t(file.size()));
+        result.compressed += compressed_size[i];
+    }
+
+    result.compress_mt = throughput(corpus.bytes, time1 - time0);
+    result.decompress_mt = throughput(corpus.bytes, time2 - time1);
+
+    return result;
+}
+
+// ------------------------------------------------------------------------------------------
+// output
+// ------------------------------------------------------------------------------------------
+
+void writeCSV(const std::string& filename, const std::vector<Result>& results)
+{
+    std::string text = "method,level,uncompressed,compressed,ratio,compress_mbs,decompress_mbs,"
+                       "compress_mt_mbs,decompress_mt_mbs,verified\n";
+
+    for (const Result& r : results)
+    {
+        text += fmt::format("{},{},{},{},{:.4f},{:.2f},{:.2f},{:.2f},{:.2f},{}\n",
+            r.method, r.level, r.uncompressed, r.compressed, r.ratio(),
+            r.compress_st, r.decompress_st, r.compress_mt, r.decompress_mt, r.verified);
+    }
+
+    OutputFileStream output(filename);
+    output.write(text.data(), text.length());
+}
+
+void writeJSON(const std::string& filename, const std::vector<Result>& results)
+{
+    std::string text = "[\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+
+        text += fmt::format("  {{ \"method\": \"{}\", \"level\": {}, \"uncompressed\": {}, \"compressed\": {}, "
+                            "\"ratio\": {:.4f}, \"compress_mbs\": {:.2f}, \"decompress_mbs\": {:.2f}, "
+                            "\"compress_mt_mbs\": {:.2f}, \"decompress_mt_mbs\": {:.2f}, \"verified\": {} }}{}\n",
+            r.method, r.level, r.uncompressed, r.compressed, r.ratio(),
+            r.compress_st, r.decompress_st, r.compress_mt, r.decompress_mt, r.verified,
+            i + 1 < results.size() ? "," : "");
+    }
+
+    text += "]\n";
+
+    OutputFileStream output(filename);
+    output.write(text.data(), text.length());
+}
+
+// ------------------------------------------------------------------------------------------
+// main
+// ------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::string program_name = removePath(argv[0]);
+
+        printf("\n");
+        printf("Usage: %s [corpus folder] [options]\n", program_name.c_str());
+        printf("  --methods a,b,c    compressors to benchmark (default: all)\n");
+        printf("  --levels 1,6,10    compression levels, \"all\" for 0..10 (default: 1,6,10)\n");
+        printf("  --csv file.csv     write results as CSV\n");
+        printf("  --json file.json   write results as JSON\n");
+        printf("  --st               single threaded only\n");
+        printf("\n");
+
+        printf("Compression methods: ");
+        const char* separator = "";
+        for (auto compressor : getCompressors())
+        {
+            printf("%s%s", separator, compressor.name.c_str());
+            separator = ", ";
+        }
+        printf("\n\n");
+
+        return 0;
+    }
+
+    Options options;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string c = argv[i];
+        bool next = i + 1 < argc;
+
+        if (c == "--methods" && next)
+        {
+            options.methods = split(argv[++i]);
+        }
+        else if (c == "--levels" && next)
+        {
+            std::string levels = argv[++i];
+            options.levels.clear();
+
+            if (levels == "all")
+            {
+                for (int level = 0; level <= 10; ++level)
+                {
+                    options.levels.push_back(level);
+                }
+            }
+            else
+            {
+                for (auto level : split(levels))
+                {
+                    options.levels.push_back(std::atoi(level.c_str()));
+                }
+            }
+        }
+        else if (c == "--csv" && next)
+        {
+            options.csv = argv[++i];
+        }
+        else if (c == "--json" && next)
+        {
+            options.json = argv[++i];
+        }
+        else if (c == "--st")
+        {
+            options.multithread = false;
+        }
+        else
+        {
+            printf("[WARNING] Unknown option: %s\n", c.c_str());
+        }
+    }
+
+    std::vector<Compressor> compressors;
+
+    try
+    {
+        if (options.methods.empty())
+        {
+            compressors = getCompressors();
+        }
+        else
+        {
+            for (auto& name : options.methods)
+            {
+                compressors.push_back(getCompressor(name));
+            }
+        }
+    }
+    catch (Exception& e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+
+    std::string folder = argv[1];
+    if (!folder.empty() && folder.back() != '/')
+    {
+        folder += '/';
+    }
+
+    Corpus corpus;
+    enumerate(Path(folder), corpus);
+
+    if (corpus.files.empty())
+    {
+        printf("[WARNING] Did not find anything to compress.\n");
+        return 0;
+    }
+
+    printf("Corpus: %zu files (%.1f MB), %d threads\n\n", corpus.files.size(),
+        corpus.bytes / double(MB), ThreadPool::getInstance().size());
+
+    printf("method                   level    ratio   comp MB/s  decomp MB/s   comp MT MB/s  decomp MT MB/s\n");
+    printf("--------------------------------------------------------------------------------------------------\n");
+
+    std::vector<Result> results;
+
+    for (const Compressor& compressor : compressors)
+    {
+        for (int level : options.levels)
+        {
+            std::vector<Result> rows;
+
+            rows.push_back(benchmark(compressor, level, corpus, options.multithread));
+
+            if (options.multithread)
+            {
+                rows.push_back(benchmark_parallel(compressor, level, corpus));
+            }
+
+            for (const Result& result : rows)
+            {
+                printf("%-23s %6d %8.3f %11.1f %12.1f %14.1f %15.1f %s\n",
+                    result.method.c_str(), result.level, result.ratio(),
+                    result.compress_st, result.decompress_st,
+                    result.compress_mt, result.decompress_mt,
+                    result.verified ? "" : "FAILED");
+                fflush(stdout);
+
+                results.push_back(result);
+            }
+        }
+    }
+
+    if (!options.csv.empty())
+    {
+        writeCSV(options.csv, results);
+    }
+
+    if (!options.json.empty())
+    {
+        writeJSON(options.json, results);
+    }
+}
@@ -28,6 +28,12 @@ namespace
 
     constexpr size_t store_threshold_default = 95; // percent
 
+    // dictionary compression (zstd, lz4)
+    constexpr u64 dictionary_file_max_size = 16 * KB;
+    constexpr u64 dictionary_sample_max_size = 16 * MB;
+    constexpr size_t dictionary_capacity = 112 * KB;
+    constexpr u32 dictionary_flag = 0x100;
+
 } // namespace
 
 /*
@@ -157,6 +163,7 @@ struct Block
     u64 compressed;
     u64 uncompressed;
     u32 method;
+    bool dictionary { false };
 
     void append(const Segment& segment)
     {
@@ -201,10 +208,39 @@ struct BlockManager
     }
 };
 
-void compress(const std::string& folder, const std::string& archive, const std::string& compression, int level, size_t store_threshold)
+std::shared_ptr<CompressionDictionary> createDictionary(const Compressor& compressor, ConstMemory memory, int level)
+{
+    switch (compressor.method)
+    {
+        case Compressor::ZSTD:
+            return zstd::createDictionary(memory, level);
+        case Compressor::LZ4:
+            return lz4::createDictionary(memory, level);
+        default:
+            return nullptr;
+    }
+}
+
+CompressionStatus compress(const Compressor& compressor, Memory dest, ConstMemory source, const CompressionDictionary& dictionary)
+{
+    if (compressor.method == Compressor::ZSTD)
+    {
+        return zstd::compress(dest, source, dictionary);
+    }
+
+    return lz4::compress(dest, source, dictionary);
+}
+
+void compress(const std::string& folder, const std::string& archive, const std::string& compression, int level, size_t store_threshold, bool use_dictionary)
 {
     Compressor compressor = getCompressor(compression);
 
+    if (use_dictionary && compressor.method != Compressor::ZSTD && compressor.method != Compressor::LZ4)
+    {
+        printf("[WARNING] Dictionary is supported only with zstd and lz4.\n");
+        use_dictionary = false;
+    }
+
     printf("Scanning files to compress...\n");
 
     State state;
@@ -233,6 +269,50 @@ void compress(const std::string& folder, const std::string& archive, const std::
             return a.size > b.size;
         });
 
+    // train a shared dictionary from the smallest files; they are compressed
+    // individually with the dictionary so that they can be decoded without
+    // decompressing the neighbouring files
+
+    Buffer dictionary;
+    std::shared_ptr<CompressionDictionary> dictionary_object;
+
+    if (use_dictionary)
+    {
+        Buffer samples;
+        std::vector<ConstMemory> sample_memory;
+        std::vector<size_t> sample_sizes;
+
+        for (auto it = state.files.rbegin(); it != state.files.rend(); ++it)
+        {
+            if (it->size > dictionary_file_max_size || samples.size() + it->size > dictionary_sample_max_size)
+            {
+                break;
+            }
+
+            InputFileStream file(path.pathname() + it->name);
+            file.read(samples.append(size_t(it->size)), it->size);
+            sample_sizes.push_back(size_t(it->size));
+        }
+
+        const u8* ptr = samples.data();
+        for (size_t size : sample_sizes)
+        {
+            sample_memory.emplace_back(ptr, size);
+            ptr += size;
+        }
+
+        dictionary.reset(dictionary_capacity);
+        size_t size = trainDictionary(dictionary, sample_memory);
+        dictionary.resize(size);
+
+        if (size)
+        {
+            dictionary_object = createDictionary(compressor, dictionary, level);
+        }
+
+        printf("Dictionary: %zu bytes from %zu samples.\n\n", size, sample_memory.size());
+    }
+
     BlockManager manager;
     Block block;
 
@@ -249,7 +329,17 @@ void compress(const std::string& folder, const std::string& archive, const std::
 
         manager.files.push_back({node.name, node.size, checksum});
 
-        if (node.size > small_file_max_size)
+        if (dictionary_object && node.size <= dictionary_file_max_size)
+        {
+            // the files are sorted by size so the merged block is complete
+            manager.flush(block);
+
+            manager.segment(0, node.size);
+            block.append({node.name, 0, node.size});
+            block.dictionary = true;
+            manager.flush(block);
+        }
+        else if (node.size > small_file_max_size)
         {
             if (node.size > large_block_size * 2)
             {
@@ -294,6 +384,11 @@ void compress(const std::string& folder, const std::string& archive, const std::
 
     str.write32(u32_mask('m', 'g', 'x', '0'));
 
+    // write dictionary
+
+    u64 dictionary_offset = output.offset();
+    output.write(dictionary.data(), dictionary.size());
+
     // compress
 
     ConcurrentQueue q; // compression queue
@@ -335,7 +430,15 @@ void compress(const std::string& folder, const std::string& archive, const std::
                 size_t bound = compressor.bound(uncompressed.size);
                 dest.reset(bound);
 
-                compressed.size = compressor.compress(dest, uncompressed, level);
+                if (block.dictionary)
+                {
+                    compressed.size = compress(compressor, dest, uncompressed, *dictionary_object);
+                }
+                else
+                {
+                    compressed.size = compressor.compress(dest, uncompressed, level);
+                }
+
                 compressed.address = dest.data();
             }
             else
@@ -358,7 +461,7 @@ void compress(const std::string& folder, const std::string& archive, const std::
             {
                 block.uncompressed = uncompressed.size;
                 block.compressed = compressed.size;
-                block.method = compressor.method;
+                block.method = compressor.method | (block.dictionary ? dictionary_flag : 0);
 
                 printf(".");
             }
@@ -476,11 +579,20 @@ void compress(const std::string& folder, const std::string& archive, const std::
 
     Compressed block data:
         u32         magic: mgx0
+        u8[]        dictionary
         u8[]        data     <-- written by the compressor, a raw binary blob w/o specific size or structure
 
     Block Info Array:
         u32         magic: mgx1
         block[]     blocks
+        Dictionary  dictionary (version 2)
+
+    Dictionary:
+        u64         offset
+        u64         size
+        u32         compression method (zstd or lz4)
+
+    Blocks compressed with the dictionary have bit 0x100 set in the method.
 
     File Info Array:
         u32         magic: mgx2
@@ -511,6 +623,13 @@ void compress(const std::string& folder, const std::string& archive, const std::
         str.write32(block.method);
     }
 
+    if (dictionary.size())
+    {
+        str.write64(dictionary_offset);
+        str.write64(dictionary.size());
+        str.write32(compressor.method);
+    }
+
     // write file data
 
     u64 file_data_offset = output.offset();
@@ -560,7 +679,7 @@ void compress(const std::string& folder, const std::string& archive, const std::
     // write header
 
     str.write32(u32_mask('m', 'g', 'x', '3'));
-    str.write32(1);
+    str.write32(dictionary.size() ? 2 : 1);
     str.write64(block_data_offset);
     str.write64(file_data_offset);
 }
@@ -578,7 +697,7 @@ int main(int argc, char* argv[])
         printf("\n");
         printf("MGX/SNITCH Compression Tool version 0.5.2 \n");
         printf("Copyright (C) 2018-2023 Fapware, inc. All rights reserved.\n");
-        printf("Usage: %s [input folder] [compression] [level:0..10]\n", program_name.c_str());
+        printf("Usage: %s [input folder] [compression] [level:0..10] [--store] [--dictionary]\n", program_name.c_str());
         printf("\n");
 
         printf("Compression methods: ");
@@ -603,6 +722,7 @@ int main(int argc, char* argv[])
     std::string compression = argv[2];
     int level = std::atoi(argv[3]);
     size_t store_threshold = store_threshold_default;
+    bool use_dictionary = false;
 
     for (int i = 4; i < argc; ++i)
     {
@@ -611,11 +731,15 @@ int main(int argc, char* argv[])
         {
             store_threshold = 0;
         }
+        else if (c == "--dictionary")
+        {
+            use_dictionary = true;
+        }
     }
 
     try
     {
-        compress(folder, archive, compression, level, store_threshold);
+        compress(folder, archive, compression, level, store_threshold, use_dictionary);
     }
     catch (Exception& e)
     {
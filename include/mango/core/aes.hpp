@@ -1,6 +1,6 @@
 /*
     MANGO Multimedia Development Platform
-    Copyright (C) 2012-2023 Twilight Finland 3D Oy Ltd. All rights reserved.
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
 */
 #pragma once
 
@@ -29,6 +29,17 @@ namespace mango
     // - the mac_length must be 4, 6, 8, 10, 12, 14, or 16
     // - output.size must be input.size + mac_length
     //
+    // gcm_encrypt() / gcm_decrypt():
+    // - the input can be any length and output.size must be at least input.size
+    // - the iv is recommended to be 12 bytes (96 bits) but any length is accepted
+    // - the tag is always 16 bytes
+    // - gcm_decrypt() returns false and clears the output when the tag does not match
+    //
+    // xts_encrypt() / xts_decrypt():
+    // - the length is the size of the data unit (sector) and must be at least 16 bytes;
+    //   incomplete last block is handled with ciphertext stealing
+    // - tweak is the second key and sector is the data unit number
+    //
 
     // Hardware acceleration support:
     //
@@ -36,6 +47,8 @@ namespace mango
     // CBC: Intel AES-NI, ARM Crypto
     // CTR: none
     // CCM: none
+    // GCM: Intel AES-NI + PCLMUL, ARM Crypto (AES only)
+    // XTS: Intel AES-NI, ARM Crypto
 
     class AES
     {
@@ -43,6 +56,12 @@ namespace mango
         std::unique_ptr<struct KeyScheduleAES> m_schedule;
         int m_bits;
 
+        void gcm_counter(u8* j0, ConstMemory iv);
+        void gcm_ghash(u8* state, const u8* data, size_t length) const;
+        void gcm_ctr32(u8* output, const u8* input, size_t length, u8* counter);
+        void xts_blocks(u8* output, const u8* input, size_t length, u8* tweak, bool encrypt);
+        void xts_crypt(u8* output, const u8* input, size_t length, AES& tweak, u64 sector, bool encrypt);
+
     public:
         AES(const u8* key, int bits);
         ~AES();
@@ -61,6 +80,16 @@ namespace mango
         void ccm_block_encrypt(Memory output, ConstMemory input, ConstMemory associated, ConstMemory nonce, int mac_length);
         void ccm_block_decrypt(Memory output, ConstMemory input, ConstMemory associated, ConstMemory nonce, int mac_length);
 
+        // authenticated encryption (Galois/Counter Mode)
+
+        void gcm_encrypt(Memory output, ConstMemory input, ConstMemory associated, ConstMemory iv, Memory tag);
+        bool gcm_decrypt(Memory output, ConstMemory input, ConstMemory associated, ConstMemory iv, ConstMemory tag);
+
+        // random access sector encryption (IEEE 1619 XTS)
+
+        void xts_encrypt(u8* output, const u8* input, size_t length, AES& tweak, u64 sector);
+        void xts_decrypt(u8* output, const u8* input, size_t length, AES& tweak, u64 sector);
+
         // aribtrary size buffer encryption
         // input can be any size but last block is automatically zero padded
 
@@ -10,6 +10,7 @@
 #include <mango/core/configure.hpp>
 #include <mango/core/exception.hpp>
 #include <mango/core/memory.hpp>
+#include <mango/core/stream.hpp>
 
 namespace mango
 {
@@ -194,6 +195,44 @@ namespace mango
         CompressionStatus decompress(Memory dest, ConstMemory source);
     }
 
+    // -----------------------------------------------------------------------
+    // dictionary compression
+    // -----------------------------------------------------------------------
+
+    // Small objects compress poorly because every object starts with an empty
+    // history. A dictionary trained from representative samples primes the history;
+    // the same dictionary must be used for compression and decompression. The
+    // dictionary is digested once when the dictionary object is created and the
+    // object can be shared between threads.
+
+    // Trains a dictionary into dest from the samples. Returns the dictionary size,
+    // which is at most dest.size; 16 - 112 KB is a good range. Every sample should
+    // be an individual object, the way it will be compressed.
+    size_t trainDictionary(Memory dest, const std::vector<ConstMemory>& samples);
+
+    class CompressionDictionary : protected NonCopyable
+    {
+    public:
+        CompressionDictionary() {}
+        virtual ~CompressionDictionary() {}
+        virtual ConstMemory memory() const = 0;
+    };
+
+    namespace lz4
+    {
+        // NOTE: lz4 uses up to the last 64 KB of the dictionary
+        std::shared_ptr<CompressionDictionary> createDictionary(ConstMemory dictionary, int level = 6);
+        CompressionStatus compress(Memory dest, ConstMemory source, const CompressionDictionary& dictionary);
+        CompressionStatus decompress(Memory dest, ConstMemory source, const CompressionDictionary& dictionary);
+    }
+
+    namespace zstd
+    {
+        std::shared_ptr<CompressionDictionary> createDictionary(ConstMemory dictionary, int level = 6);
+        CompressionStatus compress(Memory dest, ConstMemory source, const CompressionDictionary& dictionary);
+        CompressionStatus decompress(Memory dest, ConstMemory source, const CompressionDictionary& dictionary);
+    }
+
     // -----------------------------------------------------------------------
     // Compressor
     // -----------------------------------------------------------------------
@@ -233,4 +272,66 @@ namespace mango
     Compressor getCompressor(Compressor::Method method);
     Compressor getCompressor(const std::string& name);
 
+    // -----------------------------------------------------------------------
+    // streaming decompression
+    // -----------------------------------------------------------------------
+
+    // Decompression of input with unknown decompressed size in constant memory.
+    // The compressed data is pushed in pieces of any size and the output is written
+    // into a bounded buffer. The caller drains the output and calls decompress() again
+    // with the unconsumed input; a call which consumes and produces nothing needs more
+    // input. Concatenated streams (multi-member gzip, multiple zstd frames) continue
+    // when more input is pushed after the end of a stream.
+
+    // Supported methods: ZSTD, LZMA, DEFLATE, DEFLATE_ZLIB, DEFLATE_GZIP, ZLIB, BZIP2
+    // NOTE: LZMA streams need the end mark, which lzma::compress() writes
+
+    struct StreamingStatus : Status
+    {
+        size_t consumed = 0; // bytes consumed from the source
+        size_t produced = 0; // bytes written into the destination
+        bool done = false;   // end of the compressed stream
+    };
+
+    class StreamingDecompressor
+    {
+    public:
+        StreamingDecompressor() {}
+        virtual ~StreamingDecompressor() {}
+        virtual StreamingStatus decompress(Memory dest, ConstMemory source) = 0;
+    };
+
+    // returns nullptr when the method does not support streaming
+    std::shared_ptr<StreamingDecompressor> createStreamingDecompressor(Compressor::Method method);
+
+    // decompress input stream from the current offset into the output stream;
+    // the status size is the number of decompressed bytes
+    CompressionStatus decompress(Stream& output, Stream& input, Compressor::Method method);
+
+    // -----------------------------------------------------------------------
+    // parallel compression
+    // -----------------------------------------------------------------------
+
+    // The source is split into independent chunks which are compressed and
+    // decompressed concurrently in the ThreadPool. The chunks do not share history
+    // so the compression ratio is slightly lower than with the serial compressors.
+
+    // The output uses the standard framing of the format when it has one:
+    //   DEFLATE_GZIP: multi-member gzip; member size is stored in an extra field
+    //   ZSTD        : one frame per chunk, with the content size
+    //   LZ4         : LZ4 frame with independent blocks
+    // The other methods use a chunk table container.
+
+    // The decompressor accepts any valid multi-member gzip, zstd or LZ4 frame;
+    // input without the information to locate the chunks is decoded serially.
+
+    // chunk_size 0 selects the default (4 MB); LZ4 rounds it down to a frame block size
+
+    namespace parallel
+    {
+        size_t bound(const Compressor& compressor, size_t size, size_t chunk_size = 0);
+        CompressionStatus compress(const Compressor& compressor, Memory dest, ConstMemory source, int level = 6, size_t chunk_size = 0);
+        CompressionStatus decompress(const Compressor& compressor, Memory dest, ConstMemory source);
+    }
+
 } // namespace mango
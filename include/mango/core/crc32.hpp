@@ -20,6 +20,11 @@ namespace mango
 
     // NOTE: Initial crc default value is 0x0
 
+    // Large buffers (512 KB and up) are split into blocks which are computed in
+    // the ThreadPool; the partial results are merged with the combine functions.
+    // The combine functions join crc0 of the first buffer and crc1 of the second
+    // buffer of length1 bytes into the crc of the concatenated buffer.
+
     // CRC32
     u32 crc32(u32 crc, ConstMemory memory);
     u32 crc32_combine(u32 crc0, u32 crc1, size_t length1);
@@ -28,4 +33,31 @@ namespace mango
     u32 crc32c(u32 crc, ConstMemory memory);
     u32 crc32c_combine(u32 crc0, u32 crc1, size_t length1);
 
+    // Incremental CRC
+    // The crc functions above are already incremental: the crc from the previous call
+    // is the initial value for the next one. These contexts wrap the running value
+    // with the same update() / final() interface as the hash contexts.
+
+    class CRC32Context
+    {
+    public:
+        void reset() { m_crc = 0; }
+        void update(ConstMemory memory) { m_crc = crc32(m_crc, memory); }
+        u32 final() const { return m_crc; }
+
+    private:
+        u32 m_crc = 0;
+    };
+
+    class CRC32CContext
+    {
+    public:
+        void reset() { m_crc = 0; }
+        void update(ConstMemory memory) { m_crc = crc32c(m_crc, memory); }
+        u32 final() const { return m_crc; }
+
+    private:
+        u32 m_crc = 0;
+    };
+
 } // namespace mango
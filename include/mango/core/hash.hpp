@@ -4,6 +4,7 @@
 */
 #pragma once
 
+#include <memory>
 #include <mango/core/configure.hpp>
 #include <mango/core/memory.hpp>
 
@@ -66,6 +67,7 @@ namespace mango
     using SHA1 = Hash<u32, 5>;
     using SHA2 = Hash<u32, 8>;
     using XX3H128 = Hash<u64, 2>;
+    using BLAKE3 = Hash<u32, 8>;
 
     MD5 md5(ConstMemory memory);
     SHA1 sha1(ConstMemory memory);
@@ -76,4 +78,191 @@ namespace mango
     u64 xx3hash64(u64 seed, ConstMemory memory);
     XX3H128 xx3hash128(u64 seed, ConstMemory memory);
 
+    // BLAKE3 is a tree hash: large inputs are hashed with the ThreadPool
+    // and chunks are compressed in parallel in SIMD lanes.
+    BLAKE3 blake3(ConstMemory memory);
+
+    // -----------------------------------------------------------------------
+    // multi-buffer hashing
+    // -----------------------------------------------------------------------
+
+    // Compute the hashes of count independent messages. The messages are
+    // processed in parallel in SIMD lanes (4 with SSE / NEON, 8 with AVX2 and
+    // 16 with AVX-512). When the CPU has SHA instructions the messages are
+    // hashed one at a time with them instead as that is faster.
+
+    void md5(MD5* hashes, const ConstMemory* messages, size_t count);
+    void sha1(SHA1* hashes, const ConstMemory* messages, size_t count);
+    void sha2(SHA2* hashes, const ConstMemory* messages, size_t count);
+
+    // -----------------------------------------------------------------------
+    // incremental hashing
+    // -----------------------------------------------------------------------
+
+    /*
+        The data can be hashed in any number of update() calls; partial blocks
+        are carried over to the next call. The result is identical to hashing
+        all of the data in one call with the functions above.
+
+        SHA2Context context;
+        context.update(memory0);
+        context.update(memory1);
+        SHA2 hash = context.final();
+
+        final() does not modify the context so more data can still be added.
+    */
+
+    class MD5Context
+    {
+    public:
+        MD5Context();
+
+        void reset();
+        void update(ConstMemory memory);
+        MD5 final() const;
+
+    private:
+        u32 m_state[4];
+        u8 m_block[64];
+        u64 m_size;
+    };
+
+    class SHA1Context
+    {
+    public:
+        SHA1Context();
+
+        void reset();
+        void update(ConstMemory memory);
+        SHA1 final() const;
+
+    private:
+        void (*m_transform)(u32* state, const u8* data, int blocks);
+        u32 m_state[5];
+        u8 m_block[64];
+        u64 m_size;
+    };
+
+    // HMAC-SHA1 (RFC 2104); the key is processed once in the constructor
+    // so that the context can be copied to authenticate many messages.
+
+    class HMACSHA1Context
+    {
+    public:
+        HMACSHA1Context(ConstMemory key);
+
+        void update(ConstMemory memory);
+        SHA1 final() const;
+
+    private:
+        SHA1Context m_inner;
+        SHA1Context m_outer;
+    };
+
+    SHA1 hmac_sha1(ConstMemory key, ConstMemory message);
+
+    // PBKDF2-HMAC-SHA1 (RFC 8018) key derivation; fills the whole output
+    void pbkdf2_sha1(Memory output, ConstMemory password, ConstMemory salt, int iterations);
+
+    class SHA2Context
+    {
+    public:
+        SHA2Context();
+
+        void reset();
+        void update(ConstMemory memory);
+        SHA2 final() const;
+
+    private:
+        void (*m_transform)(u32* state, const u8* data, int blocks);
+        u32 m_state[8];
+        u8 m_block[64];
+        u64 m_size;
+    };
+
+    class BLAKE3Context
+    {
+    public:
+        BLAKE3Context();
+
+        void reset();
+        void update(ConstMemory memory);
+        BLAKE3 final() const;
+
+    private:
+        void pushStack(const u32* cv, u64 chunk_counter);
+        void mergeStack(u64 total_chunks);
+
+        // current chunk
+        u32 m_cv[8];
+        u8 m_block[64];
+        u32 m_block_size;
+        u32 m_blocks_compressed;
+        u64 m_chunk_counter;
+
+        // chaining values of the completed subtrees
+        u32 m_stack[54][8];
+        int m_stack_size;
+    };
+
+    class XXHash32Context
+    {
+    public:
+        XXHash32Context(u32 seed = 0);
+        ~XXHash32Context();
+
+        void reset();
+        void update(ConstMemory memory);
+        u32 final() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+
+    class XXHash64Context
+    {
+    public:
+        XXHash64Context(u64 seed = 0);
+        ~XXHash64Context();
+
+        void reset();
+        void update(ConstMemory memory);
+        u64 final() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+
+    class XX3Hash64Context
+    {
+    public:
+        XX3Hash64Context(u64 seed = 0);
+        ~XX3Hash64Context();
+
+        void reset();
+        void update(ConstMemory memory);
+        u64 final() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+
+    class XX3Hash128Context
+    {
+    public:
+        XX3Hash128Context(u64 seed = 0);
+        ~XX3Hash128Context();
+
+        void reset();
+        void update(ConstMemory memory);
+        XX3H128 final() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+
 } // namespace mango
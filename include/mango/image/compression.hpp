@@ -50,6 +50,17 @@ namespace mango::image
             PACKED      = 15,
         };
 
+        // encoding quality for formats which have a dedicated batch encoder (BC1 - BC5)
+        enum class Quality
+        {
+            FAST,       // bounding box (range fit)
+            NORMAL,     // principal component axis with least squares refinement
+            BEST        // exhaustive cluster fit
+        };
+
+        // encoding quality for the ImageEncodeOptions::quality range [0.0, 1.0]
+        static Quality getQuality(float quality);
+
         enum Flags : u32
         {
             PVR      = 0x00010000, // Imagination PVR compressed texture
@@ -256,7 +267,7 @@ namespace mango::image
         TextureCompression(vulkan::TextureFormat format);
 
         Status decompress(const Surface& surface, ConstMemory memory) const;
-        Status compress(Memory memory, const Surface& surface) const;
+        Status compress(Memory memory, const Surface& surface, Quality quality = Quality::NORMAL) const;
 
         bool isLinear() const;
 
@@ -80,6 +80,17 @@ namespace mango::image
         // - decode() destination surface must be indexed
         Palette* palette = nullptr; // enable indexed decoding by pointing to a palette
 
+        // region of interest in the selected level (exr: only the tiles the region touches are decompressed)
+        // - the region is decoded to the origin of the destination surface
+        // - empty region selects the whole image
+        struct Region
+        {
+            int x = 0;
+            int y = 0;
+            int width = 0;
+            int height = 0;
+        } region;
+
         bool simd = true;
         bool multithread = true;
         bool icc = false; // apply ICC profile
@@ -21,20 +21,37 @@ namespace mango::image
         bool direct = false;
     };
 
+    // ImageEncodeOptions::method values; they are the OpenEXR compression attribute values
+    enum : int
+    {
+        EXR_COMPRESSION_NONE = 0,
+        EXR_COMPRESSION_RLE  = 1,
+        EXR_COMPRESSION_ZIPS = 2,
+        EXR_COMPRESSION_ZIP  = 3,
+        EXR_COMPRESSION_PIZ  = 4,
+    };
+
     struct ImageEncodeOptions
     {
         Palette palette;          // gif, png
 
         ConstMemory icc;          // jpg, png, jp2
 
-        float quality = 0.90f;    // jpg, jp2, heif: [0.0, 1.0]
-        int compression = 5;      // png: [0, 10]
+        float quality = 0.90f;    // jpg, jp2, heif, dds, ktx2: [0.0, 1.0]
+        int compression = 5;      // png, ktx2, exr: [0, 10]
         bool parallel = true;     // png
         bool dithering = true;    // gif
         bool lossless = false;    // webp, jp2, heif
 
+        u32 texture = TextureCompression::NONE; // dds, ktx2: block compression (NONE: rgba)
+        int levels = 0;           // dds, ktx2: mipmap levels (0: complete chain)
+        bool supercompress = false; // ktx2: zstd
+
+        int method = EXR_COMPRESSION_ZIP; // exr: EXR_COMPRESSION_xxx
+        int tile = 0;             // exr: tile size (0: scanlines)
+
         bool simd = true;         // jpg
-        bool multithread = true;  // jpg, jp2
+        bool multithread = true;  // jpg, jp2, exr
     };
 
     class ImageEncoder : protected NonCopyable
@@ -52,6 +52,7 @@ namespace mango::image
         void clear(float red, float green, float blue, float alpha) const;
         void clear(Color color) const;
         void blit(int x, int y, const Surface& source) const;
+        void downsample(const Surface& source) const; // 2x2 box filter (next mipmap level)
         void xflip() const;
         void yflip() const;
     };
@@ -75,6 +76,9 @@ namespace mango::image
         ~Bitmap();
 
         Bitmap& operator = (Bitmap&& bitmap);
+
+        // exchange the images and their ownership
+        void swap(Bitmap& bitmap);
     };
 
 } // namespace mango::image
@@ -0,0 +1,85 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#pragma once
+
+#include <limits>
+#include <vector>
+#include <mango/math/geometry.hpp>
+#include <mango/import3d/mesh.hpp>
+
+namespace mango::import3d
+{
+
+    /*
+        Bounding volume hierarchy for ray queries over triangles or boxes.
+
+        The hierarchy is built with binned surface area heuristic; the top
+        levels are split on the calling thread and the subtrees below them
+        are built in parallel with the ThreadPool. The binary tree is then
+        collapsed into nodes with Width (4 or 8) children which are tested
+        with one float32x4 or float32x8 slab test per node.
+
+        The triangles are two-sided and the hits are reported with the
+        IntersectBarycentricTwosided rules; the box hits use the IntersectSolid
+        rules. The primitive index is the position in the array given to
+        the constructor; with the IndexedMesh the triangles of the triangle
+        list primitives are numbered in the order they are in the mesh.
+    */
+
+    template <int Width>
+    class BVH
+    {
+    public:
+        struct Hit
+        {
+            // the closest intersection; t0 is also the maximum distance to search
+            float t0 = std::numeric_limits<float>::infinity();
+            float u = 0.0f;
+            float v = 0.0f;
+            float w = 0.0f;
+            u32 primitive = 0xffffffff;
+        };
+
+        struct Node
+        {
+            float minx[Width];
+            float miny[Width];
+            float minz[Width];
+            float maxx[Width];
+            float maxy[Width];
+            float maxz[Width];
+            u32 child[Width]; // inner: node index, leaf: first primitive
+            u32 count[Width]; // inner: zero, leaf: number of primitives
+            u32 size;         // number of children
+        };
+
+    protected:
+        std::vector<Node> m_nodes;
+        std::vector<u32> m_indices;
+        std::vector<math::Triangle> m_triangles;
+        std::vector<math::Box> m_boxes;
+
+        void build(const std::vector<math::Box>& bounds);
+
+    public:
+        BVH(const std::vector<math::Triangle>& triangles);
+        BVH(const std::vector<math::Box>& boxes);
+        BVH(const IndexedMesh& mesh);
+        ~BVH();
+
+        size_t getNodeCount() const;
+        size_t getPrimitiveCount() const;
+
+        // closest hit; returns true when hit was updated
+        bool intersect(Hit& hit, const math::Ray& ray) const;
+
+        // closest hit for the active rays of the packet; returns the mask of the updated hits
+        u32 intersect(Hit hit[8], const math::RayPacket& packet) const;
+    };
+
+    using BVH4 = BVH<4>;
+    using BVH8 = BVH<8>;
+
+} // namespace mango::import3d
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <mango/import3d/mesh.hpp>
+#include <mango/import3d/bvh.hpp>
 #include <mango/import3d/import_3ds.hpp>
 #include <mango/import3d/import_obj.hpp>
 #include <mango/import3d/import_lwo.hpp>
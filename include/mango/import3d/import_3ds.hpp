@@ -11,7 +11,7 @@ namespace mango::import3d
 
     struct Import3DS : Scene
     {
-        Import3DS(const filesystem::Path& path, const std::string& filename);
+        Import3DS(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout = VertexLayout());
     };
 
 } // namespace mango::import3d
@@ -11,7 +11,7 @@ namespace mango::import3d
 
     struct ImportFBX : Scene
     {
-        ImportFBX(const filesystem::Path& path, const std::string& filename);
+        ImportFBX(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout = VertexLayout());
     };
 
 } // namespace mango::import3d
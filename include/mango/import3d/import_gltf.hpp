@@ -11,7 +11,7 @@ namespace mango::import3d
 
     struct ImportGLTF : Scene
     {
-        ImportGLTF(const filesystem::Path& path, const std::string& filename);
+        ImportGLTF(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout = VertexLayout());
     };
 
 } // namespace mango::import3d
@@ -11,7 +11,7 @@ namespace mango::import3d
 
     struct ImportLWO : Scene
     {
-        ImportLWO(const filesystem::Path& path, const std::string& filename);
+        ImportLWO(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout = VertexLayout());
     };
 
 } // namespace mango::import3d
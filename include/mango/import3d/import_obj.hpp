@@ -11,7 +11,7 @@ namespace mango::import3d
 
     struct ImportOBJ : Scene
     {
-        ImportOBJ(const filesystem::Path& path, const std::string& filename);
+        ImportOBJ(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout = VertexLayout());
     };
 
 } // namespace mango::import3d
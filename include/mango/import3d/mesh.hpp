@@ -6,9 +6,12 @@
 
 #include <vector>
 #include <string>
+#include <map>
 #include <optional>
 #include <memory>
 #include <mango/core/buffer.hpp>
+#include <mango/core/hash.hpp>
+#include <mango/core/thread.hpp>
 #include <mango/math/math.hpp>
 #include <mango/image/image.hpp>
 #include <mango/filesystem/filesystem.hpp>
@@ -24,11 +27,56 @@ namespace mango::import3d
     // texture
     // -----------------------------------------------------------------------
 
-    using Texture = std::shared_ptr<image::Bitmap>;
+    struct TextureImage : image::Bitmap
+    {
+        // top level of a block compressed image; the bitmap is empty when used
+        struct Compressed
+        {
+            u32 compression = image::TextureCompression::NONE;
+            int width = 0;
+            int height = 0;
+            Buffer data;
+        } compressed;
+
+        TextureImage();
+    };
+
+    using Texture = std::shared_ptr<TextureImage>;
 
     Texture createTexture(const filesystem::Path& path, const std::string& filename);
     Texture createTexture(ConstMemory memory);
 
+    /*
+        TextureLoader decodes the textures of a scene concurrently in the ThreadPool.
+        The same file or identical embedded image data is decoded only once and the
+        Texture is shared by all materials which reference it.
+
+        The returned Texture is valid immediately but the image is resolved only
+        after wait(); the memory given to load() must remain valid until then.
+
+        In compressed mode the block compressed images (DDS, KTX, KTX2, ...) are
+        kept as they are instead of decoding them into RGBA8.
+    */
+
+    class TextureLoader : private NonCopyable
+    {
+    protected:
+        ConcurrentQueue m_queue;
+        std::map<std::string, Texture> m_files;
+        std::map<XX3H128, Texture> m_images;
+        bool m_compressed;
+
+        Texture decode(ConstMemory memory, const std::string& extension, std::shared_ptr<void> owner);
+
+    public:
+        TextureLoader(bool compressed = false);
+        ~TextureLoader();
+
+        Texture load(const filesystem::Path& path, const std::string& filename);
+        Texture load(ConstMemory memory);
+        void wait();
+    };
+
     // -----------------------------------------------------------------------
     // material
     // -----------------------------------------------------------------------
@@ -115,20 +163,140 @@ namespace mango::import3d
         u32 material = 0;
     };
 
+    /*
+        The vertices of an IndexedMesh are stored as one stream per attribute;
+        only the attributes in flags have a stream. The positions are always
+        Float32x3, the other attributes can be stored in a compact format
+        selected with the VertexLayout:
+
+        attribute    default      compact
+        ---------------------------------------
+        Normal       Float32x3    SNorm16x4   ( 8 bytes)
+        Texcoord     Float32x2    Float16x2   ( 4 bytes)
+        Tangent      Float32x4    SNorm16x4   ( 8 bytes)
+        Color        Float32x4    UNorm8x4    ( 4 bytes)
+    */
+
+    enum class VertexFormat : u8
+    {
+        Float32x2,
+        Float32x3,
+        Float32x4,
+        Float16x2,
+        Float16x4,
+        SNorm16x4,
+        UNorm8x4,
+    };
+
+    struct VertexLayout
+    {
+        VertexFormat normal   = VertexFormat::Float32x3;
+        VertexFormat texcoord = VertexFormat::Float32x2;
+        VertexFormat tangent  = VertexFormat::Float32x4;
+        VertexFormat color    = VertexFormat::Float32x4;
+
+        static VertexLayout compact();
+    };
+
+    struct VertexStream
+    {
+        u32 attribute;          // Vertex::Position, Vertex::Normal, ..
+        VertexFormat format;
+        u32 stride;             // bytes per vertex
+        std::vector<u8> data;
+
+        VertexStream(u32 attribute, VertexFormat format);
+
+        size_t size() const
+        {
+            return data.size() / stride;
+        }
+
+        template <typename T>
+        T* as()
+        {
+            return reinterpret_cast<T*>(data.data());
+        }
+
+        template <typename T>
+        const T* as() const
+        {
+            return reinterpret_cast<const T*>(data.data());
+        }
+
+        // decode and encode the attributes; missing components are zero
+        float32x4 read(size_t index) const;
+        void write(size_t index, float32x4 value);
+
+        void write(size_t index, float32x3 value)
+        {
+            write(index, float32x4(value, 0.0f));
+        }
+
+        void write(size_t index, float32x2 value)
+        {
+            write(index, float32x4(value.x, value.y, 0.0f, 0.0f));
+        }
+    };
+
     struct IndexedMesh
     {
-        std::vector<Vertex> vertices;
+        std::vector<VertexStream> streams;
         std::vector<u32> indices;
         std::vector<Primitive> primitives;
         math::Box boundingBox;
         u32 flags = 0;
+        VertexLayout layout;
 
-        IndexedMesh();
-        IndexedMesh(const Mesh& mesh, u32 material);
+        IndexedMesh(const VertexLayout& layout = VertexLayout());
+        IndexedMesh(const Mesh& mesh, u32 material, const VertexLayout& layout = VertexLayout());
 
-        void append(const Mesh& mesh, u32 material);
+        // weld the triangles into a new primitive; see weldVertices()
+        void append(const Mesh& mesh, u32 material, float epsilon = 0.0f);
+
+        // add streams for the attributes which are not yet present;
+        // the existing vertices get zero for the new attributes
+        void addAttributes(u32 attributes);
+
+        // resize all streams
+        void resizeVertices(size_t count);
+        size_t getVertexCount() const;
+
+        VertexStream* getStream(u32 attribute);
+        const VertexStream* getStream(u32 attribute) const;
+
+        // the positions are always Float32x3
+        float32x3* getPositions();
+        const float32x3* getPositions() const;
+
+        // decoded vertex access; slow path for tools and the Mesh conversion
+        Vertex getVertex(size_t index) const;
+        void setVertex(size_t index, const Vertex& vertex);
     };
 
+    // -----------------------------------------------------------------------
+    // vertex welding
+    // -----------------------------------------------------------------------
+
+    /*
+        Find the unique vertices in an array of count vertices. The remap
+        array receives the index of every vertex in the welded vertex array;
+        the unique vertices are numbered in the order of first occurrence.
+        Returns the number of unique vertices.
+
+        The vertices are compared as binary records of stride bytes (a
+        multiple of 4, at most 256). The float version snaps the attributes
+        to a grid of epsilon sized cells and welds the vertices which fall
+        in the same cell; with epsilon of zero the comparison is exact.
+
+        The welding is done with the ThreadPool: the vertices are hashed in
+        parallel and partitioned by the hash, then each partition is welded
+        with its own open addressing hash table.
+    */
+
+    size_t weldVertices(u32* remap, const void* vertices, size_t count, size_t stride);
+    size_t weldVertices(u32* remap, const float* vertices, size_t count, size_t stride, float epsilon);
+
     // -----------------------------------------------------------------------
     // scene
     // -----------------------------------------------------------------------
@@ -149,6 +317,144 @@ namespace mango::import3d
         std::vector<u32> roots;
     };
 
+    // -----------------------------------------------------------------------
+    // optimisation
+    // -----------------------------------------------------------------------
+
+    /*
+        Optional post-import optimisation of the index and vertex buffers:
+
+        vertexCache - reorder the triangles for the post-transform vertex cache
+        overdraw    - reorder clusters of triangles so that the outward facing
+                      ones are drawn first; costs at most overdrawThreshold
+                      times the vertex cache efficiency
+        vertexFetch - store the vertices in the order they are referenced;
+                      the primitives use absolute indices afterwards
+
+        The triangle lists are optimised per Primitive in parallel. Strips,
+        fans and primitives with restart indices keep their triangle order.
+
+        ImportOBJ scene(path, filename);
+        optimize(scene);
+    */
+
+    struct OptimizeOptions
+    {
+        bool vertexCache = true;
+        bool overdraw = true;
+        bool vertexFetch = true;
+        u32 cacheSize = 16;
+        float overdrawThreshold = 1.05f;
+    };
+
+    void optimizeVertexCache(u32* indices, size_t count, size_t vertexCount, u32 cacheSize = 16);
+    void optimizeOverdraw(u32* indices, size_t count, const float32x3* positions, size_t vertexCount, u32 cacheSize = 16, float threshold = 1.05f);
+
+    void optimize(IndexedMesh& mesh, const OptimizeOptions& options = OptimizeOptions());
+    void optimize(Scene& scene, const OptimizeOptions& options = OptimizeOptions());
+
+    // -----------------------------------------------------------------------
+    // meshlets
+    // -----------------------------------------------------------------------
+
+    /*
+        The triangle lists are split into meshlets of at most maxVertices
+        vertices and maxTriangles triangles; the primitives are processed in
+        parallel. Run optimize() first for better vertex locality.
+
+        The meshlet vertices are absolute indices into the vertex streams and
+        the triangles are three bytes of meshlet local vertex indices:
+
+        vertex = vertices[meshlet.vertexOffset + triangles[meshlet.triangleOffset + i]]
+
+        The normal cone contains the triangle normals cross(p1 - p0, p2 - p0).
+        The meshlet faces away from the camera and can be culled when:
+
+        dot(center - camera, coneAxis) >= coneCutoff * length(center - camera) + radius
+    */
+
+    struct Meshlet
+    {
+        u32 primitive;          // source Primitive (material)
+        u32 vertexOffset;       // first vertex in MeshletMesh::vertices
+        u32 triangleOffset;     // first byte in MeshletMesh::triangles
+        u8 vertexCount;
+        u8 triangleCount;
+
+        // bounding sphere
+        float32x3 center;
+        float radius;
+
+        // normal cone; the cutoff is 1.0 when the meshlet cannot be cone culled
+        float32x3 coneAxis;
+        float coneCutoff;
+    };
+
+    struct MeshletMesh
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<u32> vertices;
+        std::vector<u8> triangles;
+    };
+
+    MeshletMesh createMeshlets(const IndexedMesh& mesh, u32 maxVertices = 64, u32 maxTriangles = 124);
+
+    // -----------------------------------------------------------------------
+    // simplification
+    // -----------------------------------------------------------------------
+
+    /*
+        Edge-collapse simplification with quadric error metrics. The edges are
+        collapsed into existing vertices so the simplified indices reference
+        the same vertices. Border and attribute seam vertices are preserved.
+
+        targetCount is the number of indices to reduce to. targetError is
+        the largest allowed error relative to the size of the mesh; the
+        simplification stops at whichever limit is reached first.
+
+        createLODs() simplifies every triangle list primitive in parallel;
+        each level is reduced by ratio from the previous one and shares the
+        vertex streams of the mesh. The levels stop at the first one which
+        does not reduce the index count (targetError is reached), so fewer
+        than the requested levels can be returned.
+    */
+
+    size_t simplify(u32* output, const u32* indices, size_t count, const float32x3* positions, size_t vertexCount,
+                    size_t targetCount, float targetError = 0.01f, float* resultError = nullptr);
+
+    struct MeshLOD
+    {
+        std::vector<u32> indices;
+        std::vector<Primitive> primitives;
+        float error;    // relative to the size of the mesh
+    };
+
+    std::vector<MeshLOD> createLODs(const IndexedMesh& mesh, int levels, float ratio = 0.5f, float targetError = 0.05f);
+
+    // -----------------------------------------------------------------------
+    // meshopt compression
+    // -----------------------------------------------------------------------
+
+    /*
+        Decoders for the EXT_meshopt_compression buffer views. The vertices
+        are decoded into count records of stride bytes and the indices into
+        count u16 or u32 indices (size 2 or 4); the filters are applied to the
+        decoded vertices in place. Corrupted data throws an exception.
+    */
+
+    enum class MeshoptFilter
+    {
+        None,
+        Octahedral,
+        Quaternion,
+        Exponential
+    };
+
+    void decodeMeshoptVertices(void* output, size_t count, size_t stride, ConstMemory source);
+    void decodeMeshoptTriangles(void* output, size_t count, size_t size, ConstMemory source);
+    void decodeMeshoptIndices(void* output, size_t count, size_t size, ConstMemory source);
+    void decodeMeshoptFilter(void* data, size_t count, size_t stride, MeshoptFilter filter);
+
     // -----------------------------------------------------------------------
     // shapes
     // -----------------------------------------------------------------------
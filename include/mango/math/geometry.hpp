@@ -6,6 +6,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <vector>
 #include <mango/math/math.hpp>
 
 namespace mango::math
@@ -351,6 +352,27 @@ namespace mango::math
         Ray ray(float x, float y) const;
     };
 
+    // ------------------------------------------------------------------
+    // FrustumPlanes
+    // ------------------------------------------------------------------
+
+    // The clipping planes of a view-projection matrix with the normals pointing
+    // inside the frustum. The near plane is z = -w, which is exact for the GL
+    // projections and conservative for the projections with [0, 1] depth range.
+
+    struct FrustumPlanes
+    {
+        Plane plane[6]; // 0: left, 1: right, 2: bottom, 3: top, 4: near, 5: far
+
+        FrustumPlanes() = default;
+        FrustumPlanes(const Matrix4x4& m);
+        ~FrustumPlanes() = default;
+
+        // true when the primitive is inside or intersects the frustum
+        bool intersect(const Box& box) const;
+        bool intersect(const Sphere& sphere) const;
+    };
+
     // ------------------------------------------------------------------
     // Intersect
     // ------------------------------------------------------------------
@@ -415,4 +437,134 @@ namespace mango::math
     bool intersect(const Sphere& sphere, const Box& box);
     bool intersect(const Cone& cone, const Sphere& sphere);
 
+    // ------------------------------------------------------------------
+    // Batch kernels
+    // ------------------------------------------------------------------
+
+    /*
+        Structure of arrays containers for the batch kernels. Every component
+        is stored in a separate array so that the kernels process eight objects
+        (sixteen with AVX-512) per instruction without any shuffling.
+    */
+
+    struct PointArray
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+
+        size_t size() const
+        {
+            return x.size();
+        }
+
+        void resize(size_t count)
+        {
+            x.resize(count);
+            y.resize(count);
+            z.resize(count);
+        }
+
+        void push_back(const float32x3& point)
+        {
+            x.push_back(point.x);
+            y.push_back(point.y);
+            z.push_back(point.z);
+        }
+
+        float32x3 operator [] (size_t index) const
+        {
+            return float32x3(x[index], y[index], z[index]);
+        }
+    };
+
+    struct BoxArray
+    {
+        std::vector<float> minx;
+        std::vector<float> miny;
+        std::vector<float> minz;
+        std::vector<float> maxx;
+        std::vector<float> maxy;
+        std::vector<float> maxz;
+
+        size_t size() const
+        {
+            return minx.size();
+        }
+
+        void push_back(const Box& box)
+        {
+            minx.push_back(box.corner[0].x);
+            miny.push_back(box.corner[0].y);
+            minz.push_back(box.corner[0].z);
+            maxx.push_back(box.corner[1].x);
+            maxy.push_back(box.corner[1].y);
+            maxz.push_back(box.corner[1].z);
+        }
+
+        Box operator [] (size_t index) const
+        {
+            return Box(float32x3(minx[index], miny[index], minz[index]),
+                       float32x3(maxx[index], maxy[index], maxz[index]));
+        }
+    };
+
+    struct SphereArray
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> radius;
+
+        size_t size() const
+        {
+            return x.size();
+        }
+
+        void push_back(const Sphere& sphere)
+        {
+            x.push_back(sphere.center.x);
+            y.push_back(sphere.center.y);
+            z.push_back(sphere.center.z);
+            radius.push_back(sphere.radius);
+        }
+
+        Sphere operator [] (size_t index) const
+        {
+            return Sphere(float32x3(x[index], y[index], z[index]), radius[index]);
+        }
+    };
+
+    // Eight rays in structure of arrays layout. The lanes beyond count
+    // are inactive and never intersect anything; rays is not read when
+    // count is zero.
+
+    struct RayPacket
+    {
+        float32x8 ox, oy, oz;
+        float32x8 dx, dy, dz;
+        float32x8 ix, iy, iz; // inverse direction
+        u32 mask;
+
+        RayPacket(const Ray* rays, size_t count);
+        ~RayPacket() = default;
+    };
+
+    // transform with w = 1 (points) or w = 0 (vectors); result can be the source array
+    void transformPoints(PointArray& result, const PointArray& points, const Matrix4x4& m);
+    void transformVectors(PointArray& result, const PointArray& vectors, const Matrix4x4& m);
+
+    // write the indices of the primitives which are inside or intersect the
+    // frustum in ascending order; returns the number of indices
+    size_t cull(u32* result, const FrustumPlanes& frustum, const BoxArray& boxes);
+    size_t cull(u32* result, const FrustumPlanes& frustum, const SphereArray& spheres);
+
+    // write the indices of the boxes the ray intersects and the entry distances
+    // with the IntersectRange rules; returns the number of intersections
+    size_t intersect(u32* result, float* distance, const FastRay& ray, const BoxArray& boxes);
+
+    // returns the mask of the rays which intersect the box (IntersectRange rules)
+    // and writes the entry distance of every ray into distance
+    u32 intersect(float32x8& distance, const RayPacket& packet, const Box& box);
+
 } // namespace mango::math
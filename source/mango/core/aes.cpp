@@ -2,6 +2,7 @@
     MANGO Multimedia Development Platform
     Copyright (C) 2012-2023 Twilight Finland 3D Oy Ltd. All rights reserved.
 */
+#include <algorithm>
 #include <mango/core/aes.hpp>
 #include <mango/core/endian.hpp>
 #include <mango/core/cpuinfo.hpp>
@@ -1586,8 +1587,524 @@ void aesni_cbc_decrypt(u8* output, const u8* input, size_t length, const u8* ive
     }
 }
 
+// interleaved blocks hide the latency of the aesenc / aesdec instructions
+
+template <int N>
+inline void aesni_encrypt_blocks(__m128i* data, const __m128i* schedule, int rounds)
+{
+    for (int i = 0; i < N; ++i)
+    {
+        data[i] = _mm_xor_si128(data[i], schedule[0]);
+    }
+
+    for (int r = 1; r < rounds; ++r)
+    {
+        const __m128i key = schedule[r];
+        for (int i = 0; i < N; ++i)
+        {
+            data[i] = _mm_aesenc_si128(data[i], key);
+        }
+    }
+
+    for (int i = 0; i < N; ++i)
+    {
+        data[i] = _mm_aesenclast_si128(data[i], schedule[rounds]);
+    }
+}
+
+template <int N>
+inline void aesni_decrypt_blocks(__m128i* data, const __m128i* schedule, int rounds)
+{
+    for (int i = 0; i < N; ++i)
+    {
+        data[i] = _mm_xor_si128(data[i], schedule[rounds]);
+    }
+
+    for (int r = 1; r < rounds; ++r)
+    {
+        const __m128i key = schedule[rounds + r];
+        for (int i = 0; i < N; ++i)
+        {
+            data[i] = _mm_aesdec_si128(data[i], key);
+        }
+    }
+
+    for (int i = 0; i < N; ++i)
+    {
+        data[i] = _mm_aesdeclast_si128(data[i], schedule[0]);
+    }
+}
+
+// CTR with 32 bit big endian counter in the last four bytes of the block
+
+void aesni_ctr32_crypt(u8* output, const u8* input, size_t length, u8* counter_block, const __m128i* schedule, int rounds)
+{
+    const int w0 = int(littleEndian::uload32(counter_block + 0));
+    const int w1 = int(littleEndian::uload32(counter_block + 4));
+    const int w2 = int(littleEndian::uload32(counter_block + 8));
+    u32 counter = bigEndian::uload32(counter_block + 12);
+
+    while (length >= 128)
+    {
+        __m128i data[8];
+
+        for (int i = 0; i < 8; ++i)
+        {
+            data[i] = _mm_set_epi32(int(byteswap(counter + u32(i))), w2, w1, w0);
+        }
+
+        aesni_encrypt_blocks<8>(data, schedule, rounds);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i * 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i * 16), _mm_xor_si128(data[i], source));
+        }
+
+        counter += 8;
+        output += 128;
+        input += 128;
+        length -= 128;
+    }
+
+    while (length > 0)
+    {
+        __m128i data[1] = { _mm_set_epi32(int(byteswap(counter)), w2, w1, w0) };
+        aesni_encrypt_blocks<1>(data, schedule, rounds);
+
+        u8 keystream[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(keystream), data[0]);
+
+        size_t bytes = std::min(length, size_t(16));
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            output[i] = input[i] ^ keystream[i];
+        }
+
+        ++counter;
+        output += bytes;
+        input += bytes;
+        length -= bytes;
+    }
+
+    bigEndian::ustore32(counter_block + 12, counter);
+}
+
+// XTS
+
+inline __m128i aesni_xts_double(__m128i tweak)
+{
+    // multiply by x in GF(2^128); the carry from the low to the high qword
+    // and the reduction from the top bit are selected with the sign masks
+    const __m128i mask = _mm_set_epi32(0, 1, 0, 0x87);
+    __m128i sign = _mm_shuffle_epi32(_mm_srai_epi32(tweak, 31), _MM_SHUFFLE(0, 1, 0, 3));
+    return _mm_xor_si128(_mm_slli_epi64(tweak, 1), _mm_and_si128(sign, mask));
+}
+
+void aesni_xts_crypt(u8* output, const u8* input, size_t length, u8* tweak_block, const __m128i* schedule, int rounds, bool encrypt)
+{
+    __m128i tweak = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tweak_block));
+
+    while (length >= 128)
+    {
+        __m128i tweaks[8];
+        __m128i data[8];
+
+        for (int i = 0; i < 8; ++i)
+        {
+            tweaks[i] = tweak;
+            tweak = aesni_xts_double(tweak);
+            __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i * 16));
+            data[i] = _mm_xor_si128(source, tweaks[i]);
+        }
+
+        if (encrypt)
+            aesni_encrypt_blocks<8>(data, schedule, rounds);
+        else
+            aesni_decrypt_blocks<8>(data, schedule, rounds);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i * 16), _mm_xor_si128(data[i], tweaks[i]));
+        }
+
+        output += 128;
+        input += 128;
+        length -= 128;
+    }
+
+    while (length >= 16)
+    {
+        __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+        __m128i data[1] = { _mm_xor_si128(source, tweak) };
+
+        if (encrypt)
+            aesni_encrypt_blocks<1>(data, schedule, rounds);
+        else
+            aesni_decrypt_blocks<1>(data, schedule, rounds);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output), _mm_xor_si128(data[0], tweak));
+        tweak = aesni_xts_double(tweak);
+
+        output += 16;
+        input += 16;
+        length -= 16;
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(tweak_block), tweak);
+}
+
 #endif // defined(__AES__)
 
+#if defined(__AES__) && defined(__PCLMUL__) && defined(MANGO_ENABLE_SSE4_1)
+
+// ----------------------------------------------------------------------------------------
+// Intel PCLMUL GHASH
+// ----------------------------------------------------------------------------------------
+
+// Intel Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode,
+// Shay Gueron and Michael E. Kounavis; the blocks are byte reversed and the product
+// is reduced only once for four blocks (aggregated reduction).
+
+inline __m128i pclmul_reverse(__m128i x)
+{
+    const __m128i mask = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(x, mask);
+}
+
+inline void pclmul_multiply(__m128i& lo, __m128i& hi, __m128i a, __m128i b)
+{
+    __m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+    __m128i t1 = _mm_clmulepi64_si128(a, b, 0x10);
+    __m128i t2 = _mm_clmulepi64_si128(a, b, 0x01);
+    __m128i t3 = _mm_clmulepi64_si128(a, b, 0x11);
+    t1 = _mm_xor_si128(t1, t2);
+    lo = _mm_xor_si128(t0, _mm_slli_si128(t1, 8));
+    hi = _mm_xor_si128(t3, _mm_srli_si128(t1, 8));
+}
+
+inline __m128i pclmul_reduce(__m128i lo, __m128i hi)
+{
+    // shift the 256 bit product left by one bit (the operands are bit reflected)
+    __m128i t7 = _mm_srli_epi32(lo, 31);
+    __m128i t8 = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    __m128i t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    lo = _mm_or_si128(lo, t7);
+    hi = _mm_or_si128(hi, t8);
+    hi = _mm_or_si128(hi, t9);
+
+    // reduce modulo x^128 + x^7 + x^2 + x + 1
+    t7 = _mm_slli_epi32(lo, 31);
+    t8 = _mm_slli_epi32(lo, 30);
+    t9 = _mm_slli_epi32(lo, 25);
+    t7 = _mm_xor_si128(t7, t8);
+    t7 = _mm_xor_si128(t7, t9);
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    lo = _mm_xor_si128(lo, t7);
+
+    __m128i t2 = _mm_srli_epi32(lo, 1);
+    __m128i t4 = _mm_srli_epi32(lo, 2);
+    __m128i t5 = _mm_srli_epi32(lo, 7);
+    t2 = _mm_xor_si128(t2, t4);
+    t2 = _mm_xor_si128(t2, t5);
+    t2 = _mm_xor_si128(t2, t8);
+    lo = _mm_xor_si128(lo, t2);
+    return _mm_xor_si128(hi, lo);
+}
+
+inline __m128i pclmul_gfmul(__m128i a, __m128i b)
+{
+    __m128i lo;
+    __m128i hi;
+    pclmul_multiply(lo, hi, a, b);
+    return pclmul_reduce(lo, hi);
+}
+
+// h[0..3] = H, H^2, H^3, H^4 (byte reversed)
+void pclmul_ghash_powers(__m128i* h, const u8* key)
+{
+    h[0] = pclmul_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(key)));
+    h[1] = pclmul_gfmul(h[0], h[0]);
+    h[2] = pclmul_gfmul(h[1], h[0]);
+    h[3] = pclmul_gfmul(h[2], h[0]);
+}
+
+void pclmul_ghash(u8* state, const __m128i* h, const u8* data, size_t length)
+{
+    __m128i x = pclmul_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state)));
+
+    while (length >= 64)
+    {
+        __m128i d0 = pclmul_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data +  0)));
+        __m128i d1 = pclmul_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16)));
+        __m128i d2 = pclmul_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32)));
+        __m128i d3 = pclmul_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 48)));
+
+        // X = (X + D0) * H^4 + D1 * H^3 + D2 * H^2 + D3 * H
+        __m128i lo, hi;
+        __m128i lo1, hi1;
+        pclmul_multiply(lo, hi, _mm_xor_si128(x, d0), h[3]);
+        pclmul_multiply(lo1, hi1, d1, h[2]);
+        lo = _mm_xor_si128(lo, lo1);
+        hi = _mm_xor_si128(hi, hi1);
+        pclmul_multiply(lo1, hi1, d2, h[1]);
+        lo = _mm_xor_si128(lo, lo1);
+        hi = _mm_xor_si128(hi, hi1);
+        pclmul_multiply(lo1, hi1, d3, h[0]);
+        lo = _mm_xor_si128(lo, lo1);
+        hi = _mm_xor_si128(hi, hi1);
+        x = pclmul_reduce(lo, hi);
+
+        data += 64;
+        length -= 64;
+    }
+
+    while (length > 0)
+    {
+        u8 block[16] = { 0 };
+        size_t bytes = std::min(length, size_t(16));
+        std::memcpy(block, data, bytes);
+
+        __m128i d = pclmul_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block)));
+        x = pclmul_gfmul(_mm_xor_si128(x, d), h[0]);
+
+        data += bytes;
+        length -= bytes;
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state), pclmul_reverse(x));
+}
+
+#endif // defined(__AES__) && defined(__PCLMUL__) && defined(MANGO_ENABLE_SSE4_1)
+
+#if defined(__ARM_FEATURE_CRYPTO) && defined(__aarch64__)
+
+// ----------------------------------------------------------------------------------------
+// ARM PMULL GHASH
+// ----------------------------------------------------------------------------------------
+
+// Implementing GCM on ARMv8, Conrado P. L. Gouvea and Julio Lopez; the bits in every
+// byte are reversed so that the product needs no one bit shift, and like the PCLMUL
+// code the product is reduced only once for four blocks.
+
+inline uint8x16_t pmull_low(uint8x16_t a, uint8x16_t b)
+{
+    poly64_t x = vgetq_lane_p64(vreinterpretq_p64_u8(a), 0);
+    poly64_t y = vgetq_lane_p64(vreinterpretq_p64_u8(b), 0);
+    return vreinterpretq_u8_p128(vmull_p64(x, y));
+}
+
+inline uint8x16_t pmull_high(uint8x16_t a, uint8x16_t b)
+{
+    return vreinterpretq_u8_p128(vmull_high_p64(vreinterpretq_p64_u8(a), vreinterpretq_p64_u8(b)));
+}
+
+// the 256 bit product is hi * x^128 + mid * x^64 + lo
+inline void pmull_multiply(uint8x16_t& lo, uint8x16_t& mid, uint8x16_t& hi, uint8x16_t a, uint8x16_t b)
+{
+    uint8x16_t c = vextq_u8(b, b, 8);
+    lo = pmull_low(a, b);
+    hi = pmull_high(a, b);
+    mid = veorq_u8(pmull_low(a, c), pmull_high(a, c));
+}
+
+inline uint8x16_t pmull_reduce(uint8x16_t lo, uint8x16_t mid, uint8x16_t hi)
+{
+    // reduce modulo x^128 + x^7 + x^2 + x + 1; the high half is folded down
+    // with x^128 = x^7 + x^2 + x + 1 one 64 bit lane at a time
+    const uint8x16_t r = vreinterpretq_u8_u64(vdupq_n_u64(0x87));
+    const uint8x16_t zero = vdupq_n_u8(0);
+
+    mid = veorq_u8(mid, pmull_high(hi, r));
+    lo = veorq_u8(lo, pmull_low(hi, r));
+    lo = veorq_u8(lo, pmull_high(mid, r));
+    return veorq_u8(lo, vextq_u8(zero, mid, 8));
+}
+
+inline uint8x16_t pmull_gfmul(uint8x16_t a, uint8x16_t b)
+{
+    uint8x16_t lo;
+    uint8x16_t mid;
+    uint8x16_t hi;
+    pmull_multiply(lo, mid, hi, a, b);
+    return pmull_reduce(lo, mid, hi);
+}
+
+// h[0..3] = H, H^2, H^3, H^4 (bit reversed)
+void pmull_ghash_powers(uint8x16_t* h, const u8* key)
+{
+    h[0] = vrbitq_u8(vld1q_u8(key));
+    h[1] = pmull_gfmul(h[0], h[0]);
+    h[2] = pmull_gfmul(h[1], h[0]);
+    h[3] = pmull_gfmul(h[2], h[0]);
+}
+
+void pmull_ghash(u8* state, const uint8x16_t* h, const u8* data, size_t length)
+{
+    uint8x16_t x = vrbitq_u8(vld1q_u8(state));
+
+    while (length >= 64)
+    {
+        uint8x16_t d0 = vrbitq_u8(vld1q_u8(data +  0));
+        uint8x16_t d1 = vrbitq_u8(vld1q_u8(data + 16));
+        uint8x16_t d2 = vrbitq_u8(vld1q_u8(data + 32));
+        uint8x16_t d3 = vrbitq_u8(vld1q_u8(data + 48));
+
+        // X = (X + D0) * H^4 + D1 * H^3 + D2 * H^2 + D3 * H
+        uint8x16_t lo, mid, hi;
+        uint8x16_t lo1, mid1, hi1;
+        pmull_multiply(lo, mid, hi, veorq_u8(x, d0), h[3]);
+        pmull_multiply(lo1, mid1, hi1, d1, h[2]);
+        lo = veorq_u8(lo, lo1);
+        mid = veorq_u8(mid, mid1);
+        hi = veorq_u8(hi, hi1);
+        pmull_multiply(lo1, mid1, hi1, d2, h[1]);
+        lo = veorq_u8(lo, lo1);
+        mid = veorq_u8(mid, mid1);
+        hi = veorq_u8(hi, hi1);
+        pmull_multiply(lo1, mid1, hi1, d3, h[0]);
+        lo = veorq_u8(lo, lo1);
+        mid = veorq_u8(mid, mid1);
+        hi = veorq_u8(hi, hi1);
+        x = pmull_reduce(lo, mid, hi);
+
+        data += 64;
+        length -= 64;
+    }
+
+    while (length > 0)
+    {
+        u8 block[16] = { 0 };
+        size_t bytes = std::min(length, size_t(16));
+        std::memcpy(block, data, bytes);
+
+        uint8x16_t d = vrbitq_u8(vld1q_u8(block));
+        x = pmull_gfmul(veorq_u8(x, d), h[0]);
+
+        data += bytes;
+        length -= bytes;
+    }
+
+    vst1q_u8(state, vrbitq_u8(x));
+}
+
+#endif // defined(__ARM_FEATURE_CRYPTO) && defined(__aarch64__)
+
+// ----------------------------------------------------------------------------------------
+// GHASH
+// ----------------------------------------------------------------------------------------
+
+// Shoup's 4 bit table method (portable)
+
+struct GHashTable
+{
+    u64 hl[16];
+    u64 hh[16];
+};
+
+void ghash_table_init(GHashTable& table, const u8* key)
+{
+    u64 vh = bigEndian::uload64(key + 0);
+    u64 vl = bigEndian::uload64(key + 8);
+
+    table.hl[8] = vl;
+    table.hh[8] = vh;
+    table.hl[0] = 0;
+    table.hh[0] = 0;
+
+    for (int i = 4; i > 0; i >>= 1)
+    {
+        u32 t = u32(vl & 1) * 0xe1000000;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ (u64(t) << 32);
+        table.hl[i] = vl;
+        table.hh[i] = vh;
+    }
+
+    for (int i = 2; i <= 8; i *= 2)
+    {
+        vh = table.hh[i];
+        vl = table.hl[i];
+        for (int j = 1; j < i; ++j)
+        {
+            table.hh[i + j] = vh ^ table.hh[j];
+            table.hl[i + j] = vl ^ table.hl[j];
+        }
+    }
+}
+
+void ghash_table_multiply(const GHashTable& table, u8* x)
+{
+    static const u64 last4 [] =
+    {
+        0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+        0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+    };
+
+    int lo = x[15] & 0xf;
+    u64 zh = table.hh[lo];
+    u64 zl = table.hl[lo];
+
+    for (int i = 15; i >= 0; --i)
+    {
+        lo = x[i] & 0xf;
+        int hi = (x[i] >> 4) & 0xf;
+
+        if (i != 15)
+        {
+            int rem = zl & 0xf;
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (last4[rem] << 48);
+            zh ^= table.hh[lo];
+            zl ^= table.hl[lo];
+        }
+
+        int rem = zl & 0xf;
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ (last4[rem] << 48);
+        zh ^= table.hh[hi];
+        zl ^= table.hl[hi];
+    }
+
+    bigEndian::ustore64(x + 0, zh);
+    bigEndian::ustore64(x + 8, zl);
+}
+
+void ghash_table(u8* state, const GHashTable& table, const u8* data, size_t length)
+{
+    while (length > 0)
+    {
+        size_t bytes = std::min(length, size_t(16));
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            state[i] ^= data[i];
+        }
+
+        ghash_table_multiply(table, state);
+
+        data += bytes;
+        length -= bytes;
+    }
+}
+
+// XTS tweak multiplication by x in GF(2^128) (little endian)
+
+void xts_double(u8* tweak)
+{
+    u64 lo = littleEndian::uload64(tweak + 0);
+    u64 hi = littleEndian::uload64(tweak + 8);
+    u64 carry = hi >> 63;
+    hi = (hi << 1) | (lo >> 63);
+    lo = (lo << 1) ^ (carry * 0x87);
+    littleEndian::ustore64(tweak + 0, lo);
+    littleEndian::ustore64(tweak + 8, hi);
+}
+
 } // namespace
 
 namespace mango
@@ -1606,6 +2123,17 @@ struct KeyScheduleAES
     u32 arm_decode_schedule[60];
 #endif
 
+#if defined(__AES__) && defined(__PCLMUL__) && defined(MANGO_ENABLE_SSE4_1)
+    __m128i ghash_powers[4];
+    bool pclmul_supported;
+#endif
+
+#if defined(__ARM_FEATURE_CRYPTO) && defined(__aarch64__)
+    uint8x16_t pmull_powers[4];
+#endif
+
+    GHashTable ghash_table;
+
     u32 schedule[60];
 };
 
@@ -1639,6 +2167,25 @@ AES::AES(const u8* key, int bits)
 #endif
 
     aes_key_setup(key, m_schedule->schedule, bits);
+
+    // GHASH key H = E(K, 0^128)
+    u8 zero[16] = { 0 };
+    u8 h[16];
+    ecb_block_encrypt(h, zero, 16);
+
+    ghash_table_init(m_schedule->ghash_table, h);
+
+#if defined(__AES__) && defined(__PCLMUL__) && defined(MANGO_ENABLE_SSE4_1)
+    m_schedule->pclmul_supported = (getCPUFlags() & INTEL_CLMUL) != 0;
+    if (m_schedule->pclmul_supported)
+    {
+        pclmul_ghash_powers(m_schedule->ghash_powers, h);
+    }
+#endif
+
+#if defined(__ARM_FEATURE_CRYPTO) && defined(__aarch64__)
+    pmull_ghash_powers(m_schedule->pmull_powers, h);
+#endif
 }
 
 AES::~AES()
@@ -1855,4 +2402,301 @@ void AES::ecb_decrypt(u8* output, const u8* input, size_t length)
     }
 }
 
+void AES::gcm_encrypt(Memory output, ConstMemory input, ConstMemory associated, ConstMemory iv, Memory tag)
+{
+    if (output.size < input.size)
+    {
+        MANGO_EXCEPTION("[AES] The output is too small.");
+    }
+
+    if (tag.size != 16)
+    {
+        MANGO_EXCEPTION("[AES] The tag must be 16 bytes.");
+    }
+
+    u8 j0[16];
+    gcm_counter(j0, iv);
+
+    u8 counter[16];
+    std::memcpy(counter, j0, 16);
+    bigEndian::ustore32(counter + 12, bigEndian::uload32(j0 + 12) + 1);
+
+    u8 x[16] = { 0 };
+    gcm_ghash(x, associated.address, associated.size);
+
+    u8* dest = output.address;
+    const u8* source = input.address;
+    size_t length = input.size;
+
+    // the segments are small enough to be in the L1 cache when hashed
+    while (length > 0)
+    {
+        size_t bytes = std::min(length, size_t(1024));
+        gcm_ctr32(dest, source, bytes, counter);
+        gcm_ghash(x, dest, bytes);
+        dest += bytes;
+        source += bytes;
+        length -= bytes;
+    }
+
+    u8 lengths[16];
+    bigEndian::ustore64(lengths + 0, u64(associated.size) * 8);
+    bigEndian::ustore64(lengths + 8, u64(input.size) * 8);
+    gcm_ghash(x, lengths, 16);
+
+    ecb_block_encrypt(tag.address, j0, 16);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        tag.address[i] ^= x[i];
+    }
+}
+
+bool AES::gcm_decrypt(Memory output, ConstMemory input, ConstMemory associated, ConstMemory iv, ConstMemory tag)
+{
+    if (output.size < input.size)
+    {
+        MANGO_EXCEPTION("[AES] The output is too small.");
+    }
+
+    if (tag.size != 16)
+    {
+        MANGO_EXCEPTION("[AES] The tag must be 16 bytes.");
+    }
+
+    u8 j0[16];
+    gcm_counter(j0, iv);
+
+    u8 counter[16];
+    std::memcpy(counter, j0, 16);
+    bigEndian::ustore32(counter + 12, bigEndian::uload32(j0 + 12) + 1);
+
+    u8 x[16] = { 0 };
+    gcm_ghash(x, associated.address, associated.size);
+
+    u8* dest = output.address;
+    const u8* source = input.address;
+    size_t length = input.size;
+
+    while (length > 0)
+    {
+        size_t bytes = std::min(length, size_t(1024));
+        gcm_ghash(x, source, bytes);
+        gcm_ctr32(dest, source, bytes, counter);
+        dest += bytes;
+        source += bytes;
+        length -= bytes;
+    }
+
+    u8 lengths[16];
+    bigEndian::ustore64(lengths + 0, u64(associated.size) * 8);
+    bigEndian::ustore64(lengths + 8, u64(input.size) * 8);
+    gcm_ghash(x, lengths, 16);
+
+    u8 expected[16];
+    ecb_block_encrypt(expected, j0, 16);
+
+    // constant time comparison
+    u8 difference = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        difference |= expected[i] ^ x[i] ^ tag.address[i];
+    }
+
+    if (difference)
+    {
+        // do not release unauthenticated plaintext
+        std::memset(output.address, 0, input.size);
+        return false;
+    }
+
+    return true;
+}
+
+void AES::xts_encrypt(u8* output, const u8* input, size_t length, AES& tweak, u64 sector)
+{
+    xts_crypt(output, input, length, tweak, sector, true);
+}
+
+void AES::xts_decrypt(u8* output, const u8* input, size_t length, AES& tweak, u64 sector)
+{
+    xts_crypt(output, input, length, tweak, sector, false);
+}
+
+void AES::gcm_counter(u8* j0, ConstMemory iv)
+{
+    if (iv.size == 12)
+    {
+        std::memcpy(j0, iv.address, 12);
+        bigEndian::ustore32(j0 + 12, 1);
+    }
+    else
+    {
+        u8 lengths[16];
+        bigEndian::ustore64(lengths + 0, 0);
+        bigEndian::ustore64(lengths + 8, u64(iv.size) * 8);
+
+        std::memset(j0, 0, 16);
+        gcm_ghash(j0, iv.address, iv.size);
+        gcm_ghash(j0, lengths, 16);
+    }
+}
+
+void AES::gcm_ghash(u8* state, const u8* data, size_t length) const
+{
+#if defined(__AES__) && defined(__PCLMUL__) && defined(MANGO_ENABLE_SSE4_1)
+    if (m_schedule->pclmul_supported)
+    {
+        pclmul_ghash(state, m_schedule->ghash_powers, data, length);
+        return;
+    }
+#endif
+
+#if defined(__ARM_FEATURE_CRYPTO) && defined(__aarch64__)
+    pmull_ghash(state, m_schedule->pmull_powers, data, length);
+    return;
+#endif
+
+    ghash_table(state, m_schedule->ghash_table, data, length);
+}
+
+void AES::gcm_ctr32(u8* output, const u8* input, size_t length, u8* counter)
+{
+#if defined(__AES__)
+    if (m_schedule->aesni_supported)
+    {
+        aesni_ctr32_crypt(output, input, length, counter, m_schedule->aesni_schedule, m_bits / 32 + 6);
+        return;
+    }
+#endif
+
+    u8 keystream[128];
+    u32 value = bigEndian::uload32(counter + 12);
+
+    while (length > 0)
+    {
+        size_t bytes = std::min(length, size_t(128));
+        size_t blocks = (bytes + 15) / 16;
+
+        for (size_t i = 0; i < blocks; ++i)
+        {
+            std::memcpy(keystream + i * 16, counter, 12);
+            bigEndian::ustore32(keystream + i * 16 + 12, value++);
+        }
+
+        ecb_block_encrypt(keystream, keystream, blocks * 16);
+
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            output[i] = input[i] ^ keystream[i];
+        }
+
+        output += bytes;
+        input += bytes;
+        length -= bytes;
+    }
+
+    bigEndian::ustore32(counter + 12, value);
+}
+
+void AES::xts_blocks(u8* output, const u8* input, size_t length, u8* tweak, bool encrypt)
+{
+#if defined(__AES__)
+    if (m_schedule->aesni_supported)
+    {
+        aesni_xts_crypt(output, input, length, tweak, m_schedule->aesni_schedule, m_bits / 32 + 6, encrypt);
+        return;
+    }
+#endif
+
+    u8 tweaks[128];
+    u8 buffer[128];
+
+    while (length > 0)
+    {
+        size_t bytes = std::min(length, size_t(128));
+
+        for (size_t i = 0; i < bytes; i += 16)
+        {
+            std::memcpy(tweaks + i, tweak, 16);
+            xts_double(tweak);
+
+            for (size_t j = 0; j < 16; ++j)
+            {
+                buffer[i + j] = input[i + j] ^ tweaks[i + j];
+            }
+        }
+
+        if (encrypt)
+            ecb_block_encrypt(buffer, buffer, bytes);
+        else
+            ecb_block_decrypt(buffer, buffer, bytes);
+
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            output[i] = buffer[i] ^ tweaks[i];
+        }
+
+        output += bytes;
+        input += bytes;
+        length -= bytes;
+    }
+}
+
+void AES::xts_crypt(u8* output, const u8* input, size_t length, AES& tweak, u64 sector, bool encrypt)
+{
+    if (length < 16)
+    {
+        MANGO_EXCEPTION("[AES] The XTS data unit must be at least 16 bytes.");
+    }
+
+    u8 t[16];
+    littleEndian::ustore64(t + 0, sector);
+    littleEndian::ustore64(t + 8, 0);
+    tweak.ecb_block_encrypt(t, t, 16);
+
+    const size_t tail = length & 15;
+    const size_t bulk = tail ? length - tail - 16 : length;
+
+    xts_blocks(output, input, bulk, t, encrypt);
+
+    if (!tail)
+    {
+        return;
+    }
+
+    // ciphertext stealing for the incomplete last block
+    output += bulk;
+    input += bulk;
+
+    u8 temp[16];
+    u8 block[16];
+
+    if (encrypt)
+    {
+        xts_blocks(temp, input, 16, t, true);
+
+        std::memcpy(block, input + 16, tail);
+        std::memcpy(block + tail, temp + tail, 16 - tail);
+        std::memcpy(output + 16, temp, tail);
+
+        xts_blocks(output, block, 16, t, true);
+    }
+    else
+    {
+        // the last complete block uses the tweak of the incomplete block
+        u8 next[16];
+        std::memcpy(next, t, 16);
+        xts_double(next);
+
+        xts_blocks(temp, input, 16, next, false);
+
+        std::memcpy(block, input + 16, tail);
+        std::memcpy(block + tail, temp + tail, 16 - tail);
+        std::memcpy(output + 16, temp, tail);
+
+        xts_blocks(output, block, 16, t, false);
+    }
+}
+
 } // namespace mango
@@ -0,0 +1,589 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/core/hash.hpp>
+#include <mango/core/bits.hpp>
+#include <mango/core/endian.hpp>
+#include <mango/core/thread.hpp>
+#include <mango/simd/simd.hpp>
+
+/*
+    BLAKE3
+
+    The input is split into 1 KB chunks which are the leaves of a binary tree. The
+    chunks are hashed in parallel in SIMD lanes, the complete subtrees of large
+    inputs in the ThreadPool, and the chaining values are merged into parent nodes
+    up to the root. Only the default hashing mode with 256 bit output is supported.
+*/
+
+namespace
+{
+    using namespace mango;
+
+    constexpr size_t BLAKE3_BLOCK_SIZE = 64;
+    constexpr size_t BLAKE3_CHUNK_SIZE = 1024;
+
+    enum : u32
+    {
+        CHUNK_START = 1 << 0,
+        CHUNK_END   = 1 << 1,
+        PARENT      = 1 << 2,
+        ROOT        = 1 << 3,
+    };
+
+    const u32 g_iv [] =
+    {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    const u8 g_schedule [7][16] =
+    {
+        { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+        { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+        { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+        { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+        { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+        { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+        { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+    };
+
+    // ----------------------------------------------------------------------------------------
+    // vector
+    // ----------------------------------------------------------------------------------------
+
+#if defined(MANGO_ENABLE_AVX512)
+
+    using HashVector = simd::u32x16;
+    constexpr int HashLanes = 16;
+
+    inline HashVector hash_load(const u32* p) { return simd::u32x16_uload(p); }
+    inline void hash_store(u32* p, HashVector v) { simd::u32x16_ustore(p, v); }
+    inline HashVector hash_set(u32 s) { return simd::u32x16_set(s); }
+
+#elif defined(MANGO_ENABLE_AVX2)
+
+    using HashVector = simd::u32x8;
+    constexpr int HashLanes = 8;
+
+    inline HashVector hash_load(const u32* p) { return simd::u32x8_uload(p); }
+    inline void hash_store(u32* p, HashVector v) { simd::u32x8_ustore(p, v); }
+    inline HashVector hash_set(u32 s) { return simd::u32x8_set(s); }
+
+#else
+
+    using HashVector = simd::u32x4;
+    constexpr int HashLanes = 4;
+
+    inline HashVector hash_load(const u32* p) { return simd::u32x4_uload(p); }
+    inline void hash_store(u32* p, HashVector v) { simd::u32x4_ustore(p, v); }
+    inline HashVector hash_set(u32 s) { return simd::u32x4_set(s); }
+
+#endif
+
+    inline HashVector operator + (HashVector a, HashVector b) { return simd::add(a, b); }
+    inline HashVector operator ^ (HashVector a, HashVector b) { return simd::bitwise_xor(a, b); }
+
+    template <int n>
+    inline u32 ror(u32 a)
+    {
+        return (a >> n) | (a << (32 - n));
+    }
+
+    template <int n>
+    inline HashVector ror(HashVector a)
+    {
+        return simd::bitwise_or(simd::srli<n>(a), simd::slli<32 - n>(a));
+    }
+
+    // ----------------------------------------------------------------------------------------
+    // compression function
+    // ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    inline void g(T* v, int a, int b, int c, int d, T x, T y)
+    {
+        v[a] = v[a] + v[b] + x;
+        v[d] = ror<16>(v[d] ^ v[a]);
+        v[c] = v[c] + v[d];
+        v[b] = ror<12>(v[b] ^ v[c]);
+        v[a] = v[a] + v[b] + y;
+        v[d] = ror<8>(v[d] ^ v[a]);
+        v[c] = v[c] + v[d];
+        v[b] = ror<7>(v[b] ^ v[c]);
+    }
+
+    template <typename T>
+    inline void rounds(T* v, const T* m)
+    {
+        for (int i = 0; i < 7; ++i)
+        {
+            const u8* s = g_schedule[i];
+
+            // columns
+            g(v, 0, 4,  8, 12, m[s[ 0]], m[s[ 1]]);
+            g(v, 1, 5,  9, 13, m[s[ 2]], m[s[ 3]]);
+            g(v, 2, 6, 10, 14, m[s[ 4]], m[s[ 5]]);
+            g(v, 3, 7, 11, 15, m[s[ 6]], m[s[ 7]]);
+
+            // diagonals
+            g(v, 0, 5, 10, 15, m[s[ 8]], m[s[ 9]]);
+            g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+            g(v, 2, 7,  8, 13, m[s[12]], m[s[13]]);
+            g(v, 3, 4,  9, 14, m[s[14]], m[s[15]]);
+        }
+    }
+
+    void compress(u32 cv[8], const u8* block, u32 block_size, u64 counter, u32 flags)
+    {
+        u32 m[16];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            m[i] = littleEndian::uload32(block + i * 4);
+        }
+
+        u32 v[16] =
+        {
+            cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+            g_iv[0], g_iv[1], g_iv[2], g_iv[3],
+            u32(counter), u32(counter >> 32), block_size, flags
+        };
+
+        rounds(v, m);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            cv[i] = v[i] ^ v[i + 8];
+        }
+    }
+
+    void parent_cv(u32 cv[8], const u32* left, const u32* right, u32 flags = 0)
+    {
+        u8 block[64];
+
+        for (int i = 0; i < 8; ++i)
+        {
+            littleEndian::ustore32(block + i * 4 + 0, left[i]);
+            littleEndian::ustore32(block + i * 4 + 32, right[i]);
+        }
+
+        std::memcpy(cv, g_iv, 32);
+        compress(cv, block, 64, 0, PARENT | flags);
+    }
+
+    // ----------------------------------------------------------------------------------------
+    // chunks
+    // ----------------------------------------------------------------------------------------
+
+    // hash HashLanes full chunks in parallel; each lane compresses one chunk
+    void hash_chunks_simd(u32* cvs, const u8* input, u64 counter)
+    {
+        alignas(64) u32 temp[HashLanes];
+        alignas(64) u32 temp_hi[HashLanes];
+
+        for (int lane = 0; lane < HashLanes; ++lane)
+        {
+            temp[lane] = u32(counter + lane);
+            temp_hi[lane] = u32((counter + lane) >> 32);
+        }
+
+        const HashVector counter_lo = hash_load(temp);
+        const HashVector counter_hi = hash_load(temp_hi);
+
+        HashVector cv[8];
+
+        for (int i = 0; i < 8; ++i)
+        {
+            cv[i] = hash_set(g_iv[i]);
+        }
+
+        for (size_t block = 0; block < BLAKE3_CHUNK_SIZE / BLAKE3_BLOCK_SIZE; ++block)
+        {
+            HashVector m[16];
+
+            for (int i = 0; i < 16; ++i)
+            {
+                const u8* source = input + block * BLAKE3_BLOCK_SIZE + i * 4;
+
+                for (int lane = 0; lane < HashLanes; ++lane)
+                {
+                    temp[lane] = littleEndian::uload32(source + lane * BLAKE3_CHUNK_SIZE);
+                }
+
+                m[i] = hash_load(temp);
+            }
+
+            u32 flags = 0;
+            flags |= block == 0 ? CHUNK_START : 0;
+            flags |= block == 15 ? CHUNK_END : 0;
+
+            HashVector v[16] =
+            {
+                cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                hash_set(g_iv[0]), hash_set(g_iv[1]), hash_set(g_iv[2]), hash_set(g_iv[3]),
+                counter_lo, counter_hi, hash_set(u32(BLAKE3_BLOCK_SIZE)), hash_set(flags)
+            };
+
+            rounds(v, m);
+
+            for (int i = 0; i < 8; ++i)
+            {
+                cv[i] = v[i] ^ v[i + 8];
+            }
+        }
+
+        for (int i = 0; i < 8; ++i)
+        {
+            hash_store(temp, cv[i]);
+
+            for (int lane = 0; lane < HashLanes; ++lane)
+            {
+                cvs[lane * 8 + i] = temp[lane];
+            }
+        }
+    }
+
+    void hash_chunk(u32* cv, const u8* input, u64 counter)
+    {
+        std::memcpy(cv, g_iv, 32);
+
+        for (size_t block = 0; block < BLAKE3_CHUNK_SIZE / BLAKE3_BLOCK_SIZE; ++block)
+        {
+            u32 flags = 0;
+            flags |= block == 0 ? CHUNK_START : 0;
+            flags |= block == 15 ? CHUNK_END : 0;
+            compress(cv, input + block * BLAKE3_BLOCK_SIZE, BLAKE3_BLOCK_SIZE, counter, flags);
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------
+    // subtrees
+    // ----------------------------------------------------------------------------------------
+
+    // chaining value of a complete subtree; chunks is a power of two
+    void hash_subtree(u32 cv[8], const u8* input, size_t chunks, u64 counter)
+    {
+        constexpr size_t batch = 64;
+
+        if (chunks > batch)
+        {
+            u32 left[8];
+            u32 right[8];
+
+            size_t half = chunks / 2;
+            hash_subtree(left, input, half, counter);
+            hash_subtree(right, input + half * BLAKE3_CHUNK_SIZE, half, counter + half);
+            parent_cv(cv, left, right);
+            return;
+        }
+
+        u32 cvs[batch * 8];
+        size_t i = 0;
+
+        for ( ; i + HashLanes <= chunks; i += HashLanes)
+        {
+            hash_chunks_simd(cvs + i * 8, input + i * BLAKE3_CHUNK_SIZE, counter + i);
+        }
+
+        for ( ; i < chunks; ++i)
+        {
+            hash_chunk(cvs + i * 8, input + i * BLAKE3_CHUNK_SIZE, counter + i);
+        }
+
+        // reduce to the root of the subtree
+        for ( ; chunks > 1; chunks /= 2)
+        {
+            for (size_t j = 0; j < chunks / 2; ++j)
+            {
+                parent_cv(cvs + j * 8, cvs + j * 16, cvs + j * 16 + 8);
+            }
+        }
+
+        std::memcpy(cv, cvs, 32);
+    }
+
+    // chaining values of the two children of a complete subtree (chunks >= 2)
+    void hash_subtree_children(u32 left[8], u32 right[8], const u8* input, size_t chunks, u64 counter)
+    {
+        // the pieces are large enough that the task overhead is insignificant
+        constexpr size_t piece_chunks = 256;
+
+        size_t pieces = 1;
+
+        if (chunks >= piece_chunks * 2)
+        {
+            size_t limit = u32_ceil_power_of_two(u32(ThreadPool::getInstance().size() * 4));
+            pieces = std::min(chunks / piece_chunks, limit);
+            pieces = std::max(pieces, size_t(2));
+        }
+
+        if (pieces < 2)
+        {
+            size_t half = chunks / 2;
+            hash_subtree(left, input, half, counter);
+            hash_subtree(right, input + half * BLAKE3_CHUNK_SIZE, half, counter + half);
+            return;
+        }
+
+        // pieces and chunks are powers of two so every piece is a complete subtree
+        std::vector<u32> cvs(pieces * 8);
+        const size_t size = chunks / pieces;
+
+        ConcurrentQueue q;
+
+        for (size_t i = 0; i < pieces; ++i)
+        {
+            q.enqueue([&, i]
+            {
+                hash_subtree(cvs.data() + i * 8, input + i * size * BLAKE3_CHUNK_SIZE, size, counter + i * size);
+            });
+        }
+
+        q.wait();
+
+        for ( ; pieces > 2; pieces /= 2)
+        {
+            for (size_t j = 0; j < pieces / 2; ++j)
+            {
+                parent_cv(cvs.data() + j * 8, cvs.data() + j * 16, cvs.data() + j * 16 + 8);
+            }
+        }
+
+        std::memcpy(left, cvs.data() + 0, 32);
+        std::memcpy(right, cvs.data() + 8, 32);
+    }
+
+    BLAKE3 store_hash(const u32* cv)
+    {
+        BLAKE3 hash;
+
+        // the digest is the little endian byte sequence of the chaining value
+        for (int i = 0; i < 8; ++i)
+        {
+            littleEndian::ustore32(reinterpret_cast<u8*>(hash.data + i), cv[i]);
+        }
+
+        return hash;
+    }
+
+} // namespace
+
+namespace mango
+{
+
+    // -----------------------------------------------------------------------
+    // BLAKE3Context
+    // -----------------------------------------------------------------------
+
+    BLAKE3Context::BLAKE3Context()
+    {
+        reset();
+    }
+
+    void BLAKE3Context::reset()
+    {
+        std::memcpy(m_cv, g_iv, 32);
+        m_block_size = 0;
+        m_blocks_compressed = 0;
+        m_chunk_counter = 0;
+        m_stack_size = 0;
+    }
+
+    void BLAKE3Context::mergeStack(u64 total_chunks)
+    {
+        // merging is lazy; the stack keeps one entry per bit set in the chunk counter
+        // so that the last subtree is never merged before it is known not to be the root
+        const int size = u64_popcnt(total_chunks);
+
+        while (m_stack_size > size)
+        {
+            u32* left = m_stack[m_stack_size - 2];
+            u32* right = m_stack[m_stack_size - 1];
+            parent_cv(left, left, right);
+            --m_stack_size;
+        }
+    }
+
+    void BLAKE3Context::pushStack(const u32* cv, u64 chunk_counter)
+    {
+        mergeStack(chunk_counter);
+        std::memcpy(m_stack[m_stack_size++], cv, 32);
+    }
+
+    void BLAKE3Context::update(ConstMemory memory)
+    {
+        const u8* data = memory.address;
+        size_t size = memory.size;
+
+        // continue the current chunk
+        size_t chunk_size = m_blocks_compressed * BLAKE3_BLOCK_SIZE + m_block_size;
+
+        if (chunk_size > 0)
+        {
+            while (size > 0)
+            {
+                if (m_block_size == BLAKE3_BLOCK_SIZE)
+                {
+                    if (m_blocks_compressed == 15)
+                    {
+                        // the chunk is complete and there is more input; it is not the root
+                        compress(m_cv, m_block, BLAKE3_BLOCK_SIZE, m_chunk_counter, CHUNK_END);
+                        pushStack(m_cv, m_chunk_counter);
+
+                        std::memcpy(m_cv, g_iv, 32);
+                        m_block_size = 0;
+                        m_blocks_compressed = 0;
+                        ++m_chunk_counter;
+                        break;
+                    }
+
+                    u32 flags = m_blocks_compressed ? 0 : CHUNK_START;
+                    compress(m_cv, m_block, BLAKE3_BLOCK_SIZE, m_chunk_counter, flags);
+                    m_block_size = 0;
+                    ++m_blocks_compressed;
+                }
+
+                size_t bytes = std::min(size, BLAKE3_BLOCK_SIZE - m_block_size);
+                std::memcpy(m_block + m_block_size, data, bytes);
+                m_block_size += u32(bytes);
+                data += bytes;
+                size -= bytes;
+            }
+        }
+
+        // complete subtrees
+        while (size > BLAKE3_CHUNK_SIZE)
+        {
+            // largest power of two which fits into the input and is aligned with the tree
+            u64 subtree_size = u64(1) << u64_log2(size);
+            const u64 offset = m_chunk_counter * BLAKE3_CHUNK_SIZE;
+
+            while (((subtree_size - 1) & offset) != 0)
+            {
+                subtree_size /= 2;
+            }
+
+            const size_t subtree_chunks = size_t(subtree_size / BLAKE3_CHUNK_SIZE);
+
+            if (subtree_chunks == 1)
+            {
+                u32 cv[8];
+                hash_chunk(cv, data, m_chunk_counter);
+                pushStack(cv, m_chunk_counter);
+            }
+            else
+            {
+                // the children are pushed separately; the subtree could still be the root
+                u32 left[8];
+                u32 right[8];
+                hash_subtree_children(left, right, data, subtree_chunks, m_chunk_counter);
+                pushStack(left, m_chunk_counter);
+                pushStack(right, m_chunk_counter + subtree_chunks / 2);
+            }
+
+            m_chunk_counter += subtree_chunks;
+            data += subtree_size;
+            size -= size_t(subtree_size);
+        }
+
+        // the remaining input starts a new chunk
+        if (size > 0)
+        {
+            while (size > 0)
+            {
+                if (m_block_size == BLAKE3_BLOCK_SIZE)
+                {
+                    u32 flags = m_blocks_compressed ? 0 : CHUNK_START;
+                    compress(m_cv, m_block, BLAKE3_BLOCK_SIZE, m_chunk_counter, flags);
+                    m_block_size = 0;
+                    ++m_blocks_compressed;
+                }
+
+                size_t bytes = std::min(size, BLAKE3_BLOCK_SIZE - m_block_size);
+                std::memcpy(m_block + m_block_size, data, bytes);
+                m_block_size += u32(bytes);
+                data += bytes;
+                size -= bytes;
+            }
+
+            mergeStack(m_chunk_counter);
+        }
+    }
+
+    BLAKE3 BLAKE3Context::final() const
+    {
+        u32 cv[8];
+        u8 block[64];
+        u32 block_size;
+        u64 counter;
+        u32 flags;
+        int stack_size = m_stack_size;
+
+        const size_t chunk_size = m_blocks_compressed * BLAKE3_BLOCK_SIZE + m_block_size;
+
+        if (chunk_size > 0 || !stack_size)
+        {
+            // the current chunk is the output node
+            std::memcpy(cv, m_cv, 32);
+            std::memset(block, 0, 64);
+            std::memcpy(block, m_block, m_block_size);
+            block_size = m_block_size;
+            counter = m_chunk_counter;
+            flags = CHUNK_END | (m_blocks_compressed ? 0 : CHUNK_START);
+        }
+        else
+        {
+            // the parent of the two top-most subtrees is the output node
+            stack_size -= 2;
+
+            std::memcpy(cv, g_iv, 32);
+            for (int i = 0; i < 8; ++i)
+            {
+                littleEndian::ustore32(block + i * 4 + 0, m_stack[stack_size + 0][i]);
+                littleEndian::ustore32(block + i * 4 + 32, m_stack[stack_size + 1][i]);
+            }
+            block_size = 64;
+            counter = 0;
+            flags = PARENT;
+        }
+
+        // merge the output node with the stack towards the root
+        while (stack_size > 0)
+        {
+            compress(cv, block, block_size, counter, flags);
+
+            --stack_size;
+            const u32* left = m_stack[stack_size];
+
+            u32 right[8];
+            std::memcpy(right, cv, 32);
+
+            std::memcpy(cv, g_iv, 32);
+            for (int i = 0; i < 8; ++i)
+            {
+                littleEndian::ustore32(block + i * 4 + 0, left[i]);
+                littleEndian::ustore32(block + i * 4 + 32, right[i]);
+            }
+            block_size = 64;
+            counter = 0;
+            flags = PARENT;
+        }
+
+        compress(cv, block, block_size, counter, flags | ROOT);
+
+        return store_hash(cv);
+    }
+
+    // -----------------------------------------------------------------------
+    // blake3()
+    // -----------------------------------------------------------------------
+
+    BLAKE3 blake3(ConstMemory memory)
+    {
+        BLAKE3Context context;
+        context.update(memory);
+        return context.final();
+    }
+
+} // namespace mango
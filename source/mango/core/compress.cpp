@@ -11,6 +11,9 @@
 #include <mango/core/bits.hpp>
 #include <mango/core/endian.hpp>
 #include <mango/core/pointer.hpp>
+#include <mango/core/thread.hpp>
+#include <mango/core/hash.hpp>
+#include <mango/core/crc32.hpp>
 #include <mango/math/math.hpp>
 
 #include "../../external/lz4/lz4.h"
@@ -259,6 +262,104 @@ namespace lz4
         return std::make_shared<StreamDecoderLZ4>();
     }
 
+    // dictionary
+
+    class DictionaryLZ4 : public CompressionDictionary
+    {
+    public:
+        Buffer m_buffer;
+        LZ4_stream_t* m_stream;
+        int m_acceleration;
+
+        DictionaryLZ4(ConstMemory dictionary, int level)
+        {
+            // lz4 can only reference the last 64 KB
+            const size_t size = std::min(dictionary.size, size_t(64 * 1024));
+            m_buffer.append(dictionary.address + dictionary.size - size, size);
+
+            level = math::clamp(level, 0, 6);
+            m_acceleration = 19 - level * 3;
+
+            m_stream = LZ4_createStream();
+            LZ4_loadDict(m_stream, reinterpret_cast<const char*>(m_buffer.data()), int(size));
+        }
+
+        ~DictionaryLZ4()
+        {
+            LZ4_freeStream(m_stream);
+        }
+
+        ConstMemory memory() const override
+        {
+            return m_buffer;
+        }
+    };
+
+    struct ContextLZ4
+    {
+        LZ4_stream_t* stream;
+
+        ContextLZ4()
+        {
+            stream = LZ4_createStream();
+        }
+
+        ~ContextLZ4()
+        {
+            LZ4_freeStream(stream);
+        }
+    };
+
+    static thread_local ContextLZ4 g_context;
+
+    std::shared_ptr<CompressionDictionary> createDictionary(ConstMemory dictionary, int level)
+    {
+        return std::make_shared<DictionaryLZ4>(dictionary, level);
+    }
+
+    CompressionStatus compress(Memory dest, ConstMemory source, const CompressionDictionary& dictionary)
+    {
+        CompressionStatus status;
+
+        const DictionaryLZ4* dict = dynamic_cast<const DictionaryLZ4*>(&dictionary);
+        if (!dict)
+        {
+            status.setError("[lz4] Incorrect dictionary.");
+            return status;
+        }
+
+        // the digested dictionary is attached to a per-thread working stream
+        LZ4_resetStream_fast(g_context.stream);
+        LZ4_attach_dictionary(g_context.stream, dict->m_stream);
+
+        int bytes = LZ4_compress_fast_continue(g_context.stream, source.cast<const char>(), dest.cast<char>(),
+            int(source.size), int(dest.size), dict->m_acceleration);
+        if (bytes <= 0 && source.size)
+        {
+            status.setError("[lz4] compression failed.");
+        }
+
+        status.size = std::max(bytes, 0);
+        return status;
+    }
+
+    CompressionStatus decompress(Memory dest, ConstMemory source, const CompressionDictionary& dictionary)
+    {
+        CompressionStatus status;
+
+        ConstMemory dict = dictionary.memory();
+
+        int result = LZ4_decompress_safe_usingDict(source.cast<const char>(), dest.cast<char>(),
+            int(source.size), int(dest.size), dict.cast<const char>(), int(dict.size));
+        if (result < 0)
+        {
+            status.setError("[lz4] decompression failed.");
+        }
+
+        status.size = dest.size;
+        return status;
+    }
+
 } // namespace lz4
 
 #ifdef MANGO_LICENSE_ENABLE_GPL
@@ -472,6 +573,105 @@ namespace zstd
         return std::make_shared<StreamDecoderZSTD>();
     }
 
+    // dictionary
+
+    class DictionaryZSTD : public CompressionDictionary
+    {
+    public:
+        Buffer m_buffer;
+        ZSTD_CDict* m_cdict;
+        ZSTD_DDict* m_ddict;
+
+        DictionaryZSTD(ConstMemory dictionary, int level)
+            : m_buffer(dictionary)
+        {
+            level = math::clamp(level * 2, 1, 20);
+            m_cdict = ZSTD_createCDict(m_buffer.data(), m_buffer.size(), level);
+            m_ddict = ZSTD_createDDict(m_buffer.data(), m_buffer.size());
+        }
+
+        ~DictionaryZSTD()
+        {
+            ZSTD_freeCDict(m_cdict);
+            ZSTD_freeDDict(m_ddict);
+        }
+
+        ConstMemory memory() const override
+        {
+            return m_buffer;
+        }
+    };
+
+    struct ContextZSTD
+    {
+        ZSTD_CCtx* cctx;
+        ZSTD_DCtx* dctx;
+
+        ContextZSTD()
+        {
+            cctx = ZSTD_createCCtx();
+            dctx = ZSTD_createDCtx();
+        }
+
+        ~ContextZSTD()
+        {
+            ZSTD_freeCCtx(cctx);
+            ZSTD_freeDCtx(dctx);
+        }
+    };
+
+    static thread_local ContextZSTD g_context;
+
+    std::shared_ptr<CompressionDictionary> createDictionary(ConstMemory dictionary, int level)
+    {
+        return std::make_shared<DictionaryZSTD>(dictionary, level);
+    }
+
+    CompressionStatus compress(Memory dest, ConstMemory source, const CompressionDictionary& dictionary)
+    {
+        CompressionStatus status;
+
+        const DictionaryZSTD* dict = dynamic_cast<const DictionaryZSTD*>(&dictionary);
+        if (!dict || !dict->m_cdict)
+        {
+            status.setError("[zstd] Incorrect dictionary.");
+            return status;
+        }
+
+        size_t x = ZSTD_compress_usingCDict(g_context.cctx, dest.address, dest.size,
+            source.address, source.size, dict->m_cdict);
+        if (ZSTD_isError(x))
+        {
+            status.setError("[zstd] {}", ZSTD_getErrorName(x));
+            return status;
+        }
+
+        status.size = x;
+        return status;
+    }
+
+    CompressionStatus decompress(Memory dest, ConstMemory source, const CompressionDictionary& dictionary)
+    {
+        CompressionStatus status;
+
+        const DictionaryZSTD* dict = dynamic_cast<const DictionaryZSTD*>(&dictionary);
+        if (!dict || !dict->m_ddict)
+        {
+            status.setError("[zstd] Incorrect dictionary.");
+            return status;
+        }
+
+        size_t x = ZSTD_decompress_usingDDict(g_context.dctx, dest.address, dest.size,
+            source.address, source.size, dict->m_ddict);
+        if (ZSTD_isError(x))
+        {
+            status.setError("[zstd] {}", ZSTD_getErrorName(x));
+        }
+
+        status.size = dest.size;
+        return status;
+    }
+
 } // namespace zstd
 
 #ifdef MANGO_LICENSE_ENABLE_ZLIB
@@ -757,9 +957,10 @@ namespace lzma
         SizeT dest_length = dest.size;
         SizeT source_length = source.size;
 
+        // the end mark terminates the stream for the streaming decompressor
         SRes result = LzmaEncode(
             dest.address, &dest_length, source.address, source_length,
-            &props, props_output, &props_output_size, 0,
+            &props, props_output, &props_output_size, 1,
             nullptr, &g_Alloc, &g_Alloc);
 
         CompressionStatus status;
@@ -1441,4 +1642,1405 @@ namespace isal
         return compressor;
     }
 
+// ----------------------------------------------------------------------------
+// dictionary
+// ----------------------------------------------------------------------------
+
+    // The trainer is a simplified COVER algorithm: the samples are split into epochs
+    // and from each epoch the segment with the most frequent d-mers is selected. The
+    // frequency counts in how many samples a d-mer occurs. The d-mers of a selected
+    // segment are cleared so that the segments do not repeat the same content. The
+    // best segments are placed last, closest to the data being compressed.
+
+    size_t trainDictionary(Memory dest, const std::vector<ConstMemory>& samples)
+    {
+        constexpr size_t dmer = 8;
+        constexpr int table_bits = 20;
+
+        const size_t capacity = dest.size;
+        const size_t segment_size = math::clamp(capacity / 64, size_t(64), size_t(1024));
+
+        Buffer data;
+
+        for (const ConstMemory& sample : samples)
+        {
+            data.append(sample);
+        }
+
+        if (capacity < segment_size || data.size() < segment_size)
+        {
+            return 0;
+        }
+
+        auto hash = [] (const u8* p) -> u32
+        {
+            u64 value = uload64(p);
+            return u32((value * 0x9e3779b185ebca87ull) >> (64 - table_bits));
+        };
+
+        std::vector<u32> frequency(size_t(1) << table_bits, 0);
+        std::vector<u32> last(size_t(1) << table_bits, 0xffffffff);
+
+        size_t offset = 0;
+
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const u8* p = data.data() + offset;
+            const size_t size = samples[i].size;
+
+            for (size_t j = 0; j + dmer <= size; ++j)
+            {
+                u32 h = hash(p + j);
+                if (last[h] != u32(i))
+                {
+                    last[h] = u32(i);
+                    ++frequency[h];
+                }
+            }
+
+            offset += size;
+        }
+
+        struct Segment
+        {
+            size_t offset;
+            u64 score;
+        };
+
+        std::vector<Segment> segments;
+
+        const size_t epochs = std::max(size_t(1), capacity / segment_size);
+        const size_t epoch_size = std::max(segment_size, data.size() / epochs);
+
+        const size_t dmers_per_segment = segment_size - dmer + 1;
+
+        for (size_t begin = 0; begin + segment_size <= data.size(); begin += epoch_size)
+        {
+            const size_t end = std::min(data.size(), begin + epoch_size);
+            const u8* p = data.data();
+
+            // sliding window score over the epoch
+            u64 score = 0;
+
+            for (size_t i = 0; i < dmers_per_segment; ++i)
+            {
+                score += frequency[hash(p + begin + i)];
+            }
+
+            Segment best = { begin, score };
+
+            for (size_t i = begin + 1; i + segment_size <= end; ++i)
+            {
+                score -= frequency[hash(p + i - 1)];
+                score += frequency[hash(p + i + dmers_per_segment - 1)];
+
+                if (score > best.score)
+                {
+                    best = { i, score };
+                }
+            }
+
+            if (best.score > dmers_per_segment)
+            {
+                segments.push_back(best);
+
+                for (size_t i = 0; i < dmers_per_segment; ++i)
+                {
+                    frequency[hash(p + best.offset + i)] = 0;
+                }
+            }
+        }
+
+        // the best segments are placed at the end of the dictionary
+        std::sort(segments.begin(), segments.end(), [] (const Segment& a, const Segment& b)
+        {
+            return a.score > b.score;
+        });
+
+        segments.resize(std::min(segments.size(), capacity / segment_size));
+
+        size_t size = segments.size() * segment_size;
+        u8* output = dest.address + size;
+
+        for (const Segment& segment : segments)
+        {
+            output -= segment_size;
+            std::memcpy(output, data.data() + segment.offset, segment_size);
+        }
+
+        return size;
+    }
+
+// ----------------------------------------------------------------------------
+// streaming
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+    // The decompressors loop until the output is full, the input is exhausted
+    // or the end of the compressed stream is reached.
+
+    class StreamingDecompressorZSTD : public StreamingDecompressor
+    {
+    protected:
+        ZSTD_DStream* z;
+        bool m_end = false;
+
+    public:
+        StreamingDecompressorZSTD()
+        {
+            z = ZSTD_createDStream();
+            ZSTD_initDStream(z);
+        }
+
+        ~StreamingDecompressorZSTD()
+        {
+            ZSTD_freeDStream(z);
+        }
+
+        StreamingStatus decompress(Memory dest, ConstMemory source) override
+        {
+            StreamingStatus status;
+
+            ZSTD_inBuffer input = { source.address, source.size, 0 };
+            ZSTD_outBuffer output = { dest.address, dest.size, 0 };
+
+            for (;;)
+            {
+                size_t in = input.pos;
+                size_t out = output.pos;
+
+                size_t x = ZSTD_decompressStream(z, &output, &input);
+                if (ZSTD_isError(x))
+                {
+                    status.setError("[zstd] {}", ZSTD_getErrorName(x));
+                    break;
+                }
+
+                // the frame has ended until the next one consumes input
+                if (x == 0)
+                {
+                    m_end = true;
+                }
+                else if (in != input.pos)
+                {
+                    m_end = false;
+                }
+
+                if (output.pos == output.size || (in == input.pos && out == output.pos))
+                {
+                    break;
+                }
+
+                if (input.pos == input.size && m_end)
+                {
+                    break;
+                }
+            }
+
+            status.done = m_end;
+            status.consumed = input.pos;
+            status.produced = output.pos;
+            return status;
+        }
+    };
+
+    class StreamingDecompressorLZMA : public StreamingDecompressor
+    {
+    protected:
+        CLzmaDec m_state;
+        u8 m_props[LZMA_PROPS_SIZE];
+        size_t m_props_size = 0;
+        bool m_end = false;
+
+    public:
+        StreamingDecompressorLZMA()
+        {
+            LzmaDec_Construct(&m_state);
+        }
+
+        ~StreamingDecompressorLZMA()
+        {
+            LzmaDec_Free(&m_state, &g_Alloc);
+        }
+
+        StreamingStatus decompress(Memory dest, ConstMemory source) override
+        {
+            StreamingStatus status;
+
+            if (m_props_size < LZMA_PROPS_SIZE)
+            {
+                // the props header can be split between calls
+                size_t bytes = std::min(LZMA_PROPS_SIZE - m_props_size, source.size);
+                std::memcpy(m_props + m_props_size, source.address, bytes);
+                m_props_size += bytes;
+                status.consumed = bytes;
+
+                if (m_props_size < LZMA_PROPS_SIZE)
+                {
+                    return status;
+                }
+
+                SRes result = LzmaDec_Allocate(&m_state, m_props, LZMA_PROPS_SIZE, &g_Alloc);
+
+                const char* error = lzma::get_error_string(result);
+                if (error)
+                {
+                    status.setError("[lzma] {}", error);
+                    return status;
+                }
+
+                LzmaDec_Init(&m_state);
+            }
+
+            SizeT destLen = dest.size;
+            SizeT srcLen = source.size - status.consumed;
+
+            ELzmaStatus st;
+            SRes result = LzmaDec_DecodeToBuf(&m_state, dest.address, &destLen,
+                source.address + status.consumed, &srcLen, LZMA_FINISH_ANY, &st);
+
+            const char* error = lzma::get_error_string(result);
+            if (error)
+            {
+                status.setError("[lzma] {}", error);
+            }
+
+            // the end of stream is known only from the end mark
+            if (st == LZMA_STATUS_FINISHED_WITH_MARK)
+            {
+                m_end = true;
+            }
+
+            status.done = m_end;
+            status.consumed += srcLen;
+            status.produced = destLen;
+            return status;
+        }
+    };
+
+#ifdef MANGO_LICENSE_ENABLE_ZLIB
+
+    class StreamingDecompressorZLIB : public StreamingDecompressor
+    {
+    protected:
+        z_stream m_stream;
+        int m_init;
+        bool m_multi_member;
+        bool m_end = false;
+        const char* m_name;
+
+    public:
+        StreamingDecompressorZLIB(int window_bits, bool multi_member, const char* name)
+            : m_multi_member(multi_member)
+            , m_name(name)
+        {
+            std::memset(&m_stream, 0, sizeof(z_stream));
+            m_init = inflateInit2(&m_stream, window_bits);
+        }
+
+        ~StreamingDecompressorZLIB()
+        {
+            inflateEnd(&m_stream);
+        }
+
+        StreamingStatus decompress(Memory dest, ConstMemory source) override
+        {
+            StreamingStatus status;
+
+            if (m_init != Z_OK)
+            {
+                status.setError("[{}] {}.", m_name, zlib::get_error_string(m_init));
+                return status;
+            }
+
+            for (;;)
+            {
+                if (m_end)
+                {
+                    if (!m_multi_member || status.consumed == source.size)
+                    {
+                        status.done = true;
+                        break;
+                    }
+
+                    // next member
+                    inflateReset(&m_stream);
+                    m_end = false;
+                }
+
+                size_t in = source.size - status.consumed;
+                size_t out = dest.size - status.produced;
+
+                m_stream.next_in = const_cast<Bytef*>(source.address + status.consumed);
+                m_stream.avail_in = uInt(std::min(in, size_t(0x40000000)));
+                m_stream.next_out = dest.address + status.produced;
+                m_stream.avail_out = uInt(std::min(out, size_t(0x40000000)));
+
+                uInt avail_in = m_stream.avail_in;
+                uInt avail_out = m_stream.avail_out;
+
+                int result = inflate(&m_stream, Z_NO_FLUSH);
+
+                status.consumed += avail_in - m_stream.avail_in;
+                status.produced += avail_out - m_stream.avail_out;
+
+                if (result == Z_STREAM_END)
+                {
+                    m_end = true;
+                    continue;
+                }
+
+                if (result == Z_DATA_ERROR)
+                {
+                    status.setError("[{}] {}.", m_name, m_stream.msg ? m_stream.msg : "Z_DATA_ERROR");
+                    break;
+                }
+
+                if (result != Z_OK && result != Z_BUF_ERROR)
+                {
+                    status.setError("[{}] {}.", m_name, zlib::get_error_string(result));
+                    break;
+                }
+
+                if (result == Z_BUF_ERROR || status.produced == dest.size || status.consumed == source.size)
+                {
+                    break;
+                }
+            }
+
+            return status;
+        }
+    };
+
+    class StreamingDecompressorBZIP2 : public StreamingDecompressor
+    {
+    protected:
+        bz_stream m_stream;
+        int m_init;
+        bool m_end = false;
+
+    public:
+        StreamingDecompressorBZIP2()
+        {
+            std::memset(&m_stream, 0, sizeof(bz_stream));
+            m_init = BZ2_bzDecompressInit(&m_stream, 0, 0);
+        }
+
+        ~StreamingDecompressorBZIP2()
+        {
+            if (m_init == BZ_OK)
+            {
+                BZ2_bzDecompressEnd(&m_stream);
+            }
+        }
+
+        StreamingStatus decompress(Memory dest, ConstMemory source) override
+        {
+            StreamingStatus status;
+
+            for (;;)
+            {
+                if (m_end)
+                {
+                    if (status.consumed == source.size)
+                    {
+                        status.done = true;
+                        break;
+                    }
+
+                    // concatenated stream
+                    BZ2_bzDecompressEnd(&m_stream);
+                    std::memset(&m_stream, 0, sizeof(bz_stream));
+                    m_init = BZ2_bzDecompressInit(&m_stream, 0, 0);
+                    m_end = false;
+                }
+
+                if (m_init != BZ_OK)
+                {
+                    status.setError("[bzip2] decompression failed.");
+                    break;
+                }
+
+                size_t in = source.size - status.consumed;
+                size_t out = dest.size - status.produced;
+
+                m_stream.next_in = const_cast<char*>(reinterpret_cast<const char*>(source.address + status.consumed));
+                m_stream.avail_in = unsigned(std::min(in, size_t(0x40000000)));
+                m_stream.next_out = reinterpret_cast<char*>(dest.address + status.produced);
+                m_stream.avail_out = unsigned(std::min(out, size_t(0x40000000)));
+
+                unsigned avail_in = m_stream.avail_in;
+                unsigned avail_out = m_stream.avail_out;
+
+                int result = BZ2_bzDecompress(&m_stream);
+
+                status.consumed += avail_in - m_stream.avail_in;
+                status.produced += avail_out - m_stream.avail_out;
+
+                if (result == BZ_STREAM_END)
+                {
+                    m_end = true;
+                    continue;
+                }
+
+                if (result != BZ_OK)
+                {
+                    status.setError("[bzip2] decompression failed.");
+                    break;
+                }
+
+                if (status.produced == dest.size || status.consumed == source.size ||
+                    (avail_in == m_stream.avail_in && avail_out == m_stream.avail_out))
+                {
+                    break;
+                }
+            }
+
+            return status;
+        }
+    };
+
+#endif // MANGO_LICENSE_ENABLE_ZLIB
+
+} // namespace
+
+    std::shared_ptr<StreamingDecompressor> createStreamingDecompressor(Compressor::Method method)
+    {
+        std::shared_ptr<StreamingDecompressor> decompressor;
+
+        switch (method)
+        {
+            case Compressor::ZSTD:
+                decompressor = std::make_shared<StreamingDecompressorZSTD>();
+                break;
+
+            case Compressor::LZMA:
+                decompressor = std::make_shared<StreamingDecompressorLZMA>();
+                break;
+
+#ifdef MANGO_LICENSE_ENABLE_ZLIB
+
+            case Compressor::DEFLATE:
+                decompressor = std::make_shared<StreamingDecompressorZLIB>(-15, false, "deflate");
+                break;
+
+            case Compressor::ZLIB:
+            case Compressor::DEFLATE_ZLIB:
+                decompressor = std::make_shared<StreamingDecompressorZLIB>(15, false, "zlib");
+                break;
+
+            case Compressor::DEFLATE_GZIP:
+                decompressor = std::make_shared<StreamingDecompressorZLIB>(15 + 16, true, "gzip");
+                break;
+
+            case Compressor::BZIP2:
+                decompressor = std::make_shared<StreamingDecompressorBZIP2>();
+                break;
+
+#endif // MANGO_LICENSE_ENABLE_ZLIB
+
+            default:
+                break;
+        }
+
+        return decompressor;
+    }
+
+    CompressionStatus decompress(Stream& output, Stream& input, Compressor::Method method)
+    {
+        CompressionStatus status;
+
+        std::shared_ptr<StreamingDecompressor> decompressor = createStreamingDecompressor(method);
+        if (!decompressor)
+        {
+            status.setError("[stream] Streaming decompression is not supported ({}).", int(method));
+            return status;
+        }
+
+        const size_t buffer_size = 128 * 1024;
+
+        Buffer source(buffer_size);
+        Buffer dest(buffer_size);
+
+        u64 left = input.size() - input.offset();
+        size_t pending = 0;
+        bool done = false;
+
+        for (;;)
+        {
+            size_t bytes = size_t(std::min(u64(buffer_size - pending), left));
+            if (bytes)
+            {
+                input.read(source.data() + pending, bytes);
+                left -= bytes;
+                pending += bytes;
+            }
+
+            StreamingStatus result = decompressor->decompress(dest, ConstMemory(source.data(), pending));
+            if (!result)
+            {
+                status.setError(result.info);
+                break;
+            }
+
+            if (result.produced)
+            {
+                output.write(dest.data(), result.produced);
+                status.size += result.produced;
+            }
+
+            // keep the unconsumed input for the next call
+            pending -= result.consumed;
+            std::memmove(source.data(), source.data() + result.consumed, pending);
+
+            done = result.done;
+
+            if (!bytes && !result.consumed && !result.produced)
+            {
+                // no progress without more input
+                break;
+            }
+        }
+
+        if (status && !done)
+        {
+            status.setError("[stream] Unexpected end of compressed data.");
+        }
+
+        return status;
+    }
+
+// ----------------------------------------------------------------------------
+// parallel
+// ----------------------------------------------------------------------------
+
+namespace parallel
+{
+
+    static constexpr size_t default_chunk_size = 4 * 1024 * 1024;
+    static constexpr size_t minimum_chunk_size = 64 * 1024;
+    static constexpr size_t maximum_chunk_size = 1024 * 1024 * 1024;
+
+    static constexpr u32 lz4_frame_magic = 0x184d2204;
+    static constexpr size_t lz4_frame_header = 15;
+    static constexpr size_t lz4_frame_trailer = 4;
+
+    // gzip member: 20 byte header with the "MG" extra field, 8 byte trailer
+    static constexpr size_t gzip_member_header = 20;
+    static constexpr size_t gzip_member_trailer = 8;
+
+    // chunk table container: magic, method, chunk size, total size, count
+    static constexpr size_t table_header = 28;
+
+    struct Chunk
+    {
+        ConstMemory source;
+        Memory dest;
+    };
+
+    static
+    size_t getChunkSize(const Compressor& compressor, size_t chunk_size)
+    {
+        if (!chunk_size)
+        {
+            chunk_size = default_chunk_size;
+        }
+
+        chunk_size = std::clamp(chunk_size, minimum_chunk_size, maximum_chunk_size);
+
+        if (compressor.method == Compressor::LZ4)
+        {
+            // LZ4 frame block sizes: 64 KB, 256 KB, 1 MB, 4 MB
+            size_t size = minimum_chunk_size;
+            while (size < default_chunk_size && size * 4 <= chunk_size)
+            {
+                size *= 4;
+            }
+
+            chunk_size = size;
+        }
+
+        return chunk_size;
+    }
+
+    static
+    size_t getChunkCount(size_t size, size_t chunk_size)
+    {
+        return std::max(size_t(1), (size + chunk_size - 1) / chunk_size);
+    }
+
+    static
+    size_t getHeaderSize(const Compressor& compressor, size_t count)
+    {
+        switch (compressor.method)
+        {
+            case Compressor::DEFLATE_GZIP:
+            case Compressor::ZSTD:
+                return 0;
+            case Compressor::LZ4:
+                return lz4_frame_header;
+            default:
+                return table_header + count * 8;
+        }
+    }
+
+    static
+    size_t getTrailerSize(const Compressor& compressor)
+    {
+        return compressor.method == Compressor::LZ4 ? lz4_frame_trailer : 0;
+    }
+
+    static
+    size_t getSlotSize(const Compressor& compressor, size_t chunk_size)
+    {
+        switch (compressor.method)
+        {
+            case Compressor::DEFLATE_GZIP:
+                return gzip_member_header + deflate::bound(chunk_size) + gzip_member_trailer;
+            case Compressor::ZSTD:
+                return zstd::bound(chunk_size);
+            case Compressor::LZ4:
+                return 4 + std::max(lz4::bound(chunk_size), chunk_size);
+            default:
+                return std::max(compressor.bound(chunk_size), chunk_size);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // chunk encoders
+    // ------------------------------------------------------------------------
+
+    static
+    CompressionStatus encodeGzipMember(Memory dest, ConstMemory source, int level)
+    {
+        Memory payload(dest.address + gzip_member_header, dest.size - gzip_member_header - gzip_member_trailer);
+
+        CompressionStatus status = deflate::compress(payload, source, level);
+        if (!status.size)
+        {
+            status.setError("[parallel.gzip] compression failed.");
+            return status;
+        }
+
+        size_t member_size = gzip_member_header + status.size + gzip_member_trailer;
+
+        LittleEndianPointer p = dest.address;
+
+        p.write8(0x1f);
+        p.write8(0x8b);
+        p.write8(8); // deflate
+        p.write8(0x04); // FEXTRA
+        p.write32(0); // mtime
+        p.write8(0); // xfl
+        p.write8(255); // os: unknown
+        p.write16(8); // xlen
+        p.write8('M');
+        p.write8('G');
+        p.write16(4);
+        p.write32(u32(member_size));
+
+        p += status.size;
+
+        p.write32(crc32(0, source));
+        p.write32(u32(source.size));
+
+        status.size = member_size;
+        return status;
+    }
+
+    static
+    CompressionStatus encodeLz4Block(Memory dest, ConstMemory source, int level)
+    {
+        CompressionStatus status;
+
+        if (!source.size)
+        {
+            // empty source is encoded as a frame without blocks
+            return status;
+        }
+
+        Memory payload(dest.address + 4, dest.size - 4);
+
+        CompressionStatus result = lz4::compress(payload, source, level);
+
+        u32 block_size = u32(result.size);
+
+        if (!result || !result.size || result.size >= source.size)
+        {
+            // store uncompressed
+            std::memcpy(payload.address, source.address, source.size);
+            block_size = u32(source.size) | 0x80000000;
+            result.size = source.size;
+        }
+
+        littleEndian::ustore32(dest.address, block_size);
+
+        status.size = 4 + result.size;
+        return status;
+    }
+
+    static
+    CompressionStatus encodeChunk(const Compressor& compressor, Memory dest, ConstMemory source, int level)
+    {
+        switch (compressor.method)
+        {
+            case Compressor::DEFLATE_GZIP:
+                return encodeGzipMember(dest, source, level);
+            case Compressor::ZSTD:
+                return zstd::compress(dest, source, level);
+            case Compressor::LZ4:
+                return encodeLz4Block(dest, source, level);
+            default:
+                break;
+        }
+
+        CompressionStatus status = compressor.compress(dest, source, level);
+
+        if (!status || status.size >= source.size)
+        {
+            // store uncompressed; the decoder identifies these chunks from the size
+            std::memcpy(dest.address, source.address, source.size);
+            status = CompressionStatus();
+            status.size = source.size;
+        }
+
+        return status;
+    }
+
+    // ------------------------------------------------------------------------
+    // chunk decoders
+    // ------------------------------------------------------------------------
+
+    template <typename Decoder>
+    CompressionStatus decodeChunks(const std::vector<Chunk>& chunks, Decoder decoder)
+    {
+        std::vector<CompressionStatus> results(chunks.size());
+
+        ConcurrentQueue q;
+
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            q.enqueue([&, i]
+            {
+                results[i] = decoder(chunks[i].dest, chunks[i].source);
+            });
+        }
+
+        q.wait();
+
+        CompressionStatus status;
+
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            if (!results[i])
+            {
+                return results[i];
+            }
+
+            if (results[i].size != chunks[i].dest.size)
+            {
+                status.setError("[parallel] chunk {} decompressed to {} bytes (expected: {}).",
+                    i, results[i].size, chunks[i].dest.size);
+                return status;
+            }
+
+            status.size += results[i].size;
+        }
+
+        return status;
+    }
+
+    static
+    size_t getGzipMemberSize(const u8* p, size_t size)
+    {
+        // the member size is available only when the "MG" extra field is present
+        if (size < 12 || p[0] != 0x1f || p[1] != 0x8b || p[2] != 8 || !(p[3] & 0x04))
+        {
+            return 0;
+        }
+
+        size_t xlen = littleEndian::uload16(p + 10);
+        if (size < 12 + xlen)
+        {
+            return 0;
+        }
+
+        const u8* extra = p + 12;
+        const u8* end = extra + xlen;
+
+        while (extra + 4 <= end)
+        {
+            size_t length = littleEndian::uload16(extra + 2);
+
+            if (extra[0] == 'M' && extra[1] == 'G' && length == 4 && extra + 8 <= end)
+            {
+                return littleEndian::uload32(extra + 4);
+            }
+
+            extra += 4 + length;
+        }
+
+        return 0;
+    }
+
+    static
+    CompressionStatus decompressGzip(Memory dest, ConstMemory source)
+    {
+        CompressionStatus status;
+
+        std::vector<Chunk> chunks;
+        size_t offset = 0;
+        bool indexed = true;
+
+        for (const u8* p = source.address; p < source.end(); )
+        {
+            size_t available = source.end() - p;
+            size_t member_size = getGzipMemberSize(p, available);
+
+            if (member_size < gzip_member_header + gzip_member_trailer || member_size > available)
+            {
+                indexed = false;
+                break;
+            }
+
+            size_t isize = littleEndian::uload32(p + member_size - 4);
+            if (isize > dest.size - offset)
+            {
+                status.setError("[parallel.gzip] Insufficient space.");
+                return status;
+            }
+
+            chunks.push_back({ ConstMemory(p, member_size), Memory(dest.address + offset, isize) });
+
+            offset += isize;
+            p += member_size;
+        }
+
+        if (indexed)
+        {
+            return decodeChunks(chunks, deflate_gzip::decompress);
+        }
+
+        // members cannot be located without decoding them
+        libdeflate_decompressor* decompressor = libdeflate_alloc_decompressor();
+
+        const u8* src = source.address;
+        size_t src_size = source.size;
+
+        while (src_size > 0)
+        {
+            size_t bytes_in = 0;
+            size_t bytes_out = 0;
+
+            libdeflate_result result = libdeflate_gzip_decompress_ex(decompressor, src, src_size,
+                dest.address + status.size, dest.size - status.size, &bytes_in, &bytes_out);
+
+            const char* error = deflate::get_error_string(result);
+            if (error)
+            {
+                status.setError("[parallel.gzip] {}.", error);
+                break;
+            }
+
+            src += bytes_in;
+            src_size -= bytes_in;
+            status.size += bytes_out;
+        }
+
+        libdeflate_free_decompressor(decompressor);
+
+        return status;
+    }
+
+    static
+    CompressionStatus decompressZstd(Memory dest, ConstMemory source)
+    {
+        CompressionStatus status;
+
+        std::vector<Chunk> chunks;
+        size_t offset = 0;
+
+        for (const u8* p = source.address; p < source.end(); )
+        {
+            size_t available = source.end() - p;
+
+            size_t frame_size = ZSTD_findFrameCompressedSize(p, available);
+            if (ZSTD_isError(frame_size))
+            {
+                status.setError("[parallel.zstd] {}", ZSTD_getErrorName(frame_size));
+                return status;
+            }
+
+            unsigned long long content_size = ZSTD_getFrameContentSize(p, available);
+            if (content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR)
+            {
+                // the frames cannot be placed without the content size
+                size_t x = ZSTD_decompress(dest.address, dest.size, source.address, source.size);
+                if (ZSTD_isError(x))
+                {
+                    status.setError("[parallel.zstd] {}", ZSTD_getErrorName(x));
+                    return status;
+                }
+
+                status.size = x;
+                return status;
+            }
+
+            if (content_size > dest.size - offset)
+            {
+                status.setError("[parallel.zstd] Insufficient space.");
+                return status;
+            }
+
+            // skippable frames have no content
+            if (content_size)
+            {
+                chunks.push_back({ ConstMemory(p, frame_size), Memory(dest.address + offset, size_t(content_size)) });
+            }
+
+            offset += size_t(content_size);
+            p += frame_size;
+        }
+
+        return decodeChunks(chunks, [] (Memory dest, ConstMemory source)
+        {
+            return zstd::decompress(dest, source);
+        });
+    }
+
+    static
+    CompressionStatus decodeLz4Block(Memory dest, ConstMemory source, bool stored)
+    {
+        CompressionStatus status;
+
+        if (stored)
+        {
+            if (source.size > dest.size)
+            {
+                status.setError("[parallel.lz4] Insufficient space.");
+                return status;
+            }
+
+            std::memcpy(dest.address, source.address, source.size);
+            status.size = source.size;
+            return status;
+        }
+
+        int result = LZ4_decompress_safe(source.cast<const char>(), dest.cast<char>(), int(source.size), int(dest.size));
+        if (result < 0)
+        {
+            status.setError("[parallel.lz4] decompression failed.");
+            return status;
+        }
+
+        status.size = size_t(result);
+        return status;
+    }
+
+    static
+    CompressionStatus decompressLz4(Memory dest, ConstMemory source)
+    {
+        CompressionStatus status;
+
+        if (source.size < 7 || littleEndian::uload32(source.address) != lz4_frame_magic)
+        {
+            status.setError("[parallel.lz4] Incorrect frame identifier.");
+            return status;
+        }
+
+        u8 flags = source.address[4];
+        u8 bd = source.address[5];
+
+        bool independent = (flags & 0x20) != 0;
+        bool block_checksum = (flags & 0x10) != 0;
+        bool content_size = (flags & 0x08) != 0;
+        bool content_checksum = (flags & 0x04) != 0;
+        bool dictionary = (flags & 0x01) != 0;
+
+        int block_code = (bd >> 4) & 7;
+
+        if ((flags >> 6) != 1 || block_code < 4 || dictionary)
+        {
+            status.setError("[parallel.lz4] Unsupported frame descriptor.");
+            return status;
+        }
+
+        const size_t block_max = size_t(1) << (block_code * 2 + 8);
+        const size_t descriptor = 2 + (content_size ? 8 : 0);
+
+        if (source.size < 4 + descriptor + 1)
+        {
+            status.setError("[parallel.lz4] Out of data.");
+            return status;
+        }
+
+        u8 checksum = u8(xxhash32(0, ConstMemory(source.address + 4, descriptor)) >> 8);
+        if (checksum != source.address[4 + descriptor])
+        {
+            status.setError("[parallel.lz4] Incorrect header checksum.");
+            return status;
+        }
+
+        struct Block
+        {
+            ConstMemory memory;
+            bool stored;
+        };
+
+        std::vector<Block> blocks;
+
+        const u8* p = source.address + 4 + descriptor + 1;
+        const u8* end = source.end();
+
+        for (;;)
+        {
+            if (end - p < 4)
+            {
+                status.setError("[parallel.lz4] Out of data.");
+                return status;
+            }
+
+            u32 value = littleEndian::uload32(p);
+            p += 4;
+
+            if (!value)
+            {
+                // end mark
+                break;
+            }
+
+            size_t size = value & 0x7fffffff;
+            size_t skip = size + (block_checksum ? 4 : 0);
+
+            if (size > block_max || size_t(end - p) < skip)
+            {
+                status.setError("[parallel.lz4] Incorrect block size.");
+                return status;
+            }
+
+            blocks.push_back({ ConstMemory(p, size), (value & 0x80000000) != 0 });
+            p += skip;
+        }
+
+        MANGO_UNREFERENCED(content_checksum);
+
+        if (independent)
+        {
+            // encoders fill every block but the last one; verified from the decoded sizes
+            std::vector<Chunk> chunks;
+            std::vector<bool> stored;
+
+            for (size_t i = 0; i < blocks.size(); ++i)
+            {
+                size_t offset = i * block_max;
+                if (offset >= dest.size)
+                {
+                    break;
+                }
+
+                size_t size = std::min(block_max, dest.size - offset);
+
+                chunks.push_back({ blocks[i].memory, Memory(dest.address + offset, size) });
+                stored.push_back(blocks[i].stored);
+            }
+
+            if (chunks.size() == blocks.size())
+            {
+                std::vector<CompressionStatus> results(chunks.size());
+
+                ConcurrentQueue q;
+
+                for (size_t i = 0; i < chunks.size(); ++i)
+                {
+                    q.enqueue([&, i]
+                    {
+                        results[i] = decodeLz4Block(chunks[i].dest, chunks[i].source, stored[i]);
+                    });
+                }
+
+                q.wait();
+
+                bool placed = true;
+
+                for (size_t i = 0; i < results.size(); ++i)
+                {
+                    if (!results[i])
+                    {
+                        return results[i];
+                    }
+
+                    if (i + 1 < results.size() && results[i].size != block_max)
+                    {
+                        placed = false;
+                    }
+
+                    status.size += results[i].size;
+                }
+
+                if (placed)
+                {
+                    return status;
+                }
+
+                status.size = 0;
+            }
+        }
+
+        // serial decoding; dependent blocks use the previous 64 KB of output as dictionary
+        for (const Block& block : blocks)
+        {
+            u8* output = dest.address + status.size;
+            size_t capacity = dest.size - status.size;
+
+            if (block.stored || independent)
+            {
+                CompressionStatus result = decodeLz4Block(Memory(output, capacity), block.memory, block.stored);
+                if (!result)
+                {
+                    return result;
+                }
+
+                status.size += result.size;
+            }
+            else
+            {
+                const size_t dictionary_size = std::min(status.size, size_t(64 * 1024));
+
+                int result = LZ4_decompress_safe_usingDict(block.memory.cast<const char>(),
+                    reinterpret_cast<char*>(output), int(block.memory.size), int(capacity),
+                    reinterpret_cast<const char*>(output - dictionary_size), int(dictionary_size));
+                if (result < 0)
+                {
+                    status.setError("[parallel.lz4] decompression failed.");
+                    return status;
+                }
+
+                status.size += size_t(result);
+            }
+        }
+
+        return status;
+    }
+
+    static
+    CompressionStatus decompressTable(const Compressor& compressor, Memory dest, ConstMemory source)
+    {
+        CompressionStatus status;
+
+        if (source.size < table_header || littleEndian::uload32(source.address) != u32_mask('m', 'p', 'c', 'z'))
+        {
+            status.setError("[parallel] Incorrect chunk table.");
+            return status;
+        }
+
+        LittleEndianConstPointer p = source.address + 4;
+
+        u32 method = p.read32();
+        u64 chunk_size = p.read64();
+        u64 total_size = p.read64();
+        u32 count = p.read32();
+
+        if (method != u32(compressor.method))
+        {
+            status.setError("[parallel] Incorrect compression method: {} (expected: {}).", method, int(compressor.method));
+            return status;
+        }
+
+        if (total_size > dest.size)
+        {
+            status.setError("[parallel] Insufficient space.");
+            return status;
+        }
+
+        if (!chunk_size || count != getChunkCount(size_t(total_size), size_t(chunk_size)) ||
+            source.size < table_header + size_t(count) * 8)
+        {
+            status.setError("[parallel] Incorrect chunk table.");
+            return status;
+        }
+
+        std::vector<Chunk> chunks;
+
+        const u8* data = source.address + table_header + size_t(count) * 8;
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            size_t size = size_t(p.read64());
+            size_t offset = size_t(i * chunk_size);
+
+            if (size > size_t(source.end() - data))
+            {
+                status.setError("[parallel] Out of data.");
+                return status;
+            }
+
+            size_t bytes = std::min(size_t(chunk_size), size_t(total_size) - offset);
+
+            chunks.push_back({ ConstMemory(data, size), Memory(dest.address + offset, bytes) });
+            data += size;
+        }
+
+        auto decoder = [&] (Memory dest, ConstMemory source) -> CompressionStatus
+        {
+            if (source.size == dest.size)
+            {
+                // stored uncompressed
+                std::memcpy(dest.address, source.address, source.size);
+
+                CompressionStatus status;
+                status.size = source.size;
+                return status;
+            }
+
+            return compressor.decompress(dest, source);
+        };
+
+        return decodeChunks(chunks, decoder);
+    }
+
+    // ------------------------------------------------------------------------
+    // api
+    // ------------------------------------------------------------------------
+
+    size_t bound(const Compressor& compressor, size_t size, size_t chunk_size)
+    {
+        chunk_size = getChunkSize(compressor, chunk_size);
+        const size_t count = getChunkCount(size, chunk_size);
+
+        return getHeaderSize(compressor, count) +
+               getSlotSize(compressor, chunk_size) * count +
+               getTrailerSize(compressor);
+    }
+
+    CompressionStatus compress(const Compressor& compressor, Memory dest, ConstMemory source, int level, size_t chunk_size)
+    {
+        CompressionStatus status;
+
+        if (!compressor.compress)
+        {
+            status.setError("[parallel] Incorrect compressor.");
+            return status;
+        }
+
+        chunk_size = getChunkSize(compressor, chunk_size);
+
+        const size_t count = getChunkCount(source.size, chunk_size);
+        const size_t header = getHeaderSize(compressor, count);
+        const size_t slot = getSlotSize(compressor, chunk_size);
+
+        if (dest.size < header + slot * count + getTrailerSize(compressor))
+        {
+            status.setError("[parallel] Insufficient space.");
+            return status;
+        }
+
+        // Each chunk is compressed into its own slot and moved down to the end of the
+        // previous chunk in order; the move never overlaps a slot that is still in use.
+        u8* output = dest.address + header;
+
+        std::vector<u64> sizes(count);
+        std::atomic<bool> failed { false };
+
+        ConcurrentQueue q;
+        TicketQueue tk;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t offset = i * chunk_size;
+            ConstMemory chunk(source.address + offset, std::min(chunk_size, source.size - offset));
+            Memory block(dest.address + header + i * slot, slot);
+
+            auto ticket = tk.acquire();
+
+            q.enqueue([=, &compressor, &output, &sizes, &failed]
+            {
+                CompressionStatus result = encodeChunk(compressor, block, chunk, level);
+                if (!result)
+                {
+                    failed = true;
+                }
+
+                size_t bytes = result.size;
+
+                ticket.consume([=, &output, &sizes]
+                {
+                    std::memmove(output, block.address, bytes);
+                    output += bytes;
+                    sizes[i] = bytes;
+                });
+            });
+        }
+
+        q.wait();
+        tk.wait();
+
+        if (failed)
+        {
+            status.setError("[parallel] {} compression failed.", compressor.name);
+            return status;
+        }
+
+        switch (compressor.method)
+        {
+            case Compressor::DEFLATE_GZIP:
+            case Compressor::ZSTD:
+                break;
+
+            case Compressor::LZ4:
+            {
+                LittleEndianPointer p = dest.address;
+
+                p.write32(lz4_frame_magic);
+                p.write8(0x68); // version 01, independent blocks, content size
+                p.write8(u8(((u32_log2(u32(chunk_size)) - 8) / 2) << 4));
+                p.write64(source.size);
+                p.write8(u8(xxhash32(0, ConstMemory(dest.address + 4, 10)) >> 8));
+
+                littleEndian::ustore32(output, 0); // end mark
+                output += lz4_frame_trailer;
+                break;
+            }
+
+            default:
+            {
+                LittleEndianPointer p = dest.address;
+
+                p.write32(u32_mask('m', 'p', 'c', 'z'));
+                p.write32(u32(compressor.method));
+                p.write64(chunk_size);
+                p.write64(source.size);
+                p.write32(u32(count));
+
+                for (u64 size : sizes)
+                {
+                    p.write64(size);
+                }
+
+                break;
+            }
+        }
+
+        status.size = output - dest.address;
+        return status;
+    }
+
+    CompressionStatus decompress(const Compressor& compressor, Memory dest, ConstMemory source)
+    {
+        switch (compressor.method)
+        {
+            case Compressor::DEFLATE_GZIP:
+                return decompressGzip(dest, source);
+            case Compressor::ZSTD:
+                return decompressZstd(dest, source);
+            case Compressor::LZ4:
+                return decompressLz4(dest, source);
+            default:
+                return decompressTable(compressor, dest, source);
+        }
+    }
+
+} // namespace parallel
+
 } // namespace mango
@@ -1,6 +1,6 @@
 /*
     MANGO Multimedia Development Platform
-    Copyright (C) 2012-2022 Twilight Finland 3D Oy Ltd. All rights reserved.
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
 */
 #include <mango/core/crc32.hpp>
 #include <mango/core/bits.hpp>
@@ -1306,13 +1306,15 @@ namespace
         constexpr size_t KB = 1 << 10;
         constexpr size_t MIN_BLOCK = 256 * KB;
 
-        if (memory.size < MIN_BLOCK * 2)
+        const size_t concurrency = ThreadPool::getHardwareConcurrency();
+
+        if (memory.size < MIN_BLOCK * 2 || concurrency < 2)
         {
             // don't bother multi-threading if we don't have plenty of input
             return compute(crc, memory.address, memory.size);
         }
 
-        size_t block = std::max(MIN_BLOCK, memory.size / (ThreadPool::getHardwareConcurrency() * 2));
+        size_t block = std::max(MIN_BLOCK, memory.size / (concurrency * 2));
         int threads = int(memory.size / block);
 
         struct Block
@@ -35,4 +35,150 @@ namespace mango
         return hash;
     }
 
+    // -----------------------------------------------------------------------
+    // XXHash32Context
+    // -----------------------------------------------------------------------
+
+    struct XXHash32Context::State
+    {
+        XXH32_state_t state;
+        u32 seed;
+    };
+
+    XXHash32Context::XXHash32Context(u32 seed)
+        : m_state(std::make_unique<State>())
+    {
+        m_state->seed = seed;
+        reset();
+    }
+
+    XXHash32Context::~XXHash32Context()
+    {
+    }
+
+    void XXHash32Context::reset()
+    {
+        XXH32_reset(&m_state->state, m_state->seed);
+    }
+
+    void XXHash32Context::update(ConstMemory memory)
+    {
+        XXH32_update(&m_state->state, memory.address, memory.size);
+    }
+
+    u32 XXHash32Context::final() const
+    {
+        return XXH32_digest(&m_state->state);
+    }
+
+    // -----------------------------------------------------------------------
+    // XXHash64Context
+    // -----------------------------------------------------------------------
+
+    struct XXHash64Context::State
+    {
+        XXH64_state_t state;
+        u64 seed;
+    };
+
+    XXHash64Context::XXHash64Context(u64 seed)
+        : m_state(std::make_unique<State>())
+    {
+        m_state->seed = seed;
+        reset();
+    }
+
+    XXHash64Context::~XXHash64Context()
+    {
+    }
+
+    void XXHash64Context::reset()
+    {
+        XXH64_reset(&m_state->state, m_state->seed);
+    }
+
+    void XXHash64Context::update(ConstMemory memory)
+    {
+        XXH64_update(&m_state->state, memory.address, memory.size);
+    }
+
+    u64 XXHash64Context::final() const
+    {
+        return XXH64_digest(&m_state->state);
+    }
+
+    // -----------------------------------------------------------------------
+    // XX3Hash64Context
+    // -----------------------------------------------------------------------
+
+    struct XX3Hash64Context::State
+    {
+        XXH3_state_t state;
+        u64 seed;
+    };
+
+    XX3Hash64Context::XX3Hash64Context(u64 seed)
+        : m_state(std::make_unique<State>())
+    {
+        m_state->seed = seed;
+        reset();
+    }
+
+    XX3Hash64Context::~XX3Hash64Context()
+    {
+    }
+
+    void XX3Hash64Context::reset()
+    {
+        XXH3_64bits_reset_withSeed(&m_state->state, m_state->seed);
+    }
+
+    void XX3Hash64Context::update(ConstMemory memory)
+    {
+        XXH3_64bits_update(&m_state->state, memory.address, memory.size);
+    }
+
+    u64 XX3Hash64Context::final() const
+    {
+        return XXH3_64bits_digest(&m_state->state);
+    }
+
+    // -----------------------------------------------------------------------
+    // XX3Hash128Context
+    // -----------------------------------------------------------------------
+
+    struct XX3Hash128Context::State
+    {
+        XXH3_state_t state;
+        u64 seed;
+    };
+
+    XX3Hash128Context::XX3Hash128Context(u64 seed)
+        : m_state(std::make_unique<State>())
+    {
+        m_state->seed = seed;
+        reset();
+    }
+
+    XX3Hash128Context::~XX3Hash128Context()
+    {
+    }
+
+    void XX3Hash128Context::reset()
+    {
+        XXH3_128bits_reset_withSeed(&m_state->state, m_state->seed);
+    }
+
+    void XX3Hash128Context::update(ConstMemory memory)
+    {
+        XXH3_128bits_update(&m_state->state, memory.address, memory.size);
+    }
+
+    XX3H128 XX3Hash128Context::final() const
+    {
+        XXH128_hash_t x = XXH3_128bits_digest(&m_state->state);
+        XX3H128 hash { x.low64, x.high64 };
+        return hash;
+    }
+
 } // namespace mango
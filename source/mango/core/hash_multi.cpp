@@ -0,0 +1,549 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/core/hash.hpp>
+#include <mango/core/bits.hpp>
+#include <mango/core/endian.hpp>
+#include <mango/core/cpuinfo.hpp>
+#include <mango/simd/simd.hpp>
+
+/*
+    Multi-buffer hashing
+
+    Each SIMD lane computes the hash of a different message; the transforms are the
+    scalar algorithms with every u32 replaced by a vector of u32. The lanes are fed
+    one 64 byte block at a time. When the message in a lane is finished the digest is
+    stored and the next message is scheduled into the lane so that the lanes stay busy
+    even when the messages are not the same length.
+*/
+
+namespace
+{
+    using namespace mango;
+
+    // ----------------------------------------------------------------------------------------
+    // vector
+    // ----------------------------------------------------------------------------------------
+
+#if defined(MANGO_ENABLE_AVX512)
+
+    using HashVector = simd::u32x16;
+    constexpr int HashLanes = 16;
+
+    inline HashVector hash_load(const u32* p) { return simd::u32x16_uload(p); }
+    inline void hash_store(u32* p, HashVector v) { simd::u32x16_ustore(p, v); }
+    inline HashVector hash_set(u32 s) { return simd::u32x16_set(s); }
+
+#elif defined(MANGO_ENABLE_AVX2)
+
+    using HashVector = simd::u32x8;
+    constexpr int HashLanes = 8;
+
+    inline HashVector hash_load(const u32* p) { return simd::u32x8_uload(p); }
+    inline void hash_store(u32* p, HashVector v) { simd::u32x8_ustore(p, v); }
+    inline HashVector hash_set(u32 s) { return simd::u32x8_set(s); }
+
+#else
+
+    // SSE, NEON and the rest use 128 bit vectors
+    using HashVector = simd::u32x4;
+    constexpr int HashLanes = 4;
+
+    inline HashVector hash_load(const u32* p) { return simd::u32x4_uload(p); }
+    inline void hash_store(u32* p, HashVector v) { simd::u32x4_ustore(p, v); }
+    inline HashVector hash_set(u32 s) { return simd::u32x4_set(s); }
+
+#endif
+
+    inline HashVector operator + (HashVector a, HashVector b) { return simd::add(a, b); }
+    inline HashVector operator & (HashVector a, HashVector b) { return simd::bitwise_and(a, b); }
+    inline HashVector operator | (HashVector a, HashVector b) { return simd::bitwise_or(a, b); }
+    inline HashVector operator ^ (HashVector a, HashVector b) { return simd::bitwise_xor(a, b); }
+
+    // ~a & b
+    inline HashVector andnot(HashVector a, HashVector b) { return simd::bitwise_nand(a, b); }
+
+    template <int n>
+    inline HashVector rol(HashVector a)
+    {
+        return simd::slli<n>(a) | simd::srli<32 - n>(a);
+    }
+
+    template <int n>
+    inline HashVector ror(HashVector a)
+    {
+        return simd::srli<n>(a) | simd::slli<32 - n>(a);
+    }
+
+    using BlockPointers = const u8* [HashLanes];
+
+    // transpose one 32 bit word from every lane's block into a vector
+    template <bool BigEndian>
+    inline HashVector hash_gather(const BlockPointers& block, int offset)
+    {
+        alignas(64) u32 temp[HashLanes];
+
+        for (int lane = 0; lane < HashLanes; ++lane)
+        {
+            temp[lane] = BigEndian ? bigEndian::uload32(block[lane] + offset)
+                                   : littleEndian::uload32(block[lane] + offset);
+        }
+
+        return hash_load(temp);
+    }
+
+    // ----------------------------------------------------------------------------------------
+    // MD5
+    // ----------------------------------------------------------------------------------------
+
+#define ROUND_TAIL(a, b, expr, k, s, t) \
+    a = a + (expr) + hash_set(t) + w[k]; \
+    a = b + rol<s>(a)
+
+#define ROUND0(a, b, c, d, k, s, t)  ROUND_TAIL(a, b, d ^ (b & (c ^ d)), k, s, t);
+#define ROUND1(a, b, c, d, k, s, t)  ROUND_TAIL(a, b, c ^ (d & (b ^ c)), k, s, t);
+#define ROUND2(a, b, c, d, k, s, t)  ROUND_TAIL(a, b, b ^ c ^ d        , k, s, t);
+#define ROUND3(a, b, c, d, k, s, t)  ROUND_TAIL(a, b, c ^ (b | (d ^ ones)), k, s, t);
+
+    void md5_multi_transform(u32 (&state)[4][HashLanes], const BlockPointers& block)
+    {
+        HashVector w[16];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = hash_gather<false>(block, i * 4);
+        }
+
+        HashVector a = hash_load(state[0]);
+        HashVector b = hash_load(state[1]);
+        HashVector c = hash_load(state[2]);
+        HashVector d = hash_load(state[3]);
+
+        const HashVector ones = hash_set(0xffffffff);
+
+        ROUND0(a, b, c, d,  0,  7, 0xD76AA478);
+        ROUND0(d, a, b, c,  1, 12, 0xE8C7B756);
+        ROUND0(c, d, a, b,  2, 17, 0x242070DB);
+        ROUND0(b, c, d, a,  3, 22, 0xC1BDCEEE);
+        ROUND0(a, b, c, d,  4,  7, 0xF57C0FAF);
+        ROUND0(d, a, b, c,  5, 12, 0x4787C62A);
+        ROUND0(c, d, a, b,  6, 17, 0xA8304613);
+        ROUND0(b, c, d, a,  7, 22, 0xFD469501);
+        ROUND0(a, b, c, d,  8,  7, 0x698098D8);
+        ROUND0(d, a, b, c,  9, 12, 0x8B44F7AF);
+        ROUND0(c, d, a, b, 10, 17, 0xFFFF5BB1);
+        ROUND0(b, c, d, a, 11, 22, 0x895CD7BE);
+        ROUND0(a, b, c, d, 12,  7, 0x6B901122);
+        ROUND0(d, a, b, c, 13, 12, 0xFD987193);
+        ROUND0(c, d, a, b, 14, 17, 0xA679438E);
+        ROUND0(b, c, d, a, 15, 22, 0x49B40821);
+        ROUND1(a, b, c, d,  1,  5, 0xF61E2562);
+        ROUND1(d, a, b, c,  6,  9, 0xC040B340);
+        ROUND1(c, d, a, b, 11, 14, 0x265E5A51);
+        ROUND1(b, c, d, a,  0, 20, 0xE9B6C7AA);
+        ROUND1(a, b, c, d,  5,  5, 0xD62F105D);
+        ROUND1(d, a, b, c, 10,  9, 0x02441453);
+        ROUND1(c, d, a, b, 15, 14, 0xD8A1E681);
+        ROUND1(b, c, d, a,  4, 20, 0xE7D3FBC8);
+        ROUND1(a, b, c, d,  9,  5, 0x21E1CDE6);
+        ROUND1(d, a, b, c, 14,  9, 0xC33707D6);
+        ROUND1(c, d, a, b,  3, 14, 0xF4D50D87);
+        ROUND1(b, c, d, a,  8, 20, 0x455A14ED);
+        ROUND1(a, b, c, d, 13,  5, 0xA9E3E905);
+        ROUND1(d, a, b, c,  2,  9, 0xFCEFA3F8);
+        ROUND1(c, d, a, b,  7, 14, 0x676F02D9);
+        ROUND1(b, c, d, a, 12, 20, 0x8D2A4C8A);
+        ROUND2(a, b, c, d,  5,  4, 0xFFFA3942);
+        ROUND2(d, a, b, c,  8, 11, 0x8771F681);
+        ROUND2(c, d, a, b, 11, 16, 0x6D9D6122);
+        ROUND2(b, c, d, a, 14, 23, 0xFDE5380C);
+        ROUND2(a, b, c, d,  1,  4, 0xA4BEEA44);
+        ROUND2(d, a, b, c,  4, 11, 0x4BDECFA9);
+        ROUND2(c, d, a, b,  7, 16, 0xF6BB4B60);
+        ROUND2(b, c, d, a, 10, 23, 0xBEBFBC70);
+        ROUND2(a, b, c, d, 13,  4, 0x289B7EC6);
+        ROUND2(d, a, b, c,  0, 11, 0xEAA127FA);
+        ROUND2(c, d, a, b,  3, 16, 0xD4EF3085);
+        ROUND2(b, c, d, a,  6, 23, 0x04881D05);
+        ROUND2(a, b, c, d,  9,  4, 0xD9D4D039);
+        ROUND2(d, a, b, c, 12, 11, 0xE6DB99E5);
+        ROUND2(c, d, a, b, 15, 16, 0x1FA27CF8);
+        ROUND2(b, c, d, a,  2, 23, 0xC4AC5665);
+        ROUND3(a, b, c, d,  0,  6, 0xF4292244);
+        ROUND3(d, a, b, c,  7, 10, 0x432AFF97);
+        ROUND3(c, d, a, b, 14, 15, 0xAB9423A7);
+        ROUND3(b, c, d, a,  5, 21, 0xFC93A039);
+        ROUND3(a, b, c, d, 12,  6, 0x655B59C3);
+        ROUND3(d, a, b, c,  3, 10, 0x8F0CCC92);
+        ROUND3(c, d, a, b, 10, 15, 0xFFEFF47D);
+        ROUND3(b, c, d, a,  1, 21, 0x85845DD1);
+        ROUND3(a, b, c, d,  8,  6, 0x6FA87E4F);
+        ROUND3(d, a, b, c, 15, 10, 0xFE2CE6E0);
+        ROUND3(c, d, a, b,  6, 15, 0xA3014314);
+        ROUND3(b, c, d, a, 13, 21, 0x4E0811A1);
+        ROUND3(a, b, c, d,  4,  6, 0xF7537E82);
+        ROUND3(d, a, b, c, 11, 10, 0xBD3AF235);
+        ROUND3(c, d, a, b,  2, 15, 0x2AD7D2BB);
+        ROUND3(b, c, d, a,  9, 21, 0xEB86D391);
+
+        hash_store(state[0], a + hash_load(state[0]));
+        hash_store(state[1], b + hash_load(state[1]));
+        hash_store(state[2], c + hash_load(state[2]));
+        hash_store(state[3], d + hash_load(state[3]));
+    }
+
+#undef ROUND_TAIL
+#undef ROUND0
+#undef ROUND1
+#undef ROUND2
+#undef ROUND3
+
+    // ----------------------------------------------------------------------------------------
+    // SHA1
+    // ----------------------------------------------------------------------------------------
+
+    void sha1_multi_transform(u32 (&state)[5][HashLanes], const BlockPointers& block)
+    {
+        HashVector w[16];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = hash_gather<true>(block, i * 4);
+        }
+
+        HashVector a = hash_load(state[0]);
+        HashVector b = hash_load(state[1]);
+        HashVector c = hash_load(state[2]);
+        HashVector d = hash_load(state[3]);
+        HashVector e = hash_load(state[4]);
+
+        const HashVector a0 = a;
+        const HashVector b0 = b;
+        const HashVector c0 = c;
+        const HashVector d0 = d;
+        const HashVector e0 = e;
+
+        for (int i = 0; i < 80; ++i)
+        {
+            if (i >= 16)
+            {
+                w[i & 15] = rol<1>(w[(i - 3) & 15] ^ w[(i - 8) & 15] ^ w[(i - 14) & 15] ^ w[i & 15]);
+            }
+
+            HashVector f;
+            u32 k;
+
+            if (i < 20)
+            {
+                f = d ^ (b & (c ^ d));
+                k = 0x5a827999;
+            }
+            else if (i < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            }
+            else if (i < 60)
+            {
+                f = (b & c) | (d & (b | c));
+                k = 0x8f1bbcdc;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+
+            HashVector x = rol<5>(a) + f + e + hash_set(k) + w[i & 15];
+            e = d;
+            d = c;
+            c = rol<30>(b);
+            b = a;
+            a = x;
+        }
+
+        hash_store(state[0], a + a0);
+        hash_store(state[1], b + b0);
+        hash_store(state[2], c + c0);
+        hash_store(state[3], d + d0);
+        hash_store(state[4], e + e0);
+    }
+
+    // ----------------------------------------------------------------------------------------
+    // SHA2
+    // ----------------------------------------------------------------------------------------
+
+    void sha2_multi_transform(u32 (&state)[8][HashLanes], const BlockPointers& block)
+    {
+        static const u32 k[] =
+        {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        HashVector w[16];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = hash_gather<true>(block, i * 4);
+        }
+
+        HashVector a = hash_load(state[0]);
+        HashVector b = hash_load(state[1]);
+        HashVector c = hash_load(state[2]);
+        HashVector d = hash_load(state[3]);
+        HashVector e = hash_load(state[4]);
+        HashVector f = hash_load(state[5]);
+        HashVector g = hash_load(state[6]);
+        HashVector h = hash_load(state[7]);
+
+        for (int i = 0; i < 64; ++i)
+        {
+            if (i >= 16)
+            {
+                HashVector w15 = w[(i - 15) & 15];
+                HashVector w2 = w[(i - 2) & 15];
+                HashVector t0 = ror<7>(w15) ^ ror<18>(w15) ^ simd::srli<3>(w15);
+                HashVector t1 = ror<17>(w2) ^ ror<19>(w2) ^ simd::srli<10>(w2);
+                w[i & 15] = w[i & 15] + t0 + w[(i - 7) & 15] + t1;
+            }
+
+            HashVector s1 = ror<6>(e) ^ ror<11>(e) ^ ror<25>(e);
+            HashVector ch = (e & f) ^ andnot(e, g);
+            HashVector x = h + s1 + ch + hash_set(k[i]) + w[i & 15];
+            HashVector s0 = ror<2>(a) ^ ror<13>(a) ^ ror<22>(a);
+            HashVector maj = (a & b) | (c & (a | b));
+            HashVector y = s0 + maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + x;
+            d = c;
+            c = b;
+            b = a;
+            a = x + y;
+        }
+
+        hash_store(state[0], a + hash_load(state[0]));
+        hash_store(state[1], b + hash_load(state[1]));
+        hash_store(state[2], c + hash_load(state[2]));
+        hash_store(state[3], d + hash_load(state[3]));
+        hash_store(state[4], e + hash_load(state[4]));
+        hash_store(state[5], f + hash_load(state[5]));
+        hash_store(state[6], g + hash_load(state[6]));
+        hash_store(state[7], h + hash_load(state[7]));
+    }
+
+    // ----------------------------------------------------------------------------------------
+    // scheduler
+    // ----------------------------------------------------------------------------------------
+
+    struct HashLane
+    {
+        const u8* data;
+        size_t blocks; // remaining full blocks in the message
+        u8 tail[128];  // padded last block(s)
+        int tail_blocks;
+        int tail_index;
+        size_t message;
+
+        void init(ConstMemory memory, size_t index, bool BigEndian)
+        {
+            data = memory.address;
+            blocks = memory.size / 64;
+            message = index;
+            tail_index = 0;
+
+            size_t remain = memory.size & 63;
+            tail_blocks = remain < 56 ? 1 : 2;
+
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, data + blocks * 64, remain);
+            tail[remain] = 0x80;
+
+            u8* length = tail + tail_blocks * 64 - 8;
+            u64 bits = u64(memory.size) * 8;
+
+            if (BigEndian)
+                bigEndian::ustore64(length, bits);
+            else
+                littleEndian::ustore64(length, bits);
+        }
+
+        const u8* next()
+        {
+            const u8* block;
+
+            if (blocks)
+            {
+                block = data;
+                data += 64;
+                --blocks;
+            }
+            else
+            {
+                block = tail + tail_index * 64;
+                ++tail_index;
+            }
+
+            return block;
+        }
+
+        bool done() const
+        {
+            return !blocks && tail_index == tail_blocks;
+        }
+    };
+
+    template <typename H, int Words, bool BigEndian, typename Transform>
+    void multi_hash(H* hashes, const ConstMemory* messages, size_t count, const u32 (&iv)[Words], Transform transform)
+    {
+        alignas(64) u32 state[Words][HashLanes];
+        alignas(64) static const u8 idle_block[64] = { 0 };
+
+        HashLane lanes[HashLanes];
+        BlockPointers block;
+
+        size_t next = 0;
+        int active = 0;
+
+        auto schedule = [&] (int lane)
+        {
+            if (next < count)
+            {
+                lanes[lane].init(messages[next], next, BigEndian);
+                for (int j = 0; j < Words; ++j)
+                {
+                    state[j][lane] = iv[j];
+                }
+
+                ++next;
+                ++active;
+            }
+            else
+            {
+                lanes[lane].message = count; // idle
+            }
+        };
+
+        for (int lane = 0; lane < HashLanes; ++lane)
+        {
+            schedule(lane);
+        }
+
+        while (active > 0)
+        {
+            for (int lane = 0; lane < HashLanes; ++lane)
+            {
+                block[lane] = lanes[lane].message < count ? lanes[lane].next() : idle_block;
+            }
+
+            transform(state, block);
+
+            for (int lane = 0; lane < HashLanes; ++lane)
+            {
+                HashLane& current = lanes[lane];
+
+                if (current.message < count && current.done())
+                {
+                    H& hash = hashes[current.message];
+
+                    for (int j = 0; j < Words; ++j)
+                    {
+                        u32 value = state[j][lane];
+#ifdef MANGO_LITTLE_ENDIAN
+                        // SHA digests are stored in big endian byte order
+                        value = BigEndian ? byteswap(value) : value;
+#endif
+                        hash.data[j] = value;
+                    }
+
+                    --active;
+                    schedule(lane);
+                }
+            }
+        }
+    }
+
+} // namespace
+
+namespace mango
+{
+
+    void md5(MD5* hashes, const ConstMemory* messages, size_t count)
+    {
+        static const u32 iv [] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+        multi_hash<MD5, 4, false>(hashes, messages, count, iv, md5_multi_transform);
+    }
+
+    void sha1(SHA1* hashes, const ConstMemory* messages, size_t count)
+    {
+        u64 flags = getCPUFlags();
+        MANGO_UNREFERENCED(flags);
+
+#if defined(MANGO_LICENSE_ENABLE_APACHE) && defined(__ARM_FEATURE_CRYPTO)
+        if ((flags & ARM_SHA1) != 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                hashes[i] = sha1(messages[i]);
+            }
+            return;
+        }
+#elif defined(MANGO_LICENSE_ENABLE_BSD) && defined(__SHA__)
+        if ((flags & INTEL_SHA) != 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                hashes[i] = sha1(messages[i]);
+            }
+            return;
+        }
+#endif
+
+        static const u32 iv [] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+        multi_hash<SHA1, 5, true>(hashes, messages, count, iv, sha1_multi_transform);
+    }
+
+    void sha2(SHA2* hashes, const ConstMemory* messages, size_t count)
+    {
+        u64 flags = getCPUFlags();
+        MANGO_UNREFERENCED(flags);
+
+#if defined(MANGO_LICENSE_ENABLE_APACHE) && defined(__ARM_FEATURE_CRYPTO)
+        if ((flags & ARM_SHA2) != 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                hashes[i] = sha2(messages[i]);
+            }
+            return;
+        }
+#endif
+#if defined(MANGO_LICENSE_ENABLE_BSD) && defined(__SHA__)
+        if ((flags & INTEL_SHA) != 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                hashes[i] = sha2(messages[i]);
+            }
+            return;
+        }
+#endif
+
+        static const u32 iv [] =
+        {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        multi_hash<SHA2, 8, true>(hashes, messages, count, iv, sha2_multi_transform);
+    }
+
+} // namespace mango
@@ -101,49 +101,111 @@ namespace
 #undef ROUND2
 #undef ROUND3
 
+    void md5_transform(u32 state[4], const u8* data, int blocks)
+    {
+        for (int i = 0; i < blocks; ++i)
+        {
+            md5_update(state, reinterpret_cast<const u32 *>(data));
+            data += 64;
+        }
+    }
+
 } // namespace
 
 namespace mango
 {
 
-    MD5 md5(ConstMemory memory)
+    // -----------------------------------------------------------------------
+    // MD5Context
+    // -----------------------------------------------------------------------
+
+    MD5Context::MD5Context()
     {
-        MD5 hash;
+        reset();
+    }
 
-        hash.data[0] = 0x67452301;
-        hash.data[1] = 0xEFCDAB89;
-        hash.data[2] = 0x98BADCFE;
-        hash.data[3] = 0x10325476;
+    void MD5Context::reset()
+    {
+        m_state[0] = 0x67452301;
+        m_state[1] = 0xEFCDAB89;
+        m_state[2] = 0x98BADCFE;
+        m_state[3] = 0x10325476;
+        m_size = 0;
+    }
 
-        const u32 size = u32(memory.size);
-        u32 i = 0;
-        for ( ; size - i >= 64; i += 64)
+    void MD5Context::update(ConstMemory memory)
+    {
+        const u8* data = memory.address;
+        size_t size = memory.size;
+
+        size_t offset = size_t(m_size & 63);
+        m_size += size;
+
+        if (offset)
         {
-            md5_update(hash.data, reinterpret_cast<const u32 *>(memory.address + i));
+            // complete the partial block from previous update
+            size_t bytes = std::min(size, 64 - offset);
+            std::memcpy(m_block + offset, data, bytes);
+            data += bytes;
+            size -= bytes;
+
+            if (offset + bytes < 64)
+            {
+                return;
+            }
+
+            md5_transform(m_state, m_block, 1);
+        }
+
+        while (size >= 64)
+        {
+            const int block_count = int(std::min(size / 64, size_t(0x1000000)));
+            md5_transform(m_state, data, block_count);
+            data += block_count * 64;
+            size -= block_count * 64;
         }
 
+        std::memcpy(m_block, data, size);
+    }
+
+    MD5 MD5Context::final() const
+    {
+        MD5 hash;
+        std::memcpy(hash.data, m_state, sizeof(m_state));
+
         u32 block[16];
         u8* byteBlock = reinterpret_cast<u8 *>(block);
 
-        u32 remain = size - i;
-        memcpy(byteBlock, memory.address + i, remain);
+        u32 remain = u32(m_size & 63);
+        std::memcpy(byteBlock, m_block, remain);
 
         byteBlock[remain++] = 0x80;
         if (64 - remain >= 8)
         {
-            memset(byteBlock + remain, 0, 56 - remain);
+            std::memset(byteBlock + remain, 0, 56 - remain);
         }
         else
         {
-            memset(byteBlock + remain, 0, 64 - remain);
+            std::memset(byteBlock + remain, 0, 64 - remain);
             md5_update(hash.data, block);
-            memset(block, 0, 56);
+            std::memset(block, 0, 56);
         }
-        block[14] = size << 3;
-        block[15] = size >> 29;
+        block[14] = u32(m_size << 3);
+        block[15] = u32(m_size >> 29);
         md5_update(hash.data, block);
 
         return hash;
     }
 
+    // -----------------------------------------------------------------------
+    // md5()
+    // -----------------------------------------------------------------------
+
+    MD5 md5(ConstMemory memory)
+    {
+        MD5Context context;
+        context.update(memory);
+        return context.final();
+    }
+
 } // namespace mango
@@ -572,42 +572,84 @@ namespace
 namespace mango
 {
 
-    SHA1 sha1(ConstMemory memory)
-    {
-        SHA1 hash;
-
-        hash.data[0] = 0x67452301;
-        hash.data[1] = 0xefcdab89;
-        hash.data[2] = 0x98badcfe;
-        hash.data[3] = 0x10325476;
-        hash.data[4] = 0xc3d2e1f0;
+    // -----------------------------------------------------------------------
+    // SHA1Context
+    // -----------------------------------------------------------------------
 
+    SHA1Context::SHA1Context()
+    {
         // select implementation
-        auto transform = generic_sha1_transform;
+        m_transform = generic_sha1_transform;
 
 #if defined(MANGO_LICENSE_ENABLE_APACHE) && defined(__ARM_FEATURE_CRYPTO)
         if ((getCPUFlags() & ARM_SHA1) != 0)
         {
-            transform = arm_sha1_transform;
+            m_transform = arm_sha1_transform;
         }
 #elif defined(MANGO_LICENSE_ENABLE_BSD) && defined(__SHA__)
         if ((getCPUFlags() & INTEL_SHA) != 0)
         {
-            transform = intel_sha1_transform;
+            m_transform = intel_sha1_transform;
         }
 #endif
 
-        u32 size = u32(memory.size);
+        reset();
+    }
+
+    void SHA1Context::reset()
+    {
+        m_state[0] = 0x67452301;
+        m_state[1] = 0xefcdab89;
+        m_state[2] = 0x98badcfe;
+        m_state[3] = 0x10325476;
+        m_state[4] = 0xc3d2e1f0;
+        m_size = 0;
+    }
+
+    void SHA1Context::update(ConstMemory memory)
+    {
         const u8* data = memory.address;
+        size_t size = memory.size;
+
+        size_t offset = size_t(m_size & 63);
+        m_size += size;
+
+        if (offset)
+        {
+            // complete the partial block from previous update
+            size_t bytes = std::min(size, 64 - offset);
+            std::memcpy(m_block + offset, data, bytes);
+            data += bytes;
+            size -= bytes;
+
+            if (offset + bytes < 64)
+            {
+                return;
+            }
+
+            m_transform(m_state, m_block, 1);
+        }
 
-        const int block_count = size / 64;
-        transform(hash.data, data, block_count);
-        data += block_count * 64;
-        size -= block_count * 64;
+        while (size >= 64)
+        {
+            const int block_count = int(std::min(size / 64, size_t(0x1000000)));
+            m_transform(m_state, data, block_count);
+            data += block_count * 64;
+            size -= block_count * 64;
+        }
+
+        std::memcpy(m_block, data, size);
+    }
+
+    SHA1 SHA1Context::final() const
+    {
+        SHA1 hash;
+        std::memcpy(hash.data, m_state, sizeof(m_state));
 
         u8 block[64];
 
-        std::memcpy(block, data, size);
+        u32 size = u32(m_size & 63);
+        std::memcpy(block, m_block, size);
         block[size++] = 0x80;
 
         if (size <= 56)
@@ -617,12 +659,12 @@ namespace mango
         else
         {
             std::memset(block + size, 0, 64 - size);
-            transform(hash.data, block, 1);
+            m_transform(hash.data, block, 1);
             std::memset(block, 0, 56);
         }
 
-        bigEndian::ustore64(block + 56, u64(memory.size * 8));
-        transform(hash.data, block, 1);
+        bigEndian::ustore64(block + 56, m_size * 8);
+        m_transform(hash.data, block, 1);
 
 #ifdef MANGO_LITTLE_ENDIAN
         hash.data[0] = byteswap(hash.data[0]);
@@ -635,4 +677,106 @@ namespace mango
         return hash;
     }
 
+    // -----------------------------------------------------------------------
+    // sha1()
+    // -----------------------------------------------------------------------
+
+    SHA1 sha1(ConstMemory memory)
+    {
+        SHA1Context context;
+        context.update(memory);
+        return context.final();
+    }
+
+    // -----------------------------------------------------------------------
+    // HMACSHA1Context
+    // -----------------------------------------------------------------------
+
+    HMACSHA1Context::HMACSHA1Context(ConstMemory key)
+    {
+        u8 block[64] = { 0 };
+
+        if (key.size > 64)
+        {
+            SHA1 hash = sha1(key);
+            std::memcpy(block, hash.data, 20);
+        }
+        else
+        {
+            std::memcpy(block, key.address, key.size);
+        }
+
+        u8 ipad[64];
+        u8 opad[64];
+
+        for (int i = 0; i < 64; ++i)
+        {
+            ipad[i] = block[i] ^ 0x36;
+            opad[i] = block[i] ^ 0x5c;
+        }
+
+        m_inner.update(ConstMemory(ipad, 64));
+        m_outer.update(ConstMemory(opad, 64));
+    }
+
+    void HMACSHA1Context::update(ConstMemory memory)
+    {
+        m_inner.update(memory);
+    }
+
+    SHA1 HMACSHA1Context::final() const
+    {
+        SHA1 inner = m_inner.final();
+
+        SHA1Context outer = m_outer;
+        outer.update(ConstMemory(reinterpret_cast<const u8*>(inner.data), 20));
+        return outer.final();
+    }
+
+    SHA1 hmac_sha1(ConstMemory key, ConstMemory message)
+    {
+        HMACSHA1Context context(key);
+        context.update(message);
+        return context.final();
+    }
+
+    void pbkdf2_sha1(Memory output, ConstMemory password, ConstMemory salt, int iterations)
+    {
+        // the password is keyed only once; each iteration is two transforms
+        const HMACSHA1Context keyed(password);
+
+        u8* dest = output.address;
+        size_t size = output.size;
+
+        for (u32 index = 1; size > 0; ++index)
+        {
+            u8 counter[4];
+            bigEndian::ustore32(counter, index);
+
+            HMACSHA1Context context = keyed;
+            context.update(salt);
+            context.update(ConstMemory(counter, 4));
+
+            SHA1 u = context.final();
+            SHA1 t = u;
+
+            for (int i = 1; i < iterations; ++i)
+            {
+                context = keyed;
+                context.update(ConstMemory(reinterpret_cast<const u8*>(u.data), 20));
+                u = context.final();
+
+                for (int j = 0; j < 5; ++j)
+                {
+                    t.data[j] ^= u.data[j];
+                }
+            }
+
+            size_t bytes = std::min(size, size_t(20));
+            std::memcpy(dest, t.data, bytes);
+            dest += bytes;
+            size -= bytes;
+        }
+    }
+
 } // namespace mango
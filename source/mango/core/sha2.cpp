@@ -566,56 +566,99 @@ namespace
 namespace mango
 {
 
-    SHA2 sha2(ConstMemory memory)
-    {
-        SHA2 hash;
-
-        hash.data[0] = 0x6a09e667;
-        hash.data[1] = 0xbb67ae85;
-        hash.data[2] = 0x3c6ef372;
-        hash.data[3] = 0xa54ff53a;
-        hash.data[4] = 0x510e527f;
-        hash.data[5] = 0x9b05688c;
-        hash.data[6] = 0x1f83d9ab;
-        hash.data[7] = 0x5be0cd19;
+    // -----------------------------------------------------------------------
+    // SHA2Context
+    // -----------------------------------------------------------------------
 
+    SHA2Context::SHA2Context()
+    {
         // select implementation
-        auto transform = generic_sha2_transform;
+        m_transform = generic_sha2_transform;
 
 #if defined(MANGO_LICENSE_ENABLE_APACHE) && defined(__ARM_FEATURE_CRYPTO)
         if ((getCPUFlags() & ARM_SHA2) != 0)
         {
-            transform = arm_sha2_transform;
+            m_transform = arm_sha2_transform;
         }
 #endif
 #if defined(MANGO_LICENSE_ENABLE_BSD) && defined(__SHA__)
         if ((getCPUFlags() & INTEL_SHA) != 0)
         {
-            transform = intel_sha2_transform;
+            m_transform = intel_sha2_transform;
         }
 #endif
 
-        u32 size = u32(memory.size);
+        reset();
+    }
+
+    void SHA2Context::reset()
+    {
+        m_state[0] = 0x6a09e667;
+        m_state[1] = 0xbb67ae85;
+        m_state[2] = 0x3c6ef372;
+        m_state[3] = 0xa54ff53a;
+        m_state[4] = 0x510e527f;
+        m_state[5] = 0x9b05688c;
+        m_state[6] = 0x1f83d9ab;
+        m_state[7] = 0x5be0cd19;
+        m_size = 0;
+    }
+
+    void SHA2Context::update(ConstMemory memory)
+    {
         const u8* data = memory.address;
+        size_t size = memory.size;
+
+        size_t offset = size_t(m_size & 63);
+        m_size += size;
+
+        if (offset)
+        {
+            // complete the partial block from previous update
+            size_t bytes = std::min(size, 64 - offset);
+            std::memcpy(m_block + offset, data, bytes);
+            data += bytes;
+            size -= bytes;
+
+            if (offset + bytes < 64)
+            {
+                return;
+            }
+
+            m_transform(m_state, m_block, 1);
+        }
+
+        while (size >= 64)
+        {
+            const int block_count = int(std::min(size / 64, size_t(0x1000000)));
+            m_transform(m_state, data, block_count);
+            data += block_count * 64;
+            size -= block_count * 64;
+        }
+
+        std::memcpy(m_block, data, size);
+    }
 
-        const int block_count = size / 64;
-        transform(hash.data, data, block_count);
-        data += block_count * 64;
-        size -= block_count * 64;
+    SHA2 SHA2Context::final() const
+    {
+        SHA2 hash;
+        std::memcpy(hash.data, m_state, sizeof(m_state));
+
+        u32 size = u32(m_size & 63);
 
         u8 buffer[64];
-        std::memcpy(buffer, data, size);
+        std::memcpy(buffer, m_block, size);
         std::memset(buffer + size, 0, 64 - size);
         buffer[size] = 0x80;
 
         if (size >= 56)
         {
-            transform(hash.data, buffer, 1);
+            m_transform(hash.data, buffer, 1);
             std::memset(buffer, 0, 56);
         }
 
-        bigEndian::ustore64(buffer + 56, memory.size * 8);
-        transform(hash.data, buffer, 1);
+        bigEndian::ustore64(buffer + 56, m_size * 8);
+        m_transform(hash.data, buffer, 1);
 
 #ifdef MANGO_LITTLE_ENDIAN
         hash.data[0] = byteswap(hash.data[0]);
@@ -631,4 +674,15 @@ namespace mango
         return hash;
     }
 
+    // -----------------------------------------------------------------------
+    // sha2()
+    // -----------------------------------------------------------------------
+
+    SHA2 sha2(ConstMemory memory)
+    {
+        SHA2Context context;
+        context.update(memory);
+        return context.final();
+    }
+
 } // namespace mango
@@ -14,6 +14,9 @@ namespace
 
     static constexpr u64 mgx_header_size = 24;
 
+    // block is compressed with the archive dictionary (version 2)
+    static constexpr u32 mgx_dictionary_flag = 0x100;
+
     struct Segment
     {
         u32 block;
@@ -26,10 +29,31 @@ namespace
         ConstMemory compressed;
         u64 uncompressed;
         u32 method;
+        const CompressionDictionary* dictionary = nullptr;
 
         void decompress(Memory dest) const
         {
             assert(dest.size == uncompressed);
+
+            if (method & mgx_dictionary_flag)
+            {
+                switch (method & ~mgx_dictionary_flag)
+                {
+                    case Compressor::ZSTD:
+                        zstd::decompress(dest, compressed, *dictionary);
+                        break;
+
+                    case Compressor::LZ4:
+                        lz4::decompress(dest, compressed, *dictionary);
+                        break;
+
+                    default:
+                        MANGO_EXCEPTION("[mapper.mgx] Incorrect dictionary compression ({}).", method);
+                }
+
+                return;
+            }
+
             Compressor compressor = getCompressor(Compressor::Method(method));
             compressor.decompress(dest, compressed);
         }
@@ -64,6 +88,7 @@ namespace
         ConstMemory m_memory;
         fs::Indexer<FileHeader> m_folders;
         std::vector<Block> m_blocks;
+        std::shared_ptr<CompressionDictionary> m_dictionary;
 
         HeaderMGX(ConstMemory memory)
             : m_memory(memory)
@@ -96,17 +121,15 @@ namespace
             u64 block_offset = p.read64();
             u64 file_offset = p.read64();
 
-            parseBlocks(memory.address + block_offset);
+            parseBlocks(memory.address + block_offset, version);
             parseFiles(memory.address + file_offset);
-
-            MANGO_UNREFERENCED(version);
         }
 
         ~HeaderMGX()
         {
         }
 
-        void parseBlocks(LittleEndianConstPointer p)
+        void parseBlocks(LittleEndianConstPointer p, u32 version)
         {
             u32 magic1 = p.read32();
             if (magic1 != u32_mask('m', 'g', 'x', '1'))
@@ -128,6 +151,46 @@ namespace
                 m_blocks.push_back(block);
             }
 
+            if (version >= 2)
+            {
+                // shared dictionary
+                u64 offset = p.read64();
+                u64 size = p.read64();
+                u32 method = p.read32();
+
+                if (size)
+                {
+                    ConstMemory memory(m_memory.address + offset, size_t(size));
+
+                    switch (method)
+                    {
+                        case Compressor::ZSTD:
+                            m_dictionary = zstd::createDictionary(memory);
+                            break;
+
+                        case Compressor::LZ4:
+                            m_dictionary = lz4::createDictionary(memory);
+                            break;
+
+                        default:
+                            MANGO_EXCEPTION("[mapper.mgx] Incorrect dictionary compression ({}).", method);
+                    }
+                }
+
+                for (Block& block : m_blocks)
+                {
+                    if (block.method & mgx_dictionary_flag)
+                    {
+                        if (!m_dictionary)
+                        {
+                            MANGO_EXCEPTION("[mapper.mgx] Missing dictionary.");
+                        }
+
+                        block.dictionary = m_dictionary.get();
+                    }
+                }
+            }
+
             u32 magic2 = p.read32();
             if (magic2 != u32_mask('m', 'g', 'x', '2'))
             {
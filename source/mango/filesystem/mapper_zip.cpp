@@ -1,11 +1,14 @@
 /*
     MANGO Multimedia Development Platform
-    Copyright (C) 2012-2023 Twilight Finland 3D Oy Ltd. All rights reserved.
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
 */
 #include <mango/core/pointer.hpp>
 #include <mango/core/string.hpp>
 #include <mango/core/exception.hpp>
 #include <mango/core/compress.hpp>
+#include <mango/core/aes.hpp>
+#include <mango/core/hash.hpp>
+#include <mango/core/crc32.hpp>
 #include <mango/filesystem/mapper.hpp>
 #include <mango/filesystem/path.hpp>
 #include "indexer.hpp"
@@ -35,6 +38,13 @@ namespace
 
     enum { DCKEYSIZE = 12 };
 
+    enum
+    {
+        AES_PWVERIFYSIZE = 2,
+        AES_AUTHCODESIZE = 10,
+        AES_ITERATIONS = 1000,
+    };
+
     enum Encryption : u8
     {
         ENCRYPTION_NONE    = 0,
@@ -205,6 +215,7 @@ namespace
         std::string filename;      // filename is stored after the header
         bool        is_folder;     // if the last character of filename is "/", it is a folder
         Encryption  encryption;
+        bool        crc_valid;     // AE-2 does not store the crc
 
         bool read(LittleEndianConstPointer& p)
         {
@@ -247,6 +258,7 @@ namespace
 
             filename = std::string(s, filenameLen);
             encryption = flags & 1 ? ENCRYPTION_CLASSIC : ENCRYPTION_NONE;
+            crc_valid = true;
 
             // read extra fields
             const u8* ext = p;
@@ -294,6 +306,9 @@ namespace
                             MANGO_EXCEPTION("[mapper.zip] Incorrect AES header.");
                         }
 
+                        // AE-2 replaces the crc with zero; the data is authenticated with HMAC
+                        crc_valid = version == 1;
+
                         // select encryption mode
                         switch (mode)
                         {
@@ -514,6 +529,110 @@ namespace
         return true;
     }
 
+    // --------------------------------------------------------------------
+    // WinZip AES (AE-1, AE-2)
+    // --------------------------------------------------------------------
+
+    // The data is encrypted with AES in CTR mode using little endian block counter
+    // starting from one. The encryption key, authentication key and the password
+    // verification value are derived from the password and salt with PBKDF2-HMAC-SHA1.
+    // The authentication code is the first 10 bytes of HMAC-SHA1 of the encrypted data.
+
+    class ZipDecryptAES
+    {
+    protected:
+        std::unique_ptr<AES> m_aes;
+        std::unique_ptr<HMACSHA1Context> m_hmac;
+        u8 m_verify[AES_PWVERIFYSIZE];
+        u64 m_counter = 1;
+        std::vector<u8> m_keystream;
+
+    public:
+        static constexpr size_t ChunkSize = 64 * 1024;
+
+        ZipDecryptAES(const std::string& password, ConstMemory salt)
+            : m_keystream(ChunkSize)
+        {
+            // salt is half of the key length
+            const size_t key_length = salt.size * 2;
+
+            u8 derived[32 * 2 + AES_PWVERIFYSIZE];
+            pbkdf2_sha1(Memory(derived, key_length * 2 + AES_PWVERIFYSIZE),
+                ConstMemory(reinterpret_cast<const u8*>(password.data()), password.length()),
+                salt, AES_ITERATIONS);
+
+            m_aes = std::make_unique<AES>(derived, int(key_length * 8));
+            m_hmac = std::make_unique<HMACSHA1Context>(ConstMemory(derived + key_length, key_length));
+            std::memcpy(m_verify, derived + key_length * 2, AES_PWVERIFYSIZE);
+        }
+
+        bool verify(const u8* value) const
+        {
+            return !std::memcmp(m_verify, value, AES_PWVERIFYSIZE);
+        }
+
+        // size must be multiple of 16 bytes except in the last call
+        void decrypt(u8* output, const u8* input, size_t size)
+        {
+            // the encrypted data is authenticated
+            m_hmac->update(ConstMemory(input, size));
+
+            while (size > 0)
+            {
+                size_t bytes = std::min(size, ChunkSize);
+                size_t blocks = (bytes + 15) / 16;
+
+                u8* keystream = m_keystream.data();
+
+                for (size_t i = 0; i < blocks; ++i)
+                {
+                    littleEndian::ustore64(keystream + i * 16 + 0, m_counter++);
+                    littleEndian::ustore64(keystream + i * 16 + 8, 0);
+                }
+
+                m_aes->ecb_block_encrypt(keystream, keystream, blocks * 16);
+
+                for (size_t i = 0; i < bytes; ++i)
+                {
+                    output[i] = input[i] ^ keystream[i];
+                }
+
+                output += bytes;
+                input += bytes;
+                size -= bytes;
+            }
+        }
+
+        bool authenticate(const u8* code) const
+        {
+            SHA1 hash = m_hmac->final();
+            const u8* expected = reinterpret_cast<const u8*>(hash.data);
+
+            u8 difference = 0;
+            for (int i = 0; i < AES_AUTHCODESIZE; ++i)
+            {
+                difference |= expected[i] ^ code[i];
+            }
+
+            return difference == 0;
+        }
+    };
+
+    Compressor::Method getStreamingMethod(u16 compression)
+    {
+        switch (compression)
+        {
+            case COMPRESSION_DEFLATE:
+                return Compressor::DEFLATE;
+            case COMPRESSION_BZIP2:
+                return Compressor::BZIP2;
+            case COMPRESSION_ZSTD:
+                return Compressor::ZSTD;
+            default:
+                return Compressor::NONE;
+        }
+    }
+
 } // namespace
 
 namespace mango::filesystem
@@ -645,26 +764,60 @@ namespace mango::filesystem
                 case ENCRYPTION_AES192:
                 case ENCRYPTION_AES256:
                 {
-                    u32 salt_length = getSaltLength(header.encryption);
-                    MANGO_UNREFERENCED(salt_length);
-                    MANGO_EXCEPTION("[mapper.zip] AES encryption is not supported.");
-#if 0                
-                    u8* saltvalue = address;
+                    const u32 salt_length = getSaltLength(header.encryption);
+                    const u64 overhead = salt_length + AES_PWVERIFYSIZE + AES_AUTHCODESIZE;
+
+                    if (header.compressedSize < overhead)
+                    {
+                        MANGO_EXCEPTION("[mapper.zip] Incorrect AES encrypted data.");
+                    }
+
+                    if (password.empty())
+                    {
+                        MANGO_EXCEPTION("[mapper.zip] Decryption failed (missing password).");
+                    }
+
+                    const u8* salt = address;
                     address += salt_length;
 
-                    u8* passverify = address;
+                    const u8* passverify = address;
                     address += AES_PWVERIFYSIZE;
 
-                    address += HMAC_LENGTH;
+                    header.compressedSize -= overhead;
+                    const u8* authcode = address + header.compressedSize;
+
+                    ZipDecryptAES decrypt(password, ConstMemory(salt, salt_length));
+                    if (!decrypt.verify(passverify))
+                    {
+                        MANGO_EXCEPTION("[mapper.zip] Decryption failed (probably incorrect password).");
+                    }
+
+                    // the streaming decompressors depend on the build configuration
+                    std::shared_ptr<StreamingDecompressor> decompressor;
 
-                    size_t compressed_size = size_t(header.compressedSize);
-                    compressed_size -= salt_length;
-                    compressed_size -= AES_PWVERIFYSIZE;
-                    compressed_size -= HMAC_LENGTH;
+                    if (header.compression != COMPRESSION_NONE)
+                    {
+                        decompressor = createStreamingDecompressor(getStreamingMethod(header.compression));
+                    }
+
+                    if (header.compression == COMPRESSION_NONE || decompressor)
+                    {
+                        // decryption is fused with decompression
+                        return mapAES(header, address, authcode, decrypt, decompressor.get());
+                    }
+
+                    // the remaining decompressors need all of the input at once
+                    const size_t compressed_size = size_t(header.compressedSize);
+                    buffer = new u8[compressed_size];
 
-                    // MANGO TODO: password + salt --> key
-                    // MANGO TODO: decrypt using the generated key
-#endif                
+                    decrypt.decrypt(buffer, address, compressed_size);
+                    if (!decrypt.authenticate(authcode))
+                    {
+                        delete[] buffer;
+                        MANGO_EXCEPTION("[mapper.zip] Authentication failed (the data is corrupted).");
+                    }
+
+                    address = buffer;
                     break;
                 }
             }
@@ -770,15 +923,117 @@ namespace mango::filesystem
             else if (size > 0)
             {
                 // no compression -> mapped directly to parent address
+                // NOTE: unencrypted stored files are not verified so that mapping
+                //       them does not touch the memory
             }
             else
             {
                 MANGO_EXCEPTION("[mapper.zip] Unsupported compression algorithm ({}).", header.compression);
             }
 
+            if (buffer && header.crc_valid)
+            {
+                // the data was decompressed or decrypted; large buffers are checked in parallel
+                u32 crc = crc32(0, ConstMemory(address, size_t(size)));
+                if (crc != header.crc)
+                {
+                    delete[] buffer;
+                    MANGO_EXCEPTION("[mapper.zip] CRC mismatch (the data is corrupted).");
+                }
+            }
+
             return std::make_unique<VirtualMemoryZIP>(address, buffer, size_t(size));
         }
 
+        std::unique_ptr<VirtualMemory> mapAES(const FileHeader& header, const u8* address, const u8* authcode,
+                                              ZipDecryptAES& decrypt, StreamingDecompressor* decompressor)
+        {
+            // decompressor is nullptr for stored entries
+            const size_t compressed_size = size_t(header.compressedSize);
+            const size_t uncompressed_size = size_t(header.uncompressedSize);
+
+            u8* buffer = new u8[uncompressed_size];
+            size_t produced = 0;
+
+            std::vector<u8> chunk(decompressor ? ZipDecryptAES::ChunkSize : 0);
+            std::string error;
+
+            // the crc is computed while the output is still in the cache
+            CRC32Context crc;
+
+            // decrypt one chunk at a time and push it into the decompressor; the chunk
+            // stays in the cache and no temporary buffer for the whole entry is needed
+            for (size_t offset = 0; offset < compressed_size && error.empty(); )
+            {
+                size_t bytes = std::min(compressed_size - offset, ZipDecryptAES::ChunkSize);
+
+                if (!decompressor)
+                {
+                    if (produced + bytes > uncompressed_size)
+                    {
+                        error = "Incorrect stored size.";
+                        break;
+                    }
+
+                    decrypt.decrypt(buffer + produced, address + offset, bytes);
+                    crc.update(ConstMemory(buffer + produced, bytes));
+                    produced += bytes;
+                }
+                else
+                {
+                    decrypt.decrypt(chunk.data(), address + offset, bytes);
+
+                    ConstMemory source(chunk.data(), bytes);
+
+                    while (source.size > 0)
+                    {
+                        Memory dest(buffer + produced, uncompressed_size - produced);
+                        StreamingStatus status = decompressor->decompress(dest, source);
+                        if (!status)
+                        {
+                            error = status.info;
+                            break;
+                        }
+
+                        crc.update(ConstMemory(buffer + produced, status.produced));
+                        produced += status.produced;
+                        source.address += status.consumed;
+                        source.size -= status.consumed;
+
+                        if (status.done || (!status.consumed && !status.produced))
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                offset += bytes;
+            }
+
+            if (error.empty() && !decrypt.authenticate(authcode))
+            {
+                error = "Authentication failed (the data is corrupted).";
+            }
+
+            if (error.empty() && produced != uncompressed_size)
+            {
+                error = "Incorrect decompressed size.";
+            }
+
+            if (error.empty() && header.crc_valid && crc.final() != header.crc)
+            {
+                error = "CRC mismatch (the data is corrupted).";
+            }
+
+            if (!error.empty())
+            {
+                delete[] buffer;
+                MANGO_EXCEPTION("[mapper.zip] {}", error);
+            }
+
+            return std::make_unique<VirtualMemoryZIP>(buffer, buffer, uncompressed_size);
+        }
+
         bool isFile(const std::string& filename) const override
         {
             const FileHeader* ptrHeader = m_folders.getHeader(filename);
@@ -64,6 +64,18 @@ namespace mango::image
 
     void encode_surface_astc          (const TextureCompression& info, u8* output, const u8* input, size_t stride);
 
+    // batch encode
+
+    using Quality = TextureCompression::Quality;
+
+    void encode_blocks_bc1            (u8* output, const u8* input, size_t stride, int count, Quality quality);
+    void encode_blocks_bc2            (u8* output, const u8* input, size_t stride, int count, Quality quality);
+    void encode_blocks_bc3            (u8* output, const u8* input, size_t stride, int count, Quality quality);
+    void encode_blocks_bc4u           (u8* output, const u8* input, size_t stride, int count, Quality quality);
+    void encode_blocks_bc4s           (u8* output, const u8* input, size_t stride, int count, Quality quality);
+    void encode_blocks_bc5u           (u8* output, const u8* input, size_t stride, int count, Quality quality);
+    void encode_blocks_bc5s           (u8* output, const u8* input, size_t stride, int count, Quality quality);
+
 } // namespace mango::image
 
 namespace
@@ -1126,6 +1138,58 @@ namespace
         }
     }
 
+    // block encode
+
+    using BatchEncodeFunc = void (*)(u8* output, const u8* input, size_t stride, int count, TextureCompression::Quality quality);
+
+    // formats with an encoder which compresses a whole row of blocks at once
+    BatchEncodeFunc getBatchEncoder(u32 compression)
+    {
+        switch (compression & ~TextureCompression::MASK)
+        {
+            case TextureCompression::DXT1 & ~TextureCompression::MASK:
+            case TextureCompression::DXT1_SRGB & ~TextureCompression::MASK:
+                return encode_blocks_bc1;
+            case TextureCompression::DXT3 & ~TextureCompression::MASK:
+            case TextureCompression::DXT3_SRGB & ~TextureCompression::MASK:
+                return encode_blocks_bc2;
+            case TextureCompression::DXT5 & ~TextureCompression::MASK:
+            case TextureCompression::DXT5_SRGB & ~TextureCompression::MASK:
+                return encode_blocks_bc3;
+            case TextureCompression::RGTC1_RED & ~TextureCompression::MASK:
+                return encode_blocks_bc4u;
+            case TextureCompression::RGTC1_SIGNED_RED & ~TextureCompression::MASK:
+                return encode_blocks_bc4s;
+            case TextureCompression::RGTC2_RG & ~TextureCompression::MASK:
+                return encode_blocks_bc5u;
+            case TextureCompression::RGTC2_SIGNED_RG & ~TextureCompression::MASK:
+                return encode_blocks_bc5s;
+            default:
+                return nullptr;
+        }
+    }
+
+    // replicate the last column and row into the padding of a partial block row
+    void extendBlockRow(const Surface& surface, int width, int height)
+    {
+        const size_t bpp = surface.format.bytes();
+
+        for (int y = 0; y < height; ++y)
+        {
+            u8* scan = surface.address(0, y);
+
+            for (int x = width; x < surface.width; ++x)
+            {
+                std::memcpy(scan + x * bpp, scan + (width - 1) * bpp, bpp);
+            }
+        }
+
+        for (int y = height; y < surface.height; ++y)
+        {
+            std::memcpy(surface.address(0, y), surface.address(0, height - 1), surface.width * bpp);
+        }
+    }
+
 } // namespace
 
 namespace mango::image
@@ -1308,7 +1372,16 @@ namespace mango::image
         return status;
     }
 
-    TextureCompression::Status TextureCompression::compress(Memory memory, const Surface& surface) const
+    TextureCompression::Quality TextureCompression::getQuality(float quality)
+    {
+        if (quality < 0.5f)
+            return Quality::FAST;
+        if (quality < 0.95f)
+            return Quality::NORMAL;
+        return Quality::BEST;
+    }
+
+    TextureCompression::Status TextureCompression::compress(Memory memory, const Surface& surface, Quality quality) const
     {
         TextureCompression::Status status;
 
@@ -1344,27 +1417,62 @@ namespace mango::image
             const int xblocks = getBlocksX(surface.width);
             const int yblocks = getBlocksY(surface.height);
 
-            for (int y = 0; y < yblocks; ++y)
-            {
-                queue.enqueue([this, y, xblocks, &surface, address]
-                {
-                    Bitmap temp(xblocks * width, height, format);
+            const BatchEncodeFunc batch = getBatchEncoder(compression);
 
-                    int w = std::min(surface.width, xblocks * width);
-                    int h = std::min(height, surface.height - y * height);
+            // block rows can be read directly from the surface when no conversion or padding is needed
+            const bool direct = surface.format == format && surface.width == xblocks * width;
 
-                    Surface source(surface, 0, y * height, w, h);
-                    temp.blit(0, 0, source);
+            // large enough tasks to amortize the scheduling, small enough to balance the load
+            const int rows = std::max(1, 2048 / xblocks);
 
-                    u8* data = address + y * xblocks * bytes;
-                    u8* image = temp.image;
-                    size_t step = width * format.bytes();
+            for (int y0 = 0; y0 < yblocks; y0 += rows)
+            {
+                const int y1 = std::min(y0 + rows, yblocks);
+
+                queue.enqueue([this, y0, y1, xblocks, direct, batch, quality, &surface, address]
+                {
+                    std::unique_ptr<Bitmap> temp;
 
-                    for (int x = 0; x < xblocks; ++x)
+                    for (int y = y0; y < y1; ++y)
                     {
-                        encode(*this, data, image, temp.stride);
-                        data += bytes;
-                        image += step;
+                        const u8* image = surface.address(0, y * height);
+                        size_t stride = surface.stride;
+
+                        if (!direct || (y + 1) * height > surface.height)
+                        {
+                            if (!temp)
+                            {
+                                temp = std::make_unique<Bitmap>(xblocks * width, height, format);
+                            }
+
+                            int w = std::min(surface.width, xblocks * width);
+                            int h = std::min(height, surface.height - y * height);
+
+                            Surface source(surface, 0, y * height, w, h);
+                            temp->blit(0, 0, source);
+                            extendBlockRow(*temp, w, h);
+
+                            image = temp->image;
+                            stride = temp->stride;
+                        }
+
+                        u8* data = address + y * xblocks * bytes;
+
+                        if (batch)
+                        {
+                            batch(data, image, stride, xblocks, quality);
+                        }
+                        else
+                        {
+                            size_t step = width * format.bytes();
+
+                            for (int x = 0; x < xblocks; ++x)
+                            {
+                                encode(*this, data, image, stride);
+                                data += bytes;
+                                image += step;
+                            }
+                        }
                     }
                 });
             }
@@ -0,0 +1,1064 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <algorithm>
+#include <limits>
+#include <mango/core/core.hpp>
+#include <mango/math/math.hpp>
+#include <mango/image/compression.hpp>
+
+/*
+    BC1 - BC5 batch encoder
+
+    The blocks are transposed into structure-of-arrays layout so that every SIMD lane
+    holds one block; the encoder processes 4 (SSE, NEON), 8 (AVX) or 16 (AVX-512)
+    blocks simultaneously. Every quality level runs the same code for all lanes:
+
+    FAST   : endpoints are the (inset) corners of the color bounding box
+    NORMAL : endpoints are fitted to the principal axis and refined with least squares
+    BEST   : all 4-cluster partitions along the principal axis are evaluated (cluster fit)
+*/
+
+namespace
+{
+    using namespace mango;
+    using namespace mango::math;
+    using namespace mango::image;
+
+    using Quality = TextureCompression::Quality;
+
+#if defined(MANGO_ENABLE_AVX512)
+    using FloatVector = float32x16;
+#elif defined(MANGO_ENABLE_AVX)
+    using FloatVector = float32x8;
+#else
+    using FloatVector = float32x4;
+#endif
+
+    constexpr int Lanes = FloatVector::VectorSize;
+
+    // ------------------------------------------------------------
+    // lane helpers
+    // ------------------------------------------------------------
+
+    struct LaneArray
+    {
+        alignas(64) float data[Lanes];
+
+        LaneArray(FloatVector v)
+        {
+            FloatVector::ustore(data, v);
+        }
+
+        u32 operator [] (int lane) const
+        {
+            return u32(s32(data[lane]));
+        }
+    };
+
+    static inline
+    FloatVector squared(FloatVector v)
+    {
+        return v * v;
+    }
+
+    // ------------------------------------------------------------
+    // block loading
+    // ------------------------------------------------------------
+
+    // Blocks past the count are filled with the last valid block so that
+    // the unused lanes compute something harmless.
+
+    struct ColorBlocks
+    {
+        FloatVector r[16];
+        FloatVector g[16];
+        FloatVector b[16];
+        FloatVector a[16];
+    };
+
+    void loadColorBlocks(ColorBlocks& blocks, const u8* input, size_t stride, int count)
+    {
+        alignas(64) float temp[4][16][Lanes];
+
+        for (int lane = 0; lane < Lanes; ++lane)
+        {
+            const u8* scan = input + std::min(lane, count - 1) * 16;
+
+            for (int y = 0; y < 4; ++y)
+            {
+                for (int x = 0; x < 4; ++x)
+                {
+                    const int i = y * 4 + x;
+                    temp[0][i][lane] = scan[x * 4 + 0];
+                    temp[1][i][lane] = scan[x * 4 + 1];
+                    temp[2][i][lane] = scan[x * 4 + 2];
+                    temp[3][i][lane] = scan[x * 4 + 3];
+                }
+
+                scan += stride;
+            }
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+            blocks.r[i] = FloatVector::uload(temp[0][i]);
+            blocks.g[i] = FloatVector::uload(temp[1][i]);
+            blocks.b[i] = FloatVector::uload(temp[2][i]);
+            blocks.a[i] = FloatVector::uload(temp[3][i]);
+        }
+    }
+
+    // load one channel of float32 RGBA blocks, scale it and clamp it to the endpoint range
+    void loadChannelBlocks(FloatVector* value, const u8* input, size_t stride, int count, int channel, float scale, float lo, float hi)
+    {
+        alignas(64) float temp[16][Lanes];
+
+        for (int lane = 0; lane < Lanes; ++lane)
+        {
+            const u8* scan = input + std::min(lane, count - 1) * 64;
+
+            for (int y = 0; y < 4; ++y)
+            {
+                const float* source = reinterpret_cast<const float*>(scan);
+
+                for (int x = 0; x < 4; ++x)
+                {
+                    temp[y * 4 + x][lane] = source[x * 4 + channel];
+                }
+
+                scan += stride;
+            }
+        }
+
+        const FloatVector vlo(lo);
+        const FloatVector vhi(hi);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            FloatVector v = FloatVector::uload(temp[i]) * scale;
+            value[i] = round(min(max(v, vlo), vhi));
+        }
+    }
+
+    // ------------------------------------------------------------
+    // color endpoints
+    // ------------------------------------------------------------
+
+    struct ColorEndpoints
+    {
+        // quantized 5:6:5 codes
+        FloatVector r0, g0, b0;
+        FloatVector r1, g1, b1;
+
+        // codes expanded to 8 bits exactly like the decoder does
+        FloatVector er0, eg0, eb0;
+        FloatVector er1, eg1, eb1;
+
+        FloatVector error;
+    };
+
+    static inline
+    FloatVector expand5(FloatVector q)
+    {
+        return q * 8.0f + floor(q * 0.25f);
+    }
+
+    static inline
+    FloatVector expand6(FloatVector q)
+    {
+        return q * 4.0f + floor(q * 0.0625f);
+    }
+
+    void quantizeEndpoints(ColorEndpoints& e,
+                           FloatVector r0, FloatVector g0, FloatVector b0,
+                           FloatVector r1, FloatVector g1, FloatVector b1)
+    {
+        const FloatVector zero(0.0f);
+        const FloatVector ceil255(255.0f);
+
+        r0 = clamp(r0, zero, ceil255);
+        g0 = clamp(g0, zero, ceil255);
+        b0 = clamp(b0, zero, ceil255);
+        r1 = clamp(r1, zero, ceil255);
+        g1 = clamp(g1, zero, ceil255);
+        b1 = clamp(b1, zero, ceil255);
+
+        e.r0 = round(r0 * (31.0f / 255.0f));
+        e.g0 = round(g0 * (63.0f / 255.0f));
+        e.b0 = round(b0 * (31.0f / 255.0f));
+        e.r1 = round(r1 * (31.0f / 255.0f));
+        e.g1 = round(g1 * (63.0f / 255.0f));
+        e.b1 = round(b1 * (31.0f / 255.0f));
+
+        e.er0 = expand5(e.r0);
+        e.eg0 = expand6(e.g0);
+        e.eb0 = expand5(e.b0);
+        e.er1 = expand5(e.r1);
+        e.eg1 = expand6(e.g1);
+        e.eb1 = expand5(e.b1);
+    }
+
+    // integer division by three as the decoder computes it; the bias keeps exact
+    // multiples of three from rounding down after the reciprocal multiply
+    static inline
+    FloatVector third(FloatVector a, FloatVector b)
+    {
+        return floor((a * 2.0f + b + 0.5f) * (1.0f / 3.0f));
+    }
+
+    // assign palette index for each pixel; returns the total squared error
+    FloatVector assignColorIndices(FloatVector* index, const ColorBlocks& blocks, const ColorEndpoints& e)
+    {
+        const FloatVector r2 = third(e.er0, e.er1);
+        const FloatVector g2 = third(e.eg0, e.eg1);
+        const FloatVector b2 = third(e.eb0, e.eb1);
+        const FloatVector r3 = third(e.er1, e.er0);
+        const FloatVector g3 = third(e.eg1, e.eg0);
+        const FloatVector b3 = third(e.eb1, e.eb0);
+
+        FloatVector error(0.0f);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const FloatVector r = blocks.r[i];
+            const FloatVector g = blocks.g[i];
+            const FloatVector b = blocks.b[i];
+
+            const FloatVector d0 = squared(r - e.er0) + squared(g - e.eg0) + squared(b - e.eb0);
+            const FloatVector d1 = squared(r - e.er1) + squared(g - e.eg1) + squared(b - e.eb1);
+            const FloatVector d2 = squared(r - r2) + squared(g - g2) + squared(b - b2);
+            const FloatVector d3 = squared(r - r3) + squared(g - g3) + squared(b - b3);
+
+            FloatVector best = d0;
+            FloatVector code(0.0f);
+
+            auto mask = d1 < best;
+            best = select(mask, d1, best);
+            code = select(mask, FloatVector(1.0f), code);
+
+            mask = d2 < best;
+            best = select(mask, d2, best);
+            code = select(mask, FloatVector(2.0f), code);
+
+            mask = d3 < best;
+            best = select(mask, d3, best);
+            code = select(mask, FloatVector(3.0f), code);
+
+            index[i] = code;
+            error += best;
+        }
+
+        return error;
+    }
+
+    // keep the candidate endpoints in lanes where they have smaller error
+    void selectColorEndpoints(ColorEndpoints& best, const ColorEndpoints& candidate)
+    {
+        auto mask = candidate.error < best.error;
+
+        best.r0 = select(mask, candidate.r0, best.r0);
+        best.g0 = select(mask, candidate.g0, best.g0);
+        best.b0 = select(mask, candidate.b0, best.b0);
+        best.r1 = select(mask, candidate.r1, best.r1);
+        best.g1 = select(mask, candidate.g1, best.g1);
+        best.b1 = select(mask, candidate.b1, best.b1);
+
+        best.er0 = select(mask, candidate.er0, best.er0);
+        best.eg0 = select(mask, candidate.eg0, best.eg0);
+        best.eb0 = select(mask, candidate.eb0, best.eb0);
+        best.er1 = select(mask, candidate.er1, best.er1);
+        best.eg1 = select(mask, candidate.eg1, best.eg1);
+        best.eb1 = select(mask, candidate.eb1, best.eb1);
+
+        best.error = select(mask, candidate.error, best.error);
+    }
+
+    struct ColorStatistics
+    {
+        FloatVector mr, mg, mb; // mean
+        FloatVector minr, ming, minb;
+        FloatVector maxr, maxg, maxb;
+    };
+
+    void computeColorStatistics(ColorStatistics& s, const ColorBlocks& blocks)
+    {
+        FloatVector sr = blocks.r[0];
+        FloatVector sg = blocks.g[0];
+        FloatVector sb = blocks.b[0];
+
+        s.minr = blocks.r[0];
+        s.ming = blocks.g[0];
+        s.minb = blocks.b[0];
+        s.maxr = blocks.r[0];
+        s.maxg = blocks.g[0];
+        s.maxb = blocks.b[0];
+
+        for (int i = 1; i < 16; ++i)
+        {
+            sr += blocks.r[i];
+            sg += blocks.g[i];
+            sb += blocks.b[i];
+
+            s.minr = min(s.minr, blocks.r[i]);
+            s.ming = min(s.ming, blocks.g[i]);
+            s.minb = min(s.minb, blocks.b[i]);
+            s.maxr = max(s.maxr, blocks.r[i]);
+            s.maxg = max(s.maxg, blocks.g[i]);
+            s.maxb = max(s.maxb, blocks.b[i]);
+        }
+
+        s.mr = sr * (1.0f / 16.0f);
+        s.mg = sg * (1.0f / 16.0f);
+        s.mb = sb * (1.0f / 16.0f);
+    }
+
+    struct ColorAxis
+    {
+        FloatVector r, g, b;
+    };
+
+    // principal axis of the color distribution with power iteration
+    void computePrincipalAxis(ColorAxis& axis, const ColorBlocks& blocks, const ColorStatistics& s)
+    {
+        FloatVector xx(0.0f);
+        FloatVector xy(0.0f);
+        FloatVector xz(0.0f);
+        FloatVector yy(0.0f);
+        FloatVector yz(0.0f);
+        FloatVector zz(0.0f);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const FloatVector r = blocks.r[i] - s.mr;
+            const FloatVector g = blocks.g[i] - s.mg;
+            const FloatVector b = blocks.b[i] - s.mb;
+
+            xx = madd(xx, r, r);
+            xy = madd(xy, r, g);
+            xz = madd(xz, r, b);
+            yy = madd(yy, g, g);
+            yz = madd(yz, g, b);
+            zz = madd(zz, b, b);
+        }
+
+        // start from the bounding box diagonal; the sign is irrelevant
+        FloatVector vr = s.maxr - s.minr;
+        FloatVector vg = s.maxg - s.ming;
+        FloatVector vb = s.maxb - s.minb;
+
+        for (int iteration = 0; iteration < 6; ++iteration)
+        {
+            const FloatVector r = xx * vr + xy * vg + xz * vb;
+            const FloatVector g = xy * vr + yy * vg + yz * vb;
+            const FloatVector b = xz * vr + yz * vg + zz * vb;
+
+            // normalize with the largest component to keep the values in range
+            const FloatVector m = max(max(abs(r), abs(g)), abs(b));
+            const auto valid = m > 0.0f;
+            const FloatVector scale = select(valid, FloatVector(1.0f) / max(m, FloatVector(1e-20f)), FloatVector(0.0f));
+
+            vr = select(valid, r * scale, vr);
+            vg = select(valid, g * scale, vg);
+            vb = select(valid, b * scale, vb);
+        }
+
+        axis.r = vr;
+        axis.g = vg;
+        axis.b = vb;
+    }
+
+    // endpoints at the extreme projections onto the axis
+    void fitAxisEndpoints(ColorEndpoints& e, const ColorBlocks& blocks, const ColorStatistics& s, const ColorAxis& axis)
+    {
+        FloatVector tmin(0.0f);
+        FloatVector tmax(0.0f);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const FloatVector t = (blocks.r[i] - s.mr) * axis.r +
+                                  (blocks.g[i] - s.mg) * axis.g +
+                                  (blocks.b[i] - s.mb) * axis.b;
+            tmin = min(tmin, t);
+            tmax = max(tmax, t);
+        }
+
+        const FloatVector length2 = axis.r * axis.r + axis.g * axis.g + axis.b * axis.b;
+        const auto valid = length2 > 0.0f;
+        const FloatVector scale = select(valid, FloatVector(1.0f) / max(length2, FloatVector(1e-20f)), FloatVector(0.0f));
+
+        tmin = tmin * scale;
+        tmax = tmax * scale;
+
+        quantizeEndpoints(e,
+            s.mr + axis.r * tmax, s.mg + axis.g * tmax, s.mb + axis.b * tmax,
+            s.mr + axis.r * tmin, s.mg + axis.g * tmin, s.mb + axis.b * tmin);
+    }
+
+    void fitBoxEndpoints(ColorEndpoints& e, const ColorBlocks& blocks, const ColorStatistics& s)
+    {
+        // pick the bounding box diagonal from the sign of the covariance with green
+        FloatVector rg(0.0f);
+        FloatVector bg(0.0f);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const FloatVector g = blocks.g[i] - s.mg;
+            rg = madd(rg, blocks.r[i] - s.mr, g);
+            bg = madd(bg, blocks.b[i] - s.mb, g);
+        }
+
+        // inset the box by 1/16th to reduce the error from the endpoint pixels
+        const FloatVector ir = (s.maxr - s.minr) * (1.0f / 16.0f);
+        const FloatVector ig = (s.maxg - s.ming) * (1.0f / 16.0f);
+        const FloatVector ib = (s.maxb - s.minb) * (1.0f / 16.0f);
+
+        const FloatVector maxr = s.maxr - ir;
+        const FloatVector maxg = s.maxg - ig;
+        const FloatVector maxb = s.maxb - ib;
+        const FloatVector minr = s.minr + ir;
+        const FloatVector ming = s.ming + ig;
+        const FloatVector minb = s.minb + ib;
+
+        const auto flipr = rg < 0.0f;
+        const auto flipb = bg < 0.0f;
+
+        quantizeEndpoints(e,
+            select(flipr, minr, maxr), maxg, select(flipb, minb, maxb),
+            select(flipr, maxr, minr), ming, select(flipb, maxb, minb));
+    }
+
+    // least squares endpoints for the current index assignment
+    void refineEndpoints(ColorEndpoints& e, const ColorBlocks& blocks, const FloatVector* index)
+    {
+        FloatVector aa(0.0f);
+        FloatVector bb(0.0f);
+        FloatVector ab(0.0f);
+        FloatVector ar(0.0f), ag(0.0f), ab_(0.0f);
+        FloatVector br(0.0f), bg(0.0f), bb_(0.0f);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            // index -> weight of the first endpoint: 0 -> 1, 1 -> 0, 2 -> 2/3, 3 -> 1/3
+            const FloatVector code = index[i];
+            FloatVector alpha = select(code == 0.0f, FloatVector(1.0f), FloatVector(0.0f));
+            alpha = select(code == 2.0f, FloatVector(2.0f / 3.0f), alpha);
+            alpha = select(code == 3.0f, FloatVector(1.0f / 3.0f), alpha);
+            const FloatVector beta = 1.0f - alpha;
+
+            aa = madd(aa, alpha, alpha);
+            bb = madd(bb, beta, beta);
+            ab = madd(ab, alpha, beta);
+
+            ar = madd(ar, alpha, blocks.r[i]);
+            ag = madd(ag, alpha, blocks.g[i]);
+            ab_ = madd(ab_, alpha, blocks.b[i]);
+            br = madd(br, beta, blocks.r[i]);
+            bg = madd(bg, beta, blocks.g[i]);
+            bb_ = madd(bb_, beta, blocks.b[i]);
+        }
+
+        const FloatVector det = aa * bb - ab * ab;
+        const auto valid = abs(det) > 1e-6f;
+        const FloatVector factor = select(valid, FloatVector(1.0f) / select(valid, det, FloatVector(1.0f)), FloatVector(0.0f));
+
+        const FloatVector r0 = (ar * bb - br * ab) * factor;
+        const FloatVector g0 = (ag * bb - bg * ab) * factor;
+        const FloatVector b0 = (ab_ * bb - bb_ * ab) * factor;
+        const FloatVector r1 = (br * aa - ar * ab) * factor;
+        const FloatVector g1 = (bg * aa - ag * ab) * factor;
+        const FloatVector b1 = (bb_ * aa - ab_ * ab) * factor;
+
+        ColorEndpoints candidate;
+        quantizeEndpoints(candidate, r0, g0, b0, r1, g1, b1);
+
+        // degenerate lanes keep their previous endpoints
+        candidate.r0 = select(valid, candidate.r0, e.r0);
+        candidate.g0 = select(valid, candidate.g0, e.g0);
+        candidate.b0 = select(valid, candidate.b0, e.b0);
+        candidate.r1 = select(valid, candidate.r1, e.r1);
+        candidate.g1 = select(valid, candidate.g1, e.g1);
+        candidate.b1 = select(valid, candidate.b1, e.b1);
+        candidate.er0 = select(valid, candidate.er0, e.er0);
+        candidate.eg0 = select(valid, candidate.eg0, e.eg0);
+        candidate.eb0 = select(valid, candidate.eb0, e.eb0);
+        candidate.er1 = select(valid, candidate.er1, e.er1);
+        candidate.eg1 = select(valid, candidate.eg1, e.eg1);
+        candidate.eb1 = select(valid, candidate.eb1, e.eb1);
+
+        FloatVector temp[16];
+        candidate.error = assignColorIndices(temp, blocks, candidate);
+
+        selectColorEndpoints(e, candidate);
+    }
+
+    struct ClusterWeights
+    {
+        float aa;
+        float bb;
+        float ab;
+        float factor;
+        u8 i, j, k;
+    };
+
+    struct ClusterTable
+    {
+        std::vector<ClusterWeights> weights;
+
+        ClusterTable()
+        {
+            // the points are sorted along the axis; the first i points get weight 0 for
+            // the first endpoint, next (j - i) points 1/3, next (k - j) points 2/3 and the rest 1
+            for (int i = 0; i <= 16; ++i)
+            {
+                for (int j = i; j <= 16; ++j)
+                {
+                    for (int k = j; k <= 16; ++k)
+                    {
+                        const float n1 = float(j - i);
+                        const float n2 = float(k - j);
+                        const float n3 = float(16 - k);
+
+                        const float aa = n1 * (1.0f / 9.0f) + n2 * (4.0f / 9.0f) + n3;
+                        const float bb = float(i) + n1 * (4.0f / 9.0f) + n2 * (1.0f / 9.0f);
+                        const float ab = (n1 + n2) * (2.0f / 9.0f);
+                        const float det = aa * bb - ab * ab;
+
+                        if (std::abs(det) < 1e-6f)
+                        {
+                            // single cluster; the box or axis fit handles these
+                            continue;
+                        }
+
+                        weights.push_back({ aa, bb, ab, 1.0f / det, u8(i), u8(j), u8(k) });
+                    }
+                }
+            }
+        }
+    };
+
+    void clusterFitEndpoints(ColorEndpoints& e, const ColorBlocks& blocks, const ColorStatistics& s, const ColorAxis& axis)
+    {
+        static const ClusterTable table;
+
+        alignas(64) float projection[16][Lanes];
+        alignas(64) float color[3][16][Lanes];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const FloatVector t = (blocks.r[i] - s.mr) * axis.r +
+                                  (blocks.g[i] - s.mg) * axis.g +
+                                  (blocks.b[i] - s.mb) * axis.b;
+            FloatVector::ustore(projection[i], t);
+            FloatVector::ustore(color[0][i], blocks.r[i]);
+            FloatVector::ustore(color[1][i], blocks.g[i]);
+            FloatVector::ustore(color[2][i], blocks.b[i]);
+        }
+
+        // sort every lane along the axis and compute prefix sums
+        alignas(64) float prefix[3][17][Lanes];
+
+        for (int lane = 0; lane < Lanes; ++lane)
+        {
+            u8 order[16];
+
+            for (int i = 0; i < 16; ++i)
+            {
+                order[i] = u8(i);
+            }
+
+            std::stable_sort(order, order + 16, [&] (u8 a, u8 b)
+            {
+                return projection[a][lane] < projection[b][lane];
+            });
+
+            float sr = 0.0f;
+            float sg = 0.0f;
+            float sb = 0.0f;
+
+            for (int i = 0; i < 16; ++i)
+            {
+                prefix[0][i][lane] = sr;
+                prefix[1][i][lane] = sg;
+                prefix[2][i][lane] = sb;
+                sr += color[0][order[i]][lane];
+                sg += color[1][order[i]][lane];
+                sb += color[2][order[i]][lane];
+            }
+
+            prefix[0][16][lane] = sr;
+            prefix[1][16][lane] = sg;
+            prefix[2][16][lane] = sb;
+        }
+
+        FloatVector sr[17];
+        FloatVector sg[17];
+        FloatVector sb[17];
+
+        for (int i = 0; i <= 16; ++i)
+        {
+            sr[i] = FloatVector::uload(prefix[0][i]);
+            sg[i] = FloatVector::uload(prefix[1][i]);
+            sb[i] = FloatVector::uload(prefix[2][i]);
+        }
+
+        const FloatVector zero(0.0f);
+        const FloatVector ceil255(255.0f);
+
+        FloatVector best(std::numeric_limits<float>::max());
+        FloatVector best_r0 = e.er0;
+        FloatVector best_g0 = e.eg0;
+        FloatVector best_b0 = e.eb0;
+        FloatVector best_r1 = e.er1;
+        FloatVector best_g1 = e.eg1;
+        FloatVector best_b1 = e.eb1;
+
+        for (const ClusterWeights& w : table.weights)
+        {
+            // alpha weighted sums; the beta weighted sums are the remainder
+            const FloatVector ar = (sr[w.j] - sr[w.i]) * (1.0f / 3.0f) + (sr[w.k] - sr[w.j]) * (2.0f / 3.0f) + (sr[16] - sr[w.k]);
+            const FloatVector ag = (sg[w.j] - sg[w.i]) * (1.0f / 3.0f) + (sg[w.k] - sg[w.j]) * (2.0f / 3.0f) + (sg[16] - sg[w.k]);
+            const FloatVector ab = (sb[w.j] - sb[w.i]) * (1.0f / 3.0f) + (sb[w.k] - sb[w.j]) * (2.0f / 3.0f) + (sb[16] - sb[w.k]);
+            const FloatVector br = sr[16] - ar;
+            const FloatVector bg = sg[16] - ag;
+            const FloatVector bb = sb[16] - ab;
+
+            // solve and snap to the 5:6:5 grid
+            FloatVector r0 = clamp((ar * w.bb - br * w.ab) * w.factor, zero, ceil255);
+            FloatVector g0 = clamp((ag * w.bb - bg * w.ab) * w.factor, zero, ceil255);
+            FloatVector b0 = clamp((ab * w.bb - bb * w.ab) * w.factor, zero, ceil255);
+            FloatVector r1 = clamp((br * w.aa - ar * w.ab) * w.factor, zero, ceil255);
+            FloatVector g1 = clamp((bg * w.aa - ag * w.ab) * w.factor, zero, ceil255);
+            FloatVector b1 = clamp((bb * w.aa - ab * w.ab) * w.factor, zero, ceil255);
+
+            r0 = expand5(round(r0 * (31.0f / 255.0f)));
+            g0 = expand6(round(g0 * (63.0f / 255.0f)));
+            b0 = expand5(round(b0 * (31.0f / 255.0f)));
+            r1 = expand5(round(r1 * (31.0f / 255.0f)));
+            g1 = expand6(round(g1 * (63.0f / 255.0f)));
+            b1 = expand5(round(b1 * (31.0f / 255.0f)));
+
+            // squared error without the constant sum of squared colors
+            FloatVector error = r0 * r0 * w.aa + r1 * r1 * w.bb + (r0 * r1 * w.ab - r0 * ar - r1 * br) * 2.0f;
+            error += g0 * g0 * w.aa + g1 * g1 * w.bb + (g0 * g1 * w.ab - g0 * ag - g1 * bg) * 2.0f;
+            error += b0 * b0 * w.aa + b1 * b1 * w.bb + (b0 * b1 * w.ab - b0 * ab - b1 * bb) * 2.0f;
+
+            auto mask = error < best;
+            best = select(mask, error, best);
+            best_r0 = select(mask, r0, best_r0);
+            best_g0 = select(mask, g0, best_g0);
+            best_b0 = select(mask, b0, best_b0);
+            best_r1 = select(mask, r1, best_r1);
+            best_g1 = select(mask, g1, best_g1);
+            best_b1 = select(mask, b1, best_b1);
+        }
+
+        ColorEndpoints candidate;
+        quantizeEndpoints(candidate, best_r0, best_g0, best_b0, best_r1, best_g1, best_b1);
+
+        FloatVector temp[16];
+        candidate.error = assignColorIndices(temp, blocks, candidate);
+
+        selectColorEndpoints(e, candidate);
+    }
+
+    void encodeColorBlocks(u8* output, size_t output_stride, const ColorBlocks& blocks, int count, Quality quality)
+    {
+        ColorStatistics s;
+        computeColorStatistics(s, blocks);
+
+        ColorEndpoints e;
+        FloatVector index[16];
+
+        if (quality == Quality::FAST)
+        {
+            fitBoxEndpoints(e, blocks, s);
+        }
+        else
+        {
+            ColorAxis axis;
+            computePrincipalAxis(axis, blocks, s);
+            fitAxisEndpoints(e, blocks, s, axis);
+            e.error = assignColorIndices(index, blocks, e);
+
+            for (int iteration = 0; iteration < 2; ++iteration)
+            {
+                refineEndpoints(e, blocks, index);
+                assignColorIndices(index, blocks, e);
+            }
+
+            if (quality == Quality::BEST)
+            {
+                clusterFitEndpoints(e, blocks, s, axis);
+            }
+        }
+
+        // four color mode requires color0 > color1
+        const FloatVector c0 = e.r0 * 2048.0f + e.g0 * 32.0f + e.b0;
+        const FloatVector c1 = e.r1 * 2048.0f + e.g1 * 32.0f + e.b1;
+
+        const auto swap = c0 < c1;
+
+        ColorEndpoints final = e;
+        final.er0 = select(swap, e.er1, e.er0);
+        final.eg0 = select(swap, e.eg1, e.eg0);
+        final.eb0 = select(swap, e.eb1, e.eb0);
+        final.er1 = select(swap, e.er0, e.er1);
+        final.eg1 = select(swap, e.eg0, e.eg1);
+        final.eb1 = select(swap, e.eb0, e.eb1);
+
+        assignColorIndices(index, blocks, final);
+
+        // solid color blocks only use the first endpoint
+        const auto solid = c0 == c1;
+
+        LaneArray color0 = select(swap, c1, c0);
+        LaneArray color1 = select(swap, c0, c1);
+
+        alignas(64) float codes[16][Lanes];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            FloatVector::ustore(codes[i], select(solid, FloatVector(0.0f), index[i]));
+        }
+
+        for (int lane = 0; lane < count; ++lane)
+        {
+            u32 bits = 0;
+
+            for (int i = 0; i < 16; ++i)
+            {
+                bits |= u32(codes[i][lane]) << (i * 2);
+            }
+
+            littleEndian::ustore16(output + 0, u16(color0[lane]));
+            littleEndian::ustore16(output + 2, u16(color1[lane]));
+            littleEndian::ustore32(output + 4, bits);
+            output += output_stride;
+        }
+    }
+
+    // ------------------------------------------------------------
+    // single channel (BC3 alpha, BC4, BC5)
+    // ------------------------------------------------------------
+
+    struct ChannelEndpoints
+    {
+        FloatVector e0;
+        FloatVector e1;
+        FloatVector error;
+    };
+
+    // endpoints with e0 > e1 interpolate 8 values
+    FloatVector assignInterpolated8(FloatVector* index, const FloatVector* value, FloatVector e0, FloatVector e1)
+    {
+        const FloatVector range = e0 - e1;
+        const auto valid = range > 0.0f;
+        const FloatVector scale = select(valid, FloatVector(7.0f) / select(valid, range, FloatVector(1.0f)), FloatVector(0.0f));
+        const FloatVector step = range * (1.0f / 7.0f);
+
+        FloatVector error(0.0f);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            // level 0 is e1, level 7 is e0; degenerate ranges use level 7 (index 0)
+            FloatVector level = clamp(round((value[i] - e1) * scale), FloatVector(0.0f), FloatVector(7.0f));
+            level = select(valid, level, FloatVector(7.0f));
+
+            error += squared(value[i] - (e1 + level * step));
+
+            FloatVector code = 8.0f - level;
+            code = select(level == 7.0f, FloatVector(0.0f), code);
+            code = select(level == 0.0f, FloatVector(1.0f), code);
+            index[i] = code;
+        }
+
+        return error;
+    }
+
+    // endpoints with e0 <= e1 interpolate 6 values and have explicit lo and hi values
+    FloatVector assignInterpolated6(FloatVector* index, const FloatVector* value, FloatVector e0, FloatVector e1, float lo, float hi)
+    {
+        const FloatVector range = e1 - e0;
+        const auto valid = range > 0.0f;
+        const FloatVector scale = select(valid, FloatVector(5.0f) / select(valid, range, FloatVector(1.0f)), FloatVector(0.0f));
+        const FloatVector step = range * (1.0f / 5.0f);
+
+        FloatVector error(0.0f);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const FloatVector v = value[i];
+
+            // level 0 is e0, level 5 is e1
+            const FloatVector level = clamp(round((v - e0) * scale), FloatVector(0.0f), FloatVector(5.0f));
+
+            FloatVector best = squared(v - (e0 + level * step));
+            FloatVector code = level + 1.0f;
+            code = select(level == 0.0f, FloatVector(0.0f), code);
+            code = select(level == 5.0f, FloatVector(1.0f), code);
+
+            const FloatVector dlo = squared(v - lo);
+            const FloatVector dhi = squared(v - hi);
+
+            auto mask = dlo < best;
+            best = select(mask, dlo, best);
+            code = select(mask, FloatVector(6.0f), code);
+
+            mask = dhi < best;
+            best = select(mask, dhi, best);
+            code = select(mask, FloatVector(7.0f), code);
+
+            index[i] = code;
+            error += best;
+        }
+
+        return error;
+    }
+
+    // least squares fit of the 8 value endpoints for the current levels
+    void refineInterpolated8(ChannelEndpoints& e, const FloatVector* value, const FloatVector* index, float lo, float hi)
+    {
+        FloatVector aa(0.0f);
+        FloatVector bb(0.0f);
+        FloatVector ab(0.0f);
+        FloatVector ax(0.0f);
+        FloatVector bx(0.0f);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            // index -> weight of e0: 0 -> 1, 1 -> 0, n -> (8 - n) / 7
+            const FloatVector code = index[i];
+            FloatVector alpha = (8.0f - code) * (1.0f / 7.0f);
+            alpha = select(code == 0.0f, FloatVector(1.0f), alpha);
+            alpha = select(code == 1.0f, FloatVector(0.0f), alpha);
+            const FloatVector beta = 1.0f - alpha;
+
+            aa = madd(aa, alpha, alpha);
+            bb = madd(bb, beta, beta);
+            ab = madd(ab, alpha, beta);
+            ax = madd(ax, alpha, value[i]);
+            bx = madd(bx, beta, value[i]);
+        }
+
+        const FloatVector det = aa * bb - ab * ab;
+        const auto valid = abs(det) > 1e-6f;
+        const FloatVector factor = select(valid, FloatVector(1.0f) / select(valid, det, FloatVector(1.0f)), FloatVector(0.0f));
+
+        FloatVector e0 = clamp(round((ax * bb - bx * ab) * factor), FloatVector(lo), FloatVector(hi));
+        FloatVector e1 = clamp(round((bx * aa - ax * ab) * factor), FloatVector(lo), FloatVector(hi));
+
+        // the mode must not change
+        const auto ordered = valid & (e0 > e1);
+        e0 = select(ordered, e0, e.e0);
+        e1 = select(ordered, e1, e.e1);
+
+        FloatVector temp[16];
+        const FloatVector error = assignInterpolated8(temp, value, e0, e1);
+
+        const auto mask = error < e.error;
+        e.e0 = select(mask, e0, e.e0);
+        e.e1 = select(mask, e1, e.e1);
+        e.error = select(mask, error, e.error);
+    }
+
+    // 6 value mode endpoints which span the values not within margin of the explicit lo and hi
+    void fitInterpolated6(ChannelEndpoints& e, FloatVector* index, const FloatVector* value, float lo, float hi, float margin)
+    {
+        FloatVector imin(hi);
+        FloatVector imax(lo);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const auto inner = (value[i] > lo + margin) & (value[i] < hi - margin);
+            imin = select(inner, min(imin, value[i]), imin);
+            imax = select(inner, max(imax, value[i]), imax);
+        }
+
+        FloatVector temp[16];
+
+        const FloatVector e0 = min(imin, imax);
+        const FloatVector e1 = imax;
+        const FloatVector error = assignInterpolated6(temp, value, e0, e1, lo, hi);
+
+        const auto mask = error < e.error;
+        e.e0 = select(mask, e0, e.e0);
+        e.e1 = select(mask, e1, e.e1);
+        e.error = select(mask, error, e.error);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            index[i] = select(mask, temp[i], index[i]);
+        }
+    }
+
+    // value is in the endpoint scale, rounded to integers, in range [lo, hi]
+    void encodeChannelBlocks(u8* output, size_t output_stride, const FloatVector* value, int count, Quality quality, float lo, float hi)
+    {
+        FloatVector vmin = value[0];
+        FloatVector vmax = value[0];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            vmin = min(vmin, value[i]);
+            vmax = max(vmax, value[i]);
+        }
+
+        FloatVector index[16];
+
+        ChannelEndpoints e8;
+        e8.e0 = vmax;
+        e8.e1 = vmin;
+        e8.error = assignInterpolated8(index, value, e8.e0, e8.e1);
+
+        if (quality == Quality::BEST)
+        {
+            for (int iteration = 0; iteration < 2; ++iteration)
+            {
+                refineInterpolated8(e8, value, index, lo, hi);
+                assignInterpolated8(index, value, e8.e0, e8.e1);
+            }
+        }
+
+        if (quality != Quality::FAST)
+        {
+            // the 6 value mode is used only when it has smaller error; values close to the
+            // explicit lo and hi are better snapped to them than stretching the interpolated range
+            fitInterpolated6(e8, index, value, lo, hi, 0.0f);
+            fitInterpolated6(e8, index, value, lo, hi, (hi - lo) / 32.0f);
+        }
+
+        LaneArray e0 = e8.e0;
+        LaneArray e1 = e8.e1;
+
+        u64 bits[Lanes] = { 0 };
+
+        for (int i = 0; i < 16; ++i)
+        {
+            LaneArray code = index[i];
+
+            for (int lane = 0; lane < count; ++lane)
+            {
+                bits[lane] |= u64(code[lane]) << (16 + i * 3);
+            }
+        }
+
+        for (int lane = 0; lane < count; ++lane)
+        {
+            bits[lane] |= u64(e0[lane] & 0xff);
+            bits[lane] |= u64(e1[lane] & 0xff) << 8;
+            littleEndian::ustore64(output, bits[lane]);
+            output += output_stride;
+        }
+    }
+
+    template <typename Encode>
+    void encodeBlocks(u8* output, const u8* input, int count, int block_bytes, int pixel_bytes, Encode encode)
+    {
+        for (int i = 0; i < count; i += Lanes)
+        {
+            encode(output, input, std::min(Lanes, count - i));
+            output += block_bytes * Lanes;
+            input += pixel_bytes * 4 * Lanes;
+        }
+    }
+
+} // namespace
+
+namespace mango::image
+{
+
+    void encode_blocks_bc1(u8* output, const u8* input, size_t stride, int count, Quality quality)
+    {
+        encodeBlocks(output, input, count, 8, 4, [=] (u8* output, const u8* input, int n)
+        {
+            ColorBlocks blocks;
+            loadColorBlocks(blocks, input, stride, n);
+            encodeColorBlocks(output, 8, blocks, n, quality);
+        });
+    }
+
+    void encode_blocks_bc2(u8* output, const u8* input, size_t stride, int count, Quality quality)
+    {
+        encodeBlocks(output, input, count, 16, 4, [=] (u8* output, const u8* input, int n)
+        {
+            ColorBlocks blocks;
+            loadColorBlocks(blocks, input, stride, n);
+            encodeColorBlocks(output + 8, 16, blocks, n, quality);
+
+            for (int i = 0; i < 16; ++i)
+            {
+                blocks.a[i] = round(blocks.a[i] * (15.0f / 255.0f));
+            }
+
+            for (int lane = 0; lane < n; ++lane)
+            {
+                u64 bits = 0;
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    bits |= u64(blocks.a[i][lane]) << (i * 4);
+                }
+
+                littleEndian::ustore64(output + lane * 16, bits);
+            }
+        });
+    }
+
+    void encode_blocks_bc3(u8* output, const u8* input, size_t stride, int count, Quality quality)
+    {
+        encodeBlocks(output, input, count, 16, 4, [=] (u8* output, const u8* input, int n)
+        {
+            ColorBlocks blocks;
+            loadColorBlocks(blocks, input, stride, n);
+            encodeColorBlocks(output + 8, 16, blocks, n, quality);
+            encodeChannelBlocks(output + 0, 16, blocks.a, n, quality, 0.0f, 255.0f);
+        });
+    }
+
+    void encode_blocks_bc4u(u8* output, const u8* input, size_t stride, int count, Quality quality)
+    {
+        encodeBlocks(output, input, count, 8, 16, [=] (u8* output, const u8* input, int n)
+        {
+            FloatVector red[16];
+            loadChannelBlocks(red, input, stride, n, 0, 255.0f, 0.0f, 255.0f);
+            encodeChannelBlocks(output, 8, red, n, quality, 0.0f, 255.0f);
+        });
+    }
+
+    void encode_blocks_bc4s(u8* output, const u8* input, size_t stride, int count, Quality quality)
+    {
+        encodeBlocks(output, input, count, 8, 16, [=] (u8* output, const u8* input, int n)
+        {
+            FloatVector red[16];
+            loadChannelBlocks(red, input, stride, n, 0, 127.0f, -127.0f, 127.0f);
+            encodeChannelBlocks(output, 8, red, n, quality, -127.0f, 127.0f);
+        });
+    }
+
+    void encode_blocks_bc5u(u8* output, const u8* input, size_t stride, int count, Quality quality)
+    {
+        encodeBlocks(output, input, count, 16, 16, [=] (u8* output, const u8* input, int n)
+        {
+            FloatVector value[16];
+            loadChannelBlocks(value, input, stride, n, 0, 255.0f, 0.0f, 255.0f);
+            encodeChannelBlocks(output + 0, 16, value, n, quality, 0.0f, 255.0f);
+            loadChannelBlocks(value, input, stride, n, 1, 255.0f, 0.0f, 255.0f);
+            encodeChannelBlocks(output + 8, 16, value, n, quality, 0.0f, 255.0f);
+        });
+    }
+
+    void encode_blocks_bc5s(u8* output, const u8* input, size_t stride, int count, Quality quality)
+    {
+        encodeBlocks(output, input, count, 16, 16, [=] (u8* output, const u8* input, int n)
+        {
+            FloatVector value[16];
+            loadChannelBlocks(value, input, stride, n, 0, 127.0f, -127.0f, 127.0f);
+            encodeChannelBlocks(output + 0, 16, value, n, quality, -127.0f, 127.0f);
+            loadChannelBlocks(value, input, stride, n, 1, 127.0f, -127.0f, 127.0f);
+            encodeChannelBlocks(output + 8, 16, value, n, quality, -127.0f, 127.0f);
+        });
+    }
+
+} // namespace mango::image
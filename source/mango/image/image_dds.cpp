@@ -3,7 +3,9 @@
     Copyright (C) 2012-2022 Twilight Finland 3D Oy Ltd. All rights reserved.
 */
 #include <mango/core/system.hpp>
+#include <mango/core/buffer.hpp>
 #include <mango/core/pointer.hpp>
+#include <mango/core/thread.hpp>
 #include <mango/image/image.hpp>
 
 namespace
@@ -1226,6 +1228,165 @@ namespace
         return x;
     }
 
+    // ------------------------------------------------------------
+    // ImageEncoder
+    // ------------------------------------------------------------
+
+    enum : u32
+    {
+        D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3
+    };
+
+    ImageEncodeStatus imageEncode(Stream& stream, const Surface& surface, const ImageEncodeOptions& options)
+    {
+        ImageEncodeStatus status;
+
+        TextureCompression info(options.texture);
+
+        Format format(32, Format::UNORM, Format::RGBA, 8, 8, 8, 8);
+        u32 dxgiFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+        const bool compressed = info.compression != TextureCompression::NONE;
+        if (compressed)
+        {
+            if (!info.encode)
+            {
+                status.setError("[ImageEncoder.DDS] No encoder for compression {:#x}.", options.texture);
+                return status;
+            }
+
+            if (!info.dxgi)
+            {
+                status.setError("[ImageEncoder.DDS] Compression {:#x} has no DXGI format.", options.texture);
+                return status;
+            }
+
+            format = info.format;
+            dxgiFormat = info.dxgi;
+        }
+
+        const int maxLevels = u32_log2(std::max(surface.width, surface.height)) + 1;
+        const int levels = options.levels > 0 ? std::min(options.levels, maxLevels) : maxLevels;
+
+        // mipmap chain; every level is filtered from the previous one
+        std::vector<Bitmap> mipmaps;
+        mipmaps.reserve(levels);
+        mipmaps.emplace_back(surface, format);
+
+        for (int level = 1; level < levels; ++level)
+        {
+            const Bitmap& parent = mipmaps.back();
+            mipmaps.emplace_back(std::max(1, parent.width / 2), std::max(1, parent.height / 2), format);
+            mipmaps.back().downsample(parent);
+        }
+
+        // level offsets in the image data
+        std::vector<size_t> offsets;
+        size_t bytes = 0;
+
+        for (const Bitmap& mipmap : mipmaps)
+        {
+            offsets.push_back(bytes);
+            bytes += compressed ? size_t(info.getBlockBytes(mipmap.width, mipmap.height))
+                                : size_t(mipmap.width) * mipmap.height * format.bytes();
+        }
+
+        Buffer buffer(bytes);
+
+        // the levels are compressed concurrently; the small ones would not fill the machine alone
+        const TextureCompression::Quality quality = TextureCompression::getQuality(options.quality);
+        std::atomic<bool> failure { false };
+
+        ConcurrentQueue queue;
+
+        for (int level = 0; level < levels; ++level)
+        {
+            queue.enqueue([&, level]
+            {
+                const Bitmap& mipmap = mipmaps[level];
+                u8* address = buffer.data() + offsets[level];
+
+                if (compressed)
+                {
+                    size_t size = info.getBlockBytes(mipmap.width, mipmap.height);
+                    if (!info.compress(Memory(address, size), mipmap, quality))
+                    {
+                        failure = true;
+                    }
+                }
+                else
+                {
+                    size_t size = size_t(mipmap.width) * mipmap.height * format.bytes();
+                    std::memcpy(address, mipmap.image, size);
+                }
+            });
+        }
+
+        queue.wait();
+
+        if (failure)
+        {
+            status.setError("[ImageEncoder.DDS] Compression failed.");
+            return status;
+        }
+
+        LittleEndianStream s = stream;
+
+        const u32 pitchOrLinearSize = compressed ? u32(info.getBlockBytes(surface.width, surface.height))
+                                                 : u32(surface.width * format.bytes());
+
+        u32 flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT;
+        flags |= compressed ? DDSD_LINEARSIZE : DDSD_PITCH;
+
+        u32 caps = DDSCAPS_TEXTURE;
+        if (levels > 1)
+        {
+            caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+        }
+
+        // header
+        s.write32(FOURCC_DDS);
+        s.write32(124);
+        s.write32(flags);
+        s.write32(surface.height);
+        s.write32(surface.width);
+        s.write32(pitchOrLinearSize);
+        s.write32(0); // depth
+        s.write32(levels);
+
+        for (int i = 0; i < 11; ++i)
+        {
+            s.write32(0); // reserved
+        }
+
+        // pixel format
+        s.write32(32);
+        s.write32(DDPF_FOURCC);
+        s.write32(FOURCC_DX10);
+
+        for (int i = 0; i < 5; ++i)
+        {
+            s.write32(0); // bit count and masks
+        }
+
+        s.write32(caps);
+        s.write32(0); // caps2
+        s.write32(0); // caps3
+        s.write32(0); // caps4
+        s.write32(0); // reserved
+
+        // DX10 header
+        s.write32(dxgiFormat);
+        s.write32(D3D10_RESOURCE_DIMENSION_TEXTURE2D);
+        s.write32(0); // miscFlag
+        s.write32(1); // arraySize
+        s.write32(0); // miscFlags2
+
+        s.write(buffer, bytes);
+
+        return status;
+    }
+
 } // namespace
 
 namespace mango::image
@@ -1234,6 +1395,7 @@ namespace mango::image
     void registerImageCodecDDS()
     {
         registerImageDecoder(createInterface, ".dds");
+        registerImageEncoder(imageEncode, ".dds");
     }
 
 } // namespace mango::image
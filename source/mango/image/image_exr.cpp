@@ -2,6 +2,8 @@
     MANGO Multimedia Development Platform
     Copyright (C) 2012-2023 Twilight Finland 3D Oy Ltd. All rights reserved.
 */
+#include <map>
+#include <array>
 #include <mango/core/pointer.hpp>
 #include <mango/core/system.hpp>
 #include <mango/core/buffer.hpp>
@@ -15,7 +17,6 @@ namespace
     using namespace mango::math;
     using namespace mango::image;
 
-    // MANGO TODO: mipmap / ripmap selection
     // MANGO TODO: deep image support
     // MANGO TODO: multi-part support
     // MANGO TODO: more flexible color resolver (more formats)
@@ -101,6 +102,388 @@ void unpack3(const u8 b[3], u16 s[16])
         s[i] = s[0];
 }
 
+// --------------------------------------------------------------------------------------
+// DWA uncompress
+// --------------------------------------------------------------------------------------
+
+enum DwaCompressorScheme : u8
+{
+    DWA_UNKNOWN   = 0,
+    DWA_LOSSY_DCT = 1,
+    DWA_RLE       = 2,
+};
+
+enum DwaAcCompression : u8
+{
+    DWA_STATIC_HUFFMAN = 0,
+    DWA_DEFLATE        = 1,
+};
+
+struct DwaClassifier
+{
+    std::string suffix;
+    u8 scheme;
+    u8 type;          // 0: uint, 1: half, 2: float
+    int cscIndex;     // position in a RGB set (-1: none)
+    bool caseInsensitive;
+
+    bool match(std::string name, u8 datatype) const
+    {
+        if (type != datatype)
+            return false;
+
+        if (caseInsensitive)
+        {
+            for (char& c : name)
+            {
+                c = char(std::tolower(c));
+            }
+        }
+
+        return name == suffix;
+    }
+};
+
+static
+std::vector<DwaClassifier> getLegacyDwaClassifiers()
+{
+    // version 1 streams do not carry the rules; these are implied
+    std::vector<DwaClassifier> rules;
+
+    const struct
+    {
+        const char* suffix;
+        u8 scheme;
+        int cscIndex;
+    }
+    legacy [] =
+    {
+        { "r",     DWA_LOSSY_DCT,  0 },
+        { "red",   DWA_LOSSY_DCT,  0 },
+        { "g",     DWA_LOSSY_DCT,  1 },
+        { "grn",   DWA_LOSSY_DCT,  1 },
+        { "green", DWA_LOSSY_DCT,  1 },
+        { "b",     DWA_LOSSY_DCT,  2 },
+        { "blu",   DWA_LOSSY_DCT,  2 },
+        { "blue",  DWA_LOSSY_DCT,  2 },
+        { "y",     DWA_LOSSY_DCT, -1 },
+        { "by",    DWA_LOSSY_DCT, -1 },
+        { "ry",    DWA_LOSSY_DCT, -1 },
+    };
+
+    for (const auto& rule : legacy)
+    {
+        rules.push_back({ rule.suffix, rule.scheme, 1, rule.cscIndex, true });
+        rules.push_back({ rule.suffix, rule.scheme, 2, rule.cscIndex, true });
+    }
+
+    rules.push_back({ "a", DWA_RLE, 0, -1, true });
+    rules.push_back({ "a", DWA_RLE, 1, -1, true });
+    rules.push_back({ "a", DWA_RLE, 2, -1, true });
+
+    return rules;
+}
+
+static
+bool parseDwaClassifiers(std::vector<DwaClassifier>& rules, const u8*& ptr, const u8* end)
+{
+    if (ptr + 2 > end)
+        return false;
+
+    int size = littleEndian::uload16(ptr);
+    if (size < 2 || ptr + size > end)
+        return false;
+
+    const u8* p = ptr + 2;
+    const u8* rulesEnd = ptr + size;
+
+    while (p < rulesEnd)
+    {
+        const u8* terminator = std::find(p, rulesEnd, 0);
+        if (terminator + 3 > rulesEnd)
+            return false;
+
+        DwaClassifier rule;
+
+        rule.suffix = std::string(reinterpret_cast<const char*>(p), terminator - p);
+
+        u8 value = terminator[1];
+        rule.cscIndex = int(value >> 4) - 1;
+        rule.scheme = (value >> 2) & 3;
+        rule.caseInsensitive = (value & 1) != 0;
+        rule.type = terminator[2];
+
+        if (rule.cscIndex >= 3 || rule.scheme > DWA_RLE || rule.type > 2)
+            return false;
+
+        rules.push_back(rule);
+        p = terminator + 3;
+    }
+
+    ptr = rulesEnd;
+    return true;
+}
+
+static
+bool unRleAc(const u16*& ac, const u16* end, u16 block[64], int& lastNonZero)
+{
+    // values with 0xff in the high byte are runs of zeroes, 0xff00 ends the block
+    lastNonZero = 0;
+
+    for (int index = 1; index < 64; )
+    {
+        if (ac >= end)
+            return false;
+
+        u16 value = *ac++;
+
+        if (value == 0xff00)
+        {
+            index = 64;
+        }
+        else if ((value >> 8) == 0xff)
+        {
+            index += value & 0xff;
+        }
+        else
+        {
+            lastNonZero = index;
+            block[index++] = value;
+        }
+    }
+
+    return true;
+}
+
+static inline
+void idct8(float32x4* v)
+{
+    // 1D inverse DCT of eight coefficient vectors; each lane is an independent transform
+    static const float32x4 a(0.5f * std::cos(3.14159f / 4.0f));
+    static const float32x4 b(0.5f * std::cos(3.14159f / 16.0f));
+    static const float32x4 c(0.5f * std::cos(3.14159f / 8.0f));
+    static const float32x4 d(0.5f * std::cos(3.0f * 3.14159f / 16.0f));
+    static const float32x4 e(0.5f * std::cos(5.0f * 3.14159f / 16.0f));
+    static const float32x4 f(0.5f * std::cos(3.0f * 3.14159f / 8.0f));
+    static const float32x4 g(0.5f * std::cos(7.0f * 3.14159f / 16.0f));
+
+    float32x4 alpha0 = c * v[2];
+    float32x4 alpha1 = f * v[2];
+    float32x4 alpha2 = c * v[6];
+    float32x4 alpha3 = f * v[6];
+
+    float32x4 beta0 = b * v[1] + d * v[3] + e * v[5] + g * v[7];
+    float32x4 beta1 = d * v[1] - g * v[3] - b * v[5] - e * v[7];
+    float32x4 beta2 = e * v[1] - b * v[3] + g * v[5] + d * v[7];
+    float32x4 beta3 = g * v[1] - e * v[3] + d * v[5] - b * v[7];
+
+    float32x4 theta0 = a * (v[0] + v[4]);
+    float32x4 theta3 = a * (v[0] - v[4]);
+    float32x4 theta1 = alpha0 + alpha3;
+    float32x4 theta2 = alpha1 - alpha2;
+
+    float32x4 gamma0 = theta0 + theta1;
+    float32x4 gamma1 = theta3 + theta2;
+    float32x4 gamma2 = theta3 - theta2;
+    float32x4 gamma3 = theta0 - theta1;
+
+    v[0] = gamma0 + beta0;
+    v[1] = gamma1 + beta1;
+    v[2] = gamma2 + beta2;
+    v[3] = gamma3 + beta3;
+    v[4] = gamma3 - beta3;
+    v[5] = gamma2 - beta2;
+    v[6] = gamma1 - beta1;
+    v[7] = gamma0 - beta0;
+}
+
+static
+void dctInverse8x8(float* data)
+{
+    float32x4 lo[8]; // columns 0..3
+    float32x4 hi[8]; // columns 4..7
+
+    for (int i = 0; i < 8; ++i)
+    {
+        lo[i] = float32x4::uload(data + i * 8 + 0);
+        hi[i] = float32x4::uload(data + i * 8 + 4);
+    }
+
+    // rows: transpose so that each vector holds one coefficient of four rows
+    float32x4 top[8];
+    float32x4 bottom[8];
+
+    transpose(top + 0, lo[0], lo[1], lo[2], lo[3]);
+    transpose(top + 4, hi[0], hi[1], hi[2], hi[3]);
+    transpose(bottom + 0, lo[4], lo[5], lo[6], lo[7]);
+    transpose(bottom + 4, hi[4], hi[5], hi[6], hi[7]);
+
+    idct8(top);
+    idct8(bottom);
+
+    // columns
+    transpose(lo + 0, top[0], top[1], top[2], top[3]);
+    transpose(hi + 0, top[4], top[5], top[6], top[7]);
+    transpose(lo + 4, bottom[0], bottom[1], bottom[2], bottom[3]);
+    transpose(hi + 4, bottom[4], bottom[5], bottom[6], bottom[7]);
+
+    idct8(lo);
+    idct8(hi);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        float32x4::ustore(data + i * 8 + 0, lo[i]);
+        float32x4::ustore(data + i * 8 + 4, hi[i]);
+    }
+}
+
+static
+void csc709Inverse64(float* comp0, float* comp1, float* comp2)
+{
+    for (int i = 0; i < 64; i += 4)
+    {
+        float32x4 y = float32x4::uload(comp0 + i);
+        float32x4 cb = float32x4::uload(comp1 + i);
+        float32x4 cr = float32x4::uload(comp2 + i);
+
+        float32x4 r = y + cr * 1.5747f;
+        float32x4 g = y - cb * 0.1873f - cr * 0.4682f;
+        float32x4 b = y + cb * 1.8556f;
+
+        float32x4::ustore(comp0 + i, r);
+        float32x4::ustore(comp1 + i, g);
+        float32x4::ustore(comp2 + i, b);
+    }
+}
+
+struct DwaComponent
+{
+    const std::vector<u8*>* rows;
+    bool isFloat;
+};
+
+static
+bool lossyDctDecode(const DwaComponent* components, int numComp, int width, int height,
+                    const u16*& ac, const u16* acEnd, const u16*& dc, const u16* dcEnd,
+                    const u16* toLinear)
+{
+    // zig-zag index of each coefficient in natural order
+    static const u8 zigzag [] =
+    {
+         0,  1,  5,  6, 14, 15, 27, 28,
+         2,  4,  7, 13, 16, 26, 29, 42,
+         3,  8, 12, 17, 25, 30, 41, 43,
+         9, 11, 18, 24, 31, 40, 44, 53,
+        10, 19, 23, 32, 39, 45, 52, 54,
+        20, 22, 33, 38, 46, 51, 55, 60,
+        21, 34, 37, 47, 50, 56, 59, 61,
+        35, 36, 48, 49, 57, 58, 62, 63,
+    };
+
+    const int numBlocksX = div_ceil(width, 8);
+    const int numBlocksY = div_ceil(height, 8);
+    const size_t numBlocks = size_t(numBlocksX) * numBlocksY;
+
+    // the DC values are stored as one plane per component
+    if (size_t(dcEnd - dc) < numBlocks * numComp)
+        return false;
+
+    alignas(16) float data[3][64];
+    alignas(16) u16 block[3][64];
+    alignas(16) u16 coeffs[64];
+    alignas(16) u16 natural[64];
+
+    for (int blocky = 0; blocky < numBlocksY; ++blocky)
+    {
+        const int maxY = std::min(8, height - blocky * 8);
+
+        for (int blockx = 0; blockx < numBlocksX; ++blockx)
+        {
+            const int maxX = std::min(8, width - blockx * 8);
+
+            for (int comp = 0; comp < numComp; ++comp)
+            {
+                std::memset(coeffs, 0, sizeof(coeffs));
+                coeffs[0] = dc[comp * numBlocks + blocky * numBlocksX + blockx];
+
+                int lastNonZero;
+                if (!unRleAc(ac, acEnd, coeffs, lastNonZero))
+                    return false;
+
+                float* dest = data[comp];
+
+                if (lastNonZero == 0)
+                {
+                    // constant block
+                    float16 h;
+                    h.u = coeffs[0];
+                    float32x4 value(float(h) * 3.535536e-01f * 3.535536e-01f);
+
+                    for (int i = 0; i < 64; i += 4)
+                    {
+                        float32x4::ustore(dest + i, value);
+                    }
+                }
+                else
+                {
+                    for (int i = 0; i < 64; ++i)
+                    {
+                        natural[i] = coeffs[zigzag[i]];
+                    }
+
+                    for (int i = 0; i < 64; i += 4)
+                    {
+                        float32x4::ustore(dest + i, convert<float32x4>(float16x4::uload(natural + i)));
+                    }
+
+                    dctInverse8x8(dest);
+                }
+            }
+
+            if (numComp == 3)
+            {
+                csc709Inverse64(data[0], data[1], data[2]);
+            }
+
+            for (int comp = 0; comp < numComp; ++comp)
+            {
+                for (int i = 0; i < 64; i += 4)
+                {
+                    float16x4::ustore(block[comp] + i, convert<float16x4>(float32x4::uload(data[comp] + i)));
+                }
+
+                const std::vector<u8*>& rows = *components[comp].rows;
+
+                for (int y = 0; y < maxY; ++y)
+                {
+                    const u16* src = block[comp] + y * 8;
+                    u8* dest = rows[blocky * 8 + y];
+
+                    for (int x = 0; x < maxX; ++x)
+                    {
+                        u16 value = toLinear ? toLinear[src[x]] : src[x];
+
+                        if (components[comp].isFloat)
+                        {
+                            float16 h;
+                            h.u = value;
+                            littleEndian::ustore32f(dest + (blockx * 8 + x) * 4, float(h));
+                        }
+                        else
+                        {
+                            littleEndian::ustore16(dest + (blockx * 8 + x) * 2, value);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    dc += numBlocks * numComp;
+
+    return true;
+}
+
 // --------------------------------------------------------------------------------------
 // PIZ uncompress
 // --------------------------------------------------------------------------------------
@@ -138,6 +521,19 @@ void wdec14(unsigned short l, unsigned short h, unsigned short &a, unsigned shor
     b = static_cast<unsigned short>(bs);
 }
 
+inline
+void wenc14(unsigned short a, unsigned short b, unsigned short &l, unsigned short &h)
+{
+    short as = static_cast<short>(a);
+    short bs = static_cast<short>(b);
+
+    short ms = static_cast<short>((as + bs) >> 1);
+    short ds = static_cast<short>(as - bs);
+
+    l = static_cast<unsigned short>(ms);
+    h = static_cast<unsigned short>(ds);
+}
+
 //
 // Wavelet basis functions with modulo arithmetic; they work with full
 // 16-bit data, but Huffman-encoding the wavelet-transformed data doesn't
@@ -146,8 +542,25 @@ void wdec14(unsigned short l, unsigned short h, unsigned short &a, unsigned shor
 
 const int NBITS = 16;
 const int A_OFFSET = 1 << (NBITS - 1);
+const int M_OFFSET = 1 << (NBITS - 1);
 const int MOD_MASK = (1 << NBITS) - 1;
 
+inline
+void wenc16(unsigned short a, unsigned short b, unsigned short &l, unsigned short &h)
+{
+    int ao = (a + A_OFFSET) & MOD_MASK;
+    int m = ((ao + b) >> 1);
+    int d = ao - b;
+
+    if (d < 0)
+        m = (m + M_OFFSET) & MOD_MASK;
+
+    d &= MOD_MASK;
+
+    l = static_cast<unsigned short>(m);
+    h = static_cast<unsigned short>(d);
+}
+
 inline
 void wdec16(unsigned short l, unsigned short h, unsigned short &a, unsigned short &b)
 {
@@ -160,11 +573,11 @@ void wdec16(unsigned short l, unsigned short h, unsigned short &a, unsigned shor
 }
 
 //
-// 2D Wavelet decoding:
+// 2D Wavelet encoding:
 //
 
 static
-void wav2Decode(
+void wav2Encode(
     unsigned short *in,  // io: values are transformed in place
     int nx,              // i : x size
     int ox,              // i : x offset
@@ -174,25 +587,14 @@ void wav2Decode(
 {
   bool w14 = (mx < (1 << 14));
   int n = (nx > ny) ? ny : nx;
-  int p = 1;
-  int p2;
-
-  //
-  // Search max level
-  //
-
-  while (p <= n)
-    p <<= 1;
-
-  p >>= 1;
-  p2 = p;
-  p >>= 1;
+  int p = 1;   // == 1 <<  level
+  int p2 = 2;  // == 1 << (level+1)
 
   //
   // Hierarchical loop on smaller dimension n
   //
 
-  while (p >= 1) {
+  while (p2 <= n) {
     unsigned short *py = in;
     unsigned short *ey = in + oy * (ny - p2);
     int oy1 = oy * p;
@@ -219,40 +621,40 @@ void wav2Decode(
         unsigned short *p11 = p10 + ox1;
 
         //
-        // 2D wavelet decoding
+        // 2D wavelet encoding
         //
 
         if (w14) {
-          wdec14(*px, *p10, i00, i10);
-          wdec14(*p01, *p11, i01, i11);
-          wdec14(i00, i01, *px, *p01);
-          wdec14(i10, i11, *p10, *p11);
+          wenc14(*px, *p01, i00, i01);
+          wenc14(*p10, *p11, i10, i11);
+          wenc14(i00, i10, *px, *p10);
+          wenc14(i01, i11, *p01, *p11);
         } else {
-          wdec16(*px, *p10, i00, i10);
-          wdec16(*p01, *p11, i01, i11);
-          wdec16(i00, i01, *px, *p01);
-          wdec16(i10, i11, *p10, *p11);
+          wenc16(*px, *p01, i00, i01);
+          wenc16(*p10, *p11, i10, i11);
+          wenc16(i00, i10, *px, *p10);
+          wenc16(i01, i11, *p01, *p11);
         }
       }
 
       //
-      // Decode (1D) odd column (still in Y loop)
+      // Encode (1D) odd column (still in Y loop)
       //
 
       if (nx & p) {
         unsigned short *p10 = px + oy1;
 
         if (w14)
-          wdec14(*px, *p10, i00, *p10);
+          wenc14(*px, *p10, i00, *p10);
         else
-          wdec16(*px, *p10, i00, *p10);
+          wenc16(*px, *p10, i00, *p10);
 
         *px = i00;
       }
     }
 
     //
-    // Decode (1D) odd line (must loop in X)
+    // Encode (1D) odd line (must loop in X)
     //
 
     if (ny & p) {
@@ -263,9 +665,9 @@ void wav2Decode(
         unsigned short *p01 = px + ox1;
 
         if (w14)
-          wdec14(*px, *p01, i00, *p01);
+          wenc14(*px, *p01, i00, *p01);
         else
-          wdec16(*px, *p01, i00, *p01);
+          wenc16(*px, *p01, i00, *p01);
 
         *px = i00;
       }
@@ -275,44 +677,165 @@ void wav2Decode(
     // Next level
     //
 
-    p2 = p;
-    p >>= 1;
+    p = p2;
+    p2 <<= 1;
   }
 }
 
-//-----------------------------------------------------------------------------
-//
-//  16-bit Huffman compression and decompression.
 //
-//  The source code in this file is derived from the 8-bit
-//  Huffman compression and decompression routines written
-//  by Christian Rouet for his PIZ image file format.
+// 2D Wavelet decoding:
 //
-//-----------------------------------------------------------------------------
 
-// Adds some modification for tinyexr.
+static
+void wav2Decode(
+    unsigned short *in,  // io: values are transformed in place
+    int nx,              // i : x size
+    int ox,              // i : x offset
+    int ny,              // i : y size
+    int oy,              // i : y offset
+    unsigned short mx)   // i : maximum in[x][y] value
+{
+  bool w14 = (mx < (1 << 14));
+  int n = (nx > ny) ? ny : nx;
+  int p = 1;
+  int p2;
 
-const int HUF_ENCBITS = 16;  // literal (value) bit length
-const int HUF_DECBITS = 14;  // decoding bit size (>= 8)
+  //
+  // Search max level
+  //
 
-const int HUF_ENCSIZE = (1 << HUF_ENCBITS) + 1;  // encoding table size
-const int HUF_DECSIZE = 1 << HUF_DECBITS;        // decoding table size
-const int HUF_DECMASK = HUF_DECSIZE - 1;
+  while (p <= n)
+    p <<= 1;
 
-struct HufDec
-{
-    // short code    long code
-    //-------------------------------
-    int len : 8;   // code length    0
-    int lit : 24;  // lit      p size
-    int *p;        // 0      lits
-};
+  p >>= 1;
+  p2 = p;
+  p >>= 1;
 
-inline u64 hufLength(u64 code) { return code & 63; }
-inline u64 hufCode(u64 code) { return code >> 6; }
+  //
+  // Hierarchical loop on smaller dimension n
+  //
 
-inline u64 getBits(int nBits, u64 &c, int &lc, const u8 *&in)
-{
+  while (p >= 1) {
+    unsigned short *py = in;
+    unsigned short *ey = in + oy * (ny - p2);
+    int oy1 = oy * p;
+    int oy2 = oy * p2;
+    int ox1 = ox * p;
+    int ox2 = ox * p2;
+    unsigned short i00, i01, i10, i11;
+
+    //
+    // Y loop
+    //
+
+    for (; py <= ey; py += oy2) {
+      unsigned short *px = py;
+      unsigned short *ex = py + ox * (nx - p2);
+
+      //
+      // X loop
+      //
+
+      for (; px <= ex; px += ox2) {
+        unsigned short *p01 = px + ox1;
+        unsigned short *p10 = px + oy1;
+        unsigned short *p11 = p10 + ox1;
+
+        //
+        // 2D wavelet decoding
+        //
+
+        if (w14) {
+          wdec14(*px, *p10, i00, i10);
+          wdec14(*p01, *p11, i01, i11);
+          wdec14(i00, i01, *px, *p01);
+          wdec14(i10, i11, *p10, *p11);
+        } else {
+          wdec16(*px, *p10, i00, i10);
+          wdec16(*p01, *p11, i01, i11);
+          wdec16(i00, i01, *px, *p01);
+          wdec16(i10, i11, *p10, *p11);
+        }
+      }
+
+      //
+      // Decode (1D) odd column (still in Y loop)
+      //
+
+      if (nx & p) {
+        unsigned short *p10 = px + oy1;
+
+        if (w14)
+          wdec14(*px, *p10, i00, *p10);
+        else
+          wdec16(*px, *p10, i00, *p10);
+
+        *px = i00;
+      }
+    }
+
+    //
+    // Decode (1D) odd line (must loop in X)
+    //
+
+    if (ny & p) {
+      unsigned short *px = py;
+      unsigned short *ex = py + ox * (nx - p2);
+
+      for (; px <= ex; px += ox2) {
+        unsigned short *p01 = px + ox1;
+
+        if (w14)
+          wdec14(*px, *p01, i00, *p01);
+        else
+          wdec16(*px, *p01, i00, *p01);
+
+        *px = i00;
+      }
+    }
+
+    //
+    // Next level
+    //
+
+    p2 = p;
+    p >>= 1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+//
+//  16-bit Huffman compression and decompression.
+//
+//  The source code in this file is derived from the 8-bit
+//  Huffman compression and decompression routines written
+//  by Christian Rouet for his PIZ image file format.
+//
+//-----------------------------------------------------------------------------
+
+// Adds some modification for tinyexr.
+
+const int HUF_ENCBITS = 16;  // literal (value) bit length
+const int HUF_DECBITS = 14;  // decoding bit size (>= 8)
+
+const int HUF_ENCSIZE = (1 << HUF_ENCBITS) + 1;  // encoding table size
+const int HUF_DECSIZE = 1 << HUF_DECBITS;        // decoding table size
+const int HUF_DECMASK = HUF_DECSIZE - 1;
+
+struct HufDec
+{
+    // short code    long code
+    //-------------------------------
+    int len : 8;   // code length    0
+    int lit : 24;  // lit      p size
+    int *p;        // 0      lits
+};
+
+inline u64 hufLength(u64 code) { return code & 63; }
+inline u64 hufCode(u64 code) { return code >> 6; }
+
+inline u64 getBits(int nBits, u64 &c, int &lc, const u8 *&in)
+{
     while (lc < nBits)
     {
         c = (c << 8) | *(in++);
@@ -406,6 +929,209 @@ void hufCanonicalCodeTable(u64 hcode[HUF_ENCSIZE])
 const int SHORT_ZEROCODE_RUN = 59;
 const int LONG_ZEROCODE_RUN = 63;
 const int SHORTEST_LONG_RUN = 2 + LONG_ZEROCODE_RUN - SHORT_ZEROCODE_RUN;
+const int LONGEST_LONG_RUN = 255 + SHORTEST_LONG_RUN;
+
+inline void outputBits(int nBits, u64 bits, u64 &c, int &lc, u8 *&out)
+{
+    c <<= nBits;
+    lc += nBits;
+    c |= bits;
+
+    while (lc >= 8)
+    {
+        *out++ = u8(c >> (lc -= 8));
+    }
+}
+
+//
+// Compute Huffman codes (based on frq input) and store them in frq:
+//  - code structure is : [63:lsb - 6:msb] | [5-0: bit length];
+//  - max code length is 58 bits;
+//  - codes outside the range [im-iM] have a null length (unused values);
+//  - original frequencies are destroyed;
+//  - encoding tables are used by hufEncode() and hufBuildDecTable();
+//
+
+struct FHeapCompare
+{
+    bool operator () (const u64 *a, const u64 *b) const
+    {
+        return *a > *b;
+    }
+};
+
+static
+void hufBuildEncTable(
+    u64 *frq,  // io: input frequencies [HUF_ENCSIZE], output table
+    int *im,   //  o: min frq index
+    int *iM)   //  o: max frq index
+{
+    //
+    // Find the minimum and maximum indices that point to non-zero
+    // entries in frq, fill fHeap with pointers to all non-zero
+    // entries and initialize hlink such that hlink[i] == i.
+    //
+
+    std::vector<int> hlink(HUF_ENCSIZE);
+    std::vector<u64 *> fHeap(HUF_ENCSIZE);
+
+    *im = 0;
+
+    while (!frq[*im])
+        (*im)++;
+
+    int nf = 0;
+
+    for (int i = *im; i < HUF_ENCSIZE; i++)
+    {
+        hlink[i] = i;
+
+        if (frq[i])
+        {
+            fHeap[nf] = &frq[i];
+            nf++;
+            *iM = i;
+        }
+    }
+
+    //
+    // Add a pseudo-symbol, with a frequency count of 1, to frq;
+    // adjust the fHeap and hlink array accordingly.  Function
+    // hufEncode() uses the pseudo-symbol for run-length encoding.
+    //
+
+    (*iM)++;
+    frq[*iM] = 1;
+    fHeap[nf] = &frq[*iM];
+    nf++;
+
+    //
+    // Build an array, scode, such that scode[i] contains the number
+    // of bits assigned to symbol i. The tree is not built explicitly;
+    // when two nodes are merged, their descendants are linked into a
+    // single list and the code lengths of the descendants are
+    // incremented by one.
+    //
+
+    std::make_heap(&fHeap[0], &fHeap[nf], FHeapCompare());
+
+    std::vector<u64> scode(HUF_ENCSIZE, 0);
+
+    while (nf > 1)
+    {
+        //
+        // Find the indices, mm and m, of the two smallest non-zero frq
+        // values in fHeap, add the smallest frq to the second-smallest
+        // frq, and remove the smallest frq value from fHeap.
+        //
+
+        int mm = int(fHeap[0] - frq);
+        std::pop_heap(&fHeap[0], &fHeap[nf], FHeapCompare());
+        --nf;
+
+        int m = int(fHeap[0] - frq);
+        std::pop_heap(&fHeap[0], &fHeap[nf], FHeapCompare());
+
+        frq[m] += frq[mm];
+        std::push_heap(&fHeap[0], &fHeap[nf], FHeapCompare());
+
+        //
+        // Add a bit to all codes in the first list and merge
+        // the lists that start at scode[m] and scode[mm].
+        //
+
+        for (int j = m; ; j = hlink[j])
+        {
+            scode[j]++;
+
+            if (hlink[j] == j)
+            {
+                hlink[j] = mm;
+                break;
+            }
+        }
+
+        //
+        // Add a bit to all codes in the second list
+        //
+
+        for (int j = mm; ; j = hlink[j])
+        {
+            scode[j]++;
+
+            if (hlink[j] == j)
+                break;
+        }
+    }
+
+    //
+    // Build a canonical Huffman code table, replacing the code
+    // lengths in scode with (code, code length) pairs.  Copy the
+    // code table from scode into frq.
+    //
+
+    hufCanonicalCodeTable(scode.data());
+    std::memcpy(frq, scode.data(), sizeof(u64) * HUF_ENCSIZE);
+}
+
+//
+// Pack an encoding table (see the run-length table above)
+//
+
+static
+void hufPackEncTable(
+    const u64 *hcode,  // i : encoding table [HUF_ENCSIZE]
+    int im,            // i : min hcode index
+    int iM,            // i : max hcode index
+    u8 **pcode)        //  o: ptr to packed table (updated)
+{
+    u8 *p = *pcode;
+    u64 c = 0;
+    int lc = 0;
+
+    for (; im <= iM; im++)
+    {
+        int l = int(hufLength(hcode[im]));
+
+        if (l == 0)
+        {
+            int zerun = 1;
+
+            while ((im < iM) && (zerun < LONGEST_LONG_RUN))
+            {
+                if (hufLength(hcode[im + 1]) > 0)
+                    break;
+
+                im++;
+                zerun++;
+            }
+
+            if (zerun >= 2)
+            {
+                if (zerun >= SHORTEST_LONG_RUN)
+                {
+                    outputBits(6, LONG_ZEROCODE_RUN, c, lc, p);
+                    outputBits(8, zerun - SHORTEST_LONG_RUN, c, lc, p);
+                }
+                else
+                {
+                    outputBits(6, SHORT_ZEROCODE_RUN + zerun - 2, c, lc, p);
+                }
+
+                continue;
+            }
+        }
+
+        outputBits(6, l, c, lc, p);
+    }
+
+    if (lc > 0)
+    {
+        *p++ = u8(c << (8 - lc));
+    }
+
+    *pcode = p;
+}
 
 //
 // Unpack an encoding table packed by hufPackEncTable():
@@ -425,14 +1151,14 @@ static bool hufUnpackEncTable(
   int lc = 0;
 
   for (; im <= iM; im++) {
-    if (p - *pcode > ni) {
+    if (p - *pcode >= ni) {
       return false;
     }
 
     u64 l = hcode[im] = getBits(6, c, lc, p);  // code length
 
     if (l == (u64)LONG_ZEROCODE_RUN) {
-      if (p - *pcode > ni) {
+      if (p - *pcode >= ni) {
         return false;
       }
 
@@ -619,10 +1345,8 @@ void hufFreeDecTable(HufDec *hdecod)
         \
         u8 cs = (c >> lc); \
         \
-        /*if (out + cs > oe) \
-            ; \
-        else if (out - 1 < ob) \
-            ;*/ \
+        if (out + cs > oe || out - 1 < ob) \
+            return false; \
         \
         u16 s = out[-1]; \
         \
@@ -636,10 +1360,12 @@ void hufFreeDecTable(HufDec *hdecod)
 }
 
 //
-// Decode (uncompress) ni bits based on encoding & decoding tables:
+// Decode (uncompress) ni bits based on encoding & decoding tables;
+// returns false for invalid codes or when the output size does not match:
 //
 
-void hufDecode(const u64*  hcode, // i : encoding table
+static
+bool hufDecode(const u64*  hcode, // i : encoding table
      const HufDec* hdecod, // i : decoding table
      const u8* in, // i : compressed input buffer
      int ni, // i : input size (in bits)
@@ -676,19 +1402,20 @@ void hufDecode(const u64*  hcode, // i : encoding table
                 //
 
                 lc -= pl.len;
-                /*
-                if ( lc < 0 )
+                if (lc < 0)
                 {
-                    //invalidCode(); // code length too long
+                    // code length too long
+                    return false;
                 }
-                */
+
                 getCode(pl.lit, rlc, c, lc, in, out, outb, oe)
             }
             else
             {
                 if (!pl.p)
                 {
-                    //invalidCode(); // wrong code
+                    // wrong code
+                    return false;
                 }
 
                 //
@@ -721,7 +1448,8 @@ void hufDecode(const u64*  hcode, // i : encoding table
 
                 if (j == pl.lit)
                 {
-                    //invalidCode(); // Not found
+                    // code not found
+                    return false;
                 }
             }
         }
@@ -742,24 +1470,22 @@ void hufDecode(const u64*  hcode, // i : encoding table
         if (pl.len)
         {
             lc -= pl.len;
-            /*
-            if ( lc < 0 )
+            if (lc < 0)
             {
-                //invalidCode(); // code length too long
+                // code length too long
+                return false;
             }
-            */
+
             getCode(pl.lit, rlc, c, lc, in, out, outb, oe)
         }
         else
         {
-            //invalidCode(); // wrong (long) code
+            // wrong (long) code
+            return false;
         }
     }
 
-    if (out - outb != ptrdiff_t(no))
-    {
-        //notEnoughData ();
-    }
+    return out - outb == ptrdiff_t(no);
 }
 
 //
@@ -769,7 +1495,9 @@ void hufDecode(const u64*  hcode, // i : encoding table
 static
 bool hufUncompress(const u8* compressed, int nCompressed, std::vector<u16>& output)
 {
-    if (nCompressed == 0)
+    constexpr int headerSize = 20;
+
+    if (nCompressed < headerSize)
     {
         return false;
     }
@@ -780,12 +1508,12 @@ bool hufUncompress(const u8* compressed, int nCompressed, std::vector<u16>& outp
     int iM = littleEndian::uload32(compressed + 4);
     int nBits = littleEndian::uload32(compressed + 12);
 
-    if (im < 0 || im >= HUF_ENCSIZE || iM < 0 || iM >= HUF_ENCSIZE)
+    if (im < 0 || im >= HUF_ENCSIZE || iM < 0 || iM >= HUF_ENCSIZE || nBits < 0)
     {
         return false;
     }
 
-    constexpr int headerSize = 20;
+    const u8* end = compressed + nCompressed;
 
     compressed += headerSize;
     nCompressed -= headerSize;
@@ -793,39 +1521,209 @@ bool hufUncompress(const u8* compressed, int nCompressed, std::vector<u16>& outp
     std::vector<u64> freq(HUF_ENCSIZE);
     std::vector<HufDec> hdec(HUF_DECSIZE);
 
-    hufClearDecTable(hdec.data());
-    hufUnpackEncTable(&compressed, nCompressed, im, iM, freq.data());
+    if (!hufUnpackEncTable(&compressed, nCompressed, im, iM, freq.data()))
+    {
+        return false;
+    }
 
-    if (nBits > 8 * nCompressed)
+    // the encoding table is followed by the bit stream
+    if (nBits > 8 * (end - compressed))
     {
         return false;
     }
 
-    hufBuildDecTable(freq.data(), im, iM, hdec.data());
-    hufDecode(freq.data(), hdec.data(), compressed, nBits, iM, output.size(), output.data());
+    hufClearDecTable(hdec.data());
+
+    bool status = hufBuildDecTable(freq.data(), im, iM, hdec.data()) &&
+                  hufDecode(freq.data(), hdec.data(), compressed, nBits, iM, output.size(), output.data());
 
     hufFreeDecTable(hdec.data());
 
-    return true;
+    return status;
 }
 
 //
-// Functions to compress the range of values in the pixel data
+// ENCODING
 //
 
-const int USHORT_RANGE = (1 << 16);
-const int BITMAP_SIZE = (USHORT_RANGE >> 3);
+inline void outputCode(u64 code, u64 &c, int &lc, u8 *&out)
+{
+    outputBits(int(hufLength(code)), hufCode(code), c, lc, out);
+}
 
-static
-u16 reverseLutFromBitmap(const u8 bitmap[BITMAP_SIZE], u16 lut[USHORT_RANGE])
+inline void sendCode(u64 sCode, int runCount, u64 runCode, u64 &c, int &lc, u8 *&out)
 {
-    int k = 0;
+    //
+    // Output a run of runCount instances of the symbol sCode.
+    // Output the symbols explicitly, or if that is shorter, output
+    // the sCode symbol once followed by a runCode symbol and runCount
+    // expressed as an 8-bit number.
+    //
 
-    lut[k++] = 0;
-    if (bitmap[0] & (1 << 1)) lut[k++] = 1;
-    if (bitmap[0] & (1 << 2)) lut[k++] = 2;
-    if (bitmap[0] & (1 << 3)) lut[k++] = 3;
-    if (bitmap[0] & (1 << 4)) lut[k++] = 4;
+    if (hufLength(sCode) + hufLength(runCode) + 8 < hufLength(sCode) * runCount)
+    {
+        outputCode(sCode, c, lc, out);
+        outputCode(runCode, c, lc, out);
+        outputBits(8, runCount, c, lc, out);
+    }
+    else
+    {
+        while (runCount-- >= 0)
+            outputCode(sCode, c, lc, out);
+    }
+}
+
+static
+int hufEncode(
+    const u64 *hcode,  // i : encoding table
+    const u16 *in,     // i : uncompressed input buffer
+    const int ni,      // i : input buffer size (in bytes)
+    int rlc,           // i : rl code
+    u8 *out)           //  o: compressed output buffer
+{
+    u8 *outStart = out;
+    u64 c = 0;  // bits not yet written to out
+    int lc = 0; // number of valid bits in c (LSB)
+    int s = in[0];
+    int cs = 0;
+
+    //
+    // Loop on input values
+    //
+
+    for (int i = 1; i < ni; i++)
+    {
+        //
+        // Count same values or send code
+        //
+
+        if (s == in[i] && cs < 255)
+        {
+            cs++;
+        }
+        else
+        {
+            sendCode(hcode[s], cs, hcode[rlc], c, lc, out);
+            cs = 0;
+        }
+
+        s = in[i];
+    }
+
+    //
+    // Send remaining code
+    //
+
+    sendCode(hcode[s], cs, hcode[rlc], c, lc, out);
+
+    if (lc)
+    {
+        *out = u8(c << (8 - lc));
+    }
+
+    return int(out - outStart) * 8 + lc;
+}
+
+static
+size_t hufCompress(const u16* raw, int nRaw, u8* compressed)
+{
+    if (nRaw == 0)
+    {
+        return 0;
+    }
+
+    std::vector<u64> freq(HUF_ENCSIZE, 0);
+
+    for (int i = 0; i < nRaw; ++i)
+    {
+        ++freq[raw[i]];
+    }
+
+    int im = 0;
+    int iM = 0;
+    hufBuildEncTable(freq.data(), &im, &iM);
+
+    constexpr int headerSize = 20;
+
+    u8* tableStart = compressed + headerSize;
+    u8* tableEnd = tableStart;
+    hufPackEncTable(freq.data(), im, iM, &tableEnd);
+    int tableLength = int(tableEnd - tableStart);
+
+    u8* dataStart = tableEnd;
+    int nBits = hufEncode(freq.data(), raw, nRaw, iM, dataStart);
+    int dataLength = (nBits + 7) / 8;
+
+    // write header (20 bytes)
+
+    littleEndian::ustore32(compressed + 0, im);
+    littleEndian::ustore32(compressed + 4, iM);
+    littleEndian::ustore32(compressed + 8, tableLength);
+    littleEndian::ustore32(compressed + 12, nBits);
+    littleEndian::ustore32(compressed + 16, 0); // room for future extensions
+
+    return dataStart + dataLength - compressed;
+}
+
+//
+// Functions to compress the range of values in the pixel data
+//
+
+const int USHORT_RANGE = (1 << 16);
+const int BITMAP_SIZE = (USHORT_RANGE >> 3);
+
+static
+void bitmapFromData(const u16 data[], size_t size, u8 bitmap[BITMAP_SIZE], u16& minNonZero, u16& maxNonZero)
+{
+    std::memset(bitmap, 0, BITMAP_SIZE);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        bitmap[data[i] >> 3] |= (1 << (data[i] & 7));
+    }
+
+    // zero is not explicitly stored in the bitmap; we assume that the data always contain zeroes
+    bitmap[0] &= ~1;
+
+    minNonZero = BITMAP_SIZE - 1;
+    maxNonZero = 0;
+
+    for (int i = 0; i < BITMAP_SIZE; ++i)
+    {
+        if (bitmap[i])
+        {
+            minNonZero = std::min(minNonZero, u16(i));
+            maxNonZero = std::max(maxNonZero, u16(i));
+        }
+    }
+}
+
+static
+u16 forwardLutFromBitmap(const u8 bitmap[BITMAP_SIZE], u16 lut[USHORT_RANGE])
+{
+    int k = 0;
+
+    for (int i = 0; i < USHORT_RANGE; ++i)
+    {
+        if ((i == 0) || (bitmap[i >> 3] & (1 << (i & 7))))
+            lut[i] = k++;
+        else
+            lut[i] = 0;
+    }
+
+    return k - 1; // maximum value stored in lut[]
+}
+
+static
+u16 reverseLutFromBitmap(const u8 bitmap[BITMAP_SIZE], u16 lut[USHORT_RANGE])
+{
+    int k = 0;
+
+    lut[k++] = 0;
+    if (bitmap[0] & (1 << 1)) lut[k++] = 1;
+    if (bitmap[0] & (1 << 2)) lut[k++] = 2;
+    if (bitmap[0] & (1 << 3)) lut[k++] = 3;
+    if (bitmap[0] & (1 << 4)) lut[k++] = 4;
     if (bitmap[0] & (1 << 5)) lut[k++] = 5;
     if (bitmap[0] & (1 << 6)) lut[k++] = 6;
     if (bitmap[0] & (1 << 7)) lut[k++] = 7;
@@ -888,6 +1786,125 @@ void deinterleave(u8* dest, const u8* source, size_t size)
     }
 }
 
+static
+void predictorEncode(u8* data, size_t count)
+{
+    u8 p = data[0];
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        u8 value = data[i];
+        data[i] = u8(value - p + 128);
+        p = value;
+    }
+}
+
+static
+void interleave(u8* dest, const u8* source, size_t size)
+{
+    u8* temp0 = dest;
+    u8* temp1 = dest + ((size + 1) / 2);
+
+    for (size_t i = 0; i < size; i += 2)
+    {
+        *temp0++ = source[i];
+    }
+
+    for (size_t i = 1; i < size; i += 2)
+    {
+        *temp1++ = source[i];
+    }
+}
+
+static
+size_t rleUncompress(u8* dest, size_t size, const u8* source, size_t bytes)
+{
+    const u8* in = source;
+    const u8* in_end = source + bytes;
+    u8* out = dest;
+    u8* end = dest + size;
+
+    while (in < in_end)
+    {
+        int count = s8(*in++);
+
+        if (count < 0)
+        {
+            count = -count;
+
+            if (out + count > end || in + count > in_end)
+                return 0;
+
+            std::memcpy(out, in, count);
+            out += count;
+            in += count;
+        }
+        else
+        {
+            ++count;
+
+            if (out + count > end || in >= in_end)
+                return 0;
+
+            u8 value = *in++;
+            std::memset(out, value, count);
+            out += count;
+        }
+    }
+
+    return out - dest;
+}
+
+static
+size_t rleCompress(u8* dest, const u8* source, size_t size)
+{
+    constexpr ptrdiff_t MIN_RUN_LENGTH = 3;
+    constexpr ptrdiff_t MAX_RUN_LENGTH = 127;
+
+    const u8* end = source + size;
+    const u8* runStart = source;
+    const u8* runEnd = source + 1;
+    u8* out = dest;
+
+    while (runStart < end)
+    {
+        while (runEnd < end && *runStart == *runEnd && runEnd - runStart - 1 < MAX_RUN_LENGTH)
+        {
+            ++runEnd;
+        }
+
+        if (runEnd - runStart >= MIN_RUN_LENGTH)
+        {
+            // compressible run
+            *out++ = u8((runEnd - runStart) - 1);
+            *out++ = *runStart;
+            runStart = runEnd;
+        }
+        else
+        {
+            // uncompressible run
+            while (runEnd < end &&
+                   ((runEnd + 1 >= end || runEnd[0] != runEnd[1]) ||
+                    (runEnd + 2 >= end || runEnd[1] != runEnd[2])) &&
+                   runEnd - runStart < MAX_RUN_LENGTH)
+            {
+                ++runEnd;
+            }
+
+            *out++ = u8(runStart - runEnd);
+
+            while (runStart < runEnd)
+            {
+                *out++ = *runStart++;
+            }
+        }
+
+        ++runEnd;
+    }
+
+    return out - dest;
+}
+
 static inline
 bool isfinite(float16 f)
 {
@@ -962,6 +1979,7 @@ enum class Component
 
 struct Channel
 {
+    std::string name;
     DataType datatype = DataType::NONE;
     int xsamples = 1;
     int ysamples = 1;
@@ -1021,8 +2039,54 @@ struct TileDesc
     {
         return (mode & 0x02) != 0;
     }
+
+    bool isRoundUp() const
+    {
+        return (mode & 0x10) != 0;
+    }
 };
 
+struct TileLevel
+{
+    int xlevel;
+    int ylevel;
+    int width;
+    int height;
+    int xtiles;
+    int ytiles;
+    size_t offset; // index of the first tile in the offset table
+};
+
+static
+int roundLog2(int x, bool up)
+{
+    int y = 0;
+    int r = 0;
+
+    while (x > 1)
+    {
+        r |= x & 1;
+        x >>= 1;
+        ++y;
+    }
+
+    return up ? y + r : y;
+}
+
+static
+int levelSize(int size, int level, bool up)
+{
+    int b = 1 << level;
+    int s = size / b;
+
+    if (up && s * b < size)
+    {
+        ++s;
+    }
+
+    return std::max(1, s);
+}
+
 struct Box2i
 {
     s32 xmin, ymin, xmax, ymax;
@@ -1077,6 +2141,7 @@ void readAttribute<ChannelList>(ChannelList& data, LittleEndianConstPointer p)
 
         Channel channel;
 
+        channel.name = name;
         channel.xsamples = xsamples;
         channel.ysamples = ysamples;
         channel.linear = linear;
@@ -1489,9 +2554,12 @@ struct ContextEXR
 
     int m_scanLinesPerBlock = 0;
 
+    // tiled images: levels in offset table order
+    std::vector<TileLevel> m_levels;
+
     AttributeTable m_attributes;
 
-    u16 m_log_table[0x10000];
+    u16 m_linear_table[0x10000];
 
     u64 m_time_decompress = 0;
     u64 m_time_blit = 0;
@@ -1511,14 +2579,18 @@ struct ContextEXR
     const u8* decompress_b44(Memory dest, ConstMemory source, int width, int height, int ystart);
     const u8* decompress_dwaa(Memory dest, ConstMemory source, int width, int height, int ystart);
     const u8* decompress_dwab(Memory dest, ConstMemory source, int width, int height, int ystart);
+    const u8* decompress_dwa(Memory dest, ConstMemory source, int width, int height, int ystart);
 
     void decodeBlock(Surface surface, ConstMemory memory, int x0, int y0, int x1, int y1);
     void decodeImage(const ImageDecodeOptions& options);
+    ImageDecodeStatus decodeTiles(const Surface& dest, const ImageDecodeOptions& options, int level, int face);
+    void computeLevels(int width, int height, int faces);
 
     ImageDecodeStatus decode(const Surface& dest, const ImageDecodeOptions& options, int level, int depth, int face);
 
-    void initLogTable()
+    void initLinearTableB44()
     {
+        // pLinear channels are stored as 8 * log(x)
         for (u32 i = 0; i < 0x10000; ++i)
         {
             float16 hf;
@@ -1526,18 +2598,61 @@ struct ContextEXR
 
             u16 value = 0;
 
-            if (isfinite(hf))
+            if (isfinite(hf) || (i & 0x7fff) == 0)
             {
                 float x = hf;
-                x = 8.0f * std::log(x);
-                if (std::isfinite(x))
+                if (x >= 8.0f * std::log(65504.0f))
                 {
-                    hf = x;
-                    value = hf.u;
+                    x = 65504.0f;
                 }
+                else
+                {
+                    x = std::exp(x / 8.0f);
+                }
+
+                hf = x;
+                value = hf.u;
             }
 
-            m_log_table[i] = value;
+            m_linear_table[i] = value;
+        }
+    }
+
+    void initLinearTableDWA()
+    {
+        // the lossy DCT operates on perceptual values:
+        // x^2.2 in [-1, 1] and exp(2.2 * (x - 1)) above
+        const float logBase = std::pow(2.7182818f, 2.2f);
+
+        m_linear_table[0] = 0;
+
+        for (u32 i = 1; i < 0x10000; ++i)
+        {
+            if ((i & 0x7c00) == 0x7c00)
+            {
+                // NaN and infinity
+                m_linear_table[i] = 0;
+                continue;
+            }
+
+            float16 hf;
+            hf.u = i;
+
+            float x = hf;
+            float sign = x < 0.0f ? -1.0f : 1.0f;
+            x = std::abs(x);
+
+            if (x <= 1.0f)
+            {
+                x = sign * std::pow(x, 2.2f);
+            }
+            else
+            {
+                x = sign * std::pow(logBase, x - 1.0f);
+            }
+
+            hf = x;
+            m_linear_table[i] = hf.u;
         }
     }
 
@@ -1545,7 +2660,7 @@ struct ContextEXR
     {
         for (int i = 0; i < 16; ++i)
         {
-            s[i] = m_log_table[s[i]];
+            s[i] = m_linear_table[s[i]];
         }
     }
 
@@ -1653,20 +2768,22 @@ ContextEXR::ContextEXR(ConstMemory memory)
 
         case B44_COMPRESSION:
             m_scanLinesPerBlock = 32;
-            initLogTable();
+            initLinearTableB44();
             break;
 
         case B44A_COMPRESSION:
             m_scanLinesPerBlock = 32;
-            initLogTable();
+            initLinearTableB44();
             break;
 
         case DWAA_COMPRESSION:
             m_scanLinesPerBlock = 32;
+            initLinearTableDWA();
             break;
 
         case DWAB_COMPRESSION:
             m_scanLinesPerBlock = 256;
+            initLinearTableDWA();
             break;
 
         default:
@@ -1686,10 +2803,15 @@ ContextEXR::ContextEXR(ConstMemory memory)
         height = height / 6;
     }
 
+    if (is_single_tile)
+    {
+        computeLevels(width, isCubemap ? height * 6 : height, isCubemap ? 6 : 1);
+    }
+
     m_header.width   = width;
     m_header.height  = height;
     m_header.depth   = 0;
-    m_header.levels  = 0;
+    m_header.levels  = m_levels.size() > 1 ? int(m_levels.size()) : 0;
     m_header.faces   = isCubemap ? 6 : 0;
     m_header.palette = false;
     m_header.format  = Format(64, Format::FLOAT16, Format::RGBA, 16, 16, 16, 16);
@@ -1701,6 +2823,63 @@ ContextEXR::~ContextEXR()
 {
 }
 
+void ContextEXR::computeLevels(int width, int height, int faces)
+{
+    const TileDesc& desc = m_attributes.tiledesc;
+    const bool up = desc.isRoundUp();
+
+    int xlevels = 1;
+    int ylevels = 1;
+
+    if (desc.isMipmap())
+    {
+        xlevels = roundLog2(std::max(width, height), up) + 1;
+        ylevels = xlevels;
+    }
+    else if (desc.isRipmap())
+    {
+        xlevels = roundLog2(width, up) + 1;
+        ylevels = roundLog2(height, up) + 1;
+    }
+
+    // the offset table is ordered by level, the ripmap x-levels being the inner loop
+    size_t offset = 0;
+    std::vector<TileLevel> levels;
+
+    for (int ly = 0; ly < ylevels; ++ly)
+    {
+        for (int lx = 0; lx < xlevels; ++lx)
+        {
+            if (desc.isMipmap() && lx != ly)
+            {
+                continue;
+            }
+
+            TileLevel level;
+
+            level.xlevel = lx;
+            level.ylevel = ly;
+            level.width = levelSize(width, lx, up);
+            level.height = levelSize(height, ly, up);
+            level.xtiles = div_ceil(level.width, desc.xsize);
+            level.ytiles = div_ceil(level.height, desc.ysize);
+            level.offset = offset;
+
+            offset += size_t(level.xtiles) * level.ytiles;
+
+            // ripmaps expose the uniformly scaled levels and the cubemaps the levels which
+            // are at least one pixel per face; the others still occupy the offset table
+            if (lx == ly && level.height >= faces)
+            {
+                m_levels.push_back(level);
+            }
+
+            printLine(Print::Info, "Level: ({}, {}) {} x {}, tiles: {} x {}",
+                lx, ly, level.width, level.height, level.xtiles, level.ytiles);
+        }
+    }
+}
+
 const u8* ContextEXR::decompress_none(Memory dest, ConstMemory source)
 {
     return source.address;
@@ -1716,49 +2895,22 @@ const u8* ContextEXR::decompress_rle(Memory dest, ConstMemory source)
 
     Buffer temp(dest.size);
 
-    size_t source_bytes = source.size;
-    const u8* in = source.address;
-    u8* out = temp.data();
-    u8* end = out + dest.size;
-
-    while (source_bytes > 0)
-    {
-        int count = s8(*in++);
+    rleUncompress(temp, dest.size, source.address, source.size);
 
-        if (count < 0)
-        {
-            count = -count;
+    predictor(temp, dest.size);
+    deinterleave(dest, temp, dest.size);
 
-            if (out + count > end)
-                return dest;
-
-            std::memcpy(out, in, count);
-            out += count;
-            in += count;
-            source_bytes -= count + 1;
-        }
-        else
-        {
-            ++count;
-
-            if (out + count > end)
-                return dest;
-
-            u8 value = *in++;
-            std::memset(out, value, count);
-            out += count;
-            source_bytes -= 2;
-        }
-    }
-
-    predictor(temp, dest.size);
-    deinterleave(dest, temp, dest.size);
-
-    return dest;
-}
+    return dest;
+}
 
 const u8* ContextEXR::decompress_zip(Memory dest, ConstMemory source)
 {
+    if (dest.size == source.size)
+    {
+        // no compression
+        return source.address;
+    }
+
     Buffer temp(dest.size);
 
     CompressionStatus status = deflate_zlib::decompress(temp, source);
@@ -1845,8 +2997,17 @@ const u8* ContextEXR::decompress_piz(Memory dest, ConstMemory source, int width,
         outputSize += nx * ny * wcount;
     }
 
+    if (length < 0 || length > source.end() - ptr)
+    {
+        return nullptr;
+    }
+
     std::vector<u16> tmpBuffer(outputSize);
-    hufUncompress(ptr, length, tmpBuffer);
+
+    if (!hufUncompress(ptr, length, tmpBuffer))
+    {
+        return nullptr;
+    }
 
     // Wavelet decoding
 
@@ -2018,8 +3179,9 @@ const u8* ContextEXR::decompress_b44(Memory dest, ConstMemory source, int width,
     const u8* source_end = source.end();
     const u8* dest_end = dest.end();
 
+    // the last block and the image edge tiles can be smaller than the nominal block
     const int block_width = width;
-    const int block_height = std::max(height, m_scanLinesPerBlock);
+    const int block_height = height;
 
     for (const Channel& channel : channels)
     {
@@ -2160,26 +3322,387 @@ const u8* ContextEXR::decompress_b44(Memory dest, ConstMemory source, int width,
 
 const u8* ContextEXR::decompress_dwaa(Memory dest, ConstMemory source, int width, int height, int ystart)
 {
-    MANGO_UNREFERENCED(dest);
-    MANGO_UNREFERENCED(source);
-    MANGO_UNREFERENCED(width);
-    MANGO_UNREFERENCED(height);
-    MANGO_UNREFERENCED(ystart);
-
-    // MANGO TODO
-    return nullptr;
+    return decompress_dwa(dest, source, width, height, ystart);
 }
 
 const u8* ContextEXR::decompress_dwab(Memory dest, ConstMemory source, int width, int height, int ystart)
 {
-    MANGO_UNREFERENCED(dest);
-    MANGO_UNREFERENCED(source);
-    MANGO_UNREFERENCED(width);
-    MANGO_UNREFERENCED(height);
-    MANGO_UNREFERENCED(ystart);
+    // DWAB differs from DWAA only by the number of scanlines in a block
+    return decompress_dwa(dest, source, width, height, ystart);
+}
+
+const u8* ContextEXR::decompress_dwa(Memory dest, ConstMemory source, int width, int height, int ystart)
+{
+    const std::vector<Channel>& channels = m_attributes.chlist.channels;
+
+    constexpr size_t headerSize = 11 * sizeof(u64);
+
+    if (source.size < headerSize)
+    {
+        return nullptr;
+    }
+
+    LittleEndianConstPointer p = source.address;
+
+    u64 version = p.read64();
+    u64 unknownUncompressedSize = p.read64();
+    u64 unknownCompressedSize = p.read64();
+    u64 acCompressedSize = p.read64();
+    u64 dcCompressedSize = p.read64();
+    u64 rleCompressedSize = p.read64();
+    u64 rleUncompressedSize = p.read64();
+    u64 rleRawSize = p.read64();
+    u64 acUncompressedCount = p.read64();
+    u64 dcUncompressedCount = p.read64();
+    u64 acCompression = p.read64();
+
+    if (version > 2)
+    {
+        return nullptr;
+    }
+
+    const u8* ptr = p;
+    const u8* end = source.end();
+
+    std::vector<DwaClassifier> rules;
+
+    if (version < 2)
+    {
+        rules = getLegacyDwaClassifiers();
+    }
+    else if (!parseDwaClassifiers(rules, ptr, end))
+    {
+        return nullptr;
+    }
+
+    // UNKNOWN data is packed first, followed by the AC, DC and RLE data
+
+    u64 available = u64(end - ptr);
+
+    if (unknownCompressedSize > available ||
+        acCompressedSize > available - unknownCompressedSize ||
+        dcCompressedSize > available - unknownCompressedSize - acCompressedSize ||
+        rleCompressedSize > available - unknownCompressedSize - acCompressedSize - dcCompressedSize)
+    {
+        return nullptr;
+    }
+
+    ConstMemory unknownMemory(ptr, size_t(unknownCompressedSize));
+    ptr += unknownCompressedSize;
+
+    ConstMemory acMemory(ptr, size_t(acCompressedSize));
+    ptr += acCompressedSize;
+
+    ConstMemory dcMemory(ptr, size_t(dcCompressedSize));
+    ptr += dcCompressedSize;
+
+    ConstMemory rleMemory(ptr, size_t(rleCompressedSize));
+
+    // classify the channels
+
+    struct ChannelDWA
+    {
+        u8 scheme = DWA_UNKNOWN;
+        int width = 0;
+        int height = 0;
+        int bytes = 0;
+        std::vector<u8*> rows;
+    };
+
+    const int numChannels = int(channels.size());
+    std::vector<ChannelDWA> cd(numChannels);
+
+    // RGB channel triplets (by layer name) which are color converted together
+    std::map<std::string, std::array<int, 3>> prefixMap;
+
+    for (int i = 0; i < numChannels; ++i)
+    {
+        const Channel& channel = channels[i];
+        const std::string& name = channel.name;
+
+        std::string prefix;
+        std::string suffix = name;
+
+        auto n = name.find_last_of('.');
+        if (n != std::string::npos)
+        {
+            prefix = name.substr(0, n);
+            suffix = name.substr(n + 1);
+        }
+
+        auto it = prefixMap.find(prefix);
+        if (it == prefixMap.end())
+        {
+            it = prefixMap.emplace(prefix, std::array<int, 3> { -1, -1, -1 }).first;
+        }
+
+        for (const DwaClassifier& rule : rules)
+        {
+            if (rule.match(suffix, u8(channel.datatype)))
+            {
+                cd[i].scheme = rule.scheme;
+
+                if (rule.cscIndex >= 0)
+                {
+                    it->second[rule.cscIndex] = i;
+                }
+            }
+        }
+
+        cd[i].width = div_ceil(width, channel.xsamples);
+        cd[i].bytes = channel.bytes;
+    }
+
+    // row addresses in the decompressed block
+
+    u8* out = dest.address;
+
+    for (int y = 0; y < height; ++y)
+    {
+        int cury = y + ystart;
+
+        for (int i = 0; i < numChannels; ++i)
+        {
+            const Channel& channel = channels[i];
+
+            if ((cury % channel.ysamples) != 0)
+                continue;
+
+            size_t bpl = size_t(cd[i].width) * cd[i].bytes;
+
+            if (out + bpl > dest.end())
+            {
+                return nullptr;
+            }
+
+            cd[i].rows.push_back(out);
+            out += bpl;
+        }
+    }
+
+    for (ChannelDWA& channel : cd)
+    {
+        channel.height = int(channel.rows.size());
+    }
+
+    // UNKNOWN
+
+    Buffer unknown(static_cast<size_t>(unknownUncompressedSize));
+
+    if (unknownCompressedSize > 0)
+    {
+        CompressionStatus status = deflate_zlib::decompress(unknown, unknownMemory);
+        if (!status || status.size != unknownUncompressedSize)
+        {
+            return nullptr;
+        }
+    }
+
+    // AC
+
+    std::vector<u16> ac(static_cast<size_t>(acUncompressedCount));
+
+    if (acCompressedSize > 0)
+    {
+        switch (acCompression)
+        {
+            case DWA_STATIC_HUFFMAN:
+                if (!hufUncompress(acMemory.address, int(acMemory.size), ac))
+                {
+                    return nullptr;
+                }
+                break;
+
+            case DWA_DEFLATE:
+            {
+                Memory memory(reinterpret_cast<u8*>(ac.data()), ac.size() * sizeof(u16));
+                CompressionStatus status = deflate_zlib::decompress(memory, acMemory);
+                if (!status || status.size != memory.size)
+                {
+                    return nullptr;
+                }
+                break;
+            }
+
+            default:
+                return nullptr;
+        }
+    }
+
+    // DC (zip with predictor)
+
+    std::vector<u16> dc(static_cast<size_t>(dcUncompressedCount));
+
+    if (dcCompressedSize > 0)
+    {
+        size_t bytes = dc.size() * sizeof(u16);
+
+        Buffer temp(bytes);
+        CompressionStatus status = deflate_zlib::decompress(temp, dcMemory);
+        if (!status || status.size != bytes)
+        {
+            return nullptr;
+        }
+
+        predictor(temp, bytes);
+        deinterleave(reinterpret_cast<u8*>(dc.data()), temp, bytes);
+    }
+
+    // RLE (zip on top of rle)
+
+    Buffer rle(static_cast<size_t>(rleRawSize));
+
+    if (rleRawSize > 0)
+    {
+        Buffer temp(static_cast<size_t>(rleUncompressedSize));
+        CompressionStatus status = deflate_zlib::decompress(temp, rleMemory);
+        if (!status || status.size != rleUncompressedSize)
+        {
+            return nullptr;
+        }
+
+        if (rleUncompress(rle, rle.size(), temp, temp.size()) != rleRawSize)
+        {
+            return nullptr;
+        }
+    }
+
+    // lossy DCT; the RGB sets come first followed by the individual channels
+
+    const u16* acPtr = ac.data();
+    const u16* acEnd = acPtr + ac.size();
+    const u16* dcPtr = dc.data();
+    const u16* dcEnd = dcPtr + dc.size();
+
+    std::vector<bool> decoded(numChannels, false);
+
+    for (const auto& it : prefixMap)
+    {
+        const std::array<int, 3>& index = it.second;
+
+        if (index[0] < 0 || index[1] < 0 || index[2] < 0)
+            continue;
+
+        const Channel& r = channels[index[0]];
+        const Channel& g = channels[index[1]];
+        const Channel& b = channels[index[2]];
+
+        if (r.xsamples != g.xsamples || r.xsamples != b.xsamples ||
+            r.ysamples != g.ysamples || r.ysamples != b.ysamples)
+            continue;
+
+        DwaComponent components[3];
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const int c = index[i];
+
+            if (cd[c].scheme != DWA_LOSSY_DCT || channels[c].datatype != channels[index[0]].datatype)
+            {
+                return nullptr;
+            }
+
+            components[i].rows = &cd[c].rows;
+            components[i].isFloat = channels[c].datatype == DataType::FLOAT;
+            decoded[c] = true;
+        }
+
+        if (!lossyDctDecode(components, 3, cd[index[0]].width, cd[index[0]].height,
+                            acPtr, acEnd, dcPtr, dcEnd, m_linear_table))
+        {
+            return nullptr;
+        }
+    }
+
+    const u8* unknownPtr = unknown.data();
+    const u8* unknownEnd = unknownPtr + unknown.size();
+    const u8* rlePtr = rle.data();
+    const u8* rleEnd = rlePtr + rle.size();
+
+    for (int i = 0; i < numChannels; ++i)
+    {
+        if (decoded[i])
+            continue;
+
+        const Channel& channel = channels[i];
+        ChannelDWA& current = cd[i];
+
+        const size_t bpl = size_t(current.width) * current.bytes;
+        const size_t bytes = bpl * current.height;
+
+        switch (current.scheme)
+        {
+            case DWA_LOSSY_DCT:
+            {
+                if (channel.datatype == DataType::UINT)
+                {
+                    return nullptr;
+                }
+
+                DwaComponent component;
+                component.rows = &current.rows;
+                component.isFloat = channel.datatype == DataType::FLOAT;
+
+                // perceptually linear channels are compressed as-is
+                const u16* toLinear = channel.linear ? nullptr : m_linear_table;
+
+                if (!lossyDctDecode(&component, 1, current.width, current.height,
+                                    acPtr, acEnd, dcPtr, dcEnd, toLinear))
+                {
+                    return nullptr;
+                }
+
+                break;
+            }
+
+            case DWA_RLE:
+            {
+                if (rlePtr + bytes > rleEnd)
+                {
+                    return nullptr;
+                }
+
+                // the bytes of each sample are stored in separate planes
+                const size_t planeSize = size_t(current.width) * current.height;
+
+                for (int y = 0; y < current.height; ++y)
+                {
+                    u8* dst = current.rows[y];
+                    const u8* src = rlePtr + size_t(y) * current.width;
+
+                    for (int x = 0; x < current.width; ++x)
+                    {
+                        for (int b = 0; b < current.bytes; ++b)
+                        {
+                            *dst++ = src[x + b * planeSize];
+                        }
+                    }
+                }
 
-    // MANGO TODO
-    return nullptr;
+                rlePtr += bytes;
+                break;
+            }
+
+            case DWA_UNKNOWN:
+            default:
+            {
+                if (unknownPtr + bytes > unknownEnd)
+                {
+                    return nullptr;
+                }
+
+                for (int y = 0; y < current.height; ++y)
+                {
+                    std::memcpy(current.rows[y], unknownPtr, bpl);
+                    unknownPtr += bpl;
+                }
+
+                break;
+            }
+        }
+    }
+
+    return dest;
 }
 
 static inline
@@ -2581,7 +4104,10 @@ void ContextEXR::decodeBlock(Surface surface, ConstMemory memory, int x0, int y0
 
     u64 time0 = mango::Time::us();
 
-    switch (m_attributes.compression)
+    // chunks which did not compress are stored as-is with every compression method
+    const u8 compression = memory.size == buffer.size() ? u8(NO_COMPRESSION) : m_attributes.compression;
+
+    switch (compression)
     {
         case NO_COMPRESSION:
             src = decompress_none(buffer, memory);
@@ -2635,18 +4161,21 @@ void ContextEXR::decodeBlock(Surface surface, ConstMemory memory, int x0, int y0
     // select first layer
     const Layer& layer = m_attributes.chlist.layers[0];
 
+    // the color resolvers write into block-relative coordinates
+    Surface block(surface, x0, y0, blockWidth, blockHeight);
+
     switch (layer.colortype)
     {
         case ColorType::LUMINANCE:
-            decodeLuminance(surface, src, layer, x0, y0, x1, y1);
+            decodeLuminance(block, src, layer, 0, 0, blockWidth, blockHeight);
             break;
 
         case ColorType::CHROMA:
-            decodeChroma(surface, src, layer, m_attributes.chromaticities, x0, y0, x1, y1);
+            decodeChroma(block, src, layer, m_attributes.chromaticities, 0, 0, blockWidth, blockHeight);
             break;
 
         case ColorType::RGB:
-            decodeRGB(surface, src, layer, x0, y0, x1, y1);
+            decodeRGB(block, src, layer, 0, 0, blockWidth, blockHeight);
             break;
 
         case ColorType::NONE:
@@ -2686,90 +4215,160 @@ void ContextEXR::decodeImage(const ImageDecodeOptions& options)
 
     ConcurrentQueue q;
 
-    if (is_single_tile)
+    int nblocks = div_ceil(height, m_scanLinesPerBlock);
+
+    printLine(Print::Info, "Blocks: {}", nblocks);
+
+    for (int i = 0; i < nblocks; ++i)
     {
-        int xtiles = div_ceil(width, m_attributes.tiledesc.xsize);
-        int ytiles = div_ceil(height, m_attributes.tiledesc.ysize);
-        int ntiles = xtiles * ytiles;
+        u64 offset = p.read64();
+        LittleEndianConstPointer ptr = m_memory.address + offset;
 
-        printLine(Print::Info, "Tiles: {} x {} ({})", xtiles, ytiles, ntiles);
+        int ystart = ptr.read32();
+        u32 size = ptr.read32();
 
-        for (int i = 0; i < ntiles; ++i)
+        int x0 = 0;
+        int y0 = ystart - m_attributes.dataWindow.ymin;
+        int x1 = width;
+        int y1 = std::min(height, y0 + m_scanLinesPerBlock);
+
+        if (y0 < 0 || y1 > height)
         {
-            u64 offset = p.read64();
-            LittleEndianConstPointer ptr = m_memory.address + offset;
+            // incorrect block
+            return;
+        }
 
-            int tilex = ptr.read32();
-            int tiley = ptr.read32();
-            int xlevel = ptr.read32();
-            int ylevel = ptr.read32();
-            u32 size = ptr.read32();
+        //printLine(Print::Info, "  y:{}, size: {} bytes", y0, size);
 
-            //printLine(Print::Info, "  pos:({},{}) level:({},{}) size: {} bytes", tilex, tiley, xlevel, ylevel, size);
-            MANGO_UNREFERENCED(xlevel);
-            MANGO_UNREFERENCED(ylevel);
+        auto task = [=]
+        {
+            ConstMemory memory(ptr, size);
+            decodeBlock(m_surface, memory, x0, y0, x1, y1);
+        };
 
-            int tileWidth = m_attributes.tiledesc.xsize;
-            int tileHeight = m_attributes.tiledesc.ysize;
+        if (options.multithread)
+        {
+            q.enqueue(task);
+        }
+        else
+        {
+            task();
+        }
+    }
 
-            int x0 = tilex * tileWidth;
-            int y0 = tiley * tileHeight;
-            int x1 = std::min(width, x0 + tileWidth);
-            int y1 = std::min(height, y0 + tileHeight);
+    q.wait();
 
-            if (x0 < 0 || x1 > width || y0 < 0 || y1 > height)
-            {
-                // incorrect tile
-                return;
-            }
+    u64 time1 = mango::Time::us();
+    m_time_decode += (time1 - time0);
 
-            auto task = [=]
-            {
-                ConstMemory memory(ptr, size);
-                decodeBlock(m_surface, memory, x0, y0, x1, y1);
-            };
+    report();
+}
 
-            if (options.multithread)
-            {
-                q.enqueue(task);
-            }
-            else
-            {
-                task();
-            }
-        }
+ImageDecodeStatus ContextEXR::decodeTiles(const Surface& dest, const ImageDecodeOptions& options, int level, int face)
+{
+    ImageDecodeStatus status;
+
+    if (m_levels.empty())
+    {
+        status.setError("Incorrect tile levels.");
+        return status;
     }
-    else
+
+    const TileLevel& tl = m_levels[std::clamp(level, 0, int(m_levels.size()) - 1)];
+
+    // cubemap faces are stacked vertically in every level
+    int faces = std::max(1, m_header.faces);
+    int width = tl.width;
+    int height = tl.height / faces;
+    int ystart = face * height;
+
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = width;
+    int y1 = height;
+
+    if (options.region.width > 0 && options.region.height > 0)
+    {
+        x0 = std::max(0, options.region.x);
+        y0 = std::max(0, options.region.y);
+        x1 = std::min(width, options.region.x + options.region.width);
+        y1 = std::min(height, options.region.y + options.region.height);
+    }
+
+    if (x0 >= x1 || y0 >= y1)
     {
-        int nblocks = div_ceil(height, m_scanLinesPerBlock);
+        status.setError("Incorrect region.");
+        return status;
+    }
 
-        printLine(Print::Info, "Blocks: {}", nblocks);
+    y0 += ystart;
+    y1 += ystart;
 
-        for (int i = 0; i < nblocks; ++i)
+    const int tileWidth = m_attributes.tiledesc.xsize;
+    const int tileHeight = m_attributes.tiledesc.ysize;
+
+    // only the tiles the region touches are read from the offset table
+    int tx0 = x0 / tileWidth;
+    int ty0 = y0 / tileHeight;
+    int tx1 = div_ceil(x1, tileWidth);
+    int ty1 = div_ceil(y1, tileHeight);
+
+    int left = tx0 * tileWidth;
+    int top = ty0 * tileHeight;
+
+    Bitmap temp(std::min(tl.width, tx1 * tileWidth) - left,
+                std::min(tl.height, ty1 * tileHeight) - top, m_header.format);
+
+    u64 time0 = mango::Time::us();
+
+    ConcurrentQueue q;
+
+    const u8* end = m_memory.end();
+
+    for (int ty = ty0; ty < ty1; ++ty)
+    {
+        for (int tx = tx0; tx < tx1; ++tx)
         {
+            LittleEndianConstPointer p = m_pointer + 8 * (tl.offset + size_t(ty) * tl.xtiles + tx);
+            if (p + 8 > end)
+            {
+                status.setError("Incorrect file: out of data.");
+                break;
+            }
+
             u64 offset = p.read64();
+            if (offset > m_memory.size - 20)
+            {
+                status.setError("Incorrect tile offset: {}", offset);
+                break;
+            }
+
             LittleEndianConstPointer ptr = m_memory.address + offset;
 
-            int ystart = ptr.read32();
+            int tilex = ptr.read32();
+            int tiley = ptr.read32();
+            int xlevel = ptr.read32();
+            int ylevel = ptr.read32();
             u32 size = ptr.read32();
 
-            int x0 = 0;
-            int y0 = ystart - m_attributes.dataWindow.ymin;
-            int x1 = width;
-            int y1 = std::min(height, y0 + m_scanLinesPerBlock);
+            //printLine(Print::Info, "  pos:({},{}) level:({},{}) size: {} bytes", tilex, tiley, xlevel, ylevel, size);
 
-            if (y0 < 0 || y1 > height)
+            if (tilex != tx || tiley != ty || xlevel != tl.xlevel || ylevel != tl.ylevel ||
+                size > size_t(end - ptr))
             {
-                // incorrect block
-                return;
+                status.setError("Incorrect tile: ({}, {}) level: ({}, {})", tilex, tiley, xlevel, ylevel);
+                break;
             }
 
-            //printLine(Print::Info, "  y:{}, size: {} bytes", y0, size);
+            int bx0 = tx * tileWidth;
+            int by0 = ty * tileHeight;
+            int bx1 = std::min(tl.width, bx0 + tileWidth);
+            int by1 = std::min(tl.height, by0 + tileHeight);
 
-            auto task = [=]
+            auto task = [=, &temp]
             {
                 ConstMemory memory(ptr, size);
-                decodeBlock(m_surface, memory, x0, y0, x1, y1);
+                decodeBlock(temp, memory, bx0 - left, by0 - top, bx1 - left, by1 - top);
             };
 
             if (options.multithread)
@@ -2781,6 +4380,11 @@ void ContextEXR::decodeImage(const ImageDecodeOptions& options)
                 task();
             }
         }
+
+        if (!status)
+        {
+            break;
+        }
     }
 
     q.wait();
@@ -2788,7 +4392,12 @@ void ContextEXR::decodeImage(const ImageDecodeOptions& options)
     u64 time1 = mango::Time::us();
     m_time_decode += (time1 - time0);
 
-    report();
+    if (status)
+    {
+        dest.blit(0, 0, Surface(temp, x0 - left, y0 - top, x1 - x0, y1 - y0));
+    }
+
+    return status;
 }
 
 ImageDecodeStatus ContextEXR::decode(const Surface& dest, const ImageDecodeOptions& options, int level, int depth, int face)
@@ -2801,18 +4410,30 @@ ImageDecodeStatus ContextEXR::decode(const Surface& dest, const ImageDecodeOptio
         return status;
     }
 
+    face = std::clamp(face, 0, std::max(1, m_header.faces) - 1);
+
+    // flip z-axis for cubemap faces
+    if (face == 4) face = 5;
+    else if (face == 5) face = 4;
+
+    if (is_single_tile)
+    {
+        return decodeTiles(dest, options, level, face);
+    }
+
     decodeImage(options);
 
     int width = m_header.width;
     int height = m_header.height;
 
-    face = std::clamp(face, 0, std::max(1, m_header.faces) - 1);
+    Surface source(m_surface, 0, face * height, width, height);
 
-    // flip z-axis for cubemap faces
-    if (face == 4) face = 5;
-    else if (face == 5) face = 4;
+    if (options.region.width > 0 && options.region.height > 0)
+    {
+        source = Surface(source, options.region.x, options.region.y, options.region.width, options.region.height);
+    }
 
-    dest.blit(0, 0, Surface(m_surface, 0, face * height, width, (face + 1) * height));
+    dest.blit(0, 0, source);
 
     return status;
 }
@@ -2863,6 +4484,353 @@ namespace
         return x;
     }
 
+    // ------------------------------------------------------------
+    // ImageEncoder
+    // ------------------------------------------------------------
+
+    void writeAttribute(LittleEndianStream& s, const char* name, const char* type, u32 size)
+    {
+        s.write(name, std::strlen(name) + 1);
+        s.write(type, std::strlen(type) + 1);
+        s.write32(size);
+    }
+
+    size_t compress_piz(u8* dest, const u16* source, int width, int height, int channels)
+    {
+        const size_t count = size_t(width) * height * channels;
+
+        // planar layout: the scanlines of each channel are stored contiguously
+        std::vector<u16> planar(count);
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                const u16* src = source + (size_t(y) * channels + c) * width;
+                u16* dst = planar.data() + (size_t(c) * height + y) * width;
+                std::memcpy(dst, src, width * sizeof(u16));
+            }
+        }
+
+        // compress the range of the pixel data
+
+        std::vector<u8> bitmap(BITMAP_SIZE);
+        u16 minNonZero;
+        u16 maxNonZero;
+        bitmapFromData(planar.data(), count, bitmap.data(), minNonZero, maxNonZero);
+
+        std::vector<u16> lut(USHORT_RANGE);
+        u16 maxValue = forwardLutFromBitmap(bitmap.data(), lut.data());
+        applyLut(lut.data(), planar.data(), count);
+
+        u8* ptr = dest;
+
+        littleEndian::ustore16(ptr + 0, minNonZero);
+        littleEndian::ustore16(ptr + 2, maxNonZero);
+        ptr += 4;
+
+        if (minNonZero <= maxNonZero)
+        {
+            size_t n = maxNonZero - minNonZero + 1;
+            std::memcpy(ptr, bitmap.data() + minNonZero, n);
+            ptr += n;
+        }
+
+        // Wavelet encoding
+
+        for (int c = 0; c < channels; ++c)
+        {
+            wav2Encode(planar.data() + size_t(c) * width * height, width, 1, height, width, maxValue);
+        }
+
+        // Huffman encoding
+
+        size_t length = hufCompress(planar.data(), int(count), ptr + 4);
+        littleEndian::ustore32(ptr, u32(length));
+        ptr += length + 4;
+
+        return ptr - dest;
+    }
+
+    void encodeBlock(Buffer& output, const Surface& surface, int channels, u8 compression, int level)
+    {
+        const int width = surface.width;
+        const int height = surface.height;
+        const size_t bytes = size_t(width) * height * channels * sizeof(u16);
+
+        // each scanline stores the channels one after another in alphabetical order (A, B, G, R)
+        Buffer raw(bytes);
+        u16* dest = reinterpret_cast<u16*>(raw.data());
+
+        for (int y = 0; y < height; ++y)
+        {
+            const u16* scan = reinterpret_cast<const u16*>(surface.address(0, y));
+
+            for (int c = 0; c < channels; ++c)
+            {
+                const int component = channels - 1 - c;
+
+                for (int x = 0; x < width; ++x)
+                {
+                    *dest++ = scan[x * 4 + component];
+                }
+            }
+        }
+
+        Buffer temp;
+        size_t size = bytes;
+
+        switch (compression)
+        {
+            case RLE_COMPRESSION:
+            {
+                Buffer delta(bytes);
+                interleave(delta, raw, bytes);
+                predictorEncode(delta, bytes);
+
+                temp.reset(bytes + bytes / 2 + 2);
+                size = rleCompress(temp, delta, bytes);
+                break;
+            }
+
+            case ZIPS_COMPRESSION:
+            case ZIP_COMPRESSION:
+            {
+                Buffer delta(bytes);
+                interleave(delta, raw, bytes);
+                predictorEncode(delta, bytes);
+
+                temp.reset(deflate_zlib::bound(bytes));
+                CompressionStatus status = deflate_zlib::compress(temp, delta, level);
+                if (status)
+                {
+                    size = status.size;
+                }
+                break;
+            }
+
+            case PIZ_COMPRESSION:
+            {
+                temp.reset(bytes + bytes / 16 + 65536 + 8192);
+                size = compress_piz(temp, reinterpret_cast<const u16*>(raw.data()), width, height, channels);
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        // chunks which do not compress are stored as-is; the decoder detects them from the size
+        if (size < bytes)
+        {
+            output.append(temp, size);
+        }
+        else
+        {
+            output.append(raw, bytes);
+        }
+    }
+
+    ImageEncodeStatus imageEncode(Stream& stream, const Surface& surface, const ImageEncodeOptions& options)
+    {
+        ImageEncodeStatus status;
+
+        u8 compression = NO_COMPRESSION;
+        int scanLinesPerBlock = 1;
+
+        // validate the method before narrowing it to the compression attribute
+        switch (options.method)
+        {
+            case EXR_COMPRESSION_NONE:
+                compression = NO_COMPRESSION;
+                break;
+
+            case EXR_COMPRESSION_RLE:
+                compression = RLE_COMPRESSION;
+                break;
+
+            case EXR_COMPRESSION_ZIPS:
+                compression = ZIPS_COMPRESSION;
+                break;
+
+            case EXR_COMPRESSION_ZIP:
+                compression = ZIP_COMPRESSION;
+                scanLinesPerBlock = 16;
+                break;
+
+            case EXR_COMPRESSION_PIZ:
+                compression = PIZ_COMPRESSION;
+                scanLinesPerBlock = 32;
+                break;
+
+            default:
+                status.setError("[ImageEncoder.EXR] Unsupported compression: {}", options.method);
+                return status;
+        }
+
+        const int width = surface.width;
+        const int height = surface.height;
+        const int channels = surface.format.isAlpha() ? 4 : 3;
+
+        const bool tiled = options.tile > 0;
+        const int tileWidth = tiled ? options.tile : width;
+        const int tileHeight = tiled ? options.tile : scanLinesPerBlock;
+
+        const int xblocks = div_ceil(width, tileWidth);
+        const int yblocks = div_ceil(height, tileHeight);
+        const int nblocks = xblocks * yblocks;
+
+        Format format(64, Format::FLOAT16, Format::RGBA, 16, 16, 16, 16);
+
+        Surface source = surface;
+        std::unique_ptr<Bitmap> temp;
+
+        if (surface.format != format)
+        {
+            temp = std::make_unique<Bitmap>(surface, format);
+            source = *temp;
+        }
+
+        LittleEndianStream s = stream;
+
+        // the chunk offsets are relative to the start of the file
+        const u64 base = s.offset();
+
+        s.write32(0x01312f76);
+        s.write32(2 | (tiled ? 0x0200 : 0));
+
+        // header attributes
+
+        const char* names [] = { "A", "B", "G", "R" };
+
+        writeAttribute(s, "channels", "chlist", channels * 18 + 1);
+
+        for (int c = 4 - channels; c < 4; ++c)
+        {
+            s.write(names[c], 2);
+            s.write32(u32(DataType::HALF));
+            s.write8(0); // linear
+            s.write8(0); // reserved
+            s.write8(0);
+            s.write8(0);
+            s.write32(1); // xsamples
+            s.write32(1); // ysamples
+        }
+
+        s.write8(0);
+
+        writeAttribute(s, "compression", "compression", 1);
+        s.write8(compression);
+
+        for (const char* name : { "dataWindow", "displayWindow" })
+        {
+            writeAttribute(s, name, "box2i", 16);
+            s.write32(0);
+            s.write32(0);
+            s.write32(width - 1);
+            s.write32(height - 1);
+        }
+
+        writeAttribute(s, "lineOrder", "lineOrder", 1);
+        s.write8(INCREASING_Y);
+
+        writeAttribute(s, "pixelAspectRatio", "float", 4);
+        s.write32f(1.0f);
+
+        writeAttribute(s, "screenWindowCenter", "v2f", 8);
+        s.write32f(0.0f);
+        s.write32f(0.0f);
+
+        writeAttribute(s, "screenWindowWidth", "float", 4);
+        s.write32f(1.0f);
+
+        if (tiled)
+        {
+            writeAttribute(s, "tiles", "tiledesc", 9);
+            s.write32(tileWidth);
+            s.write32(tileHeight);
+            s.write8(0); // single level, round down
+        }
+
+        s.write8(0);
+
+        // reserve the offset table; it is written after the chunks
+
+        const u64 table = s.offset();
+        std::vector<u64> offsets(nblocks, 0);
+        s.write(offsets.data(), nblocks * sizeof(u64));
+
+        // compress the chunks in parallel and write them in order
+
+        std::vector<Buffer> chunks(nblocks);
+
+        ConcurrentQueue q;
+        TicketQueue tk;
+
+        for (int i = 0; i < nblocks; ++i)
+        {
+            const int tx = i % xblocks;
+            const int ty = i / xblocks;
+
+            Surface block(source, tx * tileWidth, ty * tileHeight, tileWidth, tileHeight);
+
+            auto ticket = tk.acquire();
+
+            auto task = [&, ticket, block, i, tx, ty]
+            {
+                encodeBlock(chunks[i], block, channels, compression, options.compression);
+
+                ticket.consume([&, i, tx, ty]
+                {
+                    offsets[i] = s.offset() - base;
+
+                    if (tiled)
+                    {
+                        s.write32(tx);
+                        s.write32(ty);
+                        s.write32(0); // xlevel
+                        s.write32(0); // ylevel
+                    }
+                    else
+                    {
+                        s.write32(ty * tileHeight);
+                    }
+
+                    s.write32(u32(chunks[i].size()));
+                    s.write(chunks[i].data(), chunks[i].size());
+                    chunks[i].reset();
+                });
+            };
+
+            if (options.multithread)
+            {
+                q.enqueue(task);
+            }
+            else
+            {
+                task();
+            }
+        }
+
+        q.wait();
+        tk.wait();
+
+        // offset table
+
+        const u64 end = s.offset();
+
+        s.seek(table, Stream::BEGIN);
+
+        for (u64 offset : offsets)
+        {
+            s.write64(offset);
+        }
+
+        s.seek(end, Stream::BEGIN);
+
+        return status;
+    }
+
 } // namespace
 
 namespace mango::image
@@ -2871,6 +4839,7 @@ namespace mango::image
     void registerImageCodecEXR()
     {
         registerImageDecoder(createInterface, ".exr");
+        registerImageEncoder(imageEncode, ".exr");
     }
 
 } // namespace mango::image
@@ -6,6 +6,7 @@
 #include <mango/core/system.hpp>
 #include <mango/core/buffer.hpp>
 #include <mango/core/compress.hpp>
+#include <mango/core/thread.hpp>
 #include <mango/image/image.hpp>
 #include <mango/image/compression.hpp>
 #include "../../external/basisu/transcoder/basisu_transcoder.h"
@@ -1386,6 +1387,350 @@ namespace
         return x;
     }
 
+    // ------------------------------------------------------------
+    // ImageEncoder
+    // ------------------------------------------------------------
+
+    struct SampleKTX2
+    {
+        u8 channel;  // channel id and datatype qualifiers
+        u16 offset;  // bit offset in the texel block
+        u8 length;   // bit length in the texel block
+    };
+
+    struct DescriptorKTX2
+    {
+        u8 model = KHR_DF_MODEL_UNSPECIFIED;
+        std::vector<SampleKTX2> samples;
+    };
+
+    bool getDescriptor(DescriptorKTX2& desc, const TextureCompression& info)
+    {
+        const u8 sign = (info.compression & TextureCompression::SIGNED) ? KHR_DF_SAMPLE_DATATYPE_SIGNED : 0;
+
+        switch (info.compression)
+        {
+            case TextureCompression::NONE:
+                // R8G8B8A8
+                desc.model = KHR_DF_MODEL_RGBSDA;
+                desc.samples.push_back({ KHR_DF_CHANNEL_RGBSDA_R, 0, 8 });
+                desc.samples.push_back({ KHR_DF_CHANNEL_RGBSDA_G, 8, 8 });
+                desc.samples.push_back({ KHR_DF_CHANNEL_RGBSDA_B, 16, 8 });
+                desc.samples.push_back({ KHR_DF_CHANNEL_RGBSDA_A, 24, 8 });
+                break;
+
+            case TextureCompression::BC1_UNORM:
+            case TextureCompression::BC1_UNORM_SRGB:
+                desc.model = KHR_DF_MODEL_BC1A;
+                desc.samples.push_back({ KHR_DF_CHANNEL_BC1A_COLOR, 0, 64 });
+                break;
+
+            case TextureCompression::BC1_UNORM_ALPHA:
+            case TextureCompression::BC1_UNORM_ALPHA_SRGB:
+                desc.model = KHR_DF_MODEL_BC1A;
+                desc.samples.push_back({ KHR_DF_CHANNEL_BC1A_ALPHAPRESENT, 0, 64 });
+                break;
+
+            case TextureCompression::BC2_UNORM:
+            case TextureCompression::BC2_UNORM_SRGB:
+                desc.model = KHR_DF_MODEL_BC2;
+                desc.samples.push_back({ KHR_DF_CHANNEL_BC2_ALPHA, 0, 64 });
+                desc.samples.push_back({ KHR_DF_CHANNEL_BC2_COLOR, 64, 64 });
+                break;
+
+            case TextureCompression::BC3_UNORM:
+            case TextureCompression::BC3_UNORM_SRGB:
+                desc.model = KHR_DF_MODEL_BC3;
+                desc.samples.push_back({ KHR_DF_CHANNEL_BC3_ALPHA, 0, 64 });
+                desc.samples.push_back({ KHR_DF_CHANNEL_BC3_COLOR, 64, 64 });
+                break;
+
+            case TextureCompression::BC4_UNORM:
+            case TextureCompression::BC4_SNORM:
+                desc.model = KHR_DF_MODEL_BC4;
+                desc.samples.push_back({ u8(KHR_DF_CHANNEL_BC4_DATA | sign), 0, 64 });
+                break;
+
+            case TextureCompression::BC5_UNORM:
+            case TextureCompression::BC5_SNORM:
+                desc.model = KHR_DF_MODEL_BC5;
+                desc.samples.push_back({ u8(KHR_DF_CHANNEL_BC5_R | sign), 0, 64 });
+                desc.samples.push_back({ u8(KHR_DF_CHANNEL_BC5_G | sign), 64, 64 });
+                break;
+
+            case TextureCompression::BC6H_UF16:
+            case TextureCompression::BC6H_SF16:
+                desc.model = KHR_DF_MODEL_BC6H;
+                desc.samples.push_back({ u8(KHR_DF_CHANNEL_BC6H_COLOR | KHR_DF_SAMPLE_DATATYPE_FLOAT | sign), 0, 128 });
+                break;
+
+            case TextureCompression::BC7_UNORM:
+            case TextureCompression::BC7_UNORM_SRGB:
+                desc.model = KHR_DF_MODEL_BC7;
+                desc.samples.push_back({ KHR_DF_CHANNEL_BC7_DATA, 0, 128 });
+                break;
+
+            case TextureCompression::ETC1_RGB:
+                desc.model = KHR_DF_MODEL_ETC1;
+                desc.samples.push_back({ KHR_DF_CHANNEL_ETC1_COLOR, 0, 64 });
+                break;
+
+            case TextureCompression::ETC2_RGB:
+            case TextureCompression::ETC2_SRGB:
+                desc.model = KHR_DF_MODEL_ETC2;
+                desc.samples.push_back({ KHR_DF_CHANNEL_ETC2_COLOR, 0, 64 });
+                break;
+
+            case TextureCompression::ETC2_RGBA:
+            case TextureCompression::ETC2_SRGB_ALPHA8:
+                desc.model = KHR_DF_MODEL_ETC2;
+                desc.samples.push_back({ KHR_DF_CHANNEL_ETC2_ALPHA, 0, 64 });
+                desc.samples.push_back({ KHR_DF_CHANNEL_ETC2_COLOR, 64, 64 });
+                break;
+
+            default:
+                if ((info.compression & 0xff) == TextureCompression::ASTC)
+                {
+                    // 2D ASTC (the 3D block sizes have a different base format)
+                    desc.model = KHR_DF_MODEL_ASTC;
+                    desc.samples.push_back({ KHR_DF_CHANNEL_ASTC_DATA, 0, 128 });
+                    break;
+                }
+                return false;
+        }
+
+        return true;
+    }
+
+    void writeDescriptor(LittleEndianStream& s, const DescriptorKTX2& desc, const TextureCompression& info, bool supercompressed)
+    {
+        const bool compressed = info.compression != TextureCompression::NONE;
+        const u32 blockSize = 24 + 16 * u32(desc.samples.size());
+
+        s.write32(4 + blockSize); // dfdTotalSize
+
+        s.write32((KHR_DF_KHR_DESCRIPTORTYPE_BASICFORMAT << 17) | KHR_DF_VENDORID_KHRONOS);
+        s.write32((blockSize << 16) | 2); // version 1.3
+
+        s.write8(desc.model);
+        s.write8(KHR_DF_PRIMARIES_BT709);
+        s.write8(info.isLinear() ? KHR_DF_TRANSFER_LINEAR : KHR_DF_TRANSFER_SRGB);
+        s.write8(KHR_DF_FLAG_ALPHA_STRAIGHT);
+
+        // texelBlockDimension is stored as size - 1
+        s.write8(compressed ? u8(info.width - 1) : 0);
+        s.write8(compressed ? u8(info.height - 1) : 0);
+        s.write8(0);
+        s.write8(0);
+
+        // the size of the texel block is unknown when the levels are supercompressed
+        const u8 bytesPlane0 = supercompressed ? 0 : u8(compressed ? info.bytes : 4);
+
+        s.write8(bytesPlane0);
+        for (int i = 0; i < 7; ++i)
+        {
+            s.write8(0);
+        }
+
+        for (const SampleKTX2& sample : desc.samples)
+        {
+            u32 lower = 0;
+            u32 upper = compressed ? 0xffffffff : 0xff;
+
+            if (sample.channel & KHR_DF_SAMPLE_DATATYPE_FLOAT)
+            {
+                lower = (sample.channel & KHR_DF_SAMPLE_DATATYPE_SIGNED) ? 0xbf800000 : 0; // -1.0f : 0.0f
+                upper = 0x3f800000; // 1.0f
+            }
+            else if (sample.channel & KHR_DF_SAMPLE_DATATYPE_SIGNED)
+            {
+                lower = 0x80000000;
+                upper = 0x7fffffff;
+            }
+
+            // the alpha of sRGB formats is always linear
+            u8 channel = sample.channel;
+            if (!info.isLinear() && (channel & 0xf) == KHR_DF_CHANNEL_RGBSDA_ALPHA)
+            {
+                channel |= KHR_DF_SAMPLE_DATATYPE_LINEAR;
+            }
+
+            s.write32((u32(channel) << 24) | (u32(sample.length - 1) << 16) | sample.offset);
+            s.write32(0); // samplePosition
+            s.write32(lower);
+            s.write32(upper);
+        }
+    }
+
+    ImageEncodeStatus imageEncode(Stream& stream, const Surface& surface, const ImageEncodeOptions& options)
+    {
+        ImageEncodeStatus status;
+
+        TextureCompression info(options.texture);
+
+        Format format(32, Format::UNORM, Format::RGBA, 8, 8, 8, 8);
+        u32 vkFormat = FORMAT_R8G8B8A8_UNORM;
+        u32 typeSize = 1;
+
+        const bool compressed = info.compression != TextureCompression::NONE;
+        if (compressed)
+        {
+            if (!info.encode)
+            {
+                status.setError("[ImageEncoder.KTX2] No encoder for compression {:#x}.", options.texture);
+                return status;
+            }
+
+            format = info.format;
+            vkFormat = info.vulkan;
+        }
+
+        DescriptorKTX2 descriptor;
+
+        if (!vkFormat || !getDescriptor(descriptor, info))
+        {
+            status.setError("[ImageEncoder.KTX2] Compression {:#x} is not supported.", options.texture);
+            return status;
+        }
+
+        const int maxLevels = u32_log2(std::max(surface.width, surface.height)) + 1;
+        const int levels = options.levels > 0 ? std::min(options.levels, maxLevels) : maxLevels;
+
+        // mipmap chain; every level is filtered from the previous one
+        std::vector<Bitmap> mipmaps;
+        mipmaps.reserve(levels);
+        mipmaps.emplace_back(surface, format);
+
+        for (int level = 1; level < levels; ++level)
+        {
+            const Bitmap& parent = mipmaps.back();
+            mipmaps.emplace_back(std::max(1, parent.width / 2), std::max(1, parent.height / 2), format);
+            mipmaps.back().downsample(parent);
+        }
+
+        const TextureCompression::Quality quality = TextureCompression::getQuality(options.quality);
+        const bool supercompress = options.supercompress;
+
+        std::vector<Buffer> images(levels);
+        std::vector<u64> uncompressed(levels);
+        std::atomic<bool> failure { false };
+
+        // the levels are compressed concurrently; the small ones would not fill the machine alone
+        ConcurrentQueue queue;
+
+        for (int level = 0; level < levels; ++level)
+        {
+            queue.enqueue([&, level]
+            {
+                const Bitmap& mipmap = mipmaps[level];
+                Buffer& image = images[level];
+
+                if (compressed)
+                {
+                    image.resize(info.getBlockBytes(mipmap.width, mipmap.height));
+                    if (!info.compress(image, mipmap, quality))
+                    {
+                        failure = true;
+                        return;
+                    }
+                }
+                else
+                {
+                    image.append(mipmap.image, size_t(mipmap.width) * mipmap.height * format.bytes());
+                }
+
+                uncompressed[level] = image.size();
+
+                if (supercompress)
+                {
+                    Buffer temp(zstd::bound(image.size()));
+                    CompressionStatus result = zstd::compress(temp, image, options.compression);
+                    if (!result)
+                    {
+                        failure = true;
+                        return;
+                    }
+
+                    image.reset();
+                    image.append(temp.data(), result.size);
+                }
+            });
+        }
+
+        queue.wait();
+
+        if (failure)
+        {
+            status.setError("[ImageEncoder.KTX2] Compression failed.");
+            return status;
+        }
+
+        const u64 base = stream.offset();
+        LittleEndianStream s = stream;
+
+        // header
+        constexpr u8 identifier [] =
+        {
+            0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+            0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+        };
+
+        s.write(identifier, sizeof(identifier));
+        s.write32(vkFormat);
+        s.write32(typeSize);
+        s.write32(surface.width);
+        s.write32(surface.height);
+        s.write32(0); // pixelDepth
+        s.write32(0); // layerCount
+        s.write32(1); // faceCount
+        s.write32(levels);
+        s.write32(supercompress ? SUPERCOMPRESSION_ZSTANDARD : SUPERCOMPRESSION_NONE);
+
+        // index
+        const u32 dfdByteOffset = 80 + 24 * levels;
+        const u32 dfdByteLength = 4 + 24 + 16 * u32(descriptor.samples.size());
+
+        s.write32(dfdByteOffset);
+        s.write32(dfdByteLength);
+        s.write32(0); // kvdByteOffset
+        s.write32(0); // kvdByteLength
+        s.write64(0); // sgdByteOffset
+        s.write64(0); // sgdByteLength
+
+        // the level images are stored smallest first; without supercompression the
+        // offsets are aligned to the texel block size and four bytes
+        const u64 alignment = supercompress ? 1 : std::max(4, compressed ? info.bytes : format.bytes());
+
+        std::vector<u64> offsets(levels);
+        u64 offset = dfdByteOffset + dfdByteLength;
+
+        for (int level = levels - 1; level >= 0; --level)
+        {
+            offset = div_ceil(offset, alignment) * alignment;
+            offsets[level] = offset;
+            offset += images[level].size();
+        }
+
+        for (int level = 0; level < levels; ++level)
+        {
+            s.write64(offsets[level]);
+            s.write64(images[level].size());
+            s.write64(uncompressed[level]);
+        }
+
+        writeDescriptor(s, descriptor, info, supercompress);
+
+        // level images
+        for (int level = levels - 1; level >= 0; --level)
+        {
+            const u8 zeros [16] = { 0 };
+            s.write(zeros, size_t(offsets[level] - (stream.offset() - base)));
+            s.write(images[level], images[level].size());
+        }
+
+        return status;
+    }
+
 } // namespace
 
 namespace mango::image
@@ -1394,6 +1739,7 @@ namespace mango::image
     void registerImageCodecKTX2()
     {
         registerImageDecoder(createInterface, ".ktx2");
+        registerImageEncoder(imageEncode, ".ktx2");
     }
 
 } // namespace mango::image
@@ -82,6 +82,62 @@ namespace
         return size;
     }
 
+    // ----------------------------------------------------------------------------
+    // downsample
+    // ----------------------------------------------------------------------------
+
+    inline u8 average(u8 a, u8 b, u8 c, u8 d)
+    {
+        return u8((a + b + c + d + 2) >> 2);
+    }
+
+    inline float average(float a, float b, float c, float d)
+    {
+        return (a + b + c + d) * 0.25f;
+    }
+
+    template <typename T>
+    void downsample_scan(T* dest, const T* scan0, const T* scan1, int width, int xmax)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            // odd source dimensions clamp to the last pixel
+            const int x0 = std::min(x * 2 + 0, xmax) * 4;
+            const int x1 = std::min(x * 2 + 1, xmax) * 4;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                dest[i] = average(scan0[x0 + i], scan0[x1 + i], scan1[x0 + i], scan1[x1 + i]);
+            }
+
+            dest += 4;
+        }
+    }
+
+    template <typename T>
+    void downsample_surface(const Surface& dest, const Surface& source)
+    {
+        const int slice = 64;
+
+        ConcurrentQueue queue;
+
+        for (int y = 0; y < dest.height; y += slice)
+        {
+            queue.enqueue([=, &dest, &source]
+            {
+                const int y1 = std::min(y + slice, dest.height);
+                const int ymax = source.height - 1;
+
+                for (int i = y; i < y1; ++i)
+                {
+                    const T* scan0 = source.address<T>(0, std::min(i * 2 + 0, ymax));
+                    const T* scan1 = source.address<T>(0, std::min(i * 2 + 1, ymax));
+                    downsample_scan(dest.address<T>(0, i), scan0, scan1, dest.width, source.width - 1);
+                }
+            });
+        }
+    }
+
     // ----------------------------------------------------------------------------
     // create_surface()
     // ----------------------------------------------------------------------------
@@ -361,6 +417,32 @@ namespace mango::image
         }
     }
 
+    void Surface::downsample(const Surface& source) const
+    {
+        if (!width || !height || !source.width || !source.height)
+            return;
+
+        const Format rgba8(32, Format::UNORM, Format::RGBA, 8, 8, 8, 8);
+        const Format rgba32f(128, Format::FLOAT32, Format::RGBA, 32, 32, 32, 32);
+
+        if (format == rgba8 && source.format == rgba8)
+        {
+            downsample_surface<u8>(*this, source);
+        }
+        else if (format == rgba32f && source.format == rgba32f)
+        {
+            downsample_surface<float>(*this, source);
+        }
+        else
+        {
+            // other formats are filtered in floating point
+            Bitmap temp(source, rgba32f);
+            Bitmap result(width, height, rgba32f);
+            downsample_surface<float>(result, temp);
+            blit(0, 0, result);
+        }
+    }
+
     void Surface::xflip() const
     {
         if (!image || !stride)
@@ -505,4 +587,13 @@ namespace mango::image
         return *this;
     }
 
+    void Bitmap::swap(Bitmap& bitmap)
+    {
+        std::swap(format, bitmap.format);
+        std::swap(image, bitmap.image);
+        std::swap(stride, bitmap.stride);
+        std::swap(width, bitmap.width);
+        std::swap(height, bitmap.height);
+    }
+
 } // namespace mango::image
@@ -0,0 +1,863 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <algorithm>
+#include <memory>
+#include <mango/core/core.hpp>
+#include <mango/import3d/bvh.hpp>
+
+namespace
+{
+    using namespace mango;
+    using namespace mango::math;
+    using namespace mango::import3d;
+
+    constexpr int BinCount = 16;
+    constexpr u32 MaxLeafSize = 8;
+    constexpr int MaxDepth = 64;
+
+    // subtrees smaller than this are not worth a task of their own
+    constexpr u32 MinTaskSize = 4096;
+
+    template <int Width>
+    struct NodeFloat;
+
+    template <>
+    struct NodeFloat<4>
+    {
+        using Type = float32x4;
+    };
+
+    template <>
+    struct NodeFloat<8>
+    {
+        using Type = float32x8;
+    };
+
+    inline float surfaceArea(const Box& box)
+    {
+        const float32x3 size = box.size();
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    // ----------------------------------------------------------------------------
+    // Builder
+    // ----------------------------------------------------------------------------
+
+    struct BuildNode
+    {
+        Box box;
+        std::unique_ptr<BuildNode> child[2];
+        u32 first = 0;
+        u32 count = 0;
+
+        bool isLeaf() const
+        {
+            return !child[0];
+        }
+    };
+
+    struct Builder
+    {
+        struct Deferred
+        {
+            BuildNode* node;
+            u32 first;
+            u32 count;
+            int depth;
+        };
+
+        const std::vector<Box>& bounds;
+        std::vector<float32x3> centroids;
+        std::vector<u32> indices;
+        std::vector<Deferred> deferred;
+        int parallelDepth = 0;
+
+        Builder(const std::vector<Box>& bounds)
+            : bounds(bounds)
+            , centroids(bounds.size())
+            , indices(bounds.size())
+        {
+            const size_t count = bounds.size();
+            constexpr size_t block = 0x10000;
+
+            ConcurrentQueue q;
+
+            for (size_t start = 0; start < count; start += block)
+            {
+                q.enqueue([this, start, count]
+                {
+                    const size_t end = std::min(start + block, count);
+
+                    for (size_t i = start; i < end; ++i)
+                    {
+                        centroids[i] = this->bounds[i].center();
+                        indices[i] = u32(i);
+                    }
+                });
+            }
+
+            q.wait();
+
+            // split the top levels until there are a few subtrees for every thread
+            for (int threads = ThreadPool::getInstance().size() * 4; threads > 1; threads >>= 1)
+            {
+                ++parallelDepth;
+            }
+        }
+
+        std::unique_ptr<BuildNode> build()
+        {
+            std::unique_ptr<BuildNode> root = std::make_unique<BuildNode>();
+
+            split(root.get(), 0, u32(indices.size()), 0, true);
+
+            ConcurrentQueue q;
+
+            for (const Deferred& task : deferred)
+            {
+                q.enqueue([this, task]
+                {
+                    split(task.node, task.first, task.count, task.depth, false);
+                });
+            }
+
+            q.wait();
+
+            return root;
+        }
+
+        void split(BuildNode* node, u32 first, u32 count, int depth, bool top)
+        {
+            if (top && depth >= parallelDepth && count >= MinTaskSize)
+            {
+                deferred.push_back({ node, first, count, depth });
+                return;
+            }
+
+            u32* range = indices.data() + first;
+
+            Box centroidBox;
+
+            for (u32 i = 0; i < count; ++i)
+            {
+                node->box.extend(bounds[range[i]]);
+                centroidBox.extend(centroids[range[i]]);
+            }
+
+            node->first = first;
+            node->count = count;
+
+            if (count <= 1 || depth >= MaxDepth)
+            {
+                return;
+            }
+
+            // binned surface area heuristic
+            const float32x3 extent = centroidBox.size();
+            const float32x3 origin = centroidBox.corner[0];
+
+            struct Bin
+            {
+                Box box;
+                u32 count = 0;
+            };
+
+            Bin bins[3][BinCount];
+            float scale[3];
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                scale[axis] = extent[axis] > 0.0f ? BinCount * 0.99999f / extent[axis] : 0.0f;
+            }
+
+            auto binIndex = [&] (const float32x3& centroid, int axis)
+            {
+                int index = int((centroid[axis] - origin[axis]) * scale[axis]);
+                return std::min(index, BinCount - 1);
+            };
+
+            for (u32 i = 0; i < count; ++i)
+            {
+                const float32x3 centroid = centroids[range[i]];
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    Bin& bin = bins[axis][binIndex(centroid, axis)];
+                    bin.box.extend(bounds[range[i]]);
+                    ++bin.count;
+                }
+            }
+
+            float bestCost = std::numeric_limits<float>::max();
+            int bestAxis = -1;
+            int bestSplit = 0;
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (scale[axis] == 0.0f)
+                {
+                    continue;
+                }
+
+                // area * count of the bins right of each split
+                float rightCost[BinCount];
+                Box box;
+                u32 n = 0;
+
+                for (int i = BinCount - 1; i > 0; --i)
+                {
+                    const Bin& bin = bins[axis][i];
+                    if (bin.count)
+                    {
+                        box.extend(bin.box);
+                        n += bin.count;
+                    }
+
+                    rightCost[i] = n ? surfaceArea(box) * n : 0.0f;
+                }
+
+                box = Box();
+                n = 0;
+
+                for (int i = 1; i < BinCount; ++i)
+                {
+                    const Bin& bin = bins[axis][i - 1];
+                    if (bin.count)
+                    {
+                        box.extend(bin.box);
+                        n += bin.count;
+                    }
+
+                    if (!n || n == count)
+                    {
+                        continue;
+                    }
+
+                    const float cost = surfaceArea(box) * n + rightCost[i];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = i;
+                    }
+                }
+            }
+
+            u32 middle = 0;
+
+            if (bestAxis >= 0)
+            {
+                // traversal step is cheaper than testing one primitive
+                const float area = surfaceArea(node->box);
+                const float leafCost = float(count);
+                const float splitCost = 0.5f + (area > 0.0f ? bestCost / area : float(count));
+
+                if (leafCost <= splitCost && count <= MaxLeafSize)
+                {
+                    return;
+                }
+
+                u32* middlePtr = std::partition(range, range + count, [&] (u32 index)
+                {
+                    return binIndex(centroids[index], bestAxis) < bestSplit;
+                });
+
+                middle = u32(middlePtr - range);
+            }
+            else
+            {
+                // all centroids are in the same point
+                if (count <= MaxLeafSize)
+                {
+                    return;
+                }
+
+                middle = count / 2;
+            }
+
+            node->child[0] = std::make_unique<BuildNode>();
+            node->child[1] = std::make_unique<BuildNode>();
+
+            split(node->child[0].get(), first, middle, depth + 1, top);
+            split(node->child[1].get(), first + middle, count - middle, depth + 1, top);
+        }
+    };
+
+    // ----------------------------------------------------------------------------
+    // packet traversal
+    // ----------------------------------------------------------------------------
+
+    struct PacketState
+    {
+        float32x8 t;
+        float distance[8];
+        float v[8];
+        float w[8];
+        u32 primitive[8];
+    };
+
+    inline u32 intersectNode(float32x8& distance, const RayPacket& packet, const float32x3& corner0, const float32x3& corner1)
+    {
+        const float32x8 x0 = (float32x8(corner0.x) - packet.ox) * packet.ix;
+        const float32x8 x1 = (float32x8(corner1.x) - packet.ox) * packet.ix;
+        const float32x8 y0 = (float32x8(corner0.y) - packet.oy) * packet.iy;
+        const float32x8 y1 = (float32x8(corner1.y) - packet.oy) * packet.iy;
+        const float32x8 z0 = (float32x8(corner0.z) - packet.oz) * packet.iz;
+        const float32x8 z1 = (float32x8(corner1.z) - packet.oz) * packet.iz;
+
+        float32x8 tmin = max(max(min(x0, x1), min(y0, y1)), min(z0, z1));
+        float32x8 tmax = min(min(max(x0, x1), max(y0, y1)), max(z0, z1));
+
+        // the boxes of axis aligned triangles are flat so the hit includes tmin == tmax
+        distance = tmin;
+        return maskToInt(tmax >= max(tmin, float32x8(0.0f)));
+    }
+
+    inline u32 intersectTriangle(PacketState& state, const RayPacket& packet, const math::Triangle& triangle, u32 mask)
+    {
+        // Möller-Trumbore with the IntersectBarycentricTwosided rules
+        const float32x3 edge1 = triangle.position[1] - triangle.position[0];
+        const float32x3 edge2 = triangle.position[2] - triangle.position[0];
+
+        const float32x8 e1x(edge1.x), e1y(edge1.y), e1z(edge1.z);
+        const float32x8 e2x(edge2.x), e2y(edge2.y), e2z(edge2.z);
+
+        const float32x8 px = packet.dy * e2z - packet.dz * e2y;
+        const float32x8 py = packet.dz * e2x - packet.dx * e2z;
+        const float32x8 pz = packet.dx * e2y - packet.dy * e2x;
+
+        const float32x8 det = e1x * px + e1y * py + e1z * pz;
+        const float32x8 inv = float32x8(1.0f) / det;
+
+        const float32x8 tx = packet.ox - float32x8(triangle.position[0].x);
+        const float32x8 ty = packet.oy - float32x8(triangle.position[0].y);
+        const float32x8 tz = packet.oz - float32x8(triangle.position[0].z);
+
+        const float32x8 v = (tx * px + ty * py + tz * pz) * inv;
+
+        const float32x8 qx = ty * e1z - tz * e1y;
+        const float32x8 qy = tz * e1x - tx * e1z;
+        const float32x8 qz = tx * e1y - ty * e1x;
+
+        const float32x8 w = (packet.dx * qx + packet.dy * qy + packet.dz * qz) * inv;
+        const float32x8 t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+
+        const float32x8 zero(0.0f);
+
+        mask &= maskToInt(abs(det) >= float32x8(0.000001f));
+        mask &= maskToInt(v >= zero) & maskToInt(w >= zero) & maskToInt(v + w <= float32x8(1.0f));
+        mask &= maskToInt(t > zero) & maskToInt(t < state.t);
+
+        if (mask)
+        {
+            float temp[3][8];
+
+            float32x8::ustore(temp[0], t);
+            float32x8::ustore(temp[1], v);
+            float32x8::ustore(temp[2], w);
+
+            for (u32 bits = mask; bits; bits &= bits - 1)
+            {
+                const int lane = u32_tzcnt(bits);
+                state.distance[lane] = temp[0][lane];
+                state.v[lane] = temp[1][lane];
+                state.w[lane] = temp[2][lane];
+            }
+
+            state.t = float32x8::uload(state.distance);
+        }
+
+        return mask;
+    }
+
+    inline u32 intersectBox(PacketState& state, const RayPacket& packet, const Box& box, u32 mask)
+    {
+        // IntersectSolid rules
+        float32x8 distance;
+        mask &= intersect(distance, packet, box);
+
+        const float32x8 t = max(distance, float32x8(0.0f));
+        mask &= maskToInt(t < state.t);
+
+        if (mask)
+        {
+            float temp[8];
+            float32x8::ustore(temp, t);
+
+            for (u32 bits = mask; bits; bits &= bits - 1)
+            {
+                const int lane = u32_tzcnt(bits);
+                state.distance[lane] = temp[lane];
+                state.v[lane] = 0.0f;
+                state.w[lane] = 0.0f;
+            }
+
+            state.t = float32x8::uload(state.distance);
+        }
+
+        return mask;
+    }
+
+    std::vector<math::Triangle> getTriangles(const IndexedMesh& mesh)
+    {
+        std::vector<math::Triangle> triangles;
+
+        const float32x3* positions = mesh.getPositions();
+
+        for (const Primitive& primitive : mesh.primitives)
+        {
+            if (primitive.type != Primitive::Type::TriangleList)
+            {
+                continue;
+            }
+
+            const u32* indices = mesh.indices.data() + primitive.start;
+
+            for (u32 i = 0; i + 2 < primitive.count; i += 3)
+            {
+                triangles.emplace_back(positions[primitive.base + indices[i + 0]],
+                                       positions[primitive.base + indices[i + 1]],
+                                       positions[primitive.base + indices[i + 2]]);
+            }
+        }
+
+        return triangles;
+    }
+
+    std::vector<Box> getBounds(const std::vector<math::Triangle>& triangles)
+    {
+        std::vector<Box> bounds(triangles.size());
+
+        for (size_t i = 0; i < triangles.size(); ++i)
+        {
+            const math::Triangle& triangle = triangles[i];
+            bounds[i] = Box(triangle.position[0], triangle.position[1]);
+            bounds[i].extend(triangle.position[2]);
+        }
+
+        return bounds;
+    }
+
+    template <typename T>
+    std::vector<T> reorder(const std::vector<T>& source, const std::vector<u32>& indices)
+    {
+        std::vector<T> result(indices.size());
+
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            result[i] = source[indices[i]];
+        }
+
+        return result;
+    }
+
+    template <int Width>
+    struct Collapse
+    {
+        using Node = typename BVH<Width>::Node;
+
+        std::vector<Node>& nodes;
+
+        // merge the binary nodes into wide nodes; the largest inner child is
+        // opened until the node is full
+        u32 emit(const BuildNode* node)
+        {
+            const u32 index = u32(nodes.size());
+            nodes.emplace_back();
+
+            const BuildNode* children[Width];
+            int size = 0;
+
+            if (node->isLeaf())
+            {
+                children[size++] = node;
+            }
+            else
+            {
+                children[size++] = node->child[0].get();
+                children[size++] = node->child[1].get();
+            }
+
+            while (size < Width)
+            {
+                int best = -1;
+                float bestArea = -1.0f;
+
+                for (int i = 0; i < size; ++i)
+                {
+                    if (!children[i]->isLeaf())
+                    {
+                        float area = surfaceArea(children[i]->box);
+                        if (area > bestArea)
+                        {
+                            bestArea = area;
+                            best = i;
+                        }
+                    }
+                }
+
+                if (best < 0)
+                {
+                    break;
+                }
+
+                const BuildNode* temp = children[best];
+                children[best] = temp->child[0].get();
+                children[size++] = temp->child[1].get();
+            }
+
+            Node result;
+
+            constexpr float s = std::numeric_limits<float>::infinity();
+
+            for (int i = 0; i < Width; ++i)
+            {
+                // empty slots are never intersected
+                result.minx[i] = s;
+                result.miny[i] = s;
+                result.minz[i] = s;
+                result.maxx[i] = -s;
+                result.maxy[i] = -s;
+                result.maxz[i] = -s;
+                result.child[i] = 0;
+                result.count[i] = 0;
+            }
+
+            for (int i = 0; i < size; ++i)
+            {
+                const BuildNode* child = children[i];
+
+                result.minx[i] = child->box.corner[0].x;
+                result.miny[i] = child->box.corner[0].y;
+                result.minz[i] = child->box.corner[0].z;
+                result.maxx[i] = child->box.corner[1].x;
+                result.maxy[i] = child->box.corner[1].y;
+                result.maxz[i] = child->box.corner[1].z;
+
+                if (child->isLeaf())
+                {
+                    result.child[i] = child->first;
+                    result.count[i] = child->count;
+                }
+                else
+                {
+                    result.child[i] = emit(child);
+                }
+            }
+
+            result.size = u32(size);
+            nodes[index] = result;
+
+            return index;
+        }
+    };
+
+} // namespace
+
+namespace mango::import3d
+{
+
+    template <int Width>
+    BVH<Width>::BVH(const std::vector<math::Triangle>& triangles)
+    {
+        build(getBounds(triangles));
+        m_triangles = reorder(triangles, m_indices);
+    }
+
+    template <int Width>
+    BVH<Width>::BVH(const std::vector<Box>& boxes)
+    {
+        build(boxes);
+        m_boxes = reorder(boxes, m_indices);
+    }
+
+    template <int Width>
+    BVH<Width>::BVH(const IndexedMesh& mesh)
+        : BVH(getTriangles(mesh))
+    {
+    }
+
+    template <int Width>
+    BVH<Width>::~BVH()
+    {
+    }
+
+    template <int Width>
+    void BVH<Width>::build(const std::vector<Box>& bounds)
+    {
+        if (bounds.empty())
+        {
+            return;
+        }
+
+        if (bounds.size() >= 0xffffffff)
+        {
+            MANGO_EXCEPTION("[BVH] Too many primitives: {}.", bounds.size());
+        }
+
+        Builder builder(bounds);
+        std::unique_ptr<BuildNode> root = builder.build();
+
+        m_indices = std::move(builder.indices);
+
+        Collapse<Width> collapse { m_nodes };
+        collapse.emit(root.get());
+    }
+
+    template <int Width>
+    size_t BVH<Width>::getNodeCount() const
+    {
+        return m_nodes.size();
+    }
+
+    template <int Width>
+    size_t BVH<Width>::getPrimitiveCount() const
+    {
+        return m_indices.size();
+    }
+
+    template <int Width>
+    bool BVH<Width>::intersect(Hit& hit, const Ray& ray) const
+    {
+        if (m_nodes.empty())
+        {
+            return false;
+        }
+
+        using FloatN = typename NodeFloat<Width>::Type;
+
+        const FastRay fast(ray);
+
+        // the slab planes the ray enters and exits through
+        float (Node::*nearx)[Width] = fast.sign.x ? &Node::maxx : &Node::minx;
+        float (Node::*neary)[Width] = fast.sign.y ? &Node::maxy : &Node::miny;
+        float (Node::*nearz)[Width] = fast.sign.z ? &Node::maxz : &Node::minz;
+        float (Node::*farx)[Width] = fast.sign.x ? &Node::minx : &Node::maxx;
+        float (Node::*fary)[Width] = fast.sign.y ? &Node::miny : &Node::maxy;
+        float (Node::*farz)[Width] = fast.sign.z ? &Node::minz : &Node::maxz;
+
+        const FloatN ox(fast.origin.x);
+        const FloatN oy(fast.origin.y);
+        const FloatN oz(fast.origin.z);
+        const FloatN ix(fast.invdir.x);
+        const FloatN iy(fast.invdir.y);
+        const FloatN iz(fast.invdir.z);
+        const FloatN zero(0.0f);
+
+        struct Entry
+        {
+            u32 child;
+            u32 count;
+            float distance;
+        };
+
+        Entry stack[(MaxDepth + 1) * Width];
+        int sp = 0;
+
+        stack[sp++] = { 0, 0, 0.0f };
+
+        bool found = false;
+
+        while (sp > 0)
+        {
+            const Entry entry = stack[--sp];
+
+            if (entry.distance >= hit.t0)
+            {
+                continue;
+            }
+
+            if (entry.count)
+            {
+                for (u32 i = entry.child; i < entry.child + entry.count; ++i)
+                {
+                    if (!m_triangles.empty())
+                    {
+                        IntersectBarycentricTwosided is;
+                        if (is.intersect(ray, m_triangles[i]) && is.t0 > 0.0f && is.t0 < hit.t0)
+                        {
+                            hit.t0 = is.t0;
+                            hit.u = is.u;
+                            hit.v = is.v;
+                            hit.w = is.w;
+                            hit.primitive = m_indices[i];
+                            found = true;
+                        }
+                    }
+                    else
+                    {
+                        IntersectSolid is;
+                        if (is.intersect(fast, m_boxes[i]) && is.t0 < hit.t0)
+                        {
+                            hit.t0 = is.t0;
+                            hit.u = 0.0f;
+                            hit.v = 0.0f;
+                            hit.w = 0.0f;
+                            hit.primitive = m_indices[i];
+                            found = true;
+                        }
+                    }
+                }
+
+                continue;
+            }
+
+            const Node& node = m_nodes[entry.child];
+
+            FloatN tmin = (FloatN::uload(node.*nearx) - ox) * ix;
+            FloatN tmax = (FloatN::uload(node.*farx) - ox) * ix;
+            tmin = max(tmin, (FloatN::uload(node.*neary) - oy) * iy);
+            tmax = min(tmax, (FloatN::uload(node.*fary) - oy) * iy);
+            tmin = max(tmin, (FloatN::uload(node.*nearz) - oz) * iz);
+            tmax = min(tmax, (FloatN::uload(node.*farz) - oz) * iz);
+
+            u32 mask = maskToInt(tmax >= max(tmin, zero)) & maskToInt(tmin < FloatN(hit.t0));
+            mask &= (1u << node.size) - 1;
+
+            if (!mask)
+            {
+                continue;
+            }
+
+            float distance[Width];
+            FloatN::ustore(distance, tmin);
+
+            // sort the children so that the closest is on the top of the stack
+            const int bottom = sp;
+
+            for ( ; mask; mask &= mask - 1)
+            {
+                const int i = u32_tzcnt(mask);
+                const Entry child = { node.child[i], node.count[i], distance[i] };
+
+                int j = sp++;
+
+                for ( ; j > bottom && stack[j - 1].distance < child.distance; --j)
+                {
+                    stack[j] = stack[j - 1];
+                }
+
+                stack[j] = child;
+            }
+        }
+
+        return found;
+    }
+
+    template <int Width>
+    u32 BVH<Width>::intersect(Hit hit[8], const RayPacket& packet) const
+    {
+        if (m_nodes.empty() || !packet.mask)
+        {
+            return 0;
+        }
+
+        PacketState state;
+
+        for (int i = 0; i < 8; ++i)
+        {
+            state.distance[i] = (packet.mask >> i) & 1 ? hit[i].t0 : 0.0f;
+            state.primitive[i] = 0;
+        }
+
+        state.t = float32x8::uload(state.distance);
+
+        struct Entry
+        {
+            u32 child;
+            u32 count;
+            u32 mask;
+            float distance;
+        };
+
+        Entry stack[(MaxDepth + 1) * Width];
+        int sp = 0;
+
+        stack[sp++] = { 0, 0, packet.mask, 0.0f };
+
+        u32 found = 0;
+
+        while (sp > 0)
+        {
+            const Entry entry = stack[--sp];
+
+            if (entry.count)
+            {
+                for (u32 i = entry.child; i < entry.child + entry.count; ++i)
+                {
+                    u32 mask = !m_triangles.empty() ?
+                        intersectTriangle(state, packet, m_triangles[i], entry.mask) :
+                        intersectBox(state, packet, m_boxes[i], entry.mask);
+
+                    for (u32 bits = mask; bits; bits &= bits - 1)
+                    {
+                        state.primitive[u32_tzcnt(bits)] = m_indices[i];
+                    }
+
+                    found |= mask;
+                }
+
+                continue;
+            }
+
+            const Node& node = m_nodes[entry.child];
+            const int bottom = sp;
+
+            for (u32 i = 0; i < node.size; ++i)
+            {
+                const float32x3 corner0(node.minx[i], node.miny[i], node.minz[i]);
+                const float32x3 corner1(node.maxx[i], node.maxy[i], node.maxz[i]);
+
+                float32x8 distance;
+                u32 mask = intersectNode(distance, packet, corner0, corner1);
+
+                mask &= maskToInt(distance < state.t) & entry.mask;
+                if (!mask)
+                {
+                    continue;
+                }
+
+                // order by the closest active ray
+                float temp[8];
+                float32x8::ustore(temp, distance);
+
+                float closest = std::numeric_limits<float>::infinity();
+
+                for (u32 bits = mask; bits; bits &= bits - 1)
+                {
+                    closest = std::min(closest, temp[u32_tzcnt(bits)]);
+                }
+
+                const Entry child = { node.child[i], node.count[i], mask, closest };
+
+                int j = sp++;
+
+                for ( ; j > bottom && stack[j - 1].distance < child.distance; --j)
+                {
+                    stack[j] = stack[j - 1];
+                }
+
+                stack[j] = child;
+            }
+        }
+
+        for (u32 bits = found; bits; bits &= bits - 1)
+        {
+            const int lane = u32_tzcnt(bits);
+
+            hit[lane].t0 = state.distance[lane];
+            hit[lane].v = state.v[lane];
+            hit[lane].w = state.w[lane];
+            hit[lane].u = m_triangles.empty() ? 0.0f : 1.0f - (state.v[lane] + state.w[lane]);
+            hit[lane].primitive = state.primitive[lane];
+        }
+
+        return found;
+    }
+
+    template class BVH<4>;
+    template class BVH<8>;
+
+} // namespace mango::import3d
@@ -1029,11 +1029,13 @@ namespace
 namespace mango::import3d
 {
 
-    Import3DS::Import3DS(const filesystem::Path& path, const std::string& filename)
+    Import3DS::Import3DS(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout)
     {
         filesystem::File file(path, filename);
         Reader3DS reader(file);
 
+        TextureLoader loader;
+
         for (auto& material3ds : reader.materials)
         {
             Material material;
@@ -1043,8 +1045,8 @@ namespace mango::import3d
             material.baseColorFactor = material3ds.diffuse;
             material.twosided = material3ds.twosided;
 
-            material.baseColorTexture = createTexture(path, material3ds.texture_map1.filename);
-            material.emissiveTexture = createTexture(path, material3ds.texture_self_illum.filename);
+            material.baseColorTexture = loader.load(path, material3ds.texture_map1.filename);
+            material.emissiveTexture = loader.load(path, material3ds.texture_self_illum.filename);
 
             materials.push_back(material);
         }
@@ -1121,7 +1123,7 @@ namespace mango::import3d
 
             // process material lists
 
-            std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>();
+            std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>(layout);
             IndexedMesh& mesh = *ptr;
 
             for (const auto& primitive3ds : mesh3ds.primitives)
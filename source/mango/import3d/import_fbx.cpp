@@ -2,6 +2,7 @@
     MANGO Multimedia Development Platform
     Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
 */
+#include <atomic>
 #include <variant>
 #include <mango/core/core.hpp>
 #include <mango/import3d/import_fbx.hpp>
@@ -29,6 +30,27 @@ namespace
         IndexToDirect,
     };
 
+    // Array property which is decoded in the second pass. The first pass
+    // only records where the elements are so that the arrays which are not
+    // used are never decompressed.
+    struct PropertyArray
+    {
+        char type = 0;      // 'f', 'd', 'l', 'i' or 'b'
+        u32 length = 0;     // number of elements
+        u32 encoding = 0;   // 0: raw, 1: zlib
+        ConstMemory memory; // raw or compressed elements
+
+        bool isFloat() const
+        {
+            return type == 'f' || type == 'd';
+        }
+
+        bool isInteger() const
+        {
+            return type == 'i';
+        }
+    };
+
     template <typename T>
     struct ArrayFBX
     {
@@ -36,6 +58,9 @@ namespace
         std::vector<u32> indices;
         MappingInformationType mappingType { ByPolygonVertex };
         ReferenceInformationType referenceType { Direct };
+
+        PropertyArray valueArray;
+        PropertyArray indexArray;
     };
 
     struct MeshFBX
@@ -55,10 +80,7 @@ namespace
             U32,
             U64,
             F32,
-            ARRAY_U8,
-            ARRAY_U32,
-            ARRAY_U64,
-            ARRAY_F32,
+            ARRAY,
             STRING,
             MEMORY,
         };
@@ -70,10 +92,7 @@ namespace
             u32,
             u64,
             float32,
-            std::vector<u8>,
-            std::vector<u32>,
-            std::vector<u64>,
-            std::vector<float32>,
+            PropertyArray,
             std::string_view,
             ConstMemory>;
 
@@ -81,6 +100,80 @@ namespace
         Variant value;
     };
 
+    template <typename D, typename S>
+    bool decode_array(D* output, size_t count, const PropertyArray& array)
+    {
+        const size_t bytes = size_t(array.length) * sizeof(S);
+
+        if constexpr (std::is_same<D, S>::value)
+        {
+            if (array.encoding && count == array.length)
+            {
+                // inflate directly into the preallocated storage
+                CompressionStatus status = deflate_zlib::decompress(Memory(reinterpret_cast<u8*>(output), bytes), array.memory);
+                if (!status || status.size != bytes)
+                {
+                    return false;
+                }
+
+#if !defined(MANGO_LITTLE_ENDIAN)
+                for (size_t i = 0; i < count; ++i)
+                {
+                    output[i] = byteswap(output[i]);
+                }
+#endif
+                return true;
+            }
+        }
+
+        const u8* p = array.memory.address;
+        Buffer buffer;
+
+        if (array.encoding)
+        {
+            buffer.resize(bytes);
+            CompressionStatus status = deflate_zlib::decompress(buffer, array.memory);
+            if (!status || status.size != bytes)
+            {
+                return false;
+            }
+
+            p = buffer;
+        }
+        else if (array.memory.size < bytes)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            S value;
+            std::memcpy(&value, p, sizeof(S));
+            p += sizeof(S);
+#if !defined(MANGO_LITTLE_ENDIAN)
+            value = byteswap(value);
+#endif
+            output[i] = D(value);
+        }
+
+        return true;
+    }
+
+    bool decode_array(float* output, size_t count, const PropertyArray& array)
+    {
+        if (array.type == 'd')
+        {
+            return decode_array<float, double>(output, count, array);
+        }
+
+        return decode_array<float, float>(output, count, array);
+    }
+
+    bool decode_array(u32* output, size_t count, const PropertyArray& array)
+    {
+        return decode_array<u32, u32>(output, count, array);
+    }
+
     struct ReaderFBX
     {
         ConstMemory m_memory;
@@ -114,55 +207,95 @@ namespace
 
             const u8* end = memory.address + memory.size;
 
+            // first pass: index the nodes and the array properties
             while (p && p < end)
             {
                 p = read_node(p, 0);
             }
+
+            // second pass: decode the arrays in parallel
+            decode_arrays();
         }
 
         ~ReaderFBX()
         {
         }
 
-        template <typename D, typename S>
-        void read_values(std::vector<D>& output, const u8* p, u32 count)
+        void decode_arrays()
         {
-            while (count-- > 0)
+            ConcurrentQueue q;
+            std::atomic<bool> failed { false };
+
+            auto enqueue = [&] (auto* output, size_t count, const PropertyArray& array)
             {
-                S value;
-                std::memcpy(&value, p, sizeof(S));
-                p += sizeof(S);
-#if !defined(MANGO_LITTLE_ENDIAN)
-                value = byteswap(value);
-#endif
-                output.push_back(D(value));
+                if (!count)
+                {
+                    return;
+                }
+
+                q.enqueue([output, count, &array, &failed]
+                {
+                    if (!decode_array(output, count, array))
+                    {
+                        failed = true;
+                    }
+                });
+            };
+
+            // allocate the storage before any of the arrays is decoded
+            for (MeshFBX& mesh : m_meshes)
+            {
+                mesh.positions.values.resize(mesh.positions.valueArray.length / 3);
+                mesh.positions.indices.resize(mesh.positions.indexArray.length);
+                mesh.normals.values.resize(mesh.normals.valueArray.length / 3);
+                mesh.texcoords.values.resize(mesh.texcoords.valueArray.length / 2);
+                mesh.texcoords.indices.resize(mesh.texcoords.indexArray.length);
+            }
+
+            for (MeshFBX& mesh : m_meshes)
+            {
+                enqueue(reinterpret_cast<float*>(mesh.positions.values.data()), mesh.positions.values.size() * 3, mesh.positions.valueArray);
+                enqueue(mesh.positions.indices.data(), mesh.positions.indices.size(), mesh.positions.indexArray);
+                enqueue(reinterpret_cast<float*>(mesh.normals.values.data()), mesh.normals.values.size() * 3, mesh.normals.valueArray);
+                enqueue(reinterpret_cast<float*>(mesh.texcoords.values.data()), mesh.texcoords.values.size() * 2, mesh.texcoords.valueArray);
+                enqueue(mesh.texcoords.indices.data(), mesh.texcoords.indices.size(), mesh.texcoords.indexArray);
+            }
+
+            q.wait();
+
+            if (failed)
+            {
+                MANGO_EXCEPTION("[ImportFBX] Incorrect array data.");
             }
         }
 
-        template <typename D, typename S>
-        std::vector<D> read_property_array(LittleEndianConstPointer& p)
+        PropertyArray read_property_array(LittleEndianConstPointer& p, char type, size_t size)
         {
-            u32 length = p.read32();
-            u32 encoding = p.read32();
+            PropertyArray array;
+
+            array.type = type;
+            array.length = p.read32();
+            array.encoding = p.read32();
+
             u32 compressed = p.read32();
+            size_t bytes = array.encoding ? compressed : size_t(array.length) * size;
 
-            std::vector<D> output;
+            array.memory = ConstMemory(p, bytes);
+            p += bytes;
 
-            if (encoding)
-            {
-                Buffer buffer(length * sizeof(S));
-                CompressionStatus status = deflate_zlib::decompress(buffer, ConstMemory(p, compressed));
+            return array;
+        }
 
-                read_values<D, S>(output, buffer, length);
-                p += compressed;
-            }
-            else
-            {
-                read_values<D, S>(output, p, length);
-                p += length * sizeof(S);
-            }
+        static bool isFloatArray(const std::vector<Property>& properties)
+        {
+            return !properties.empty() && std::holds_alternative<PropertyArray>(properties[0].value) &&
+                std::get<PropertyArray>(properties[0].value).isFloat();
+        }
 
-            return output;
+        static bool isIntegerArray(const std::vector<Property>& properties)
+        {
+            return !properties.empty() && std::holds_alternative<PropertyArray>(properties[0].value) &&
+                std::get<PropertyArray>(properties[0].value).isInteger();
         }
 
         const u8* read_node(LittleEndianConstPointer p, int level)
@@ -279,41 +412,41 @@ namespace
 
                     case 'f':
                     {
-                        auto value = read_property_array<float, float>(p);
+                        auto value = read_property_array(p, type, 4);
                         property.value = value;
-                        printLine(Print::Verbose, level * 2 + 2, "f32[{}]", value.size());
+                        printLine(Print::Verbose, level * 2 + 2, "f32[{}]", value.length);
                         break;
                     }
 
                     case 'd':
                     {
-                        auto value = read_property_array<float, double>(p);
+                        auto value = read_property_array(p, type, 8);
                         property.value = value;
-                        printLine(Print::Verbose, level * 2 + 2, "f64[{}]", value.size());
+                        printLine(Print::Verbose, level * 2 + 2, "f64[{}]", value.length);
                         break;
                     }
 
                     case 'l':
                     {
-                        auto value = read_property_array<u64, u64>(p);
+                        auto value = read_property_array(p, type, 8);
                         property.value = value;
-                        printLine(Print::Verbose, level * 2 + 2, "u64[{}]", value.size());
+                        printLine(Print::Verbose, level * 2 + 2, "u64[{}]", value.length);
                         break;
                     }
 
                     case 'i':
                     {
-                        auto value = read_property_array<u32, u32>(p);
+                        auto value = read_property_array(p, type, 4);
                         property.value = value;
-                        printLine(Print::Verbose, level * 2 + 2, "u32[{}]", value.size());
+                        printLine(Print::Verbose, level * 2 + 2, "u32[{}]", value.length);
                         break;
                     }
 
                     case 'b':
                     {
-                        auto value = read_property_array<u8, u8>(p);
+                        auto value = read_property_array(p, type, 1);
                         property.value = value;
-                        printLine(Print::Verbose, level * 2 + 2, "u8[{}]", value.size());
+                        printLine(Print::Verbose, level * 2 + 2, "u8[{}]", value.length);
                         break;
                     }
 
@@ -397,47 +530,27 @@ namespace
 
                 if (name == "Vertices")
                 {
-                    if (std::holds_alternative<std::vector<float32>>(properties[0].value))
+                    if (isFloatArray(properties))
                     {
-                        auto vec = std::get<std::vector<float32>>(properties[0].value);
-
-                        for (size_t i = 0; i < vec.size() - 2; i += 3)
-                        {
-                            // TODO: coordinate system conversion
-                            float x = vec[i + 0];
-                            float y = vec[i + 1];
-                            float z = vec[i + 2];
-                            float32x3 position(x, y, z);
-                            mesh.positions.values.push_back(position);
-                        }
+                        // TODO: coordinate system conversion
+                        mesh.positions.valueArray = std::get<PropertyArray>(properties[0].value);
                     }
                 }
                 else if (name == "PolygonVertexIndex")
                 {
-                    if (std::holds_alternative<std::vector<u32>>(properties[0].value))
+                    if (isIntegerArray(properties))
                     {
-                        auto vec = std::get<std::vector<u32>>(properties[0].value);
-                        mesh.positions.indices = vec;
+                        mesh.positions.indexArray = std::get<PropertyArray>(properties[0].value);
                     }
                 }
                 else if (name == "Normals")
                 {
-                    if (std::holds_alternative<std::vector<float32>>(properties[0].value))
+                    if (isFloatArray(properties))
                     {
-                        auto vec = std::get<std::vector<float32>>(properties[0].value);
-
+                        // TODO: coordinate system conversion
                         mesh.normals.mappingType = currentMappingType;
                         mesh.normals.referenceType = currentReferenceType;
-
-                        for (size_t i = 0; i < vec.size() - 2; i += 3)
-                        {
-                            // TODO: coordinate system conversion
-                            float x = vec[i + 0];
-                            float y = vec[i + 1];
-                            float z = vec[i + 2];
-                            float32x3 normal(x, y, z);
-                            mesh.normals.values.push_back(normal);
-                        }
+                        mesh.normals.valueArray = std::get<PropertyArray>(properties[0].value);
                     }
                 }
                 else if (name == "NormalsW")
@@ -446,28 +559,18 @@ namespace
                 }
                 else if (name == "UV")
                 {
-                    if (std::holds_alternative<std::vector<float32>>(properties[0].value))
+                    if (isFloatArray(properties))
                     {
-                        auto vec = std::get<std::vector<float32>>(properties[0].value);
-
                         mesh.texcoords.mappingType = currentMappingType;
                         mesh.texcoords.referenceType = currentReferenceType;
-
-                        for (size_t i = 0; i < vec.size() - 1; i += 2)
-                        {
-                            float x = vec[i + 0];
-                            float y = vec[i + 1];
-                            float32x2 texcoord(x, y);
-                            mesh.texcoords.values.push_back(texcoord);
-                        }
+                        mesh.texcoords.valueArray = std::get<PropertyArray>(properties[0].value);
                     }
                 }
                 else if (name == "UVIndex")
                 {
-                    if (std::holds_alternative<std::vector<u32>>(properties[0].value))
+                    if (isIntegerArray(properties))
                     {
-                        auto vec = std::get<std::vector<u32>>(properties[0].value);
-                        mesh.texcoords.indices = vec;
+                        mesh.texcoords.indexArray = std::get<PropertyArray>(properties[0].value);
                     }
                 }
                 else if (name == "Smoothing")
@@ -490,7 +593,7 @@ namespace
 namespace mango::import3d
 {
 
-    ImportFBX::ImportFBX(const filesystem::Path& path, const std::string& filename)
+    ImportFBX::ImportFBX(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout)
     {
         filesystem::File file(path, filename);
         ReaderFBX reader(file);
@@ -498,7 +601,7 @@ namespace mango::import3d
         Material material;
         materials.push_back(material);
 
-        std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>();
+        std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>(layout);
         IndexedMesh& mesh = *ptr;
 
         for (const auto& current : reader.m_meshes)
@@ -17,6 +17,7 @@
 namespace
 {
     using namespace mango;
+    using namespace mango::import3d;
 
     struct Attribute
     {
@@ -25,19 +26,110 @@ namespace
         size_t stride = 0;
         size_t components;
         fastgltf::ComponentType type;
+        bool normalized = false;
 
         operator bool () const
         {
             return data != nullptr;
         }
+
+        bool isSNorm16() const
+        {
+            return type == fastgltf::ComponentType::Short && normalized;
+        }
+
+        bool isUNorm8() const
+        {
+            return type == fastgltf::ComponentType::UnsignedByte && normalized;
+        }
     };
 
+    template <typename T, typename Func>
+    void readComponents(const Attribute& attribute, float32x4 defaults, Func func)
+    {
+        // KHR_mesh_quantization: the normalized integers are mapped to [-1, 1] or [0, 1]
+        float scale = 1.0f;
+        float low = -std::numeric_limits<float>::max();
+
+        if constexpr (std::is_integral_v<T>)
+        {
+            if (attribute.normalized)
+            {
+                scale = 1.0f / float(std::numeric_limits<T>::max());
+                low = std::is_signed_v<T> ? -1.0f : 0.0f;
+            }
+        }
+
+        const size_t components = std::min(attribute.components, size_t(4));
+        const u8* data = attribute.data;
+
+        for (size_t i = 0; i < attribute.count; ++i)
+        {
+            float temp[4] = { defaults.x, defaults.y, defaults.z, defaults.w };
+
+            for (size_t j = 0; j < components; ++j)
+            {
+                T value;
+                std::memcpy(&value, data + j * sizeof(T), sizeof(T));
+                temp[j] = std::max(float(value) * scale, low);
+            }
+
+            func(i, float32x4(temp[0], temp[1], temp[2], temp[3]));
+            data += attribute.stride;
+        }
+    }
+
+    // call func(index, value) for every element of the attribute
+    template <typename Func>
+    void readAttribute(const Attribute& attribute, float32x4 defaults, Func func)
+    {
+        switch (attribute.type)
+        {
+            case fastgltf::ComponentType::Byte:
+                readComponents<s8>(attribute, defaults, func);
+                break;
+            case fastgltf::ComponentType::UnsignedByte:
+                readComponents<u8>(attribute, defaults, func);
+                break;
+            case fastgltf::ComponentType::Short:
+                readComponents<s16>(attribute, defaults, func);
+                break;
+            case fastgltf::ComponentType::UnsignedShort:
+                readComponents<u16>(attribute, defaults, func);
+                break;
+            case fastgltf::ComponentType::Float:
+                readComponents<float>(attribute, defaults, func);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // copy snorm16 vectors into a SNorm16x4 stream without conversion
+    void copySNorm16(VertexStream& stream, size_t base, const Attribute& attribute)
+    {
+        const size_t components = std::min(attribute.components, size_t(4));
+        const u8* data = attribute.data;
+
+        for (size_t i = 0; i < attribute.count; ++i)
+        {
+            s16 temp[4] = { 0, 0, 0, 0 };
+            std::memcpy(temp, data, components * 2);
+
+            // coordinate system conversion; -32768 and -32767 are both -1.0
+            temp[2] = s16(-std::max(temp[2], s16(-32767)));
+
+            std::memcpy(stream.data.data() + (base + i) * stream.stride, temp, 8);
+            data += attribute.stride;
+        }
+    }
+
 } // namespace
 
 namespace mango::import3d
 {
 
-ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename)
+ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout)
 {
     u64 time0 = Time::ms();
 
@@ -125,10 +217,17 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
 
         std::visit(fastgltf::visitor
         {
-            [] (const auto& arg)
+            [&] (const auto& arg)
             {
+                buffers.push_back(ConstMemory());
                 printLine(Print::Verbose, "  Unknown");
             },
+            [&] (const fastgltf::sources::Fallback& source)
+            {
+                // EXT_meshopt_compression fallback buffer without data
+                buffers.push_back(ConstMemory());
+                printLine(Print::Verbose, "  Fallback");
+            },
             [&] (const fastgltf::sources::URI& source)
             {
                 //std::string filename = path.parent_path() / source.uri.path();
@@ -156,6 +255,8 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             },
             [&] (const fastgltf::sources::BufferView& source)
             {
+                buffers.push_back(ConstMemory());
+
                 // [ ] standard
                 // [ ] binary
                 // [ ] embedded
@@ -183,6 +284,8 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             },
             [&] (const fastgltf::sources::CustomBuffer& source)
             {
+                buffers.push_back(ConstMemory());
+
                 // [ ] standard
                 // [ ] binary
                 // [ ] embedded
@@ -191,10 +294,104 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
         }, current.data);
     }
 
+    // --------------------------------------------------------------------------
+    // buffer views
+    // --------------------------------------------------------------------------
+
+    // EXT_meshopt_compression views are decoded in parallel before the meshes
+    std::vector<std::vector<u8>> decodedViews(asset.bufferViews.size());
+
+    ConcurrentQueue queue;
+
+    for (size_t i = 0; i < asset.bufferViews.size(); ++i)
+    {
+        const auto& view = asset.bufferViews[i];
+
+        if (!view.meshoptCompression)
+        {
+            continue;
+        }
+
+        const fastgltf::CompressedBufferView& compression = *view.meshoptCompression;
+
+        ConstMemory source;
+
+        if (compression.bufferIndex < buffers.size())
+        {
+            ConstMemory buffer = buffers[compression.bufferIndex];
+            if (buffer.address && compression.byteOffset + compression.byteLength <= buffer.size)
+            {
+                source = buffer.slice(compression.byteOffset, compression.byteLength);
+            }
+        }
+
+        if (!source.address)
+        {
+            printLine(Print::Error, "  BufferView {}: compressed data is not available.", i);
+            continue;
+        }
+
+        printLine(Print::Verbose, "[BufferView: meshopt]");
+        printLine(Print::Verbose, "  count: {}, stride: {}, {} bytes", compression.count, compression.byteStride, source.size);
+
+        queue.enqueue([&decodedViews, &compression, source, i]
+        {
+            std::vector<u8> output(compression.count * compression.byteStride);
+
+            try
+            {
+                switch (compression.mode)
+                {
+                    case fastgltf::MeshoptCompressionMode::Attributes:
+                        decodeMeshoptVertices(output.data(), compression.count, compression.byteStride, source);
+                        decodeMeshoptFilter(output.data(), compression.count, compression.byteStride, MeshoptFilter(compression.filter));
+                        break;
+
+                    case fastgltf::MeshoptCompressionMode::Triangles:
+                        decodeMeshoptTriangles(output.data(), compression.count, compression.byteStride, source);
+                        break;
+
+                    case fastgltf::MeshoptCompressionMode::Indices:
+                        decodeMeshoptIndices(output.data(), compression.count, compression.byteStride, source);
+                        break;
+                }
+            }
+            catch (const Exception& e)
+            {
+                printLine(Print::Error, "  BufferView {}: {}", i, e.what());
+                return;
+            }
+
+            decodedViews[i] = std::move(output);
+        });
+    }
+
+    queue.wait();
+
+    // resolve the data of a view; nullptr when it is not available
+    auto getViewData = [&] (size_t index) -> const u8*
+    {
+        const auto& view = asset.bufferViews[index];
+
+        if (view.meshoptCompression)
+        {
+            return decodedViews[index].empty() ? nullptr : decodedViews[index].data();
+        }
+
+        if (view.bufferIndex >= buffers.size() || !buffers[view.bufferIndex].address)
+        {
+            return nullptr;
+        }
+
+        return buffers[view.bufferIndex].address + view.byteOffset;
+    };
+
     // --------------------------------------------------------------------------
     // images
     // --------------------------------------------------------------------------
 
+    // the images are decoded in the background while the meshes are converted
+    TextureLoader loader;
     std::vector<Texture> textures;
 
     for (const auto& current : asset.images)
@@ -210,22 +407,19 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             {
                 const std::string filename(source.uri.path().begin(), source.uri.path().end());
 
-                auto file = std::make_unique<filesystem::File>(path, filename);
-                ConstMemory memory = *file;
-
-                Texture texture = createTexture(path, filename);
+                Texture texture = loader.load(path, filename);
                 textures.push_back(texture);
 
                 // [x] standard
                 // [ ] binary
                 // [ ] embedded
-                printLine(Print::Verbose, "  URI: \"{}\" {} bytes", filename, memory.size);
+                printLine(Print::Verbose, "  URI: \"{}\"", filename);
             },
             [&] (const fastgltf::sources::Array& source)
             {
                 ConstMemory memory(reinterpret_cast<const u8*>(source.bytes.data()), source.bytes.size());
 
-                Texture texture = createTexture(memory);
+                Texture texture = loader.load(memory);
                 textures.push_back(texture);
 
                 // [ ] standard
@@ -237,7 +431,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             {
                 ConstMemory memory(reinterpret_cast<const u8*>(source.bytes.data()), source.bytes.size());
 
-                Texture texture = createTexture(memory);
+                Texture texture = loader.load(memory);
                 textures.push_back(texture);
 
                 // [ ] standard
@@ -273,7 +467,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
 
                 if (memory.address)
                 {
-                    Texture texture = createTexture(memory);
+                    Texture texture = loader.load(memory);
                     textures.push_back(texture);
                 }
 
@@ -333,7 +527,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             {
                 Texture image = textures[*texture.imageIndex];
                 material.baseColorTexture = image;
-                printLine(Print::Verbose, "  baseColorTexture: ({} x {})", image->width, image->height);
+                printLine(Print::Verbose, "  baseColorTexture: image {}", *texture.imageIndex);
             }
         }
 
@@ -344,7 +538,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             {
                 Texture image = textures[*texture.imageIndex];
                 material.metallicRoughnessTexture = image;
-                printLine(Print::Verbose, "  metallicRoughnessTexture: ({} x {})", image->width, image->height);
+                printLine(Print::Verbose, "  metallicRoughnessTexture: image {}", *texture.imageIndex);
             }
         }
 
@@ -355,7 +549,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             {
                 Texture image = textures[*texture.imageIndex];
                 material.normalTexture = image;
-                printLine(Print::Verbose, "  normalTexture: ({} x {})", image->width, image->height);
+                printLine(Print::Verbose, "  normalTexture: image {}", *texture.imageIndex);
             }
         }
 
@@ -366,7 +560,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             {
                 Texture image = textures[*texture.imageIndex];
                 material.occlusionTexture = image;
-                printLine(Print::Verbose, "  occlusionTexture: ({} x {})", image->width, image->height);
+                printLine(Print::Verbose, "  occlusionTexture: image {}", *texture.imageIndex);
             }
         }
 
@@ -377,7 +571,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             {
                 Texture image = textures[*texture.imageIndex];
                 material.emissiveTexture = image;
-                printLine(Print::Verbose, "  emissiveTexture: ({} x {})", image->width, image->height);
+                printLine(Print::Verbose, "  emissiveTexture: image {}", *texture.imageIndex);
             }
         }
 
@@ -509,7 +703,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
         printLine(Print::Verbose, "[Mesh]");
         printLine(Print::Verbose, "  name: \"{}\"", current.name);
 
-        std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>();
+        std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>(layout);
         IndexedMesh& mesh = *ptr;
 
         for (auto primitiveIterator = current.primitives.begin(); primitiveIterator != current.primitives.end(); ++primitiveIterator)
@@ -522,37 +716,40 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             Attribute attributeTexcoord;
             Attribute attributeColor;
 
+            u32 flags = 0;
+
             for (auto attributeIterator = primitiveIterator->attributes.begin(); attributeIterator != primitiveIterator->attributes.end(); ++attributeIterator)
             {
                 auto name = attributeIterator->name;
 
                 Attribute* attribute = nullptr;
+                u32 attributeFlag = 0;
                 const char* message = "";
 
                 if (name == "POSITION")
                 {
                     attribute = &attributePosition;
-                    mesh.flags |= Vertex::Position;
+                    attributeFlag = Vertex::Position;
                 }
                 else if (name == "NORMAL")
                 {
                     attribute = &attributeNormal;
-                    mesh.flags |= Vertex::Normal;
+                    attributeFlag = Vertex::Normal;
                 }
                 else if (name == "TANGENT")
                 {
                     attribute = &attributeTangent;
-                    mesh.flags |= Vertex::Tangent;
+                    attributeFlag = Vertex::Tangent;
                 }
                 else if (name == "TEXCOORD_0")
                 {
                     attribute = &attributeTexcoord;
-                    mesh.flags |= Vertex::Texcoord;
+                    attributeFlag = Vertex::Texcoord;
                 }
                 else if (name == "COLOR_0")
                 {
                     attribute = &attributeColor;
-                    mesh.flags |= Vertex::Color;
+                    attributeFlag = Vertex::Color;
                 }
                 else
                 {
@@ -564,8 +761,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
                 auto& accessor = asset.accessors[attributeIterator->accessorIndex];
                 auto& view = asset.bufferViews[accessor.bufferViewIndex.value()];
 
-                auto offset = view.byteOffset + accessor.byteOffset;
-                size_t index = view.bufferIndex;
+                const u8* data = getViewData(accessor.bufferViewIndex.value());
                 size_t count = accessor.count;
 
                 size_t stride;
@@ -573,20 +769,31 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
                 {
                     stride = view.byteStride.value();
                 }
+                else if (view.meshoptCompression)
+                {
+                    stride = view.meshoptCompression->byteStride;
+                }
                 else
                 {
                     stride = fastgltf::getElementByteSize(accessor.type, accessor.componentType);
                 }
 
                 size_t components = fastgltf::getNumComponents(accessor.type);
+                const char* normalized = accessor.normalized ? " normalized" : "";
 
                 switch (accessor.componentType)
                 {
+                    case fastgltf::ComponentType::Byte:
+                        printLine(Print::Verbose, "      type: s8 x {}{}", components, normalized);
+                        break;
                     case fastgltf::ComponentType::UnsignedByte:
-                        printLine(Print::Verbose, "      type: u8 x {}", components);
+                        printLine(Print::Verbose, "      type: u8 x {}{}", components, normalized);
+                        break;
+                    case fastgltf::ComponentType::Short:
+                        printLine(Print::Verbose, "      type: s16 x {}{}", components, normalized);
                         break;
                     case fastgltf::ComponentType::UnsignedShort:
-                        printLine(Print::Verbose, "      type: u16 x {}", components);
+                        printLine(Print::Verbose, "      type: u16 x {}{}", components, normalized);
                         break;
                     case fastgltf::ComponentType::Float:
                         printLine(Print::Verbose, "      type: f32 x {}", components);
@@ -599,131 +806,44 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
                 printLine(Print::Verbose, "      stride: {}", stride);
                 printLine(Print::Verbose, "      count: {}", count);
 
-                if (attribute)
+                if (attribute && data)
                 {
-                    attribute->data = buffers[index].address + offset;
+                    attribute->data = data + accessor.byteOffset;
                     attribute->count = count;
                     attribute->stride = stride;
                     attribute->components = components;
                     attribute->type = accessor.componentType;
+                    attribute->normalized = accessor.normalized;
+
+                    flags |= attributeFlag;
                 }
 
             } // attributeIterator
 
-            // vertices
-
-            std::vector<Vertex> vertices(attributePosition.count);
-
-            if (attributePosition)
-            {
-                const u8* data = attributePosition.data;
-
-                for (size_t i = 0; i < attributePosition.count; ++i)
-                {
-                    float x = uload32f(data + 0);
-                    float y = uload32f(data + 4);
-                    float z = uload32f(data + 8);
-                    float32x3 position(x, y, -z);
-
-                    data += attributePosition.stride;
-
-                    vertices[i].position = position;
-
-                    mesh.boundingBox.extend(position);
-                }
-            }
-            else
+            if (!attributePosition)
             {
                 // position attribute is required
                 continue;
             }
 
-            if (attributeNormal)
-            {
-                if (attributeNormal.count != attributePosition.count)
-                {
-                    // attribute counts must be identical
-                    continue;
-                }
-
-                const u8* data = attributeNormal.data;
-
-                for (size_t i = 0; i < attributeNormal.count; ++i)
-                {
-                    float x = uload32f(data + 0);
-                    float y = uload32f(data + 4);
-                    float z = uload32f(data + 8);
-                    float32x3 normal(x, y, -z);
-
-                    data += attributeNormal.stride;
-
-                    vertices[i].normal = normal;
-                }
-            }
-
-            if (attributeTangent)
+            if ((attributeNormal && attributeNormal.count != attributePosition.count) ||
+                (attributeTangent && attributeTangent.count != attributePosition.count) ||
+                (attributeTexcoord && attributeTexcoord.count != attributePosition.count) ||
+                (attributeColor && attributeColor.count != attributePosition.count))
             {
-                if (attributeTangent.count != attributePosition.count)
-                {
-                    // attribute counts must be identical
-                    continue;
-                }
-
-                const u8* data = attributeTangent.data;
-
-                for (size_t i = 0; i < attributeTangent.count; ++i)
-                {
-                    float x = uload32f(data + 0);
-                    float y = uload32f(data + 4);
-                    float z = uload32f(data + 8);
-                    float w = uload32f(data + 12);
-                    float32x4 tangent(x, y, -z, w);
-
-                    data += attributeTangent.stride;
-
-                    vertices[i].tangent = tangent;
-                }
-            }
-
-            if (attributeTexcoord)
-            {
-                if (attributeTexcoord.count != attributePosition.count)
-                {
-                    // attribute counts must be identical
-                    continue;
-                }
-
-                const u8* data = attributeTexcoord.data;
-
-                for (size_t i = 0; i < attributeTexcoord.count; ++i)
-                {
-                    // TODO: u8, u16
-                    float32x2 texcoord = float32x2::uload(data);
-                    data += attributeTexcoord.stride;
-
-                    vertices[i].texcoord = texcoord;
-                }
+                // attribute counts must be identical
+                continue;
             }
 
-            if (attributeColor)
+            switch (primitiveIterator->type)
             {
-                if (attributeColor.count != attributePosition.count)
-                {
-                    // attribute counts must be identical
+                case fastgltf::PrimitiveType::Triangles:
+                case fastgltf::PrimitiveType::TriangleStrip:
+                case fastgltf::PrimitiveType::TriangleFan:
+                    break;
+                default:
+                    // unsupported primitive type
                     continue;
-                }
-
-                const u8* data = attributeColor.data;
-
-                for (size_t i = 0; i < attributeColor.count; ++i)
-                {
-                    // TODO: 3 and 4 components
-                    // TODO: u8, u16
-                    float32x3 color = float32x3::uload(data);
-                    data += attributeColor.stride;
-
-                    vertices[i].color = float32x4(color, 1.0f);
-                }
             }
 
             // indices
@@ -735,23 +855,20 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
                 auto& indicesAccessor = asset.accessors[primitiveIterator->indicesAccessor.value()];
                 if (indicesAccessor.bufferViewIndex.has_value())
                 {
-                    auto& indicesView = asset.bufferViews[indicesAccessor.bufferViewIndex.value()];
-
-                    size_t offset = indicesView.byteOffset + indicesAccessor.byteOffset;
+                    const u8* data = getViewData(indicesAccessor.bufferViewIndex.value());
                     size_t count = indicesAccessor.count;
 
-                    size_t bufferIndex = indicesView.bufferIndex;
-                    const u8* data = buffers[bufferIndex].address + offset;
-
                     printLine(Print::Verbose, "    [Indices]");
                     printLine(Print::Verbose, "      count: {}", count);
 
-                    if (count < 3)
+                    if (!data || count < 3)
                     {
                         // not enough indices
                         continue;
                     }
 
+                    data += indicesAccessor.byteOffset;
+
                     indices.resize(count);
 
                     switch (indicesAccessor.componentType)
@@ -791,13 +908,127 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
                 }
             }
 
+            // vertices are written directly into the vertex streams
+
+            const size_t base = mesh.getVertexCount();
+            const size_t count = attributePosition.count;
+
+            mesh.addAttributes(flags);
+            mesh.resizeVertices(base + count);
+
+            {
+                float32x3* positions = mesh.getPositions() + base;
+
+                if (attributePosition.type == fastgltf::ComponentType::Float)
+                {
+                    const u8* data = attributePosition.data;
+
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        float x = uload32f(data + 0);
+                        float y = uload32f(data + 4);
+                        float z = uload32f(data + 8);
+                        float32x3 position(x, y, -z);
+
+                        data += attributePosition.stride;
+
+                        positions[i] = position;
+
+                        mesh.boundingBox.extend(position);
+                    }
+                }
+                else
+                {
+                    // quantized positions; the node transform has the dequantization
+                    readAttribute(attributePosition, float32x4(0.0f), [&] (size_t i, float32x4 v)
+                    {
+                        float32x3 position(v.x, v.y, -v.z);
+                        positions[i] = position;
+                        mesh.boundingBox.extend(position);
+                    });
+                }
+            }
+
+            if (attributeNormal)
+            {
+                VertexStream& stream = *mesh.getStream(Vertex::Normal);
+
+                if (stream.format == VertexFormat::SNorm16x4 && attributeNormal.isSNorm16())
+                {
+                    copySNorm16(stream, base, attributeNormal);
+                }
+                else
+                {
+                    readAttribute(attributeNormal, float32x4(0.0f), [&] (size_t i, float32x4 v)
+                    {
+                        stream.write(base + i, float32x3(v.x, v.y, -v.z));
+                    });
+                }
+            }
+
+            if (attributeTangent)
+            {
+                VertexStream& stream = *mesh.getStream(Vertex::Tangent);
+
+                if (stream.format == VertexFormat::SNorm16x4 && attributeTangent.isSNorm16())
+                {
+                    copySNorm16(stream, base, attributeTangent);
+                }
+                else
+                {
+                    readAttribute(attributeTangent, float32x4(0.0f, 0.0f, 0.0f, 1.0f), [&] (size_t i, float32x4 v)
+                    {
+                        stream.write(base + i, float32x4(v.x, v.y, -v.z, v.w));
+                    });
+                }
+            }
+
+            if (attributeTexcoord)
+            {
+                VertexStream& stream = *mesh.getStream(Vertex::Texcoord);
+
+                readAttribute(attributeTexcoord, float32x4(0.0f), [&] (size_t i, float32x4 v)
+                {
+                    stream.write(base + i, float32x2(v.x, v.y));
+                });
+            }
+
+            if (attributeColor)
+            {
+                VertexStream& stream = *mesh.getStream(Vertex::Color);
+
+                if (stream.format == VertexFormat::UNorm8x4 && attributeColor.isUNorm8())
+                {
+                    const u8* data = attributeColor.data;
+                    u8* dest = stream.data.data() + base * stream.stride;
+
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        dest[0] = data[0];
+                        dest[1] = data[1];
+                        dest[2] = data[2];
+                        dest[3] = attributeColor.components == 4 ? data[3] : 0xff;
+
+                        data += attributeColor.stride;
+                        dest += stream.stride;
+                    }
+                }
+                else
+                {
+                    readAttribute(attributeColor, float32x4(1.0f), [&] (size_t i, float32x4 v)
+                    {
+                        stream.write(base + i, v);
+                    });
+                }
+            }
+
             bool needIndices = false;
 
             if (indices.empty())
             {
                 needIndices = true;
 
-                for (size_t i = 0; i < vertices.size(); ++i)
+                for (size_t i = 0; i < attributePosition.count; ++i)
                 {
                     u32 index = u32(i);
                     indices.push_back(index);
@@ -823,7 +1054,12 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
             {
                 Mesh trimesh;
 
-                trimesh.flags = mesh.flags;
+                trimesh.flags = flags;
+
+                auto getVertex = [&] (u32 index)
+                {
+                    return mesh.getVertex(base + index);
+                };
 
                 // TODO: support primitive restart (index: 0xffffffff)
 
@@ -835,9 +1071,9 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
                         {
                             Triangle triangle;
 
-                            triangle.vertex[0] = vertices[indices[i - 0]];
-                            triangle.vertex[1] = vertices[indices[i - 1]];
-                            triangle.vertex[2] = vertices[indices[i - 2]];
+                            triangle.vertex[0] = getVertex(indices[i - 0]);
+                            triangle.vertex[1] = getVertex(indices[i - 1]);
+                            triangle.vertex[2] = getVertex(indices[i - 2]);
 
                             trimesh.triangles.push_back(triangle);
                         }
@@ -846,8 +1082,8 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
 
                     case fastgltf::PrimitiveType::TriangleStrip:
                     {
-                        Vertex v0 = vertices[indices[0]];
-                        Vertex v1 = vertices[indices[1]];
+                        Vertex v0 = getVertex(indices[0]);
+                        Vertex v1 = getVertex(indices[1]);
 
                         for (size_t i = 2; i < indices.size(); ++i)
                         {
@@ -855,7 +1091,7 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
 
                             triangle.vertex[(i + 1) & 1] = v0;
                             triangle.vertex[(i + 0) & 1] = v1;
-                            triangle.vertex[2] = vertices[indices[i]];
+                            triangle.vertex[2] = getVertex(indices[i]);
 
                             trimesh.triangles.push_back(triangle);
 
@@ -869,13 +1105,13 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
                     {
                         Triangle triangle;
 
-                        triangle.vertex[0] = vertices[indices[0]];
-                        triangle.vertex[1] = vertices[indices[1]];
+                        triangle.vertex[0] = getVertex(indices[0]);
+                        triangle.vertex[1] = getVertex(indices[1]);
 
                         for (size_t i = 2; i < indices.size(); ++i)
                         {
                             triangle.vertex[2] = triangle.vertex[1];
-                            triangle.vertex[1] = vertices[indices[i]];
+                            triangle.vertex[1] = getVertex(indices[i]);
 
                             trimesh.triangles.push_back(triangle);
                         }
@@ -887,6 +1123,9 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
                         continue;
                 }
 
+                // the triangles are re-indexed by append()
+                mesh.resizeVertices(base);
+
                 u64 time0 = Time::us();
 
                 if (needTangent)
@@ -985,12 +1224,11 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
 
                 primitive.start = u32(mesh.indices.size());
                 primitive.count = u32(indices.size());
-                primitive.base = u32(mesh.vertices.size());
+                primitive.base = u32(base);
                 primitive.material = u32(materialIndex);
 
                 mesh.primitives.push_back(primitive);
 
-                mesh.vertices.insert(mesh.vertices.end(), vertices.begin(), vertices.end());
                 mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
             }
         }
@@ -1061,6 +1299,8 @@ ImportGLTF::ImportGLTF(const filesystem::Path& path, const std::string& filename
         }
     }
 
+    loader.wait();
+
     // --------------------------------------------------------------------------
     // summary
     // --------------------------------------------------------------------------
@@ -815,15 +815,17 @@ namespace mango::import3d
         }
     };
 
-    void import_LWOB(Scene& scene, const filesystem::Path& path, BigEndianConstPointer p, const u8* end)
+    void import_LWOB(Scene& scene, const filesystem::Path& path, BigEndianConstPointer p, const u8* end, const VertexLayout& layout)
     {
         ReaderLWO reader(p, end);
 
-        std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>();
+        std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>(layout);
         IndexedMesh& mesh = *ptr;
 
         u32 materialIndex = 0;
 
+        TextureLoader loader;
+
         for (const auto& surface : reader.surfaces)
         {
             Material material;
@@ -835,7 +837,7 @@ namespace mango::import3d
                 std::string filename = filesystem::removePath(surface.ctex.name);
                 try
                 {
-                    Texture ctex = createTexture(path, filename);
+                    Texture ctex = loader.load(path, filename);
                     material.baseColorTexture = ctex;
                 }
                 catch(...)
@@ -1724,11 +1726,11 @@ namespace mango::import3d
         */
     };
 
-    void import_LWO2(Scene& scene, const filesystem::Path& path, BigEndianConstPointer p, const u8* end)
+    void import_LWO2(Scene& scene, const filesystem::Path& path, BigEndianConstPointer p, const u8* end, const VertexLayout& layout)
     {
         ReaderLWO2 reader(p, end);
 
-        std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>();
+        std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>(layout);
         IndexedMesh& mesh = *ptr;
 
         Material material;
@@ -1801,7 +1803,7 @@ namespace mango::import3d
     // import
     // --------------------------------------------------------------------------
 
-    ImportLWO::ImportLWO(const filesystem::Path& path, const std::string& filename)
+    ImportLWO::ImportLWO(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout)
     {
         filesystem::File file(path, filename);
         ConstMemory memory = file;
@@ -1825,11 +1827,11 @@ namespace mango::import3d
         switch (id)
         {
             case u32_mask_rev('L', 'W', 'O', 'B'):
-                import_LWOB(*this, path, p, memory.end());
+                import_LWOB(*this, path, p, memory.end(), layout);
                 break;
 
             case u32_mask_rev('L', 'W', 'O', '2'):
-                import_LWO2(*this, path, p, memory.end());
+                import_LWO2(*this, path, p, memory.end(), layout);
                 break;
 
             default:
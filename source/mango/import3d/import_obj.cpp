@@ -24,20 +24,6 @@ namespace mango::import3d
         u32 normal;
     };
 
-    static inline
-    bool operator == (const VertexOBJ& a, const VertexOBJ& b)
-    {
-        return std::memcmp(&a, &b, sizeof(VertexOBJ)) == 0;
-    }
-
-    struct VertexHash
-    {
-        std::size_t operator () (const VertexOBJ& v) const
-        {
-            return v.position;
-        }
-    };
-
     struct FaceOBJ
     {
         VertexOBJ vertex[3];
@@ -96,6 +82,396 @@ namespace mango::import3d
         std::vector<GroupOBJ> groups;
     };
 
+    // ------------------------------------------------------------------------------
+    // chunk parsing
+    // ------------------------------------------------------------------------------
+
+    /*
+        The file is split into chunks at line boundaries which are parsed in parallel.
+        The first pass counts the vertex attributes in each chunk so that every chunk
+        knows the global attribute offset at its start. The second pass writes the
+        attributes directly into their final location and resolves the relative
+        (negative) face indices. Statements which change the object, group or material
+        are recorded per chunk and replayed in file order when the chunks are stitched.
+    */
+
+    enum class LineOBJ
+    {
+        Other,
+        Position,
+        Normal,
+        Texcoord,
+        Face,
+        Object,
+        Group,
+        Material,
+        Library,
+    };
+
+    struct CommandOBJ
+    {
+        LineOBJ type;
+        std::string name;
+        size_t face; // number of faces in the chunk before this command
+    };
+
+    struct ChunkOBJ
+    {
+        const char* begin;
+        const char* end;
+
+        // attribute counts (first pass)
+        size_t positions = 0;
+        size_t normals = 0;
+        size_t texcoords = 0;
+
+        // attribute offsets in the whole file
+        size_t position_base = 0;
+        size_t normal_base = 0;
+        size_t texcoord_base = 0;
+
+        std::vector<FaceOBJ> faces;
+        std::vector<CommandOBJ> commands;
+    };
+
+    static inline
+    bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    static inline
+    const char* skipBlank(const char* p, const char* end)
+    {
+        while (p < end && isBlank(*p))
+        {
+            ++p;
+        }
+        return p;
+    }
+
+    static inline
+    const char* findNewline(const char* p, const char* end)
+    {
+        const simd::u8x16 newline = simd::u8x16_set('\n');
+
+        while (end - p >= 16)
+        {
+            u32 mask = simd::get_mask(simd::compare_eq(simd::u8x16_uload(p), newline));
+            if (mask)
+            {
+                return p + u32_tzcnt(mask);
+            }
+            p += 16;
+        }
+
+        while (p < end && *p != '\n')
+        {
+            ++p;
+        }
+
+        return p;
+    }
+
+    // returns the line type and moves p to the first argument
+    static inline
+    LineOBJ classifyLine(const char*& p, const char* end)
+    {
+        p = skipBlank(p, end);
+
+        const char* id = p;
+        while (p < end && !isBlank(*p) && *p != '\n')
+        {
+            ++p;
+        }
+
+        const size_t length = p - id;
+        LineOBJ type = LineOBJ::Other;
+
+        if (length == 1)
+        {
+            switch (id[0])
+            {
+                case 'v': type = LineOBJ::Position; break;
+                case 'f': type = LineOBJ::Face; break;
+                case 'o': type = LineOBJ::Object; break;
+                case 'g': type = LineOBJ::Group; break;
+                default: break;
+            }
+        }
+        else if (length == 2 && id[0] == 'v')
+        {
+            if (id[1] == 'n')
+                type = LineOBJ::Normal;
+            else if (id[1] == 't')
+                type = LineOBJ::Texcoord;
+        }
+        else if (length == 6 && !std::memcmp(id, "usemtl", 6))
+        {
+            type = LineOBJ::Material;
+        }
+        else if (length == 6 && !std::memcmp(id, "mtllib", 6))
+        {
+            type = LineOBJ::Library;
+        }
+
+        p = skipBlank(p, end);
+        return type;
+    }
+
+    static inline
+    int parseFloats(float* output, int count, const char* p, const char* end)
+    {
+        int index = 0;
+
+        while (index < count)
+        {
+            p = skipBlank(p, end);
+            if (p >= end)
+                break;
+
+            auto result = fast_float::from_chars(p, end, output[index]);
+            if (result.ec != std::errc())
+                break;
+
+            p = result.ptr;
+            ++index;
+        }
+
+        return index;
+    }
+
+    static inline
+    const char* parseIndex(s32& value, const char* p, const char* end)
+    {
+        bool negative = false;
+
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative = *p++ == '-';
+        }
+
+        s32 result = 0;
+
+        for ( ; p < end; ++p)
+        {
+            u32 d = u32(*p) - '0';
+            if (d > 9)
+                break;
+            result = result * 10 + s32(d);
+        }
+
+        value = negative ? -result : result;
+        return p;
+    }
+
+    static inline
+    const char* stripComment(const char* p, const char* end)
+    {
+        const char* comment = static_cast<const char*>(std::memchr(p, '#', end - p));
+        return comment ? comment : end;
+    }
+
+    static inline
+    const char* parseToken(std::string& token, const char* p, const char* end)
+    {
+        p = skipBlank(p, end);
+
+        const char* first = p;
+        while (p < end && !isBlank(*p))
+        {
+            ++p;
+        }
+
+        token.assign(first, p);
+        return p;
+    }
+
+    static
+    void countChunk(ChunkOBJ& chunk)
+    {
+        const char* end = chunk.end;
+
+        for (const char* p = chunk.begin; p < end; )
+        {
+            const char* eol = findNewline(p, end);
+
+            switch (classifyLine(p, eol))
+            {
+                case LineOBJ::Position: ++chunk.positions; break;
+                case LineOBJ::Normal: ++chunk.normals; break;
+                case LineOBJ::Texcoord: ++chunk.texcoords; break;
+                default: break;
+            }
+
+            p = eol + 1;
+        }
+    }
+
+    static
+    void parseFace(ChunkOBJ& chunk, const char* p, const char* end, const s32* bias)
+    {
+        constexpr size_t maxVertexPerFace = 128;
+
+        VertexOBJ vertex[maxVertexPerFace];
+        size_t count = 0;
+
+        for (;;)
+        {
+            p = skipBlank(p, end);
+            if (p >= end || count == maxVertexPerFace)
+                break;
+
+            // "pos"
+            // "pos/tex"
+            // "pos/tex/nrm"
+            // "pos//nrm"
+            s32 value[3] = { 0, 0, 0 };
+
+            for (int i = 0; i < 3; ++i)
+            {
+                p = parseIndex(value[i], p, end);
+
+                if (p >= end || *p != '/')
+                    break;
+
+                ++p;
+            }
+
+            // skip garbage until the next token
+            while (p < end && !isBlank(*p))
+            {
+                ++p;
+            }
+
+            // negative indices start from the last element
+            for (int i = 0; i < 3; ++i)
+            {
+                if (value[i] < 0)
+                {
+                    value[i] += bias[i];
+                }
+            }
+
+            vertex[count].position = u32(value[0]);
+            vertex[count].texcoord = u32(value[1]);
+            vertex[count].normal = u32(value[2]);
+            ++count;
+        }
+
+        if (count < 3 || p < end)
+        {
+            // error
+            return;
+        }
+
+        for (size_t i = 0; i < count - 2; ++i)
+        {
+            FaceOBJ face;
+
+            face.vertex[0] = vertex[0];
+            face.vertex[1] = vertex[i + 1];
+            face.vertex[2] = vertex[i + 2];
+
+            chunk.faces.push_back(face);
+        }
+    }
+
+    static
+    void parseChunk(ChunkOBJ& chunk, float32x3* positions, float32x3* normals, float32x2* texcoords)
+    {
+        size_t position_index = chunk.position_base;
+        size_t normal_index = chunk.normal_base;
+        size_t texcoord_index = chunk.texcoord_base;
+
+        const char* end = chunk.end;
+
+        for (const char* p = chunk.begin; p < end; )
+        {
+            const char* eol = findNewline(p, end);
+            LineOBJ type = classifyLine(p, eol);
+            const char* last = stripComment(p, eol);
+
+            switch (type)
+            {
+                case LineOBJ::Position:
+                {
+                    float value[3] = { 0.0f, 0.0f, 0.0f };
+                    parseFloats(value, 3, p, last);
+                    positions[position_index++] = float32x3(value[0], value[1], value[2]);
+                    break;
+                }
+
+                case LineOBJ::Normal:
+                {
+                    float value[3] = { 0.0f, 0.0f, 0.0f };
+                    parseFloats(value, 3, p, last);
+                    normals[normal_index++] = float32x3(value[0], value[1], value[2]);
+                    break;
+                }
+
+                case LineOBJ::Texcoord:
+                {
+                    float value[2] = { 0.0f, 0.0f };
+                    parseFloats(value, 2, p, last);
+                    texcoords[texcoord_index++] = float32x2(value[0], value[1]);
+                    break;
+                }
+
+                case LineOBJ::Face:
+                {
+                    const s32 bias[3] =
+                    {
+                        s32(position_index + 1),
+                        s32(texcoord_index + 1),
+                        s32(normal_index + 1),
+                    };
+
+                    parseFace(chunk, p, last, bias);
+                    break;
+                }
+
+                case LineOBJ::Object:
+                case LineOBJ::Group:
+                case LineOBJ::Material:
+                {
+                    std::string name;
+                    parseToken(name, p, last);
+                    if (!name.empty())
+                    {
+                        chunk.commands.push_back({ type, name, chunk.faces.size() });
+                    }
+                    break;
+                }
+
+                case LineOBJ::Library:
+                {
+                    // mtllib can list multiple files
+                    for (;;)
+                    {
+                        std::string filename;
+                        p = parseToken(filename, p, last);
+                        if (filename.empty())
+                            break;
+
+                        chunk.commands.push_back({ type, filename, chunk.faces.size() });
+                    }
+                    break;
+                }
+
+                case LineOBJ::Other:
+                    // comments, smoothing groups and unsupported statements
+                    break;
+            }
+
+            p = eol + 1;
+        }
+    }
+
+    // ------------------------------------------------------------------------------
+    // ReaderOBJ
+    // ------------------------------------------------------------------------------
+
     struct ReaderOBJ
     {
         const filesystem::Path& m_path;
@@ -113,15 +489,12 @@ namespace mango::import3d
 
         void parse_mtl(const std::string_view& s);
 
-        void parse_v(const std::string_view* tokens, size_t count);
-        void parse_vn(const std::string_view* tokens, size_t count);
-        void parse_vt(const std::string_view* tokens, size_t count);
-        void parse_mtllib(const std::string_view* tokens, size_t count);
-        void parse_usemtl(const std::string_view* tokens, size_t count);
-        void parse_o(const std::string_view* tokens, size_t count);
-        void parse_g(const std::string_view* tokens, size_t count);
-        void parse_s(const std::string_view* tokens, size_t count);
-        void parse_f(const std::string_view* tokens, size_t count);
+        void parse_mtllib(const std::string& filename);
+        void parse_usemtl(const std::string& name);
+        void parse_o(const std::string& name);
+        void parse_g(const std::string& name);
+
+        void stitch(const ChunkOBJ& chunk);
 
         ObjectOBJ& getCurrentObject()
         {
@@ -155,54 +528,6 @@ namespace mango::import3d
             return value;
         }
 
-        int parseInt(const char* s) const
-        {
-            int result = 0;
-
-            // Skip whitespaces
-            for ( ;; ++s)
-            {
-                char c = *s;
-                bool whitespace = c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
-                if (!whitespace)
-                    break;
-            }
-
-            if (*s == '-')
-            {
-                ++s;
-
-                // Iterate through all characters of input string and update result
-                for ( ;; ++s)
-                {
-                    u32 d = u32(*s) - '0';
-                    if (d > 9)
-                    {
-                        return result;
-                    }
-                    result = result * 10 - d;
-                }
-            }
-            else if (*s == '+')
-            {
-                ++s;
-            }
-
-            // Iterate through all characters of input string and update result
-            for ( ;; ++s)
-            {
-                u32 d = u32(*s) - '0';
-                if (d > 9)
-                {
-                    return result;
-                }
-                result = result * 10 + d;
-            }
-
-            //  unreachable
-            return result;
-        }
-
         std::string map_filename(const std::string_view* tokens, size_t count) const
         {
             // skip parameters
@@ -246,88 +571,123 @@ namespace mango::import3d
         : m_path(path)
     {
         filesystem::File file(path, filename);
-        std::string_view s(reinterpret_cast<const char *>(file.data()), file.size());
 
-        std::vector<std::string_view> tokens;
+        const char* begin = reinterpret_cast<const char *>(file.data());
+        const char* end = begin + file.size();
 
-        size_t first = 0;
+        // split the file at line boundaries
+        constexpr size_t MB = 1 << 20;
+        const size_t concurrency = ThreadPool::getInstance().size();
+        const size_t chunk_size = std::max(4 * MB, size_t(file.size() / (concurrency * 4 + 1)));
 
-        while (first < s.size())
+        std::vector<ChunkOBJ> chunks;
+
+        for (const char* p = begin; p < end; )
         {
-            size_t second = s.find_first_of(" \t\n\r", first);
+            const char* next = end;
 
-            if (first < second)
+            if (size_t(end - p) > chunk_size)
             {
-                tokens.emplace_back(s.data() + first, second - first);
+                next = findNewline(p + chunk_size, end);
+                next = std::min(next + 1, end);
+            }
 
-                char s0 = s[second + 0];
-                char s1 = s[second + 1];
+            ChunkOBJ chunk;
+            chunk.begin = p;
+            chunk.end = next;
+            chunks.push_back(std::move(chunk));
 
-                if (s0 == '\n' || s0 == '\r' || s1 == '\n' || s1 == '\r')
-                {
-                    /*
-                    printf("%s", std::string(id).c_str());
-                    for (size_t i = 0; i < tokens.size(); ++i)
-                    {
-                        printf(" %s", std::string(tokens[i]).c_str());
-                    }
-                    printf("\n");
-                    */
+            p = next;
+        }
 
-                    const std::string_view& id = tokens[0];
-                    const std::string_view* data = tokens.data() + 1;
-                    size_t count = tokens.size() - 1;
+        ConcurrentQueue q;
 
-                    if (id == "#")
-                    {
-                        // comment
-                    }
-                    else if (id == "v")
-                    {
-                        parse_v(data, count);
-                    }
-                    else if (id == "vn")
-                    {
-                        parse_vn(data, count);
-                    }
-                    else if (id == "vt")
-                    {
-                        parse_vt(data, count);
-                    }
-                    else if (id == "mtllib")
-                    {
-                        parse_mtllib(data, count);
-                    }
-                    else if (id == "usemtl")
-                    {
-                        parse_usemtl(data, count);
-                    }
-                    else if (id == "o")
-                    {
-                        parse_o(data, count);
-                    }
-                    else if (id == "g")
-                    {
-                        parse_g(data, count);
-                    }
-                    else if (id == "s")
-                    {
-                        parse_s(data, count);
-                    }
-                    else if (id == "f")
-                    {
-                        parse_f(data, count);
-                    }
+        // first pass: count the vertex attributes
 
-                    tokens.clear();
-                }
+        for (auto& chunk : chunks)
+        {
+            q.enqueue([&chunk]
+            {
+                countChunk(chunk);
+            });
+        }
+
+        q.wait();
+
+        size_t position_count = 0;
+        size_t normal_count = 0;
+        size_t texcoord_count = 0;
+
+        for (auto& chunk : chunks)
+        {
+            chunk.position_base = position_count;
+            chunk.normal_base = normal_count;
+            chunk.texcoord_base = texcoord_count;
+            position_count += chunk.positions;
+            normal_count += chunk.normals;
+            texcoord_count += chunk.texcoords;
+        }
+
+        positions.resize(position_count);
+        normals.resize(normal_count);
+        texcoords.resize(texcoord_count);
+
+        // second pass: parse the chunks directly into the attribute arrays
+
+        for (auto& chunk : chunks)
+        {
+            q.enqueue([this, &chunk]
+            {
+                parseChunk(chunk, positions.data(), normals.data(), texcoords.data());
+            });
+        }
+
+        q.wait();
+
+        for (const auto& chunk : chunks)
+        {
+            stitch(chunk);
+        }
+    }
+
+    void ReaderOBJ::stitch(const ChunkOBJ& chunk)
+    {
+        size_t first = 0;
+
+        auto flush = [&] (size_t last)
+        {
+            if (first < last)
+            {
+                auto& faces = getCurrentGroup().faces;
+                faces.insert(faces.end(), chunk.faces.begin() + first, chunk.faces.begin() + last);
             }
+            first = last;
+        };
 
-            if (second == std::string_view::npos)
-                break;
+        for (const CommandOBJ& command : chunk.commands)
+        {
+            flush(command.face);
 
-            first = second + 1;
+            switch (command.type)
+            {
+                case LineOBJ::Object:
+                    parse_o(command.name);
+                    break;
+                case LineOBJ::Group:
+                    parse_g(command.name);
+                    break;
+                case LineOBJ::Material:
+                    parse_usemtl(command.name);
+                    break;
+                case LineOBJ::Library:
+                    parse_mtllib(command.name);
+                    break;
+                default:
+                    break;
+            }
         }
+
+        flush(chunk.faces.size());
     }
 
     void ReaderOBJ::parse_mtl(const std::string_view& s)
@@ -466,60 +826,8 @@ namespace mango::import3d
         }
     }
 
-    void ReaderOBJ::parse_v(const std::string_view* tokens, size_t count)
-    {
-        if (count < 3 || count > 4)
-        {
-            // error
-        }
-
-        float value[4];
-
-        value[3] = 1.0;
-
-        for (size_t i = 0; i < count; ++i)
-        {
-            value[i] = parseFloat(tokens[i]);
-        }
-
-        //printf("v %f %f %f %f\n", value[0], value[1], value[2], value[3]);
-        positions.emplace_back(value[0], value[1], value[2]);
-    }
-
-    void ReaderOBJ::parse_vn(const std::string_view* tokens, size_t count)
-    {
-        float32x3 value = parse_float32x3(tokens, count);
-        normals.push_back(value);
-    }
-
-    void ReaderOBJ::parse_vt(const std::string_view* tokens, size_t count)
-    {
-        if (count < 2 || count > 3)
-        {
-            // error
-        }
-
-        float value[3];
-
-        value[2] = 0.0;
-
-        for (size_t i = 0; i < count; ++i)
-        {
-            value[i] = parseFloat(tokens[i]);
-        }
-
-        //printf("vt %f %f %f\n", value[0], value[1], value[2]);
-        texcoords.emplace_back(value[0], value[1]);
-    }
-
-    void ReaderOBJ::parse_mtllib(const std::string_view* tokens, size_t count)
+    void ReaderOBJ::parse_mtllib(const std::string& filename)
     {
-        if (count != 1)
-        {
-            // error
-        }
-
-        std::string filename(tokens[0]);
         printLine(Print::Verbose, "mtllib: {}", filename);
 
         filesystem::File file(m_path, filename);
@@ -528,15 +836,8 @@ namespace mango::import3d
         parse_mtl(s);
     }
 
-    void ReaderOBJ::parse_usemtl(const std::string_view* tokens, size_t count)
+    void ReaderOBJ::parse_usemtl(const std::string& name)
     {
-        if (count != 1)
-        {
-            // error
-        }
-
-        std::string name(tokens[0]);
-
         // NOTE: brute-force search
         for (size_t index = 0; index < m_materials.size(); ++index)
         {
@@ -548,129 +849,116 @@ namespace mango::import3d
         }
     }
 
-    void ReaderOBJ::parse_o(const std::string_view* tokens, size_t count)
+    void ReaderOBJ::parse_o(const std::string& name)
     {
-        if (count != 1)
-        {
-            // error
-            return;
-        }
-
         ObjectOBJ object;
-        object.name = std::string(tokens[0]);
+        object.name = name;
         m_objects.push_back(object);
     }
 
-    void ReaderOBJ::parse_g(const std::string_view* tokens, size_t count)
+    void ReaderOBJ::parse_g(const std::string& name)
     {
-        if (count != 1)
-        {
-            // error
-            return;
-        }
-
         ObjectOBJ& object = getCurrentObject();
 
         GroupOBJ group;
-        group.name = std::string(tokens[0]);
+        group.name = name;
         object.groups.push_back(group);
     }
 
-    void ReaderOBJ::parse_s(const std::string_view* tokens, size_t count)
+    static
+    void convertGroup(IndexedMesh& mesh, const GroupOBJ& group, const ReaderOBJ& reader)
     {
-        if (count != 1)
+        u32 attributes = Vertex::Position;
+
+        if (!reader.normals.empty())
         {
-            // error
-            return;
+            attributes |= Vertex::Normal;
         }
 
-        // TODO
-        /*
-        s 1
-        s off
-        */
-    }
-
-    void ReaderOBJ::parse_f(const std::string_view* tokens, size_t count)
-    {
-        constexpr size_t maxVertexPerFace = 128;
-
-        if (count < 3 || count > maxVertexPerFace)
+        if (!reader.texcoords.empty())
         {
-            // error
-            return;
+            attributes |= Vertex::Texcoord;
         }
 
-        s32 positionIndex[maxVertexPerFace];
-        s32 texcoordIndex[maxVertexPerFace];
-        s32 normalIndex[maxVertexPerFace];
+        // the attributes are written directly into the vertex streams
+        mesh.addAttributes(attributes);
 
-        const s32 bias[3] =
-        {
-            s32(positions.size() + 1),
-            s32(texcoords.size() + 1),
-            s32(normals.size() + 1),
-        };
+        VertexStream* positions = mesh.getStream(Vertex::Position);
+        VertexStream* normals = mesh.getStream(Vertex::Normal);
+        VertexStream* texcoords = mesh.getStream(Vertex::Texcoord);
 
-        for (size_t i = 0; i < count; ++i)
-        {
-            // "pos"
-            // "pos/tex"
-            // "pos/tex/nrm"
-            // "pos//nrm"
-            std::string_view s = tokens[i];
+        // the faces are welded by the position, texcoord and normal indices
+        static_assert(sizeof(FaceOBJ) == sizeof(VertexOBJ) * 3, "FaceOBJ must be tightly packed.");
+
+        const size_t count = group.faces.size() * 3;
+        const VertexOBJ* vertices = group.faces.empty() ? nullptr : group.faces[0].vertex;
 
-            int value[3] = { 0, 0, 0 };
+        mesh.indices.resize(count);
+        size_t unique = weldVertices(mesh.indices.data(), vertices, count, sizeof(VertexOBJ));
 
-            size_t index = 0;
-            size_t first = 0;
+        mesh.resizeVertices(unique);
 
-            while (first < s.size() && index < 3)
+        for (size_t i = 0, next = 0; i < count; ++i)
+        {
+            if (mesh.indices[i] != next)
             {
-                value[index++] = parseInt(s.data() + first);
+                // vertex already exists
+                continue;
+            }
 
-                size_t second = s.find_first_of("/", first);
-                if (second == std::string_view::npos)
-                    break;
+            const u32 index = u32(next++);
 
-                first = second + 1;
+            u32 positionIndex = vertices[i].position;
+            u32 texcoordIndex = vertices[i].texcoord;
+            u32 normalIndex = vertices[i].normal;
+
+            if (positionIndex > reader.positions.size())
+            {
+                //printLine("positionIndex: {} > {}", positionIndex, reader.positions.size());
             }
 
-            // negative indices start from the last element
-            if (value[0] < 0) value[0] += bias[0];
-            if (value[1] < 0) value[1] += bias[1];
-            if (value[2] < 0) value[2] += bias[2];
+            if (texcoordIndex != 0 && texcoordIndex > reader.texcoords.size())
+            {
+                //printLine("texcoordIndex: {} > {}", texcoordIndex, reader.texcoords.size());
+                texcoordIndex = 0;
+            }
 
-            positionIndex[i] = value[0];
-            texcoordIndex[i] = value[1];
-            normalIndex[i] = value[2];
-        }
+            if (normalIndex != 0 && normalIndex > reader.normals.size())
+            {
+                //printLine("normalIndex: {} > {}", normalIndex, reader.normals.size());
+                normalIndex = 0;
+            }
 
-        GroupOBJ& group = getCurrentGroup();
+            float32x3 position = reader.positions[positionIndex - 1];
 
-        auto& faces = group.faces;
+            positions->as<float32x3>()[index] = position;
+            mesh.boundingBox.extend(position);
 
-        for (size_t i = 0; i < count - 2; ++i)
-        {
-            FaceOBJ face;
+            if (texcoordIndex)
+            {
+                float32x2 texcoord = reader.texcoords[texcoordIndex - 1];
+                texcoord.y = -texcoord.y;
+                texcoords->write(index, texcoord);
+            }
 
-            face.vertex[0].position = positionIndex[0];
-            face.vertex[0].texcoord = texcoordIndex[0];
-            face.vertex[0].normal   = normalIndex[0];
+            if (normalIndex)
+            {
+                normals->write(index, reader.normals[normalIndex - 1]);
+            }
+        }
 
-            face.vertex[1].position = positionIndex[i + 1];
-            face.vertex[1].texcoord = texcoordIndex[i + 1];
-            face.vertex[1].normal   = normalIndex[i + 1];
+        Primitive primitive;
 
-            face.vertex[2].position = positionIndex[i + 2];
-            face.vertex[2].texcoord = texcoordIndex[i + 2];
-            face.vertex[2].normal   = normalIndex[i + 2];
+        primitive.type = Primitive::Type::TriangleList;
+        primitive.start = 0;
+        primitive.count = u32(mesh.indices.size());
+        primitive.base = 0;
+        primitive.material = group.material;
 
-            faces.push_back(face);
-        }
+        mesh.primitives.push_back(primitive);
     }
 
-    ImportOBJ::ImportOBJ(const filesystem::Path& path, const std::string& filename)
+    ImportOBJ::ImportOBJ(const filesystem::Path& path, const std::string& filename, const VertexLayout& layout)
     {
         u64 time0 = mango::Time::ms();
 
@@ -680,6 +968,9 @@ namespace mango::import3d
 
         printLine("Materials: {}", reader.m_materials.size());
 
+        // the textures are decoded in the background while the groups are converted
+        TextureLoader loader;
+
         for (const MaterialOBJ& materialobj : reader.m_materials)
         {
             Material material;
@@ -689,10 +980,10 @@ namespace mango::import3d
             material.baseColorFactor = float32x4(materialobj.kd, materialobj.tr);
             material.emissiveFactor = materialobj.ke;
 
-            material.baseColorTexture = createTexture(path, materialobj.map_kd);
-            material.emissiveTexture = createTexture(path, materialobj.map_ke);
-            material.normalTexture = createTexture(path, materialobj.map_bump);
-            material.occlusionTexture = createTexture(path, materialobj.map_ka);
+            material.baseColorTexture = loader.load(path, materialobj.map_kd);
+            material.emissiveTexture = loader.load(path, materialobj.map_ke);
+            material.normalTexture = loader.load(path, materialobj.map_bump);
+            material.occlusionTexture = loader.load(path, materialobj.map_ka);
 
             materials.push_back(material);
         }
@@ -714,88 +1005,21 @@ namespace mango::import3d
 
         printLine("Objects: {}", reader.m_objects.size());
 
+        // the groups are converted into meshes in parallel
+        ConcurrentQueue q;
+
         for (const auto& object : reader.m_objects)
         {
             for (const auto& group : object.groups)
             {
-                std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>();
-                IndexedMesh& mesh = *ptr;
+                std::unique_ptr<IndexedMesh> ptr = std::make_unique<IndexedMesh>(layout);
+                IndexedMesh* mesh = ptr.get();
+                const GroupOBJ* source = &group;
 
-                mesh.flags = Vertex::Position | Vertex::Normal | Vertex::Texcoord;
-
-                std::unordered_map<VertexOBJ, u32, VertexHash> unique;
-
-                for (const FaceOBJ& face : group.faces)
+                q.enqueue([mesh, source, &reader]
                 {
-                    for (int i = 0; i < 3; ++i)
-                    {
-                        u32 index;
-
-                        auto it = unique.find(face.vertex[i]);
-                        if (it != unique.end())
-                        {
-                            // vertex already exists; use it's index
-                            index = it->second;
-                        }
-                        else
-                        {
-                            index = u32(mesh.vertices.size());
-                            unique[face.vertex[i]] = index; // remember the index of this vertex
-
-                            Vertex vertex;
-
-                            u32 positionIndex = face.vertex[i].position;
-                            u32 texcoordIndex = face.vertex[i].texcoord;
-                            u32 normalIndex = face.vertex[i].normal;
-
-                            if (positionIndex > reader.positions.size())
-                            {
-                                //printLine("positionIndex: {} > {}", positionIndex, reader.positions.size());
-                            }
-
-                            if (texcoordIndex != 0 && texcoordIndex > reader.texcoords.size())
-                            {
-                                //printLine("texcoordIndex: {} > {}", texcoordIndex, reader.texcoords.size());
-                                texcoordIndex = 0;
-                            }
-
-                            if (normalIndex != 0 && normalIndex > reader.normals.size())
-                            {
-                                //printLine("normalIndex: {} > {}", normalIndex, reader.normals.size());
-                                normalIndex = 0;
-                            }
-
-                            vertex.position = reader.positions[positionIndex - 1];
-
-                            mesh.boundingBox.extend(vertex.position);
-
-                            if (texcoordIndex)
-                            {
-                                vertex.texcoord = reader.texcoords[texcoordIndex - 1];
-                                vertex.texcoord.y = -vertex.texcoord.y;
-                            }
-
-                            if (normalIndex)
-                            {
-                                vertex.normal = reader.normals[normalIndex - 1];
-                            }
-
-                            mesh.vertices.push_back(vertex);
-                        }
-
-                        mesh.indices.push_back(index);
-                    }
-                }
-
-                Primitive primitive;
-
-                primitive.type = Primitive::Type::TriangleList;
-                primitive.start = 0;
-                primitive.count = u32(mesh.indices.size());
-                primitive.base = 0;
-                primitive.material = group.material;
-
-                mesh.primitives.push_back(primitive);
+                    convertGroup(*mesh, *source, reader);
+                });
 
                 Node node;
 
@@ -808,6 +1032,8 @@ namespace mango::import3d
             } // groups
         } // objects
 
+        q.wait();
+
         printLine("Nodes: {}", nodes.size());
 
         // NOTE: we don't care about hierarchy in the .obj scene
@@ -80,54 +80,143 @@ namespace mango::import3d
     constexpr float pi2 = float(math::pi * 2.0);
 
     // --------------------------------------------------------------------
-    // std::unordered_map<Vertex, u32>
+    // texture
     // --------------------------------------------------------------------
 
-    static inline
-    bool operator == (const Vertex& a, const Vertex& b)
+    TextureImage::TextureImage()
+        : image::Bitmap(0, 0, image::Format(32, image::Format::UNORM, image::Format::RGBA, 8, 8, 8, 8))
     {
-        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
     }
 
-    struct VertexHash
+    Texture createTexture(const filesystem::Path& path, const std::string& filename)
     {
-        std::size_t operator () (const Vertex& v) const
+        Texture texture;
+
+        if (filename.empty())
         {
-            u32 temp[3];
-            std::memcpy(temp, v.position.data(), 12);
-            return (temp[0] ^ temp[1]) | (temp[2] << 16);
+            return texture;
         }
-    };
+
+        TextureLoader loader;
+        texture = loader.load(path, filename);
+
+        return texture;
+    }
+
+    Texture createTexture(ConstMemory memory)
+    {
+        TextureLoader loader;
+        Texture texture = loader.load(memory);
+
+        return texture;
+    }
 
     // --------------------------------------------------------------------
-    // texture
+    // TextureLoader
     // --------------------------------------------------------------------
 
-    Texture createTexture(const filesystem::Path& path, const std::string& filename)
+    TextureLoader::TextureLoader(bool compressed)
+        : m_compressed(compressed)
+    {
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        wait();
+    }
+
+    Texture TextureLoader::decode(ConstMemory memory, const std::string& extension, std::shared_ptr<void> owner)
+    {
+        Texture texture = std::make_shared<TextureImage>();
+
+        // the owner keeps the memory alive until the texture is decoded
+        m_queue.enqueue([this, texture, memory, extension, owner]
+        {
+            // the worker threads do not handle exceptions; a texture which
+            // fails to decode is reported and left empty
+            try
+            {
+                if (m_compressed)
+                {
+                    image::ImageDecoder decoder(memory, extension);
+                    if (decoder.isDecoder())
+                    {
+                        image::ImageHeader header = decoder.header();
+                        if (header && header.compression != image::TextureCompression::NONE)
+                        {
+                            ConstMemory data = decoder.memory(0, 0, 0);
+                            if (data.address)
+                            {
+                                texture->compressed.compression = header.compression;
+                                texture->compressed.width = header.width;
+                                texture->compressed.height = header.height;
+                                texture->compressed.data.append(data);
+                                return;
+                            }
+                        }
+                    }
+                }
+
+                image::Format format(32, image::Format::UNORM, image::Format::RGBA, 8, 8, 8, 8);
+                image::Bitmap bitmap(memory, extension, format);
+                texture->swap(bitmap);
+            }
+            catch (const std::exception& e)
+            {
+                printLine(Print::Error, "[TextureLoader] \"{}\": {}", extension, e.what());
+            }
+        });
+
+        return texture;
+    }
+
+    Texture TextureLoader::load(const filesystem::Path& path, const std::string& filename)
     {
-        std::shared_ptr<image::Bitmap> texture;
+        Texture texture;
 
         if (filename.empty())
         {
             return texture;
         }
 
-        filesystem::File file(path, filename);
+        std::string key = path.pathname() + filename;
 
-        image::Format format(32, image::Format::UNORM, image::Format::RGBA, 8, 8, 8, 8);
-        texture = std::make_shared<image::Bitmap>(file, filename, format);
+        auto it = m_files.find(key);
+        if (it != m_files.end())
+        {
+            return it->second;
+        }
+
+        // open the file here so that a missing file is reported to the caller
+        auto file = std::make_shared<filesystem::File>(path, filename);
+
+        texture = decode(*file, filename, file);
+        m_files[key] = texture;
 
         return texture;
     }
 
-    Texture createTexture(ConstMemory memory)
+    Texture TextureLoader::load(ConstMemory memory)
     {
-        image::Format format(32, image::Format::UNORM, image::Format::RGBA, 8, 8, 8, 8);
-        std::shared_ptr<image::Bitmap> texture = std::make_shared<image::Bitmap>(memory, "", format);
+        XX3H128 hash = xx3hash128(0, memory);
+
+        auto it = m_images.find(hash);
+        if (it != m_images.end())
+        {
+            return it->second;
+        }
+
+        Texture texture = decode(memory, "", nullptr);
+        m_images[hash] = texture;
 
         return texture;
     }
 
+    void TextureLoader::wait()
+    {
+        m_queue.wait();
+    }
+
     void Mesh::computeTangents()
     {
         if (flags & Vertex::Tangent)
@@ -163,61 +252,376 @@ namespace mango::import3d
         flags |= Vertex::Tangent;
     }
 
-    IndexedMesh::IndexedMesh()
+    // --------------------------------------------------------------------
+    // VertexStream
+    // --------------------------------------------------------------------
+
+    static inline
+    s16 encodeSNorm16(float value)
     {
+        value = std::clamp(value, -1.0f, 1.0f);
+        return s16(std::round(value * 32767.0f));
     }
 
-    IndexedMesh::IndexedMesh(const Mesh& mesh, u32 material)
+    static inline
+    float decodeSNorm16(s16 value)
     {
-        append(mesh, material);
+        return std::max(float(value) / 32767.0f, -1.0f);
     }
 
-    void IndexedMesh::append(const Mesh& mesh, u32 material)
+    static inline
+    u8 encodeUNorm8(float value)
     {
-        // NOTE: This starts a new primitive with it's own unique vertices!
-        std::unordered_map<Vertex, u32, VertexHash> unique;
+        value = std::clamp(value, 0.0f, 1.0f);
+        return u8(std::round(value * 255.0f));
+    }
 
-        size_t startIndex = indices.size();
+    static inline
+    float decodeUNorm8(u8 value)
+    {
+        return float(value) / 255.0f;
+    }
 
-        for (const Triangle& triangle : mesh.triangles)
+    VertexLayout VertexLayout::compact()
+    {
+        VertexLayout layout;
+
+        layout.normal   = VertexFormat::SNorm16x4;
+        layout.texcoord = VertexFormat::Float16x2;
+        layout.tangent  = VertexFormat::SNorm16x4;
+        layout.color    = VertexFormat::UNorm8x4;
+
+        return layout;
+    }
+
+    VertexStream::VertexStream(u32 attribute, VertexFormat format)
+        : attribute(attribute)
+        , format(format)
+    {
+        switch (format)
         {
-            for (const Vertex& vertex : triangle.vertex)
-            {
-                u32 index;
+            case VertexFormat::Float32x2: stride = 8; break;
+            case VertexFormat::Float32x3: stride = 12; break;
+            case VertexFormat::Float32x4: stride = 16; break;
+            case VertexFormat::Float16x2: stride = 4; break;
+            case VertexFormat::Float16x4: stride = 8; break;
+            case VertexFormat::SNorm16x4: stride = 8; break;
+            case VertexFormat::UNorm8x4: stride = 4; break;
+            default: stride = 16; break;
+        }
+    }
+
+    float32x4 VertexStream::read(size_t index) const
+    {
+        const u8* p = data.data() + index * stride;
+
+        float temp[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-                auto it = unique.find(vertex);
-                if (it != unique.end())
+        switch (format)
+        {
+            case VertexFormat::Float32x2:
+            case VertexFormat::Float32x3:
+            case VertexFormat::Float32x4:
+                std::memcpy(temp, p, stride);
+                break;
+
+            case VertexFormat::Float16x2:
+            case VertexFormat::Float16x4:
+                for (u32 i = 0; i < stride / 2; ++i)
                 {
-                    // vertex already exists; use it's index
-                    index = it->second;
+                    float16 h(u16(uload16(p + i * 2)));
+                    temp[i] = float(h);
                 }
-                else
+                break;
+
+            case VertexFormat::SNorm16x4:
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    temp[i] = decodeSNorm16(s16(uload16(p + i * 2)));
+                }
+                break;
+
+            case VertexFormat::UNorm8x4:
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    temp[i] = decodeUNorm8(p[i]);
+                }
+                break;
+        }
+
+        return float32x4(temp[0], temp[1], temp[2], temp[3]);
+    }
+
+    void VertexStream::write(size_t index, float32x4 value)
+    {
+        u8* p = data.data() + index * stride;
+
+        const float temp[4] = { value.x, value.y, value.z, value.w };
+
+        switch (format)
+        {
+            case VertexFormat::Float32x2:
+            case VertexFormat::Float32x3:
+            case VertexFormat::Float32x4:
+                std::memcpy(p, temp, stride);
+                break;
+
+            case VertexFormat::Float16x2:
+            case VertexFormat::Float16x4:
+                for (u32 i = 0; i < stride / 2; ++i)
+                {
+                    float16 h(temp[i]);
+                    ustore16(p + i * 2, h.u);
+                }
+                break;
+
+            case VertexFormat::SNorm16x4:
+                for (u32 i = 0; i < 4; ++i)
                 {
-                    index = u32(vertices.size());
-                    unique[vertex] = index; // remember the index of this vertex
-                    vertices.push_back(vertex);
+                    ustore16(p + i * 2, u16(encodeSNorm16(temp[i])));
+                }
+                break;
 
-                    // update bounding box
-                    boundingBox.extend(vertex.position);
+            case VertexFormat::UNorm8x4:
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    p[i] = encodeUNorm8(temp[i]);
                 }
+                break;
+        }
+    }
+
+    // --------------------------------------------------------------------
+    // IndexedMesh
+    // --------------------------------------------------------------------
 
-                indices.push_back(index);
+    IndexedMesh::IndexedMesh(const VertexLayout& layout)
+        : layout(layout)
+    {
+    }
+
+    IndexedMesh::IndexedMesh(const Mesh& mesh, u32 material, const VertexLayout& layout)
+        : layout(layout)
+    {
+        append(mesh, material);
+    }
+
+    void IndexedMesh::addAttributes(u32 attributes)
+    {
+        const size_t count = getVertexCount();
+
+        for (u32 attribute = Vertex::Position; attribute <= Vertex::Color; attribute <<= 1)
+        {
+            if (!(attributes & attribute) || (flags & attribute))
+            {
+                continue;
+            }
+
+            VertexFormat format = VertexFormat::Float32x3;
+
+            switch (attribute)
+            {
+                case Vertex::Normal: format = layout.normal; break;
+                case Vertex::Texcoord: format = layout.texcoord; break;
+                case Vertex::Tangent: format = layout.tangent; break;
+                case Vertex::Color: format = layout.color; break;
+            }
+
+            VertexStream stream(attribute, format);
+            stream.data.resize(count * stream.stride);
+
+            // keep the streams in attribute order
+            auto it = streams.begin();
+            while (it != streams.end() && it->attribute < attribute)
+            {
+                ++it;
+            }
+
+            streams.insert(it, std::move(stream));
+            flags |= attribute;
+        }
+    }
+
+    void IndexedMesh::resizeVertices(size_t count)
+    {
+        for (VertexStream& stream : streams)
+        {
+            stream.data.resize(count * stream.stride);
+        }
+    }
+
+    size_t IndexedMesh::getVertexCount() const
+    {
+        return streams.empty() ? 0 : streams[0].size();
+    }
+
+    VertexStream* IndexedMesh::getStream(u32 attribute)
+    {
+        for (VertexStream& stream : streams)
+        {
+            if (stream.attribute == attribute)
+            {
+                return &stream;
             }
         }
 
-        size_t endIndex = indices.size();
+        return nullptr;
+    }
+
+    const VertexStream* IndexedMesh::getStream(u32 attribute) const
+    {
+        for (const VertexStream& stream : streams)
+        {
+            if (stream.attribute == attribute)
+            {
+                return &stream;
+            }
+        }
+
+        return nullptr;
+    }
+
+    float32x3* IndexedMesh::getPositions()
+    {
+        VertexStream* stream = getStream(Vertex::Position);
+        return stream ? stream->as<float32x3>() : nullptr;
+    }
+
+    const float32x3* IndexedMesh::getPositions() const
+    {
+        const VertexStream* stream = getStream(Vertex::Position);
+        return stream ? stream->as<float32x3>() : nullptr;
+    }
+
+    Vertex IndexedMesh::getVertex(size_t index) const
+    {
+        Vertex vertex;
+
+        for (const VertexStream& stream : streams)
+        {
+            float32x4 value = stream.read(index);
+
+            switch (stream.attribute)
+            {
+                case Vertex::Position:
+                    vertex.position = float32x3(value.x, value.y, value.z);
+                    break;
+                case Vertex::Normal:
+                    vertex.normal = float32x3(value.x, value.y, value.z);
+                    break;
+                case Vertex::Texcoord:
+                    vertex.texcoord = float32x2(value.x, value.y);
+                    break;
+                case Vertex::Tangent:
+                    vertex.tangent = value;
+                    break;
+                case Vertex::Color:
+                    vertex.color = value;
+                    break;
+            }
+        }
+
+        return vertex;
+    }
+
+    void IndexedMesh::setVertex(size_t index, const Vertex& vertex)
+    {
+        for (VertexStream& stream : streams)
+        {
+            switch (stream.attribute)
+            {
+                case Vertex::Position:
+                    stream.write(index, vertex.position);
+                    break;
+                case Vertex::Normal:
+                    stream.write(index, vertex.normal);
+                    break;
+                case Vertex::Texcoord:
+                    stream.write(index, vertex.texcoord);
+                    break;
+                case Vertex::Tangent:
+                    stream.write(index, vertex.tangent);
+                    break;
+                case Vertex::Color:
+                    stream.write(index, vertex.color);
+                    break;
+            }
+        }
+    }
+
+    void IndexedMesh::append(const Mesh& mesh, u32 material, float epsilon)
+    {
+        // NOTE: This starts a new primitive with it's own unique vertices!
+        addAttributes(mesh.flags | Vertex::Position);
+
+        const size_t count = mesh.triangles.size() * 3;
+        const Vertex* vertices = mesh.triangles.empty() ? nullptr : mesh.triangles[0].vertex;
+
+        std::vector<u32> remap(count);
+        size_t unique = weldVertices(remap.data(), reinterpret_cast<const float*>(vertices),
+                                     count, sizeof(Vertex), epsilon);
+
+        // the first occurrence of each unique vertex is stored
+        std::vector<u32> source(unique);
+
+        for (size_t i = 0, next = 0; i < count; ++i)
+        {
+            if (remap[i] == next)
+            {
+                source[next++] = u32(i);
+            }
+        }
+
+        const size_t base = getVertexCount();
+        resizeVertices(base + unique);
+
+        constexpr size_t blockSize = 1 << 16;
+        const size_t blocks = (unique + blockSize - 1) / blockSize;
+
+        std::vector<math::Box> boxes(blocks);
+
+        ConcurrentQueue q;
+
+        for (size_t block = 0; block < blocks; ++block)
+        {
+            q.enqueue([&, block]
+            {
+                const size_t begin = block * blockSize;
+                const size_t end = std::min(begin + blockSize, unique);
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const Vertex& vertex = vertices[source[i]];
+                    setVertex(base + i, vertex);
+                    boxes[block].extend(vertex.position);
+                }
+            });
+        }
+
+        q.wait();
+
+        for (const math::Box& box : boxes)
+        {
+            boundingBox.extend(box);
+        }
+
+        const size_t startIndex = indices.size();
+        indices.resize(startIndex + count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            indices[startIndex + i] = u32(base + remap[i]);
+        }
 
         Primitive primitive;
 
         primitive.type = Primitive::Type::TriangleList;
         primitive.start = u32(startIndex);
-        primitive.count = u32(endIndex - startIndex);
+        primitive.count = u32(count);
         primitive.base = 0;
         primitive.material = material;
 
         primitives.push_back(primitive);
-
-        flags |= mesh.flags;
     }
 
     // --------------------------------------------------------------------
@@ -294,7 +698,8 @@ namespace mango::import3d
         auto ptr = std::make_unique<IndexedMesh>();
         IndexedMesh& mesh = *ptr;
 
-        mesh.flags = Vertex::Position | Vertex::Normal | Vertex::Texcoord | Vertex::Tangent;
+        mesh.addAttributes(Vertex::Position | Vertex::Normal | Vertex::Texcoord | Vertex::Tangent);
+        mesh.resizeVertices(24);
 
         for (int i = 0; i < 6; ++i)
         {
@@ -307,7 +712,7 @@ namespace mango::import3d
             {
                 vertex.position = positions[faces[i * 4 + j]];
                 vertex.texcoord = texcoords[j];
-                mesh.vertices.push_back(vertex);
+                mesh.setVertex(i * 4 + j, vertex);
             }
         }
 
@@ -499,7 +904,8 @@ namespace mango::import3d
         auto ptr = std::make_unique<IndexedMesh>();
         IndexedMesh& mesh = *ptr;
 
-        mesh.flags = Vertex::Position | Vertex::Normal | Vertex::Texcoord | Vertex::Tangent;
+        mesh.addAttributes(Vertex::Position | Vertex::Normal | Vertex::Texcoord | Vertex::Tangent);
+        mesh.resizeVertices(numVertex);
 
         for (int i = 0; i < params.innerSegments + 1; ++i)
         {
@@ -523,7 +929,7 @@ namespace mango::import3d
                 vertex.texcoord = float32x2(i * uscale, j * vscale);
                 vertex.tangent  = float32x4(tangent, 1.0f);
 
-                mesh.vertices.push_back(vertex);
+                mesh.setVertex(i * (params.outerSegments + 1) + j, vertex);
                 mesh.boundingBox.extend(position);
             }
         }
@@ -579,10 +985,10 @@ namespace mango::import3d
         auto ptr = std::make_unique<IndexedMesh>();
         IndexedMesh& mesh = *ptr;
 
-        mesh.flags = Vertex::Position | Vertex::Normal | Vertex::Texcoord | Vertex::Tangent;
+        mesh.addAttributes(Vertex::Position | Vertex::Normal | Vertex::Texcoord | Vertex::Tangent);
 
         const size_t numVertex = (params.steps + 1) * (params.facets + 1) + 1;
-        mesh.vertices.resize(numVertex);
+        mesh.resizeVertices(numVertex);
 
         float Pp = params.p * 0 * pi2 / params.steps;
         float Qp = params.q * 0 * pi2 / params.steps;
@@ -620,20 +1026,22 @@ namespace mango::import3d
                 float32x3 tangent = normalize(B * pointx - N * pointy);
 
                 const int offset = i * (params.facets + 1) + j;
-                Vertex& vertex = mesh.vertices[offset];
+                Vertex vertex;
 
                 vertex.position = centerpoint + normal;
                 vertex.normal   = normalize(normal);
                 vertex.texcoord = float32x2(j * uscale, i * vscale);
                 vertex.tangent  = float32x4(tangent, 1.0f);
 
+                mesh.setVertex(offset, vertex);
                 mesh.boundingBox.extend(vertex.position);
             }
 
             // create duplicate vertex for sideways wrapping
             // otherwise identical to first vertex in the 'ring' except for the U coordinate
-            mesh.vertices[i * (params.facets + 1) + params.facets] = mesh.vertices[i * (params.facets + 1)];
-            mesh.vertices[i * (params.facets + 1) + params.facets].texcoord.x = params.uscale;
+            Vertex vertex = mesh.getVertex(i * (params.facets + 1));
+            vertex.texcoord.x = params.uscale;
+            mesh.setVertex(i * (params.facets + 1) + params.facets, vertex);
 
             centerpoint = nextpoint;
         }
@@ -642,13 +1050,15 @@ namespace mango::import3d
         // otherwise identical to first 'ring' in the knot except for the V coordinate
         for (int j = 0; j < params.facets; ++j)
         {
-            mesh.vertices[params.steps * (params.facets + 1) + j] = mesh.vertices[j];
-            mesh.vertices[params.steps * (params.facets + 1) + j].texcoord.y = params.vscale;
+            Vertex vertex = mesh.getVertex(j);
+            vertex.texcoord.y = params.vscale;
+            mesh.setVertex(params.steps * (params.facets + 1) + j, vertex);
         }
 
         // finally, there's one vertex that needs to be duplicated due to both U and V coordinate.
-        mesh.vertices[params.steps * (params.facets + 1) + params.facets] = mesh.vertices[0];
-        mesh.vertices[params.steps * (params.facets + 1) + params.facets].texcoord = float32x2(params.uscale, params.vscale);
+        Vertex vertex = mesh.getVertex(0);
+        vertex.texcoord = float32x2(params.uscale, params.vscale);
+        mesh.setVertex(params.steps * (params.facets + 1) + params.facets, vertex);
 
         // generate indices
 
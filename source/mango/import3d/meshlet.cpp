@@ -0,0 +1,249 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <algorithm>
+#include <mango/core/core.hpp>
+#include <mango/import3d/mesh.hpp>
+
+namespace
+{
+    using namespace mango;
+    using namespace mango::import3d;
+
+    struct MeshletBuilder
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<u32> vertices;
+        std::vector<u8> triangles;
+    };
+
+    void computeBounds(Meshlet& meshlet, const MeshletBuilder& builder, const float32x3* positions)
+    {
+        const u32* vertices = builder.vertices.data() + meshlet.vertexOffset;
+        const u8* triangles = builder.triangles.data() + meshlet.triangleOffset;
+
+        // bounding sphere around the center of the bounding box
+        math::Box box;
+
+        for (u32 i = 0; i < meshlet.vertexCount; ++i)
+        {
+            box.extend(positions[vertices[i]]);
+        }
+
+        float32x3 center = box.center();
+        float radius = 0.0f;
+
+        for (u32 i = 0; i < meshlet.vertexCount; ++i)
+        {
+            radius = std::max(radius, length(positions[vertices[i]] - center));
+        }
+
+        meshlet.center = center;
+        meshlet.radius = radius;
+
+        // normal cone
+        std::vector<float32x3> normals;
+        float32x3 axis(0.0f, 0.0f, 0.0f);
+
+        for (u32 i = 0; i < meshlet.triangleCount; ++i)
+        {
+            float32x3 p0 = positions[vertices[triangles[i * 3 + 0]]];
+            float32x3 p1 = positions[vertices[triangles[i * 3 + 1]]];
+            float32x3 p2 = positions[vertices[triangles[i * 3 + 2]]];
+
+            float32x3 n = cross(p1 - p0, p2 - p0);
+            float area = length(n);
+
+            if (area > 0.0f)
+            {
+                n = n / area;
+                normals.push_back(n);
+                axis += n;
+            }
+        }
+
+        float len = length(axis);
+
+        meshlet.coneAxis = float32x3(0.0f, 0.0f, 0.0f);
+        meshlet.coneCutoff = 1.0f;
+
+        if (normals.empty() || len == 0.0f)
+        {
+            // degenerate cone; never culled
+            return;
+        }
+
+        axis = axis / len;
+
+        float mindp = 1.0f;
+
+        for (const float32x3& n : normals)
+        {
+            mindp = std::min(mindp, dot(n, axis));
+        }
+
+        meshlet.coneAxis = axis;
+
+        if (mindp <= 0.1f)
+        {
+            // the normals span a hemisphere; culling would never succeed
+            return;
+        }
+
+        // the triangles are back facing when the view direction is within
+        // 90 degrees minus the cone angle from the axis: cos(90 - a) = sin(a)
+        meshlet.coneCutoff = std::sqrt(1.0f - mindp * mindp);
+    }
+
+    void buildPrimitive(MeshletBuilder& builder, const IndexedMesh& mesh, u32 primitiveIndex, u32 maxVertices, u32 maxTriangles)
+    {
+        const Primitive& primitive = mesh.primitives[primitiveIndex];
+
+        if (primitive.type != Primitive::Type::TriangleList || primitive.count < 3)
+        {
+            return;
+        }
+
+        const u32* indices = mesh.indices.data() + primitive.start;
+        const size_t count = primitive.count - primitive.count % 3;
+        const size_t vertexCount = mesh.getVertexCount();
+
+        u32 low = 0xffffffff;
+        u32 high = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            low = std::min(low, indices[i]);
+            high = std::max(high, indices[i]);
+        }
+
+        if (size_t(high) + primitive.base >= vertexCount)
+        {
+            // invalid indices or primitive restart
+            return;
+        }
+
+        const float32x3* positions = mesh.getPositions();
+
+        // meshlet local index of the vertices in the current meshlet
+        std::vector<u8> local(high - low + 1, 0xff);
+
+        Meshlet meshlet;
+
+        meshlet.primitive = primitiveIndex;
+        meshlet.vertexOffset = 0;
+        meshlet.triangleOffset = 0;
+        meshlet.vertexCount = 0;
+        meshlet.triangleCount = 0;
+
+        auto flush = [&]
+        {
+            if (!meshlet.triangleCount)
+            {
+                return;
+            }
+
+            computeBounds(meshlet, builder, positions);
+            builder.meshlets.push_back(meshlet);
+
+            for (u32 i = 0; i < meshlet.vertexCount; ++i)
+            {
+                local[builder.vertices[meshlet.vertexOffset + i] - primitive.base - low] = 0xff;
+            }
+
+            meshlet.vertexOffset = u32(builder.vertices.size());
+            meshlet.triangleOffset = u32(builder.triangles.size());
+            meshlet.vertexCount = 0;
+            meshlet.triangleCount = 0;
+        };
+
+        // the triangles are added in index buffer order; optimize() for the
+        // vertex cache first to get meshlets with better locality
+        for (size_t i = 0; i < count; i += 3)
+        {
+            u8* v[3] =
+            {
+                &local[indices[i + 0] - low],
+                &local[indices[i + 1] - low],
+                &local[indices[i + 2] - low],
+            };
+
+            // the same vertex can appear more than once in a degenerate triangle
+            u32 added = (*v[0] == 0xff) +
+                        (*v[1] == 0xff && v[1] != v[0]) +
+                        (*v[2] == 0xff && v[2] != v[0] && v[2] != v[1]);
+
+            if (meshlet.vertexCount + added > maxVertices || meshlet.triangleCount + 1u > maxTriangles)
+            {
+                flush();
+            }
+
+            for (int j = 0; j < 3; ++j)
+            {
+                if (*v[j] == 0xff)
+                {
+                    *v[j] = meshlet.vertexCount++;
+                    builder.vertices.push_back(indices[i + j] + primitive.base);
+                }
+
+                builder.triangles.push_back(*v[j]);
+            }
+
+            ++meshlet.triangleCount;
+        }
+
+        flush();
+    }
+
+} // namespace
+
+namespace mango::import3d
+{
+
+    MeshletMesh createMeshlets(const IndexedMesh& mesh, u32 maxVertices, u32 maxTriangles)
+    {
+        if (maxVertices < 3 || maxVertices > 255 || maxTriangles < 1 || maxTriangles > 255)
+        {
+            MANGO_EXCEPTION("[createMeshlets] Incorrect meshlet limits: {} vertices, {} triangles.", maxVertices, maxTriangles);
+        }
+
+        const size_t primitiveCount = mesh.primitives.size();
+
+        std::vector<MeshletBuilder> builders(primitiveCount);
+
+        ConcurrentQueue q;
+
+        for (size_t i = 0; i < primitiveCount; ++i)
+        {
+            q.enqueue([&, i]
+            {
+                buildPrimitive(builders[i], mesh, u32(i), maxVertices, maxTriangles);
+            });
+        }
+
+        q.wait();
+
+        // concatenate the primitives
+        MeshletMesh result;
+
+        for (const MeshletBuilder& builder : builders)
+        {
+            const u32 vertexOffset = u32(result.vertices.size());
+            const u32 triangleOffset = u32(result.triangles.size());
+
+            for (Meshlet meshlet : builder.meshlets)
+            {
+                meshlet.vertexOffset += vertexOffset;
+                meshlet.triangleOffset += triangleOffset;
+                result.meshlets.push_back(meshlet);
+            }
+
+            result.vertices.insert(result.vertices.end(), builder.vertices.begin(), builder.vertices.end());
+            result.triangles.insert(result.triangles.end(), builder.triangles.begin(), builder.triangles.end());
+        }
+
+        return result;
+    }
+
+} // namespace mango::import3d
@@ -0,0 +1,831 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/core/core.hpp>
+#include <mango/math/math.hpp>
+#include <mango/import3d/mesh.hpp>
+
+/*
+    EXT_meshopt_compression decoder
+
+    https://github.com/KhronosGroup/glTF/tree/main/extensions/2.0/Vendor/EXT_meshopt_compression
+
+    The vertex data is stored in blocks of byte planes; every byte of the vertex
+    is delta coded against the previous vertex and the deltas are packed into
+    groups of 16 with 0, 2, 4 or 8 bits per delta. The triangles are coded with
+    an edge and a vertex FIFO and the index sequences as zigzag coded deltas.
+*/
+
+namespace
+{
+    using namespace mango;
+    using namespace mango::math;
+
+    // --------------------------------------------------------------------
+    // vertex codec
+    // --------------------------------------------------------------------
+
+    constexpr u8 VertexHeader = 0xa0;
+
+    constexpr size_t VertexBlockSizeBytes = 8192;
+    constexpr size_t VertexBlockMaxSize = 256;
+    constexpr size_t ByteGroupSize = 16;
+    constexpr size_t ByteGroupDecodeLimit = 24;
+    constexpr size_t TailMaxSize = 32;
+
+    inline
+    size_t getVertexBlockSize(size_t stride)
+    {
+        size_t size = VertexBlockSizeBytes / stride;
+        size &= ~(ByteGroupSize - 1);
+        return std::min(size, VertexBlockMaxSize);
+    }
+
+    template <int bits>
+    const u8* decodeBytesGroup(const u8* data, u8* output)
+    {
+        constexpr int values = 8 / bits;
+        constexpr u32 mask = (1 << bits) - 1;
+
+        // the deltas which don't fit into the bits are stored after the packed bits
+        const u8* extra = data + bits * 2;
+
+        u64 packed = littleEndian::uload64(data) & (u64(-1) >> (64 - bits * 16));
+
+        // the lowest bit of every field where all the bits are set
+        constexpr u64 low = 0x5555555555555555ull & (bits == 2 ? ~0ull : 0x1111111111111111ull);
+        u64 escape = packed;
+        for (int i = 1; i < bits; ++i)
+        {
+            escape &= packed >> i;
+        }
+
+        if (!(escape & low))
+        {
+            // fast path: no escaped values
+            for (int i = 0; i < bits * 2; ++i)
+            {
+                u32 byte = data[i];
+
+                for (int j = 0; j < values; ++j)
+                {
+                    output[i * values + j] = u8((byte >> (8 - bits * (j + 1))) & mask);
+                }
+            }
+
+            return extra;
+        }
+
+        for (int i = 0; i < bits * 2; ++i)
+        {
+            u32 byte = data[i];
+
+            for (int j = 0; j < values; ++j)
+            {
+                u32 value = (byte >> (8 - bits)) & mask;
+                byte <<= bits;
+
+                bool escaped = value == mask;
+                *output++ = escaped ? *extra : u8(value);
+                extra += escaped;
+            }
+        }
+
+        return extra;
+    }
+
+#if defined(MANGO_ENABLE_SSSE3)
+
+    struct GroupTables
+    {
+        // shuffle which moves the escaped values into the lanes selected by the mask
+        u8 shuffle[256][8];
+        u8 count[256];
+
+        constexpr GroupTables()
+            : shuffle()
+            , count()
+        {
+            for (int mask = 0; mask < 256; ++mask)
+            {
+                int n = 0;
+
+                for (int i = 0; i < 8; ++i)
+                {
+                    shuffle[mask][i] = (mask & (1 << i)) ? u8(n++) : 0x80;
+                }
+
+                count[mask] = u8(n);
+            }
+        }
+    };
+
+    constexpr GroupTables g_group_tables;
+
+    template <int bits>
+    const u8* decodeBytesGroupSSSE3(const u8* data, u8* output)
+    {
+        __m128i sel;
+        __m128i rest;
+
+        if constexpr (bits == 2)
+        {
+            __m128i sel2 = _mm_cvtsi32_si128(s32(littleEndian::uload32(data)));
+            __m128i sel22 = _mm_unpacklo_epi8(_mm_srli_epi16(sel2, 4), sel2);
+            __m128i sel2222 = _mm_unpacklo_epi8(_mm_srli_epi16(sel22, 2), sel22);
+            sel = _mm_and_si128(sel2222, _mm_set1_epi8(3));
+            rest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 4));
+        }
+        else
+        {
+            __m128i sel4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+            __m128i sel44 = _mm_unpacklo_epi8(_mm_srli_epi16(sel4, 4), sel4);
+            sel = _mm_and_si128(sel44, _mm_set1_epi8(15));
+            rest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 8));
+        }
+
+        __m128i escape = _mm_cmpeq_epi8(sel, _mm_set1_epi8((1 << bits) - 1));
+        u32 mask = _mm_movemask_epi8(escape);
+        u32 mask0 = mask & 0xff;
+        u32 mask1 = mask >> 8;
+
+        // the second half continues from the escaped values of the first half
+        __m128i shuffle0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(g_group_tables.shuffle[mask0]));
+        __m128i shuffle1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(g_group_tables.shuffle[mask1]));
+        shuffle1 = _mm_add_epi8(shuffle1, _mm_set1_epi8(g_group_tables.count[mask0]));
+        __m128i shuffle = _mm_unpacklo_epi64(shuffle0, shuffle1);
+
+        __m128i result = _mm_or_si128(_mm_shuffle_epi8(rest, shuffle), _mm_andnot_si128(escape, sel));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), result);
+
+        return data + bits * 2 + g_group_tables.count[mask0] + g_group_tables.count[mask1];
+    }
+
+#endif // defined(MANGO_ENABLE_SSSE3)
+
+    const u8* decodeBytes(const u8* data, const u8* end, u8* output, size_t size)
+    {
+        // two bits per group select the packing
+        const size_t headerSize = (size / ByteGroupSize + 3) / 4;
+
+        if (size_t(end - data) < headerSize)
+        {
+            return nullptr;
+        }
+
+        const u8* header = data;
+        data += headerSize;
+
+        for (size_t i = 0; i < size; i += ByteGroupSize)
+        {
+            // the tail padding guarantees that a group can be read without checks
+            if (size_t(end - data) < ByteGroupDecodeLimit)
+            {
+                return nullptr;
+            }
+
+            const size_t group = i / ByteGroupSize;
+            const int mode = (header[group / 4] >> ((group % 4) * 2)) & 3;
+
+            switch (mode)
+            {
+                case 0:
+                    std::memset(output + i, 0, ByteGroupSize);
+                    break;
+#if defined(MANGO_ENABLE_SSSE3)
+                case 1:
+                    data = decodeBytesGroupSSSE3<2>(data, output + i);
+                    break;
+                case 2:
+                    data = decodeBytesGroupSSSE3<4>(data, output + i);
+                    break;
+#else
+                case 1:
+                    data = decodeBytesGroup<2>(data, output + i);
+                    break;
+                case 2:
+                    data = decodeBytesGroup<4>(data, output + i);
+                    break;
+#endif
+                case 3:
+                    std::memcpy(output + i, data, ByteGroupSize);
+                    data += ByteGroupSize;
+                    break;
+            }
+        }
+
+        return data;
+    }
+
+    const u8* decodeVertexBlock(const u8* data, const u8* end, u8* output, size_t count, size_t stride, u8* last)
+    {
+        u8 deltas[4][VertexBlockMaxSize];
+
+        const size_t alignedCount = (count + ByteGroupSize - 1) & ~(ByteGroupSize - 1);
+
+        // the stride is a multiple of 4; four byte planes are decoded together
+        for (size_t k = 0; k < stride; k += 4)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                data = decodeBytes(data, end, deltas[j], alignedCount);
+                if (!data)
+                {
+                    return nullptr;
+                }
+            }
+
+            u8* dest = output + k;
+            u32 p = littleEndian::uload32(last + k);
+
+            size_t i = 0;
+
+#if defined(MANGO_ENABLE_SSSE3)
+            __m128i prev = _mm_cvtsi32_si128(s32(p));
+            prev = _mm_shuffle_epi32(prev, 0);
+
+            for ( ; i + 16 <= count; i += 16)
+            {
+                __m128i d0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas[0] + i));
+                __m128i d1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas[1] + i));
+                __m128i d2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas[2] + i));
+                __m128i d3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas[3] + i));
+
+                // transpose the byte planes into vertices
+                __m128i t0 = _mm_unpacklo_epi8(d0, d1);
+                __m128i t1 = _mm_unpackhi_epi8(d0, d1);
+                __m128i t2 = _mm_unpacklo_epi8(d2, d3);
+                __m128i t3 = _mm_unpackhi_epi8(d2, d3);
+
+                __m128i v[4];
+
+                v[0] = _mm_unpacklo_epi16(t0, t2);
+                v[1] = _mm_unpackhi_epi16(t0, t2);
+                v[2] = _mm_unpacklo_epi16(t1, t3);
+                v[3] = _mm_unpackhi_epi16(t1, t3);
+
+                for (int j = 0; j < 4; ++j)
+                {
+                    // zigzag decoding
+                    __m128i x = v[j];
+                    __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(x, _mm_set1_epi8(1)));
+                    x = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi8(0x7f)), sign);
+
+                    // prefix sum of the four vertices
+                    x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+                    x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+                    x = _mm_add_epi8(x, prev);
+                    prev = _mm_shuffle_epi32(x, 0xff);
+
+                    littleEndian::ustore32(dest + stride * 0, u32(_mm_cvtsi128_si32(x)));
+                    littleEndian::ustore32(dest + stride * 1, u32(_mm_cvtsi128_si32(_mm_shuffle_epi32(x, 0x55))));
+                    littleEndian::ustore32(dest + stride * 2, u32(_mm_cvtsi128_si32(_mm_shuffle_epi32(x, 0xaa))));
+                    littleEndian::ustore32(dest + stride * 3, u32(_mm_cvtsi128_si32(prev)));
+                    dest += stride * 4;
+                }
+            }
+
+            p = u32(_mm_cvtsi128_si32(prev));
+#endif
+
+            for ( ; i < count; ++i)
+            {
+                u32 delta = deltas[0][i] | (deltas[1][i] << 8) | (deltas[2][i] << 16) | (deltas[3][i] << 24);
+
+                // zigzag decoding of the four bytes
+                delta = ((delta >> 1) & 0x7f7f7f7f) ^ ((delta & 0x01010101) * 0xff);
+
+                // add the bytes without carry between them
+                p = ((p & 0x7f7f7f7f) + (delta & 0x7f7f7f7f)) ^ ((p ^ delta) & 0x80808080);
+
+                littleEndian::ustore32(dest, p);
+                dest += stride;
+            }
+
+            littleEndian::ustore32(last + k, p);
+        }
+
+        return data;
+    }
+
+    // --------------------------------------------------------------------
+    // index codecs
+    // --------------------------------------------------------------------
+
+    constexpr u8 IndexHeader = 0xe0;
+    constexpr u8 SequenceHeader = 0xd0;
+
+    inline
+    u32 decodeVByte(const u8*& data)
+    {
+        u32 lead = *data++;
+
+        if (lead < 128)
+        {
+            return lead;
+        }
+
+        u32 result = lead & 127;
+        u32 shift = 7;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            u32 group = *data++;
+            result |= (group & 127) << shift;
+            shift += 7;
+
+            if (group < 128)
+            {
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    inline
+    u32 decodeIndex(const u8*& data, u32 last)
+    {
+        u32 v = decodeVByte(data);
+        u32 delta = (v >> 1) ^ u32(-s32(v & 1));
+        return last + delta;
+    }
+
+    inline
+    void writeIndex(void* output, size_t index, size_t size, u32 value)
+    {
+        if (size == 2)
+        {
+            reinterpret_cast<u16*>(output)[index] = u16(value);
+        }
+        else
+        {
+            reinterpret_cast<u32*>(output)[index] = value;
+        }
+    }
+
+    struct TriangleFifo
+    {
+        u32 edges[16][2];
+        u32 vertices[16];
+        size_t edgeOffset = 0;
+        size_t vertexOffset = 0;
+
+        TriangleFifo()
+        {
+            std::memset(edges, 0xff, sizeof(edges));
+            std::memset(vertices, 0xff, sizeof(vertices));
+        }
+
+        void pushEdge(u32 a, u32 b)
+        {
+            edges[edgeOffset][0] = a;
+            edges[edgeOffset][1] = b;
+            edgeOffset = (edgeOffset + 1) & 15;
+        }
+
+        void pushVertex(u32 v, bool push = true)
+        {
+            vertices[vertexOffset] = v;
+            vertexOffset = (vertexOffset + push) & 15;
+        }
+
+        u32 edge(size_t index, int vertex) const
+        {
+            return edges[(edgeOffset - 1 - index) & 15][vertex];
+        }
+
+        u32 vertex(size_t index) const
+        {
+            return vertices[(vertexOffset - index) & 15];
+        }
+    };
+
+    // --------------------------------------------------------------------
+    // filters
+    // --------------------------------------------------------------------
+
+    inline
+    int32x4 roundSigned(float32x4 v)
+    {
+        // round half away from zero like the encoder
+        float32x4 half = select(v >= 0.0f, float32x4(0.5f), float32x4(-0.5f));
+        return truncate<int32x4>(v + half);
+    }
+
+    template <typename T>
+    void decodeFilterOctahedral(T* data, size_t count)
+    {
+        const float32x4 one(float((1 << (sizeof(T) * 8 - 1)) - 1));
+        const float32x4 zero(0.0f);
+
+        // four vertices at a time
+        for (size_t i = 0; i < count; i += 4)
+        {
+            const size_t n = std::min(count - i, size_t(4));
+
+            s32 temp[3][4] = { };
+
+            for (size_t j = 0; j < n; ++j)
+            {
+                temp[0][j] = data[(i + j) * 4 + 0];
+                temp[1][j] = data[(i + j) * 4 + 1];
+                temp[2][j] = data[(i + j) * 4 + 2];
+            }
+
+            float32x4 x = convert<float32x4>(int32x4(temp[0][0], temp[0][1], temp[0][2], temp[0][3]));
+            float32x4 y = convert<float32x4>(int32x4(temp[1][0], temp[1][1], temp[1][2], temp[1][3]));
+            float32x4 z = convert<float32x4>(int32x4(temp[2][0], temp[2][1], temp[2][2], temp[2][3]));
+
+            // the third component encodes 1.0 at the same precision
+            z = z - abs(x) - abs(y);
+
+            // fold the lower hemisphere
+            float32x4 t = min(z, zero);
+            x = x + select(x >= zero, t, -t);
+            y = y + select(y >= zero, t, -t);
+
+            float32x4 len = sqrt(x * x + y * y + z * z);
+            float32x4 s = select(len > zero, one / len, zero);
+
+            int32x4 xi = roundSigned(x * s);
+            int32x4 yi = roundSigned(y * s);
+            int32x4 zi = roundSigned(z * s);
+
+            s32 xs[4];
+            s32 ys[4];
+            s32 zs[4];
+
+            int32x4::ustore(xs, xi);
+            int32x4::ustore(ys, yi);
+            int32x4::ustore(zs, zi);
+
+            for (size_t j = 0; j < n; ++j)
+            {
+                data[(i + j) * 4 + 0] = T(xs[j]);
+                data[(i + j) * 4 + 1] = T(ys[j]);
+                data[(i + j) * 4 + 2] = T(zs[j]);
+            }
+        }
+    }
+
+    void decodeFilterQuaternion(s16* data, size_t count)
+    {
+        const float scale = 1.0f / std::sqrt(2.0f);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            s16* q = data + i * 4;
+
+            // the scale is stored in the high bits of the last component
+            const int sf = q[3] | 3;
+            const float ss = scale / float(sf);
+
+            float32x4 v = float32x4(float(q[0]), float(q[1]), float(q[2]), 0.0f) * ss;
+
+            // reconstruct the largest component
+            float ww = 1.0f - dot(v, v);
+            v.w = std::sqrt(std::max(ww, 0.0f));
+
+            s32 temp[4];
+            int32x4::ustore(temp, roundSigned(v * 32767.0f));
+
+            // the two low bits select the position of the largest component
+            const int qc = q[3] & 3;
+
+            q[(qc + 1) & 3] = s16(temp[0]);
+            q[(qc + 2) & 3] = s16(temp[1]);
+            q[(qc + 3) & 3] = s16(temp[2]);
+            q[(qc + 0) & 3] = s16(temp[3]);
+        }
+    }
+
+    void decodeFilterExponential(u32* data, size_t count)
+    {
+        size_t i = 0;
+
+        for ( ; i + 4 <= count; i += 4)
+        {
+            int32x4 v = int32x4::uload(data + i);
+
+            // 24 bit signed mantissa and 8 bit signed exponent
+            int32x4 m = (v << 8) >> 8;
+            int32x4 e = v >> 24;
+
+            // ldexp(m, e) with the exponent injected into a float
+            float32x4 scale = reinterpret<float32x4>((e + 127) << 23);
+            float32x4 f = convert<float32x4>(m) * scale;
+
+            float32x4::ustore(data + i, f);
+        }
+
+        for ( ; i < count; ++i)
+        {
+            u32 v = data[i];
+
+            s32 m = s32(v << 8) >> 8;
+            s32 e = s32(v) >> 24;
+
+            u32 bits = u32(e + 127) << 23;
+            float scale;
+            std::memcpy(&scale, &bits, 4);
+
+            float f = float(m) * scale;
+            std::memcpy(data + i, &f, 4);
+        }
+    }
+
+} // namespace
+
+namespace mango::import3d
+{
+
+    void decodeMeshoptVertices(void* output, size_t count, size_t stride, ConstMemory source)
+    {
+        if (!stride || stride > 256 || stride % 4)
+        {
+            MANGO_EXCEPTION("[meshopt] Incorrect vertex stride: {}.", stride);
+        }
+
+        const u8* data = source.address;
+        const u8* end = source.address + source.size;
+
+        if (source.size < 1 + stride)
+        {
+            MANGO_EXCEPTION("[meshopt] Not enough vertex data.");
+        }
+
+        u8 header = *data++;
+        if ((header & 0xf0) != VertexHeader || (header & 0x0f) > 0)
+        {
+            MANGO_EXCEPTION("[meshopt] Incorrect vertex header: {:#x}.", header);
+        }
+
+        // the tail stores the baseline for the first delta
+        u8 last[256];
+        std::memcpy(last, end - stride, stride);
+
+        const size_t blockSize = getVertexBlockSize(stride);
+        u8* dest = reinterpret_cast<u8*>(output);
+
+        for (size_t offset = 0; offset < count; offset += blockSize)
+        {
+            size_t size = std::min(blockSize, count - offset);
+
+            data = decodeVertexBlock(data, end, dest + offset * stride, size, stride, last);
+            if (!data)
+            {
+                MANGO_EXCEPTION("[meshopt] Corrupted vertex data.");
+            }
+        }
+
+        if (size_t(end - data) != std::max(stride, TailMaxSize))
+        {
+            MANGO_EXCEPTION("[meshopt] Corrupted vertex data.");
+        }
+    }
+
+    void decodeMeshoptTriangles(void* output, size_t count, size_t size, ConstMemory source)
+    {
+        if (count % 3 || (size != 2 && size != 4))
+        {
+            MANGO_EXCEPTION("[meshopt] Incorrect triangle indices: {} x {} bytes.", count, size);
+        }
+
+        if (source.size < 1 + count / 3 + 16)
+        {
+            MANGO_EXCEPTION("[meshopt] Not enough triangle data.");
+        }
+
+        const u8* buffer = source.address;
+
+        u8 header = buffer[0];
+        int version = header & 0x0f;
+
+        if ((header & 0xf0) != IndexHeader || version > 1)
+        {
+            MANGO_EXCEPTION("[meshopt] Incorrect triangle header: {:#x}.", header);
+        }
+
+        TriangleFifo fifo;
+
+        u32 next = 0;
+        u32 last = 0;
+
+        const int fecmax = version >= 1 ? 13 : 15;
+
+        // the 16 byte code table is at the end of the data
+        const u8* code = buffer + 1;
+        const u8* data = code + count / 3;
+        const u8* end = buffer + source.size - 16;
+        const u8* table = end;
+
+        for (size_t i = 0; i < count; i += 3)
+        {
+            if (data > end)
+            {
+                MANGO_EXCEPTION("[meshopt] Corrupted triangle data.");
+            }
+
+            u32 codetri = *code++;
+
+            if (codetri < 0xf0)
+            {
+                // edge from the fifo
+                int fe = codetri >> 4;
+                u32 a = fifo.edge(fe, 0);
+                u32 b = fifo.edge(fe, 1);
+                u32 c;
+
+                int fec = codetri & 15;
+
+                if (fec < fecmax)
+                {
+                    bool fec0 = fec == 0;
+                    c = fec0 ? next : fifo.vertex(fec + 1);
+                    next += fec0;
+                    fifo.pushVertex(c, fec0);
+                }
+                else
+                {
+                    // 13 and 14 are -1 and 1 deltas from the last free index
+                    c = fec != 15 ? last + (fec - (fec ^ 3)) : decodeIndex(data, last);
+                    last = c;
+                    fifo.pushVertex(c);
+                }
+
+                writeIndex(output, i + 0, size, a);
+                writeIndex(output, i + 1, size, b);
+                writeIndex(output, i + 2, size, c);
+
+                fifo.pushEdge(c, b);
+                fifo.pushEdge(a, c);
+            }
+            else if (codetri < 0xfe)
+            {
+                // vertices from the fifo or new vertices; the codes are in the table
+                u32 codeaux = table[codetri & 15];
+                int feb = codeaux >> 4;
+                int fec = codeaux & 15;
+
+                u32 a = next++;
+
+                bool feb0 = feb == 0;
+                u32 b = feb0 ? next : fifo.vertex(feb);
+                next += feb0;
+
+                bool fec0 = fec == 0;
+                u32 c = fec0 ? next : fifo.vertex(fec);
+                next += fec0;
+
+                writeIndex(output, i + 0, size, a);
+                writeIndex(output, i + 1, size, b);
+                writeIndex(output, i + 2, size, c);
+
+                fifo.pushVertex(a);
+                fifo.pushVertex(b, feb0);
+                fifo.pushVertex(c, fec0);
+
+                fifo.pushEdge(b, a);
+                fifo.pushEdge(c, b);
+                fifo.pushEdge(a, c);
+            }
+            else
+            {
+                // the codes are stored in the data
+                u32 codeaux = *data++;
+                int fea = codetri == 0xfe ? 0 : 15;
+                int feb = codeaux >> 4;
+                int fec = codeaux & 15;
+
+                if (codeaux == 0)
+                {
+                    // restart
+                    next = 0;
+                }
+
+                // the new vertices are numbered before the free indices are decoded
+                u32 a = fea == 0 ? next++ : 0;
+                u32 b = feb == 0 ? next++ : fifo.vertex(feb);
+                u32 c = fec == 0 ? next++ : fifo.vertex(fec);
+
+                if (fea == 15)
+                {
+                    last = a = decodeIndex(data, last);
+                }
+
+                if (feb == 15)
+                {
+                    last = b = decodeIndex(data, last);
+                }
+
+                if (fec == 15)
+                {
+                    last = c = decodeIndex(data, last);
+                }
+
+                writeIndex(output, i + 0, size, a);
+                writeIndex(output, i + 1, size, b);
+                writeIndex(output, i + 2, size, c);
+
+                fifo.pushVertex(a);
+                fifo.pushVertex(b, feb == 0 || feb == 15);
+                fifo.pushVertex(c, fec == 0 || fec == 15);
+
+                fifo.pushEdge(b, a);
+                fifo.pushEdge(c, b);
+                fifo.pushEdge(a, c);
+            }
+        }
+
+        if (data != end)
+        {
+            MANGO_EXCEPTION("[meshopt] Corrupted triangle data.");
+        }
+    }
+
+    void decodeMeshoptIndices(void* output, size_t count, size_t size, ConstMemory source)
+    {
+        if (size != 2 && size != 4)
+        {
+            MANGO_EXCEPTION("[meshopt] Incorrect index size: {}.", size);
+        }
+
+        if (source.size < 1 + count + 4)
+        {
+            MANGO_EXCEPTION("[meshopt] Not enough index data.");
+        }
+
+        const u8* data = source.address;
+
+        u8 header = *data++;
+        if ((header & 0xf0) != SequenceHeader || (header & 0x0f) > 1)
+        {
+            MANGO_EXCEPTION("[meshopt] Incorrect index header: {:#x}.", header);
+        }
+
+        const u8* end = source.address + source.size - 4;
+
+        // two baselines; the lowest bit of the code selects one
+        u32 last[2] = { 0, 0 };
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (data >= end)
+            {
+                MANGO_EXCEPTION("[meshopt] Corrupted index data.");
+            }
+
+            u32 v = decodeVByte(data);
+            u32 baseline = v & 1;
+            v >>= 1;
+
+            u32 delta = (v >> 1) ^ u32(-s32(v & 1));
+            u32 index = last[baseline] + delta;
+            last[baseline] = index;
+
+            writeIndex(output, i, size, index);
+        }
+
+        if (data != end)
+        {
+            MANGO_EXCEPTION("[meshopt] Corrupted index data.");
+        }
+    }
+
+    void decodeMeshoptFilter(void* data, size_t count, size_t stride, MeshoptFilter filter)
+    {
+        switch (filter)
+        {
+            case MeshoptFilter::None:
+                break;
+
+            case MeshoptFilter::Octahedral:
+                if (stride == 4)
+                    decodeFilterOctahedral(reinterpret_cast<s8*>(data), count);
+                else if (stride == 8)
+                    decodeFilterOctahedral(reinterpret_cast<s16*>(data), count);
+                else
+                    MANGO_EXCEPTION("[meshopt] Incorrect octahedral filter stride: {}.", stride);
+                break;
+
+            case MeshoptFilter::Quaternion:
+                if (stride != 8)
+                {
+                    MANGO_EXCEPTION("[meshopt] Incorrect quaternion filter stride: {}.", stride);
+                }
+                decodeFilterQuaternion(reinterpret_cast<s16*>(data), count);
+                break;
+
+            case MeshoptFilter::Exponential:
+                if (stride % 4)
+                {
+                    MANGO_EXCEPTION("[meshopt] Incorrect exponential filter stride: {}.", stride);
+                }
+                decodeFilterExponential(reinterpret_cast<u32*>(data), count * stride / 4);
+                break;
+        }
+    }
+
+} // namespace mango::import3d
@@ -0,0 +1,526 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <algorithm>
+#include <mango/core/core.hpp>
+#include <mango/import3d/mesh.hpp>
+
+/*
+    Mesh optimisation
+
+    Vertex cache: "Fast Triangle Reordering for Vertex Locality and Reduced
+    Overdraw", Sander, Nehab and Barczak, 2007 (Tipsify). The triangles are
+    emitted by fanning around vertices which are still in the simulated
+    cache; the algorithm runs in linear time.
+
+    Overdraw: the cache optimised triangles are split into clusters where
+    the cache efficiency allows it and the clusters are sorted so that the
+    ones facing away from the center of the primitive are drawn first.
+
+    Vertex fetch: the vertices are stored in the order they are first
+    referenced by the index buffer.
+*/
+
+namespace
+{
+    using namespace mango;
+    using namespace mango::import3d;
+
+    constexpr u32 InvalidVertex = 0xffffffff;
+
+    struct Adjacency
+    {
+        std::vector<u32> counts;
+        std::vector<u32> offsets;
+        std::vector<u32> triangles;
+
+        Adjacency(const u32* indices, size_t count, size_t vertexCount)
+            : counts(vertexCount, 0)
+            , offsets(vertexCount + 1)
+            , triangles(count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                ++counts[indices[i]];
+            }
+
+            u32 offset = 0;
+
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                offsets[i] = offset;
+                offset += counts[i];
+            }
+
+            offsets[vertexCount] = offset;
+
+            std::vector<u32> current(offsets.begin(), offsets.end() - 1);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                triangles[current[indices[i]]++] = u32(i / 3);
+            }
+        }
+    };
+
+    // simulated FIFO cache misses of a triangle
+    struct CacheFIFO
+    {
+        std::vector<u32> timestamps;
+        u32 time;
+        u32 size;
+
+        CacheFIFO(size_t vertexCount, u32 size)
+            : timestamps(vertexCount, 0)
+            , time(size + 1)
+            , size(size)
+        {
+        }
+
+        void reset()
+        {
+            time += size + 1;
+        }
+
+        u32 triangle(const u32* v)
+        {
+            u32 misses = 0;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                if (time - timestamps[v[i]] > size)
+                {
+                    timestamps[v[i]] = time++;
+                    ++misses;
+                }
+            }
+
+            return misses;
+        }
+    };
+
+    void tipsify(u32* output, const u32* indices, size_t count, size_t vertexCount, u32 cacheSize)
+    {
+        const size_t triangleCount = count / 3;
+
+        Adjacency adjacency(indices, count, vertexCount);
+
+        std::vector<u32> live = adjacency.counts;
+        std::vector<u32> timestamps(vertexCount, 0);
+        std::vector<u8> emitted(triangleCount, 0);
+        std::vector<u32> deadEnd;
+        std::vector<u32> candidates;
+
+        u32 time = cacheSize + 1;
+        size_t cursor = 0;
+
+        u32 fanning = indices[0];
+
+        while (fanning != InvalidVertex)
+        {
+            candidates.clear();
+
+            // emit the remaining triangles around the fanning vertex
+            const u32* first = adjacency.triangles.data() + adjacency.offsets[fanning];
+            const u32* last = adjacency.triangles.data() + adjacency.offsets[fanning + 1];
+
+            for ( ; first < last; ++first)
+            {
+                const u32 triangle = *first;
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                emitted[triangle] = 1;
+
+                const u32* v = indices + triangle * 3;
+
+                for (int i = 0; i < 3; ++i)
+                {
+                    *output++ = v[i];
+
+                    deadEnd.push_back(v[i]);
+                    candidates.push_back(v[i]);
+
+                    --live[v[i]];
+
+                    if (time - timestamps[v[i]] > cacheSize)
+                    {
+                        timestamps[v[i]] = time++;
+                    }
+                }
+            }
+
+            // the candidate which stays in the cache longest while it's
+            // remaining triangles are emitted is the next fanning vertex
+            fanning = InvalidVertex;
+            int priority = -1;
+
+            for (u32 v : candidates)
+            {
+                if (live[v])
+                {
+                    int p = 0;
+
+                    if (time - timestamps[v] + 2 * live[v] <= cacheSize)
+                    {
+                        p = int(time - timestamps[v]);
+                    }
+
+                    if (p > priority)
+                    {
+                        priority = p;
+                        fanning = v;
+                    }
+                }
+            }
+
+            if (fanning != InvalidVertex)
+            {
+                continue;
+            }
+
+            // dead-end: recently referenced vertex with remaining triangles
+            while (!deadEnd.empty())
+            {
+                u32 v = deadEnd.back();
+                deadEnd.pop_back();
+
+                if (live[v])
+                {
+                    fanning = v;
+                    break;
+                }
+            }
+
+            if (fanning != InvalidVertex)
+            {
+                continue;
+            }
+
+            // next vertex in input order with remaining triangles
+            for ( ; cursor < vertexCount; ++cursor)
+            {
+                if (live[cursor])
+                {
+                    fanning = u32(cursor);
+                    break;
+                }
+            }
+        }
+    }
+
+    struct Cluster
+    {
+        u32 start;
+        u32 count;
+        float sort;
+    };
+
+    void sortClusters(u32* indices, size_t count, const float32x3* positions, size_t vertexCount, u32 cacheSize, float threshold)
+    {
+        const size_t triangleCount = count / 3;
+
+        // cache efficiency of the whole primitive
+        CacheFIFO cache(vertexCount, cacheSize);
+
+        u32 misses = 0;
+
+        for (size_t i = 0; i < triangleCount; ++i)
+        {
+            misses += cache.triangle(indices + i * 3);
+        }
+
+        const float acmr = float(misses) / float(triangleCount);
+
+        // split into clusters where the cluster alone is not less efficient
+        std::vector<Cluster> clusters;
+
+        cache.reset();
+
+        u32 start = 0;
+        misses = 0;
+
+        for (size_t i = 0; i < triangleCount; ++i)
+        {
+            misses += cache.triangle(indices + i * 3);
+
+            const u32 size = u32(i + 1) - start;
+            const bool last = i + 1 == triangleCount;
+
+            if (last || (size >= 16 && float(misses) <= acmr * threshold * float(size)))
+            {
+                clusters.push_back({ start, size, 0.0f });
+
+                start = u32(i + 1);
+                misses = 0;
+
+                cache.reset();
+            }
+        }
+
+        if (clusters.size() < 2)
+        {
+            return;
+        }
+
+        // area weighted centroids and normals
+        float32x3 center(0.0f, 0.0f, 0.0f);
+        float area = 0.0f;
+
+        std::vector<float32x3> centroids(clusters.size());
+        std::vector<float32x3> normals(clusters.size());
+
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            float32x3 centroid(0.0f, 0.0f, 0.0f);
+            float32x3 normal(0.0f, 0.0f, 0.0f);
+            float clusterArea = 0.0f;
+
+            const u32* v = indices + clusters[c].start * 3;
+
+            for (u32 i = 0; i < clusters[c].count; ++i)
+            {
+                float32x3 p0 = positions[v[0]];
+                float32x3 p1 = positions[v[1]];
+                float32x3 p2 = positions[v[2]];
+                v += 3;
+
+                float32x3 n = cross(p1 - p0, p2 - p0);
+                float a = length(n);
+
+                centroid += (p0 + p1 + p2) * (a / 3.0f);
+                normal += n;
+                clusterArea += a;
+            }
+
+            center += centroid;
+            area += clusterArea;
+
+            centroids[c] = clusterArea > 0.0f ? centroid / clusterArea : centroid;
+            normals[c] = normal;
+        }
+
+        if (area > 0.0f)
+        {
+            center = center / area;
+        }
+
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            float32x3 n = normals[c];
+            float len = length(n);
+            n = len > 0.0f ? n / len : n;
+
+            clusters[c].sort = dot(centroids[c] - center, n);
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(), [] (const Cluster& a, const Cluster& b)
+        {
+            return a.sort > b.sort;
+        });
+
+        std::vector<u32> temp(indices, indices + count);
+        u32* output = indices;
+
+        for (const Cluster& cluster : clusters)
+        {
+            const u32* source = temp.data() + cluster.start * 3;
+            std::memcpy(output, source, cluster.count * 12);
+            output += cluster.count * 3;
+        }
+    }
+
+    void optimizePrimitive(IndexedMesh& mesh, const Primitive& primitive, const OptimizeOptions& options)
+    {
+        if (primitive.type != Primitive::Type::TriangleList || primitive.count < 6)
+        {
+            return;
+        }
+
+        u32* indices = mesh.indices.data() + primitive.start;
+        const size_t count = primitive.count - primitive.count % 3;
+
+        // the algorithms work on the range of vertices this primitive uses
+        u32 low = InvalidVertex;
+        u32 high = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            low = std::min(low, indices[i]);
+            high = std::max(high, indices[i]);
+        }
+
+        const size_t vertexCount = mesh.getVertexCount();
+
+        if (size_t(high) + primitive.base >= vertexCount)
+        {
+            // invalid indices or primitive restart
+            return;
+        }
+
+        const size_t range = high - low + 1;
+
+        std::vector<u32> local(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            local[i] = indices[i] - low;
+        }
+
+        if (options.vertexCache)
+        {
+            tipsify(indices, local.data(), count, range, options.cacheSize);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                local[i] = indices[i] - low;
+            }
+        }
+
+        if (options.overdraw)
+        {
+            const float32x3* positions = mesh.getPositions() + primitive.base + low;
+            sortClusters(local.data(), count, positions, range, options.cacheSize, options.overdrawThreshold);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            indices[i] = local[i] + low;
+        }
+    }
+
+    void optimizeVertexFetch(IndexedMesh& mesh)
+    {
+        const size_t vertexCount = mesh.getVertexCount();
+
+        std::vector<u32> remap(vertexCount, InvalidVertex);
+        u32 next = 0;
+
+        for (Primitive& primitive : mesh.primitives)
+        {
+            u32* indices = mesh.indices.data() + primitive.start;
+
+            for (u32 i = 0; i < primitive.count; ++i)
+            {
+                const size_t index = size_t(indices[i]) + primitive.base;
+
+                if (index >= vertexCount)
+                {
+                    // primitive restart is not supported
+                    return;
+                }
+            }
+        }
+
+        for (Primitive& primitive : mesh.primitives)
+        {
+            u32* indices = mesh.indices.data() + primitive.start;
+
+            for (u32 i = 0; i < primitive.count; ++i)
+            {
+                u32& index = remap[indices[i] + primitive.base];
+
+                if (index == InvalidVertex)
+                {
+                    index = next++;
+                }
+
+                indices[i] = index;
+            }
+
+            // the indices are absolute after the remap
+            primitive.base = 0;
+        }
+
+        // unreferenced vertices are kept after the referenced ones
+        for (u32& index : remap)
+        {
+            if (index == InvalidVertex)
+            {
+                index = next++;
+            }
+        }
+
+        for (VertexStream& stream : mesh.streams)
+        {
+            std::vector<u8> data(stream.data.size());
+
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                std::memcpy(data.data() + remap[i] * stream.stride, stream.data.data() + i * stream.stride, stream.stride);
+            }
+
+            stream.data = std::move(data);
+        }
+    }
+
+} // namespace
+
+namespace mango::import3d
+{
+
+    void optimizeVertexCache(u32* indices, size_t count, size_t vertexCount, u32 cacheSize)
+    {
+        count -= count % 3;
+        if (count < 6)
+        {
+            return;
+        }
+
+        std::vector<u32> temp(indices, indices + count);
+        tipsify(indices, temp.data(), count, vertexCount, cacheSize);
+    }
+
+    void optimizeOverdraw(u32* indices, size_t count, const float32x3* positions, size_t vertexCount, u32 cacheSize, float threshold)
+    {
+        count -= count % 3;
+        if (count < 6)
+        {
+            return;
+        }
+
+        sortClusters(indices, count, positions, vertexCount, cacheSize, threshold);
+    }
+
+    void optimize(IndexedMesh& mesh, const OptimizeOptions& options)
+    {
+        ConcurrentQueue q;
+
+        // the primitives have their own index ranges
+        for (const Primitive& primitive : mesh.primitives)
+        {
+            q.enqueue([&mesh, &primitive, &options]
+            {
+                optimizePrimitive(mesh, primitive, options);
+            });
+        }
+
+        q.wait();
+
+        if (options.vertexFetch)
+        {
+            optimizeVertexFetch(mesh);
+        }
+    }
+
+    void optimize(Scene& scene, const OptimizeOptions& options)
+    {
+        ConcurrentQueue q;
+
+        for (auto& mesh : scene.meshes)
+        {
+            IndexedMesh* ptr = mesh.get();
+
+            q.enqueue([ptr, &options]
+            {
+                optimize(*ptr, options);
+            });
+        }
+
+        q.wait();
+    }
+
+} // namespace mango::import3d
@@ -0,0 +1,580 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <algorithm>
+#include <mango/core/core.hpp>
+#include <mango/import3d/mesh.hpp>
+
+/*
+    Mesh simplification
+
+    "Surface Simplification Using Quadric Error Metrics", Garland and
+    Heckbert, 1997. The edges are collapsed into one of their end points so
+    the simplified index buffers reference the original vertices and all
+    levels of detail share the vertex streams.
+
+    The collapses are done in passes: the cheapest collapses of the pass
+    are applied as long as they don't touch the neighbourhood of another
+    collapse from the same pass and don't flip any triangles.
+
+    Vertices on open borders and attribute seams (more than one vertex
+    with the same position) are never collapsed away so that the outline
+    and the texture mapping are preserved.
+*/
+
+namespace
+{
+    using namespace mango;
+    using namespace mango::import3d;
+
+    struct Quadric
+    {
+        double a00, a01, a02, a11, a12, a22;
+        double b0, b1, b2;
+        double c;
+        double weight;
+
+        void plane(float32x3 normal, float d, double area)
+        {
+            const double x = normal.x;
+            const double y = normal.y;
+            const double z = normal.z;
+
+            a00 = area * x * x;
+            a01 = area * x * y;
+            a02 = area * x * z;
+            a11 = area * y * y;
+            a12 = area * y * z;
+            a22 = area * z * z;
+            b0 = area * x * d;
+            b1 = area * y * d;
+            b2 = area * z * d;
+            c = area * d * d;
+            weight = area;
+        }
+
+        void add(const Quadric& q)
+        {
+            a00 += q.a00;
+            a01 += q.a01;
+            a02 += q.a02;
+            a11 += q.a11;
+            a12 += q.a12;
+            a22 += q.a22;
+            b0 += q.b0;
+            b1 += q.b1;
+            b2 += q.b2;
+            c += q.c;
+            weight += q.weight;
+        }
+
+        // squared distance to the planes, averaged by area
+        double error(float32x3 p) const
+        {
+            const double x = p.x;
+            const double y = p.y;
+            const double z = p.z;
+
+            double e = a00 * x * x + a11 * y * y + a22 * z * z +
+                       2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                       2.0 * (b0 * x + b1 * y + b2 * z) + c;
+
+            return std::abs(e) / std::max(weight, 1e-20);
+        }
+    };
+
+    struct Collapse
+    {
+        u32 source;
+        u32 target;
+        double error;
+    };
+
+    // returns true if moving the vertex to target flips any triangle around it
+    bool hasFlips(const u32* indices, const std::vector<u32>& offsets, const std::vector<u32>& adjacency,
+                  const float32x3* positions, u32 vertex, u32 target)
+    {
+        for (u32 i = offsets[vertex]; i < offsets[vertex + 1]; ++i)
+        {
+            const u32* v = indices + adjacency[i] * 3;
+
+            if (v[0] == target || v[1] == target || v[2] == target)
+            {
+                // the triangle is removed by the collapse
+                continue;
+            }
+
+            float32x3 p[3];
+            float32x3 q[3];
+
+            for (int j = 0; j < 3; ++j)
+            {
+                p[j] = positions[v[j]];
+                q[j] = v[j] == vertex ? positions[target] : p[j];
+            }
+
+            float32x3 n0 = cross(p[1] - p[0], p[2] - p[0]);
+            float32x3 n1 = cross(q[1] - q[0], q[2] - q[0]);
+
+            if (dot(n0, n0) == 0.0f)
+            {
+                // degenerate triangle has no orientation
+                continue;
+            }
+
+            if (dot(n0, n1) <= 0.0f)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // the per mesh state is kept between the calls so that the levels of
+    // detail are simplified from the previous level with the accumulated quadrics
+    struct Simplifier
+    {
+        const float32x3* positions;
+        size_t vertexCount;
+
+        std::vector<u8> locked;
+        std::vector<Quadric> quadrics;
+
+        float extent;
+        double currentError = 0.0;
+
+        std::vector<u32> offsets;
+        std::vector<u32> adjacency;
+        std::vector<Collapse> collapses;
+        std::vector<u8> touched;
+        std::vector<u32> collapseTarget;
+
+        Simplifier(const u32* indices, size_t count, const float32x3* positions, size_t vertexCount);
+
+        void reduce(std::vector<u32>& indices, size_t targetCount, float targetError);
+
+        // largest error so far relative to the size of the mesh
+        float getError() const
+        {
+            return float(std::sqrt(currentError) / extent);
+        }
+    };
+
+    Simplifier::Simplifier(const u32* indices, size_t count, const float32x3* positions, size_t vertexCount)
+        : positions(positions)
+        , vertexCount(vertexCount)
+        , offsets(vertexCount + 1)
+        , touched(vertexCount)
+        , collapseTarget(vertexCount)
+    {
+        // vertices which share the position are attribute seams
+        std::vector<u32> remap(vertexCount);
+        size_t uniquePositions = weldVertices(remap.data(), positions, vertexCount, sizeof(float32x3));
+
+        std::vector<u32> positionUsers(uniquePositions, 0);
+        std::vector<u8> used(vertexCount, 0);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            used[indices[i]] = 1;
+        }
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            positionUsers[remap[i]] += used[i];
+        }
+
+        locked.resize(vertexCount, 0);
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            locked[i] = positionUsers[remap[i]] > 1;
+        }
+
+        // open and non-manifold edges by position
+        std::vector<u64> edges;
+        edges.reserve(count);
+
+        for (size_t i = 0; i < count; i += 3)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                u32 a = remap[indices[i + j]];
+                u32 b = remap[indices[i + (j + 1) % 3]];
+                if (a > b)
+                {
+                    std::swap(a, b);
+                }
+
+                edges.push_back((u64(a) << 32) | b);
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+
+        std::vector<u8> border(uniquePositions, 0);
+
+        for (size_t i = 0; i < edges.size(); )
+        {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j] == edges[i])
+            {
+                ++j;
+            }
+
+            if (j - i != 2)
+            {
+                border[edges[i] >> 32] = 1;
+                border[edges[i] & 0xffffffff] = 1;
+            }
+
+            i = j;
+        }
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            locked[i] |= border[remap[i]];
+        }
+
+        // error quadrics of the vertices
+        quadrics.resize(vertexCount);
+        std::memset(quadrics.data(), 0, vertexCount * sizeof(Quadric));
+
+        math::Box box;
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            if (used[i])
+            {
+                box.extend(positions[i]);
+            }
+        }
+
+        for (size_t i = 0; i < count; i += 3)
+        {
+            float32x3 p0 = positions[indices[i + 0]];
+            float32x3 p1 = positions[indices[i + 1]];
+            float32x3 p2 = positions[indices[i + 2]];
+
+            float32x3 n = cross(p1 - p0, p2 - p0);
+            float area = length(n);
+
+            if (area > 0.0f)
+            {
+                n = n / area;
+
+                Quadric q;
+                q.plane(n, -dot(n, p0), area * 0.5);
+
+                for (int j = 0; j < 3; ++j)
+                {
+                    quadrics[indices[i + j]].add(q);
+                }
+            }
+        }
+
+        // the error is relative to the size of the mesh
+        extent = std::max(length(box.size()), 1e-20f);
+    }
+
+    void Simplifier::reduce(std::vector<u32>& indices, size_t targetCount, float targetError)
+    {
+        const double maxError = double(targetError) * double(extent) * double(targetError) * double(extent);
+
+        while (indices.size() > targetCount)
+        {
+            // vertex to triangle adjacency
+            std::fill(offsets.begin(), offsets.end(), 0);
+
+            for (u32 index : indices)
+            {
+                ++offsets[index + 1];
+            }
+
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                offsets[i + 1] += offsets[i];
+            }
+
+            adjacency.resize(indices.size());
+
+            {
+                std::vector<u32> current(offsets.begin(), offsets.end() - 1);
+
+                for (size_t i = 0; i < indices.size(); ++i)
+                {
+                    adjacency[current[indices[i]]++] = u32(i / 3);
+                }
+            }
+
+            // cost of collapsing every edge in both directions
+            collapses.clear();
+
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    const u32 a = indices[i + j];
+                    const u32 b = indices[i + (j + 1) % 3];
+
+                    const u32 edge[2][2] = { { a, b }, { b, a } };
+
+                    for (int k = 0; k < 2; ++k)
+                    {
+                        const u32 source = edge[k][0];
+                        const u32 target = edge[k][1];
+
+                        if (locked[source])
+                        {
+                            continue;
+                        }
+
+                        Quadric q = quadrics[source];
+                        q.add(quadrics[target]);
+
+                        double error = q.error(positions[target]);
+                        if (error <= maxError)
+                        {
+                            collapses.push_back({ source, target, error });
+                        }
+                    }
+                }
+            }
+
+            if (collapses.empty())
+            {
+                break;
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [] (const Collapse& a, const Collapse& b)
+            {
+                return a.error < b.error;
+            });
+
+            // every collapse removes about two triangles
+            const size_t triangles = indices.size() / 3;
+            const size_t goal = (triangles - targetCount / 3) / 2 + 1;
+
+            std::fill(touched.begin(), touched.end(), 0);
+
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                collapseTarget[i] = u32(i);
+            }
+
+            size_t performed = 0;
+
+            for (const Collapse& collapse : collapses)
+            {
+                if (performed >= goal)
+                {
+                    break;
+                }
+
+                const u32 source = collapse.source;
+                const u32 target = collapse.target;
+
+                if (touched[source] || touched[target])
+                {
+                    continue;
+                }
+
+                if (hasFlips(indices.data(), offsets, adjacency, positions, source, target))
+                {
+                    continue;
+                }
+
+                // the neighbourhoods of both end points are fixed for this pass
+                for (u32 vertex : { source, target })
+                {
+                    for (u32 i = offsets[vertex]; i < offsets[vertex + 1]; ++i)
+                    {
+                        const u32* v = indices.data() + adjacency[i] * 3;
+                        touched[v[0]] = 1;
+                        touched[v[1]] = 1;
+                        touched[v[2]] = 1;
+                    }
+                }
+
+                collapseTarget[source] = target;
+                quadrics[target].add(quadrics[source]);
+
+                currentError = std::max(currentError, collapse.error);
+                ++performed;
+            }
+
+            if (!performed)
+            {
+                break;
+            }
+
+            // apply the collapses and remove the degenerate triangles
+            size_t write = 0;
+
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                u32 a = collapseTarget[indices[i + 0]];
+                u32 b = collapseTarget[indices[i + 1]];
+                u32 c = collapseTarget[indices[i + 2]];
+
+                if (a != b && a != c && b != c)
+                {
+                    indices[write + 0] = a;
+                    indices[write + 1] = b;
+                    indices[write + 2] = c;
+                    write += 3;
+                }
+            }
+
+            indices.resize(write);
+        }
+    }
+
+} // namespace
+
+namespace mango::import3d
+{
+
+    size_t simplify(u32* output, const u32* input, size_t count, const float32x3* positions, size_t vertexCount,
+                    size_t targetCount, float targetError, float* resultError)
+    {
+        count -= count % 3;
+
+        std::vector<u32> indices(input, input + count);
+
+        Simplifier simplifier(indices.data(), count, positions, vertexCount);
+        simplifier.reduce(indices, targetCount, targetError);
+
+        if (resultError)
+        {
+            *resultError = simplifier.getError();
+        }
+
+        std::memcpy(output, indices.data(), indices.size() * sizeof(u32));
+
+        return indices.size();
+    }
+
+    std::vector<MeshLOD> createLODs(const IndexedMesh& mesh, int levels, float ratio, float targetError)
+    {
+        const size_t primitiveCount = mesh.primitives.size();
+        const size_t vertexCount = mesh.getVertexCount();
+        const float32x3* positions = mesh.getPositions();
+
+        // simplified indices of every level for every primitive
+        std::vector<std::vector<std::vector<u32>>> results(primitiveCount);
+        std::vector<std::vector<float>> errors(primitiveCount);
+
+        ConcurrentQueue q;
+
+        for (size_t i = 0; i < primitiveCount; ++i)
+        {
+            q.enqueue([&, i]
+            {
+                const Primitive& primitive = mesh.primitives[i];
+
+                const u32* source = mesh.indices.data() + primitive.start;
+                std::vector<u32> current(source, source + primitive.count);
+
+                results[i].resize(levels);
+                errors[i].resize(levels, 0.0f);
+
+                bool simplifiable = primitive.type == Primitive::Type::TriangleList && positions;
+
+                u32 high = 0;
+
+                for (u32 index : current)
+                {
+                    high = std::max(high, index);
+                }
+
+                if (size_t(high) + primitive.base >= vertexCount)
+                {
+                    // invalid indices or primitive restart
+                    simplifiable = false;
+                }
+
+                if (!simplifiable)
+                {
+                    std::fill(results[i].begin(), results[i].end(), current);
+                    return;
+                }
+
+                current.resize(current.size() - current.size() % 3);
+
+                Simplifier simplifier(current.data(), current.size(), positions + primitive.base, high + 1);
+
+                for (int level = 0; level < levels; ++level)
+                {
+                    // each level is simplified from the previous one
+                    size_t previous = current.size();
+                    size_t target = size_t(float(previous / 3) * ratio) * 3;
+                    simplifier.reduce(current, target, targetError);
+
+                    if (current.size() >= previous)
+                    {
+                        // the error bound is reached; the remaining levels would be identical
+                        std::fill(results[i].begin() + level, results[i].end(), current);
+                        std::fill(errors[i].begin() + level, errors[i].end(), simplifier.getError());
+                        break;
+                    }
+
+                    results[i][level] = current;
+                    errors[i][level] = simplifier.getError();
+                }
+            });
+        }
+
+        q.wait();
+
+        std::vector<MeshLOD> lods;
+
+        size_t previous = 0;
+
+        for (const Primitive& primitive : mesh.primitives)
+        {
+            previous += primitive.count;
+        }
+
+        for (int level = 0; level < levels; ++level)
+        {
+            size_t count = 0;
+
+            for (size_t i = 0; i < primitiveCount; ++i)
+            {
+                count += results[i][level].size();
+            }
+
+            if (count >= previous)
+            {
+                // no primitive was reduced; stop instead of repeating the previous level
+                break;
+            }
+
+            previous = count;
+
+            MeshLOD& lod = lods.emplace_back();
+
+            lod.error = 0.0f;
+
+            for (size_t i = 0; i < primitiveCount; ++i)
+            {
+                Primitive primitive = mesh.primitives[i];
+
+                const std::vector<u32>& indices = results[i][level];
+
+                primitive.start = u32(lod.indices.size());
+                primitive.count = u32(indices.size());
+
+                lod.indices.insert(lod.indices.end(), indices.begin(), indices.end());
+                lod.primitives.push_back(primitive);
+                lod.error = std::max(lod.error, errors[i][level]);
+            }
+        }
+
+        return lods;
+    }
+
+} // namespace mango::import3d
@@ -0,0 +1,413 @@
+/*
+    MANGO Multimedia Development Platform
+    Copyright (C) 2012-2024 Twilight Finland 3D Oy Ltd. All rights reserved.
+*/
+#include <mango/core/core.hpp>
+#include <mango/simd/simd.hpp>
+#include <mango/import3d/mesh.hpp>
+
+/*
+    Vertex welding
+
+    The vertices are welded in four parallel passes:
+
+    1. hash every vertex and count the vertices in each partition per chunk
+    2. scatter the vertex indices into partitions; the top bits of the hash
+       select the partition so identical vertices land in the same one
+    3. weld every partition with its own open addressing hash table; the
+       first occurrence of a vertex is the representative of the duplicates
+    4. number the representatives in the order of first occurrence
+
+    The vertex indices are kept in ascending order inside the partitions so
+    the result is deterministic and identical to the sequential welding.
+*/
+
+namespace
+{
+    using namespace mango;
+
+    constexpr size_t WeldChunkSize = 1 << 16;
+    constexpr u32 WeldEmpty = 0xffffffff;
+
+    static inline
+    u32 hashFinalize(u32 h)
+    {
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // hash words (multiple of 4) with four independent lanes
+    static inline
+    u32 hashKey(const u32* key, size_t words)
+    {
+        simd::u32x4 h = simd::u32x4_set(0x9e3779b1, 0x85ebca77, 0xc2b2ae3d, 0x27d4eb2f);
+        const simd::u32x4 prime = simd::u32x4_set(0x85ebca77);
+
+        for (size_t i = 0; i < words; i += 4)
+        {
+            simd::u32x4 k = simd::u32x4_uload(key + i);
+            h = simd::bitwise_xor(h, k);
+            h = simd::mullo(h, prime);
+            h = simd::bitwise_xor(h, simd::srli<15>(h));
+        }
+
+        u32 x = simd::get_component<0>(h);
+        u32 y = simd::get_component<1>(h);
+        u32 z = simd::get_component<2>(h);
+        u32 w = simd::get_component<3>(h);
+
+        return hashFinalize(x ^ u32_ror(y, 7) ^ u32_ror(z, 13) ^ u32_ror(w, 23));
+    }
+
+    // exact binary comparison of the vertices
+    struct KeyExact
+    {
+        const u8* data;
+        size_t stride;
+        size_t words;
+
+        KeyExact(const void* vertices, size_t stride)
+            : data(reinterpret_cast<const u8*>(vertices))
+            , stride(stride)
+            , words((stride / 4 + 3) & ~3)
+        {
+        }
+
+        u32 hash(size_t index) const
+        {
+            const u8* p = data + index * stride;
+
+            if (stride & 15)
+            {
+                u32 temp[64] = { 0 };
+                std::memcpy(temp, p, stride);
+                return hashKey(temp, words);
+            }
+
+            return hashKey(reinterpret_cast<const u32*>(p), words);
+        }
+
+        bool equal(size_t a, size_t b) const
+        {
+            return !std::memcmp(data + a * stride, data + b * stride, stride);
+        }
+    };
+
+    // the attributes are snapped to a grid of epsilon sized cells
+    struct KeyEpsilon
+    {
+        const u8* data;
+        size_t stride;
+        size_t words;
+        float scale;
+
+        KeyEpsilon(const float* vertices, size_t stride, float epsilon)
+            : data(reinterpret_cast<const u8*>(vertices))
+            , stride(stride)
+            , words((stride / 4 + 3) & ~3)
+            , scale(1.0f / epsilon)
+        {
+        }
+
+        void snap(u32* key, size_t index) const
+        {
+            const float* p = reinterpret_cast<const float*>(data + index * stride);
+            const size_t count = stride / 4;
+
+            // the cells are clamped to the s32 range (NaN to the lowest cell)
+            // as the conversion of out of range floats is undefined
+            constexpr float low = -2147483648.0f;
+            constexpr float high = 2147483520.0f;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                float cell = std::floor(p[i] * scale + 0.5f);
+                cell = cell > low ? cell : low;
+                cell = cell < high ? cell : high;
+                key[i] = u32(s32(cell));
+            }
+
+            for (size_t i = count; i < words; ++i)
+            {
+                key[i] = 0;
+            }
+        }
+
+        u32 hash(size_t index) const
+        {
+            u32 key[64];
+            snap(key, index);
+            return hashKey(key, words);
+        }
+
+        bool equal(size_t a, size_t b) const
+        {
+            u32 key0[64];
+            u32 key1[64];
+            snap(key0, a);
+            snap(key1, b);
+            return !std::memcmp(key0, key1, words * 4);
+        }
+    };
+
+    template <typename Key>
+    size_t weld(u32* remap, size_t count, const Key& key)
+    {
+        if (!count)
+        {
+            return 0;
+        }
+
+        const size_t chunks = (count + WeldChunkSize - 1) / WeldChunkSize;
+
+        // the partition count is a power of two so that the top hash bits select it
+        int bits = 0;
+        if (chunks > 1)
+        {
+            size_t threads = ThreadPool::getInstance().size();
+            while ((size_t(1) << bits) < threads * 4 && bits < 8)
+            {
+                ++bits;
+            }
+        }
+
+        const size_t partitions = size_t(1) << bits;
+        const int shift = 32 - bits;
+
+        auto getPartition = [=] (u32 h) -> size_t
+        {
+            return bits ? h >> shift : 0;
+        };
+
+        std::vector<u32> hashes(count);
+        std::vector<u32> order(count);
+        std::vector<size_t> offsets(chunks * partitions, 0);
+
+        ConcurrentQueue q;
+
+        // hash the vertices
+
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            q.enqueue([&, chunk]
+            {
+                const size_t begin = chunk * WeldChunkSize;
+                const size_t end = std::min(begin + WeldChunkSize, count);
+
+                size_t* counts = offsets.data() + chunk * partitions;
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    u32 h = key.hash(i);
+                    hashes[i] = h;
+                    ++counts[getPartition(h)];
+                }
+            });
+        }
+
+        q.wait();
+
+        // compute where each chunk writes its vertices in every partition
+
+        std::vector<size_t> partitionOffsets(partitions + 1);
+
+        size_t offset = 0;
+
+        for (size_t partition = 0; partition < partitions; ++partition)
+        {
+            partitionOffsets[partition] = offset;
+
+            for (size_t chunk = 0; chunk < chunks; ++chunk)
+            {
+                size_t& current = offsets[chunk * partitions + partition];
+                size_t size = current;
+                current = offset;
+                offset += size;
+            }
+        }
+
+        partitionOffsets[partitions] = offset;
+
+        // scatter the vertices into partitions
+
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            q.enqueue([&, chunk]
+            {
+                const size_t begin = chunk * WeldChunkSize;
+                const size_t end = std::min(begin + WeldChunkSize, count);
+
+                size_t* current = offsets.data() + chunk * partitions;
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    order[current[getPartition(hashes[i])]++] = u32(i);
+                }
+            });
+        }
+
+        q.wait();
+
+        // weld the partitions
+
+        for (size_t partition = 0; partition < partitions; ++partition)
+        {
+            q.enqueue([&, partition]
+            {
+                const u32* first = order.data() + partitionOffsets[partition];
+                const u32* last = order.data() + partitionOffsets[partition + 1];
+                const size_t size = last - first;
+
+                size_t capacity = 16;
+                while (capacity < size * 2)
+                {
+                    capacity *= 2;
+                }
+
+                const u32 mask = u32(capacity - 1);
+                std::vector<u32> table(capacity, WeldEmpty);
+
+                for ( ; first < last; ++first)
+                {
+                    const u32 index = *first;
+                    const u32 h = hashes[index];
+
+                    u32 slot = h & mask;
+                    u32 representative = index;
+
+                    for (;;)
+                    {
+                        u32 current = table[slot];
+
+                        if (current == WeldEmpty)
+                        {
+                            table[slot] = index;
+                            break;
+                        }
+
+                        if (hashes[current] == h && key.equal(current, index))
+                        {
+                            representative = current;
+                            break;
+                        }
+
+                        // linear probing
+                        slot = (slot + 1) & mask;
+                    }
+
+                    remap[index] = representative;
+                }
+            });
+        }
+
+        q.wait();
+
+        // number the representatives in order of the first occurrence;
+        // the hashes are not needed anymore so they store the numbers
+
+        std::vector<size_t> uniqueOffsets(chunks);
+
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            q.enqueue([&, chunk]
+            {
+                const size_t begin = chunk * WeldChunkSize;
+                const size_t end = std::min(begin + WeldChunkSize, count);
+
+                size_t unique = 0;
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    unique += (remap[i] == i);
+                }
+
+                uniqueOffsets[chunk] = unique;
+            });
+        }
+
+        q.wait();
+
+        size_t unique = 0;
+
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            size_t size = uniqueOffsets[chunk];
+            uniqueOffsets[chunk] = unique;
+            unique += size;
+        }
+
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            q.enqueue([&, chunk]
+            {
+                const size_t begin = chunk * WeldChunkSize;
+                const size_t end = std::min(begin + WeldChunkSize, count);
+
+                u32 number = u32(uniqueOffsets[chunk]);
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    if (remap[i] == i)
+                    {
+                        hashes[i] = number++;
+                    }
+                }
+            });
+        }
+
+        q.wait();
+
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            q.enqueue([&, chunk]
+            {
+                const size_t begin = chunk * WeldChunkSize;
+                const size_t end = std::min(begin + WeldChunkSize, count);
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    remap[i] = hashes[remap[i]];
+                }
+            });
+        }
+
+        q.wait();
+
+        return unique;
+    }
+
+} // namespace
+
+namespace mango::import3d
+{
+
+    size_t weldVertices(u32* remap, const void* vertices, size_t count, size_t stride)
+    {
+        if (stride & 3 || stride > 256)
+        {
+            MANGO_EXCEPTION("[weldVertices] Incorrect vertex stride: {}.", stride);
+        }
+
+        return weld(remap, count, KeyExact(vertices, stride));
+    }
+
+    size_t weldVertices(u32* remap, const float* vertices, size_t count, size_t stride, float epsilon)
+    {
+        if (stride & 3 || stride > 256)
+        {
+            MANGO_EXCEPTION("[weldVertices] Incorrect vertex stride: {}.", stride);
+        }
+
+        if (epsilon <= 0.0f)
+        {
+            return weld(remap, count, KeyExact(vertices, stride));
+        }
+
+        return weld(remap, count, KeyEpsilon(vertices, stride, epsilon));
+    }
+
+} // namespace mango::import3d
@@ -4,8 +4,94 @@
 */
 
 #include <cmath>
+#include <mango/core/bits.hpp>
 #include <mango/math/geometry.hpp>
 
+namespace
+{
+    using namespace mango;
+    using namespace mango::math;
+
+#if defined(MANGO_ENABLE_AVX512)
+    using BatchFloat = float32x16;
+#else
+    using BatchFloat = float32x8;
+#endif
+
+    constexpr size_t BatchSize = BatchFloat::VectorSize;
+
+    // the last block of the arrays goes through a zero padded temporary
+
+    inline BatchFloat load(const float* source, size_t count)
+    {
+        if (count == BatchSize)
+        {
+            return BatchFloat::uload(source);
+        }
+
+        float temp[BatchSize] = {};
+        std::memcpy(temp, source, count * sizeof(float));
+        return BatchFloat::uload(temp);
+    }
+
+    inline void store(float* dest, BatchFloat value, size_t count)
+    {
+        if (count == BatchSize)
+        {
+            BatchFloat::ustore(dest, value);
+            return;
+        }
+
+        float temp[BatchSize];
+        BatchFloat::ustore(temp, value);
+        std::memcpy(dest, temp, count * sizeof(float));
+    }
+
+    inline u32 blockMask(size_t count)
+    {
+        return u32((u64(1) << count) - 1);
+    }
+
+    inline size_t compact(u32* result, u32 mask, size_t base)
+    {
+        size_t count = 0;
+
+        while (mask)
+        {
+            result[count++] = u32(base + u32_tzcnt(mask));
+            mask &= mask - 1;
+        }
+
+        return count;
+    }
+
+    void transform(PointArray& result, const PointArray& source, const Matrix4x4& m, float w)
+    {
+        const size_t count = source.size();
+
+        result.resize(count);
+
+        const BatchFloat m00(m(0, 0)), m01(m(0, 1)), m02(m(0, 2));
+        const BatchFloat m10(m(1, 0)), m11(m(1, 1)), m12(m(1, 2));
+        const BatchFloat m20(m(2, 0)), m21(m(2, 1)), m22(m(2, 2));
+        const BatchFloat m30(m(3, 0) * w), m31(m(3, 1) * w), m32(m(3, 2) * w);
+
+        for (size_t i = 0; i < count; i += BatchSize)
+        {
+            const size_t n = std::min(BatchSize, count - i);
+
+            const BatchFloat x = load(source.x.data() + i, n);
+            const BatchFloat y = load(source.y.data() + i, n);
+            const BatchFloat z = load(source.z.data() + i, n);
+
+            store(result.x.data() + i, x * m00 + y * m10 + z * m20 + m30, n);
+            store(result.y.data() + i, x * m01 + y * m11 + z * m21 + m31, n);
+            store(result.z.data() + i, x * m02 + y * m12 + z * m22 + m32, n);
+        }
+    }
+
+} // namespace
+
 namespace mango::math
 {
 
@@ -286,6 +372,58 @@ namespace mango::math
         return Ray(origin, normalize(p - origin));
     }
 
+    // ------------------------------------------------------------------
+    // FrustumPlanes
+    // ------------------------------------------------------------------
+
+    FrustumPlanes::FrustumPlanes(const Matrix4x4& tm)
+    {
+        const Matrix4x4 m = transpose(tm);
+
+        const float32x4 v[] =
+        {
+            m[3] + m[0],
+            m[3] - m[0],
+            m[3] + m[1],
+            m[3] - m[1],
+            m[3] + m[2],
+            m[3] - m[2],
+        };
+
+        for (int i = 0; i < 6; ++i)
+        {
+            const float32x3 normal = v[i].xyz;
+            const float s = 1.0f / length(normal);
+            plane[i] = Plane(normal * s, -float(v[i].w) * s);
+        }
+    }
+
+    bool FrustumPlanes::intersect(const Box& box) const
+    {
+        for (const Plane& p : plane)
+        {
+            // the box corner furthest along the plane normal
+            const float32x3 v(box.corner[p.normal.x >= 0].x,
+                              box.corner[p.normal.y >= 0].y,
+                              box.corner[p.normal.z >= 0].z);
+            if (p.distance(v) < 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool FrustumPlanes::intersect(const Sphere& sphere) const
+    {
+        for (const Plane& p : plane)
+        {
+            if (p.distance(sphere.center) < -sphere.radius)
+                return false;
+        }
+
+        return true;
+    }
+
     // ------------------------------------------------------------------
     // Intersect
     // ------------------------------------------------------------------
@@ -651,4 +789,207 @@ namespace mango::math
         return discr >= 0 && test >= 0;
     }
 
+    // ------------------------------------------------------------------
+    // Batch kernels
+    // ------------------------------------------------------------------
+
+    RayPacket::RayPacket(const Ray* rays, size_t count)
+    {
+        count = std::min(count, size_t(8));
+        mask = u32((1 << count) - 1);
+
+        if (!count)
+        {
+            // empty packet: there is no ray to replicate into the inactive lanes
+            ox = oy = oz = float32x8(0.0f);
+            dx = dy = dz = float32x8(0.0f);
+            ix = iy = iz = float32x8(0.0f);
+            return;
+        }
+
+        float temp[9][8] = {};
+
+        for (size_t i = 0; i < 8; ++i)
+        {
+            // the inactive lanes repeat the first ray
+            const Ray& ray = rays[i < count ? i : 0];
+            const float32x3 invdir = 1.0f / ray.direction;
+
+            temp[0][i] = ray.origin.x;
+            temp[1][i] = ray.origin.y;
+            temp[2][i] = ray.origin.z;
+            temp[3][i] = ray.direction.x;
+            temp[4][i] = ray.direction.y;
+            temp[5][i] = ray.direction.z;
+            temp[6][i] = invdir.x;
+            temp[7][i] = invdir.y;
+            temp[8][i] = invdir.z;
+        }
+
+        ox = float32x8::uload(temp[0]);
+        oy = float32x8::uload(temp[1]);
+        oz = float32x8::uload(temp[2]);
+        dx = float32x8::uload(temp[3]);
+        dy = float32x8::uload(temp[4]);
+        dz = float32x8::uload(temp[5]);
+        ix = float32x8::uload(temp[6]);
+        iy = float32x8::uload(temp[7]);
+        iz = float32x8::uload(temp[8]);
+    }
+
+    void transformPoints(PointArray& result, const PointArray& points, const Matrix4x4& m)
+    {
+        transform(result, points, m, 1.0f);
+    }
+
+    void transformVectors(PointArray& result, const PointArray& vectors, const Matrix4x4& m)
+    {
+        transform(result, vectors, m, 0.0f);
+    }
+
+    size_t cull(u32* result, const FrustumPlanes& frustum, const BoxArray& boxes)
+    {
+        const size_t count = boxes.size();
+        size_t visible = 0;
+
+        for (size_t i = 0; i < count; i += BatchSize)
+        {
+            const size_t n = std::min(BatchSize, count - i);
+
+            const BatchFloat x0 = load(boxes.minx.data() + i, n);
+            const BatchFloat y0 = load(boxes.miny.data() + i, n);
+            const BatchFloat z0 = load(boxes.minz.data() + i, n);
+            const BatchFloat x1 = load(boxes.maxx.data() + i, n);
+            const BatchFloat y1 = load(boxes.maxy.data() + i, n);
+            const BatchFloat z1 = load(boxes.maxz.data() + i, n);
+
+            u32 mask = blockMask(n);
+
+            for (const Plane& plane : frustum.plane)
+            {
+                // the box corners furthest along the plane normal
+                const BatchFloat x = plane.normal.x >= 0 ? x1 : x0;
+                const BatchFloat y = plane.normal.y >= 0 ? y1 : y0;
+                const BatchFloat z = plane.normal.z >= 0 ? z1 : z0;
+
+                const BatchFloat d = x * BatchFloat(plane.normal.x) +
+                                     y * BatchFloat(plane.normal.y) +
+                                     z * BatchFloat(plane.normal.z);
+
+                mask &= maskToInt(d >= BatchFloat(plane.dist));
+                if (!mask)
+                    break;
+            }
+
+            visible += compact(result + visible, mask, i);
+        }
+
+        return visible;
+    }
+
+    size_t cull(u32* result, const FrustumPlanes& frustum, const SphereArray& spheres)
+    {
+        const size_t count = spheres.size();
+        size_t visible = 0;
+
+        for (size_t i = 0; i < count; i += BatchSize)
+        {
+            const size_t n = std::min(BatchSize, count - i);
+
+            const BatchFloat x = load(spheres.x.data() + i, n);
+            const BatchFloat y = load(spheres.y.data() + i, n);
+            const BatchFloat z = load(spheres.z.data() + i, n);
+            const BatchFloat r = load(spheres.radius.data() + i, n);
+
+            u32 mask = blockMask(n);
+
+            for (const Plane& plane : frustum.plane)
+            {
+                const BatchFloat d = x * BatchFloat(plane.normal.x) +
+                                     y * BatchFloat(plane.normal.y) +
+                                     z * BatchFloat(plane.normal.z);
+
+                mask &= maskToInt(d + r >= BatchFloat(plane.dist));
+                if (!mask)
+                    break;
+            }
+
+            visible += compact(result + visible, mask, i);
+        }
+
+        return visible;
+    }
+
+    size_t intersect(u32* result, float* distance, const FastRay& ray, const BoxArray& boxes)
+    {
+        const size_t count = boxes.size();
+        size_t hits = 0;
+
+        // the slab planes the ray enters and exits through depend only on the ray direction
+        const float* nearx = ray.sign.x ? boxes.maxx.data() : boxes.minx.data();
+        const float* neary = ray.sign.y ? boxes.maxy.data() : boxes.miny.data();
+        const float* nearz = ray.sign.z ? boxes.maxz.data() : boxes.minz.data();
+        const float* farx = ray.sign.x ? boxes.minx.data() : boxes.maxx.data();
+        const float* fary = ray.sign.y ? boxes.miny.data() : boxes.maxy.data();
+        const float* farz = ray.sign.z ? boxes.minz.data() : boxes.maxz.data();
+
+        const BatchFloat ox(ray.origin.x);
+        const BatchFloat oy(ray.origin.y);
+        const BatchFloat oz(ray.origin.z);
+        const BatchFloat ix(ray.invdir.x);
+        const BatchFloat iy(ray.invdir.y);
+        const BatchFloat iz(ray.invdir.z);
+        const BatchFloat zero(0.0f);
+
+        for (size_t i = 0; i < count; i += BatchSize)
+        {
+            const size_t n = std::min(BatchSize, count - i);
+
+            BatchFloat tmin = (load(nearx + i, n) - ox) * ix;
+            BatchFloat tmax = (load(farx + i, n) - ox) * ix;
+            tmin = max(tmin, (load(neary + i, n) - oy) * iy);
+            tmax = min(tmax, (load(fary + i, n) - oy) * iy);
+            tmin = max(tmin, (load(nearz + i, n) - oz) * iz);
+            tmax = min(tmax, (load(farz + i, n) - oz) * iz);
+
+            u32 mask = maskToInt(tmax > max(tmin, zero)) & blockMask(n);
+            if (!mask)
+                continue;
+
+            float temp[BatchSize];
+            BatchFloat::ustore(temp, tmin);
+
+            while (mask)
+            {
+                const int lane = u32_tzcnt(mask);
+                result[hits] = u32(i + lane);
+                distance[hits] = temp[lane];
+                ++hits;
+                mask &= mask - 1;
+            }
+        }
+
+        return hits;
+    }
+
+    u32 intersect(float32x8& distance, const RayPacket& packet, const Box& box)
+    {
+        const float32x8 x0 = (float32x8(box.corner[0].x) - packet.ox) * packet.ix;
+        const float32x8 x1 = (float32x8(box.corner[1].x) - packet.ox) * packet.ix;
+        const float32x8 y0 = (float32x8(box.corner[0].y) - packet.oy) * packet.iy;
+        const float32x8 y1 = (float32x8(box.corner[1].y) - packet.oy) * packet.iy;
+        const float32x8 z0 = (float32x8(box.corner[0].z) - packet.oz) * packet.iz;
+        const float32x8 z1 = (float32x8(box.corner[1].z) - packet.oz) * packet.iz;
+
+        float32x8 tmin = min(x0, x1);
+        float32x8 tmax = max(x0, x1);
+        tmin = max(tmin, min(y0, y1));
+        tmax = min(tmax, max(y0, y1));
+        tmin = max(tmin, min(z0, z1));
+        tmax = min(tmax, max(z0, z1));
+
+        distance = tmin;
+        return maskToInt(tmax > max(tmin, float32x8(0.0f))) & packet.mask;
+    }
+
 } // namespace mango::math